@@ -0,0 +1,87 @@
+/* -*- C++ -*- ------------------------------------------------------------
+ 
+Copyright (c) 2007 Jesse Anders and Demian Nave http://cmldev.net/
+
+The Configurable Math Library (CML) is distributed under the terms of the
+Boost Software License, v1.0 (see cml/LICENSE for details).
+
+ *-----------------------------------------------------------------------*/
+/** @file
+ *  @brief Selector for banded matrices.
+ */
+
+#ifndef banded_h
+#define banded_h
+
+#include <cml/defaults.h>
+#include <cml/core/common.h>
+#include <cml/packed.h>
+
+namespace cml {
+
+/** This is a selector for banded matrices.
+ *
+ * A banded matrix is square, and stores only the elements on its diagonal,
+ * its first Lower subdiagonals and its first Upper superdiagonals, i.e.
+ * element (i,j) with i-Lower <= j <= i+Upper; the other elements are zero.
+ * banded<1,1> is a tridiagonal matrix, and banded<2,2> a pentadiagonal
+ * one.  Assigning an expression to a banded matrix stores the band of the
+ * expression.  Alloc is rebound to the element type, as for dynamic<>.
+ *
+ * @sa cml/matrix/tridiagonal_solve.h
+ */
+template<int Lower, int Upper, class Alloc = CML_DEFAULT_ARRAY_ALLOC>
+struct banded {
+    enum { lower_bandwidth = Lower, upper_bandwidth = Upper };
+    typedef Alloc allocator_type;
+    typedef banded_tag<Lower,Upper> structure_tag;
+    typedef banded<Upper,Lower,Alloc> transposed_type;
+};
+
+template<int Lower, int Upper, class Alloc>
+struct matrix_structure< banded<Lower,Upper,Alloc> > {
+    typedef banded_tag<Lower,Upper> type;
+};
+
+/* Banded arrays are not stored in row- or column-major order: */
+template<int Lower, int Upper, class Alloc>
+struct contiguous_storage< banded<Lower,Upper,Alloc> > {
+    enum { is_true = false };
+};
+
+namespace detail {
+
+/** Narrow [k0,k1) to the columns of row i inside the band. */
+template<int Lower, int Upper> inline void
+NonZeroCols(size_t i, size_t& k0, size_t& k1, banded_tag<Lower,Upper>)
+{
+    if(i > k0 + Lower) k0 = i - Lower;
+    if(i + Upper + 1 < k1) k1 = i + Upper + 1;
+}
+
+/** Narrow [k0,k1) to the rows of column j inside the band. */
+template<int Lower, int Upper> inline void
+NonZeroRows(size_t j, size_t& k0, size_t& k1, banded_tag<Lower,Upper>)
+{
+    if(j > k0 + Upper) k0 = j - Upper;
+    if(j + Lower + 1 < k1) k1 = j + Lower + 1;
+}
+
+/* The whole band is stored: */
+template<int Lower, int Upper> inline void
+StoredCols(size_t i, size_t& k0, size_t& k1, banded_tag<Lower,Upper>) {
+    NonZeroCols(i, k0, k1, banded_tag<Lower,Upper>());
+}
+
+template<int Lower, int Upper> inline void
+StoredRows(size_t j, size_t& k0, size_t& k1, banded_tag<Lower,Upper>) {
+    NonZeroRows(j, k0, k1, banded_tag<Lower,Upper>());
+}
+
+} // namespace detail
+} // namespace cml
+
+#endif
+
+// -------------------------------------------------------------------------
+// vim:ft=cpp
@@ -65,6 +65,7 @@ Boost Software License, v1.0 (see cml/LICENSE for details).
 
 #include <cml/vector.h>
 #include <cml/matrix.h>
+#include <cml/sparse.h>
 #include <cml/quaternion.h>
 #include <cml/util.h>
 #include <cml/mathlib/mathlib.h>
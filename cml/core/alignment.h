@@ -0,0 +1,178 @@
+/* -*- C++ -*- ------------------------------------------------------------
+ 
+Copyright (c) 2007 Jesse Anders and Demian Nave http://cmldev.net/
+
+The Configurable Math Library (CML) is distributed under the terms of the
+Boost Software License, v1.0 (see cml/LICENSE for details).
+
+ *-----------------------------------------------------------------------*/
+/** @file
+ *  @brief Alignment of array storage.
+ *
+ * Fixed-size arrays are aligned by the third argument of the fixed<>
+ * generator, e.g. vector< float, fixed<4,-1,16> > or
+ * matrix< float, fixed<4,4,64> >.  Dynamic arrays are aligned by their
+ * allocator, e.g. vector< float, dynamic< aligned_allocator<void,32> > >.
+ *
+ * Every array type records its guaranteed alignment in bytes as
+ * array_alignment, which ExprTraits<> reports as alignment for vectors and
+ * matrices.  The SIMD kernels use aligned loads and stores for operands
+ * aligned to at least the packet size.
+ */
+
+#ifndef core_alignment_h
+#define core_alignment_h
+
+#include <cstddef>
+#include <new>
+#include <cml/core/cml_meta.h>
+#include <cml/core/cml_assert.h>
+
+/* This is used below to create a more meaningful compile-time error when
+ * an alignment is not a power of two.
+ */
+struct alignment_must_be_a_power_of_two_error;
+
+/** Declare a variable or member aligned to at least _n_ bytes.
+ *
+ * _n_ can depend on template arguments, but must not be less than the
+ * natural alignment of the type.
+ */
+#if __cplusplus >= 201103L || (defined(_MSC_VER) && _MSC_VER >= 1900)
+#define CML_ALIGNAS(_n_) alignas(_n_)
+#elif defined(__GNUC__)
+#define CML_ALIGNAS(_n_) __attribute__((aligned(_n_)))
+#else
+#error "CML_ALIGNAS is not defined for this compiler."
+#endif
+
+namespace cml {
+
+/** The natural alignment of type E, in bytes. */
+template<typename E> struct alignment_of {
+    struct padded { char c; E e; };
+    enum { value = sizeof(padded) - sizeof(E) };
+};
+
+/** The alignment of an array of E requested to be Align bytes, which is at
+ * least the natural alignment of E.  Align = 0 requests the natural
+ * alignment.
+ */
+template<typename E, int Align> struct storage_alignment {
+    CML_STATIC_REQUIRE_M(
+            (Align >= 0 && (Align & (Align-1)) == 0),
+            alignment_must_be_a_power_of_two_error);
+    enum { natural = alignment_of<E>::value };
+    enum { value = (int(Align) > int(natural)) ? int(Align) : int(natural) };
+};
+
+/** An allocator returning memory aligned to Align bytes.
+ *
+ * This can be used as the allocator of dynamic<>, like std::allocator<void>.
+ * Align must be a power of two.
+ */
+template<typename T, int Align> class aligned_allocator
+{
+  public:
+
+    CML_STATIC_REQUIRE_M(
+            (Align > 0 && (Align & (Align-1)) == 0),
+            alignment_must_be_a_power_of_two_error);
+
+    typedef T value_type;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef size_t size_type;
+    typedef ptrdiff_t difference_type;
+
+    template<class U> struct rebind {
+        typedef aligned_allocator<U,Align> other;
+    };
+
+    enum { alignment = storage_alignment<T,Align>::value };
+
+
+  public:
+
+    aligned_allocator() {}
+    template<class U> aligned_allocator(const aligned_allocator<U,Align>&) {}
+
+    pointer address(reference x) const { return &x; }
+    const_pointer address(const_reference x) const { return &x; }
+
+    size_type max_size() const {
+        return (size_type(-1) - alignment - sizeof(void*)) / sizeof(T);
+    }
+
+    /** Allocate n elements, aligned to alignment bytes.
+     *
+     * The block is over-allocated, and the address returned by operator
+     * new is stored just before the aligned address for deallocate().
+     */
+    pointer allocate(size_type n, const void* = 0) {
+        if(n > max_size()) throw std::bad_alloc();
+        char* raw = static_cast<char*>(
+                ::operator new(n*sizeof(T) + alignment + sizeof(void*)));
+        const size_t a = alignment;
+        char* p = raw + sizeof(void*);
+        p += (a - reinterpret_cast<size_t>(p) % a) % a;
+        reinterpret_cast<void**>(p)[-1] = raw;
+        return reinterpret_cast<pointer>(p);
+    }
+
+    void deallocate(pointer p, size_type) {
+        if(p) ::operator delete(reinterpret_cast<void**>(p)[-1]);
+    }
+
+    void construct(pointer p, const T& x) { new((void*) p) T(x); }
+    void destroy(pointer p) { p->~T(); }
+};
+
+/** The void aligned_allocator<>, used only to rebind to element types. */
+template<int Align> class aligned_allocator<void,Align>
+{
+  public:
+
+    typedef void value_type;
+    typedef void* pointer;
+    typedef const void* const_pointer;
+
+    template<class U> struct rebind {
+        typedef aligned_allocator<U,Align> other;
+    };
+};
+
+template<typename T, typename U, int Align> inline bool operator==(
+        const aligned_allocator<T,Align>&, const aligned_allocator<U,Align>&)
+{
+    return true;
+}
+
+template<typename T, typename U, int Align> inline bool operator!=(
+        const aligned_allocator<T,Align>&, const aligned_allocator<U,Align>&)
+{
+    return false;
+}
+
+/** The alignment of arrays of E from allocator Alloc (already rebound to
+ * E).  Allocators other than aligned_allocator<> are only assumed to give
+ * the natural alignment of E.
+ */
+template<class Alloc, typename E = typename Alloc::value_type>
+struct allocator_alignment {
+    enum { value = alignment_of<E>::value };
+};
+
+template<typename E, int Align>
+struct allocator_alignment<aligned_allocator<E,Align>,E> {
+    enum { value = aligned_allocator<E,Align>::alignment };
+};
+
+} // namespace cml
+
+#endif
+
+// -------------------------------------------------------------------------
+// vim:ft=cpp
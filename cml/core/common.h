@@ -30,6 +30,12 @@ typedef _W64 int   ssize_t;
 #include <utility>              // for std::pair<>
 #include <cml/defaults.h>
 
+/* Use move semantics if the compiler supports rvalue references: */
+#if !defined(CML_NO_RVALUE_REFERENCES) && (__cplusplus >= 201103L \
+        || (defined(_MSC_VER) && _MSC_VER >= 1600))
+#define CML_HAS_RVALUE_REFERENCES
+#endif
+
 namespace cml {
 
 /** 1D tag (to select array shape). */
@@ -74,6 +80,21 @@ struct row_basis {};
 /** Column-vector matrix basis tag. */
 struct col_basis {};
 
+/** General (unstructured) matrix tag. */
+struct general_tag {};
+
+/** Symmetric matrix tag. */
+struct symmetric_tag {};
+
+/** Lower triangular matrix tag. */
+struct lower_triangular_tag {};
+
+/** Upper triangular matrix tag. */
+struct upper_triangular_tag {};
+
+/** Banded matrix tag, for Lower subdiagonals and Upper superdiagonals. */
+template<int Lower, int Upper> struct banded_tag {};
+
 /* This is the pair returned from the matrix size() method, as well as from
  * the matrix expression size checking code:
  */
@@ -14,6 +14,7 @@ Boost Software License, v1.0 (see cml/LICENSE for details).
 #define dynamic_1D_h
 
 #include <memory>
+#include <algorithm>                // for std::swap
 #include <cml/core/common.h>
 #include <cml/dynamic.h>
 
@@ -23,6 +24,9 @@ namespace cml {
  *
  * @note The allocator should be an STL-compatible allocator.
  *
+ * The array keeps its allocation when it shrinks, so that it can be resized
+ * or copied into again without reallocating; see capacity() and reserve().
+ *
  * @internal The internal array type <em>must</em> have the proper copy
  * semantics, otherwise copy construction will fail.
  */
@@ -62,24 +66,38 @@ class dynamic_1D
     /** Dynamic arrays have no fixed size. */
     enum { array_size = -1 };
 
+    /** The alignment of the array in bytes, given by the allocator. */
+    enum { array_alignment = allocator_alignment<allocator_type>::value };
+
 
   public:
 
     /** Construct a dynamic array with no size. */
-    dynamic_1D() : m_size(0), m_data(0), m_alloc() {}
+    dynamic_1D() : m_size(0), m_capacity(0), m_data(0), m_alloc() {}
 
     /** Construct a dynamic array given the size. */
-    explicit dynamic_1D(size_t size) : m_size(0), m_data(0), m_alloc() {
+    explicit dynamic_1D(size_t size)
+      : m_size(0), m_capacity(0), m_data(0), m_alloc()
+    {
       this->resize(size);
     }
 
     /** Copy construct a dynamic array. */
     dynamic_1D(const dynamic_1D& other)
-      : m_size(0), m_data(0), m_alloc()
+      : m_size(0), m_capacity(0), m_data(0), m_alloc()
     {
       this->copy(other);
     }
 
+#if defined(CML_HAS_RVALUE_REFERENCES)
+    /** Move construct a dynamic array, taking the array of other. */
+    dynamic_1D(dynamic_1D&& other)
+      : m_size(0), m_capacity(0), m_data(0), m_alloc()
+    {
+      this->swap(other);
+    }
+#endif
+
     ~dynamic_1D() {
       this->destroy();
     }
@@ -90,6 +108,11 @@ class dynamic_1D
     /** Return the number of elements in the array. */
     size_t size() const { return m_size; }
 
+    /** Return the number of elements the array can hold without
+     * reallocating.
+     */
+    size_t capacity() const { return m_capacity; }
+
     /** Access to the data as a C array.
      *
      * @param i a size_t index into the array.
@@ -117,9 +140,9 @@ class dynamic_1D
 
   public:
 
-    /** Set the array size to the given value.  The previous contents are
-     * destroyed before reallocating the array.  If s == size(),
-     * nothing happens.
+    /** Set the array size to the given value.  The elements are reset to
+     * value_type().  The array is only reallocated if s > capacity().  If
+     * s == size(), nothing happens.
      *
      * @warning This is not guaranteed to preserve the original data.
      */
@@ -128,43 +151,127 @@ class dynamic_1D
       /* Nothing to do if the size isn't changing: */
       if(s == m_size) return;
 
-      /* Destroy the current array contents: */
+      /* Reuse the current array if it's big enough: */
+      if(s <= m_capacity) {
+	for(size_t i = 0; i < s; ++ i) m_data[i] = value_type();
+	m_size = s;
+	return;
+      }
+
+      /* Otherwise, destroy the current array and allocate a new one: */
       this->destroy();
+      value_type* data = m_alloc.allocate(s);
+      for(size_t i = 0; i < s; ++ i)
+	m_alloc.construct(&data[i], value_type());
 
-      /* Set the new size if non-zero: */
-      if(s > 0) {
-	value_type* data = m_alloc.allocate(s);
-	for(size_t i = 0; i < s; ++ i)
-	  m_alloc.construct(&data[i], value_type());
+      /* Success, save s and data: */
+      m_size = m_capacity = s;
+      m_data = data;
+    }
 
-	/* Success, save s and data: */
+    /** Set the array size to the given value, without resetting the
+     * elements.  This is for arrays that are overwritten completely next,
+     * like the library's temporaries.  The elements keep their old values
+     * if the array is reused, and are left uninitialized if value_type has
+     * a trivial constructor (see has_trivial_constructor<>).
+     */
+    void resize_uninitialized(size_t s) {
+
+      /* Reuse the current array if it's big enough: */
+      if(s <= m_capacity) {
 	m_size = s;
-	m_data = data;
+	return;
+      }
+
+      /* Otherwise, destroy the current array and allocate a new one: */
+      this->destroy();
+      value_type* data = m_alloc.allocate(s);
+      if(!has_trivial_constructor<value_type>::is_true) {
+	for(size_t i = 0; i < s; ++ i)
+	  m_alloc.construct(&data[i], value_type());
       }
+
+      /* Success, save s and data: */
+      m_size = m_capacity = s;
+      m_data = data;
+    }
+
+    /** Make room for at least n elements without reallocating, preserving
+     * the current elements.
+     */
+    void reserve(size_t n) {
+
+      /* Nothing to do if the array is already big enough: */
+      if(n <= m_capacity) return;
+
+      value_type* data = m_alloc.allocate(n);
+      for(size_t i = 0; i < m_size; ++ i)
+	m_alloc.construct(&data[i], m_data[i]);
+      for(size_t i = m_size; i < n; ++ i)
+	m_alloc.construct(&data[i], value_type());
+
+      /* Success, so replace the array: */
+      size_t s = m_size;
+      this->destroy();
+      m_size = s;
+      m_capacity = n;
+      m_data = data;
     }
 
-    /** Copy the source array. The previous contents are destroyed before
-     * reallocating the array.  If other == *this, nothing happens.
+    /** Copy the source array.  The current array is reused if it is big
+     * enough, and reallocated otherwise.  If other == *this, nothing
+     * happens.
      */
     void copy(const dynamic_1D& other) {
 
       /* Nothing to do if it's the same array: */
       if(&other == this) return;
 
-      /* Destroy the current array contents: */
-      this->destroy();
-
-      /* Set the new size if non-zero: */
+      /* Reuse the current array if it's big enough: */
       size_t s = other.size();
-      if(s > 0) {
-	value_type* data = m_alloc.allocate(s);
-	for(size_t i = 0; i < s; ++ i)
-	  m_alloc.construct(&data[i], other[i]);
-
-	/* Success, so save the new array and the size: */
+      if(s <= m_capacity) {
+	for(size_t i = 0; i < s; ++ i) m_data[i] = other[i];
 	m_size = s;
-	m_data = data;
+	return;
       }
+
+      /* Otherwise, destroy the current array and allocate a new one: */
+      this->destroy();
+      value_type* data = m_alloc.allocate(s);
+      for(size_t i = 0; i < s; ++ i)
+	m_alloc.construct(&data[i], other[i]);
+
+      /* Success, so save the new array and the size: */
+      m_size = m_capacity = s;
+      m_data = data;
+    }
+
+    /** Copy assignment, reusing the current array if possible. */
+    dynamic_1D& operator=(const dynamic_1D& other) {
+      this->copy(other);
+      return *this;
+    }
+
+#if defined(CML_HAS_RVALUE_REFERENCES)
+    /** Move assignment, exchanging the arrays of *this and other if their
+     * allocators are equal, and copying other otherwise.
+     */
+    dynamic_1D& operator=(dynamic_1D&& other) {
+      if(m_alloc == other.m_alloc) this->swap(other);
+      else this->copy(other);
+      return *this;
+    }
+#endif
+
+    /** Return a copy of the allocator. */
+    allocator_type get_allocator() const { return m_alloc; }
+
+    /** Exchange the arrays of *this and other, without copying. */
+    void swap(dynamic_1D& other) {
+      std::swap(m_size, other.m_size);
+      std::swap(m_capacity, other.m_capacity);
+      std::swap(m_data, other.m_data);
+      std::swap(m_alloc, other.m_alloc);
     }
 
 
@@ -173,10 +280,10 @@ class dynamic_1D
     /** Destroy the current contents of the array. */
     void destroy() {
       if(m_data) {
-	for(size_t i = 0; i < m_size; ++ i)
+	for(size_t i = 0; i < m_capacity; ++ i)
 	  m_alloc.destroy(&m_data[i]);
-	m_alloc.deallocate(m_data, m_size);
-	m_size = 0;
+	m_alloc.deallocate(m_data, m_capacity);
+	m_size = m_capacity = 0;
 	m_data = 0;
       }
     }
@@ -187,6 +294,9 @@ class dynamic_1D
     /** Current array size (may be 0). */
     size_t			m_size;
 
+    /** Number of elements allocated, all constructed (>= m_size). */
+    size_t			m_capacity;
+
     /** Array data (may be NULL). */
     value_type*			m_data;
 
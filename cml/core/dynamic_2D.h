@@ -24,6 +24,9 @@ namespace cml {
  *
  * @note The allocator should be an STL-compatible allocator.
  *
+ * The array keeps its allocation when it shrinks, so that it can be resized
+ * or copied into again without reallocating; see capacity() and reserve().
+ *
  * @internal The internal array type <em>must</em> have the proper copy
  * semantics, otherwise copy construction will fail.
  *
@@ -74,22 +77,32 @@ class dynamic_2D
   protected:
 
     /** Construct a dynamic array with no size. */
-    dynamic_2D() : m_rows(0), m_cols(0), m_data(0), m_alloc() {}
+    dynamic_2D()
+        : m_rows(0), m_cols(0), m_capacity(0), m_data(0), m_alloc() {}
 
     /** Construct a dynamic matrix given the dimensions. */
     explicit dynamic_2D(size_t rows, size_t cols) 
-        : m_rows(0), m_cols(0), m_data(0), m_alloc()
+        : m_rows(0), m_cols(0), m_capacity(0), m_data(0), m_alloc()
        	{
 	  this->resize(rows, cols);
 	}
 
     /** Copy construct a dynamic matrix. */
     dynamic_2D(const dynamic_2D& other)
-        : m_rows(0), m_cols(0), m_data(0), m_alloc()
+        : m_rows(0), m_cols(0), m_capacity(0), m_data(0), m_alloc()
        	{
 	  this->copy(other);
 	}
 
+#if defined(CML_HAS_RVALUE_REFERENCES)
+    /** Move construct a dynamic matrix, taking the array of other. */
+    dynamic_2D(dynamic_2D&& other)
+        : m_rows(0), m_cols(0), m_capacity(0), m_data(0), m_alloc()
+       	{
+	  this->swap(other);
+	}
+#endif
+
     ~dynamic_2D() {
       this->destroy();
     }
@@ -99,6 +112,9 @@ class dynamic_2D
 
     enum { array_rows = -1, array_cols = -1 };
 
+    /** The alignment of the array in bytes, given by the allocator. */
+    enum { array_alignment = allocator_alignment<allocator_type>::value };
+
 
   public:
 
@@ -108,6 +124,11 @@ class dynamic_2D
     /** Return the number of cols in the array. */
     size_t cols() const { return m_cols; }
 
+    /** Return the number of elements the array can hold without
+     * reallocating.
+     */
+    size_t capacity() const { return m_capacity; }
+
 
   public:
 
@@ -140,10 +161,9 @@ class dynamic_2D
 
   public:
 
-    /** Set the array dimensions.  The previous contents are destroyed
-     * before reallocating the array.  If the number of rows and columns
-     * isn't changing, nothing happens.  Also, if either rows or cols is 0,
-     * the array is cleared.
+    /** Set the array dimensions.  The elements are reset to value_type().
+     * The array is only reallocated if rows*cols > capacity().  If the
+     * number of rows and columns isn't changing, nothing happens.
      *
      * @warning This is not guaranteed to preserve the original data.
      */
@@ -152,46 +172,142 @@ class dynamic_2D
       /* Nothing to do if the size isn't changing: */
       if(rows == m_rows && cols == m_cols) return;
 
-      /* Destroy the current array contents: */
+      /* Reuse the current array if it's big enough: */
+      size_t n = rows*cols;
+      if(n <= m_capacity) {
+	for(size_t i = 0; i < n; ++ i) m_data[i] = value_type();
+	m_rows = rows;
+	m_cols = cols;
+	return;
+      }
+
+      /* Otherwise, destroy the current array and allocate a new one: */
       this->destroy();
+      value_type* data = m_alloc.allocate(n);
+      for(size_t i = 0; i < n; ++ i)
+	m_alloc.construct(&data[i], value_type());
+
+      /* Success, so save the new array and the dimensions: */
+      m_rows = rows;
+      m_cols = cols;
+      m_capacity = n;
+      m_data = data;
+    }
 
-      /* Set the new size if non-zero: */
-      if(rows*cols > 0) {
-	value_type* data = m_alloc.allocate(rows*cols);
-	for(size_t i = 0; i < rows*cols; ++ i)
-	  m_alloc.construct(&data[i], value_type());
+    /** Set the array dimensions, without resetting the elements.  This is
+     * for arrays that are overwritten completely next, like the library's
+     * temporaries.  The elements keep their old values if the array is
+     * reused, and are left uninitialized if value_type has a trivial
+     * constructor (see has_trivial_constructor<>).
+     */
+    void resize_uninitialized(size_t rows, size_t cols) {
 
-	/* Success, so save the new array and the dimensions: */
+      /* Reuse the current array if it's big enough: */
+      size_t n = rows*cols;
+      if(n <= m_capacity) {
 	m_rows = rows;
 	m_cols = cols;
-	m_data = data;
+	return;
+      }
+
+      /* Otherwise, destroy the current array and allocate a new one: */
+      this->destroy();
+      value_type* data = m_alloc.allocate(n);
+      if(!has_trivial_constructor<value_type>::is_true) {
+	for(size_t i = 0; i < n; ++ i)
+	  m_alloc.construct(&data[i], value_type());
       }
+
+      /* Success, so save the new array and the dimensions: */
+      m_rows = rows;
+      m_cols = cols;
+      m_capacity = n;
+      m_data = data;
     }
 
-    /** Copy the other array.  The previous contents are destroyed before
-     * reallocating the array.  If other == *this, nothing happens.  Also,
-     * if either other.rows() or other.cols() is 0, the array is cleared.
+    /** Make room for at least n elements without reallocating, preserving
+     * the current elements.
      */
-    void copy(const dynamic_2D& other) {
+    void reserve(size_t n) {
 
-      /* Nothing to do if it's the same array: */
-      if(&other == this) return;
+      /* Nothing to do if the array is already big enough: */
+      if(n <= m_capacity) return;
+
+      size_t s = m_rows*m_cols;
+      value_type* data = m_alloc.allocate(n);
+      for(size_t i = 0; i < s; ++ i)
+	m_alloc.construct(&data[i], m_data[i]);
+      for(size_t i = s; i < n; ++ i)
+	m_alloc.construct(&data[i], value_type());
 
-      /* Destroy the current array contents: */
+      /* Success, so replace the array: */
+      size_t rows = m_rows, cols = m_cols;
       this->destroy();
+      m_rows = rows;
+      m_cols = cols;
+      m_capacity = n;
+      m_data = data;
+    }
 
-      /* Set the new size if non-zero: */
-      size_t rows = other.rows(), cols = other.cols();
-      if(rows*cols > 0) {
-	value_type* data = m_alloc.allocate(rows*cols);
-	for(size_t i = 0; i < rows*cols; ++ i)
-	  m_alloc.construct(&data[i], other[i]);
+    /** Copy the other array.  The current array is reused if it is big
+     * enough, and reallocated otherwise.  If other == *this, nothing
+     * happens.
+     */
+    void copy(const dynamic_2D& other) {
 
-	/* Success, so save the new array and the dimensions: */
+      /* Nothing to do if it's the same array: */
+      if(&other == this) return;
+
+      /* Reuse the current array if it's big enough: */
+      size_t rows = other.rows(), cols = other.cols(), n = rows*cols;
+      const value_type* src = other.m_data;
+      if(n <= m_capacity) {
+	for(size_t i = 0; i < n; ++ i) m_data[i] = src[i];
 	m_rows = rows;
 	m_cols = cols;
-	m_data = data;
+	return;
       }
+
+      /* Otherwise, destroy the current array and allocate a new one: */
+      this->destroy();
+      value_type* data = m_alloc.allocate(n);
+      for(size_t i = 0; i < n; ++ i)
+	m_alloc.construct(&data[i], src[i]);
+
+      /* Success, so save the new array and the dimensions: */
+      m_rows = rows;
+      m_cols = cols;
+      m_capacity = n;
+      m_data = data;
+    }
+
+    /** Copy assignment, reusing the current array if possible. */
+    dynamic_2D& operator=(const dynamic_2D& other) {
+      this->copy(other);
+      return *this;
+    }
+
+#if defined(CML_HAS_RVALUE_REFERENCES)
+    /** Move assignment, exchanging the arrays of *this and other if their
+     * allocators are equal, and copying other otherwise.
+     */
+    dynamic_2D& operator=(dynamic_2D&& other) {
+      if(m_alloc == other.m_alloc) this->swap(other);
+      else this->copy(other);
+      return *this;
+    }
+#endif
+
+    /** Return a copy of the allocator. */
+    allocator_type get_allocator() const { return m_alloc; }
+
+    /** Exchange the arrays of *this and other, without copying. */
+    void swap(dynamic_2D& other) {
+      std::swap(m_rows, other.m_rows);
+      std::swap(m_cols, other.m_cols);
+      std::swap(m_capacity, other.m_capacity);
+      std::swap(m_data, other.m_data);
+      std::swap(m_alloc, other.m_alloc);
     }
 
 
@@ -219,10 +335,10 @@ class dynamic_2D
     /** Destroy the current contents of the array. */
     void destroy() {
       if(m_data) {
-	for(size_t i = 0; i < m_rows*m_cols; ++ i)
+	for(size_t i = 0; i < m_capacity; ++ i)
 	  m_alloc.destroy(&m_data[i]);
-	m_alloc.deallocate(m_data, m_rows*m_cols);
-	m_rows = m_cols = 0;
+	m_alloc.deallocate(m_data, m_capacity);
+	m_rows = m_cols = m_capacity = 0;
 	m_data = 0;
       }
     }
@@ -233,6 +349,9 @@ class dynamic_2D
     /** Current array dimensions (may be 0,0). */
     size_t                      m_rows, m_cols;
 
+    /** Number of elements allocated, all constructed (>= rows*cols). */
+    size_t                      m_capacity;
+
     /** Array data (may be NULL). */
     value_type*			m_data;
 
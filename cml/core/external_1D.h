@@ -21,6 +21,7 @@ Boost Software License, v1.0 (see cml/LICENSE for details).
 #include <cml/core/common.h>
 #include <cml/core/cml_meta.h>
 #include <cml/core/cml_assert.h>
+#include <cml/core/alignment.h>
 #include <cml/external.h>
 
 namespace cml {
@@ -69,6 +70,9 @@ class external_1D
     /** The length as an enumerated value. */
     enum { array_size = Size };
 
+    /** External arrays are only known to have natural alignment. */
+    enum { array_alignment = alignment_of<Element>::value };
+
 
   public:
 
@@ -164,6 +168,9 @@ class external_1D<Element,-1>
     /** The length as an enumerated value. */
     enum { array_size = -1 };
 
+    /** External arrays are only known to have natural alignment. */
+    enum { array_alignment = alignment_of<Element>::value };
+
 
   public:
 
@@ -84,6 +84,9 @@ class external_2D
 
     enum { array_rows = Rows, array_cols = Cols };
 
+    /** External arrays are only known to have natural alignment. */
+    enum { array_alignment = alignment_of<Element>::value };
+
 
   public:
 
@@ -222,6 +225,9 @@ class external_2D<Element,-1,-1,Layout>
 
     enum { array_rows = -1, array_cols = -1 };
 
+    /** External arrays are only known to have natural alignment. */
+    enum { array_alignment = alignment_of<Element>::value };
+
 
   public:
 
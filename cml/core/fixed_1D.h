@@ -16,15 +16,17 @@ Boost Software License, v1.0 (see cml/LICENSE for details).
 #include <cml/core/common.h>
 #include <cml/core/cml_meta.h>
 #include <cml/core/cml_assert.h>
+#include <cml/core/alignment.h>
+#include <cml/core/fwd.h>
 #include <cml/fixed.h>
 
 namespace cml {
 
 /** Statically-allocated array.
  *
- * @note This class is designed to have the same size as a C array with the
- * same length.  It's therefore possible (but not recommended!) to coerce
- * a normal C array into a fixed_1D<> like this:
+ * @note Unless aligned, this class is designed to have the same size as a C
+ * array with the same length.  It's therefore possible (but not
+ * recommended!) to coerce a normal C array into a fixed_1D<> like this:
  *
  * typedef fixed_1D<double,10> array;
  * double c_array[10];
@@ -37,13 +39,16 @@ namespace cml {
  * a separate class to take a C array (or pointer) and turn it into an array
  * object.
  *
+ * The array is aligned to Align bytes, or to the natural alignment of
+ * Element if Align is 0 (see cml/core/alignment.h).
+ *
  * @sa cml::fixed
  *
  * @internal Do <em>not</em> add the empty constructor and destructor; at
  * least one compiler (Intel C++ 9.0) fails to optimize them away, and they
  * aren't needed anyway here.
  */
-template<typename Element, int Size>
+template<typename Element, int Size, int Align>
 class fixed_1D
 {
   public:
@@ -52,7 +57,7 @@ class fixed_1D
     CML_STATIC_REQUIRE(Size > 0);
 
     /* Record the generator: */
-    typedef fixed<Size,-1> generator_type;
+    typedef fixed<Size,-1,Align> generator_type;
 
     /* Standard: */
     typedef Element value_type;
@@ -82,6 +87,9 @@ class fixed_1D
     /** The length as an enumerated value. */
     enum { array_size = Size };
 
+    /** The alignment of the array in bytes. */
+    enum { array_alignment = storage_alignment<Element,Align>::value };
+
 
   public:
 
@@ -119,7 +127,7 @@ class fixed_1D
 
   protected:
 
-    array_impl                  m_data;
+    CML_ALIGNAS(array_alignment) array_impl m_data;
 
 
   private:
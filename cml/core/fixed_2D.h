@@ -15,6 +15,8 @@ Boost Software License, v1.0 (see cml/LICENSE for details).
 
 #include <cml/core/common.h>
 #include <cml/core/fixed_1D.h>
+#include <cml/core/alignment.h>
+#include <cml/core/fwd.h>
 
 /* This is used below to create a more meaningful compile-time error when
  * an unknown layout argument is given:
@@ -36,11 +38,14 @@ namespace cml {
  * better optimize 2D array dereferences.  This is different from
  * dynamic_2D<>, which must use the 1D array method.
  *
+ * The array is aligned to Align bytes, or to the natural alignment of
+ * Element if Align is 0 (see cml/core/alignment.h).
+ *
  * @sa cml::fixed
  *
- * @note This class is designed to have the same size as a C array with the
- * same dimensions.  It's therefore possible (but not recommended!) to coerce
- * a normal C array into a fixed_2D<> like this:
+ * @note Unless aligned, this class is designed to have the same size as a C
+ * array with the same dimensions.  It's therefore possible (but not
+ * recommended!) to coerce a normal C array into a fixed_2D<> like this:
  *
  * typedef fixed_2D<double,10,10,row_major> array;
  * double c_array[10][10];
@@ -57,7 +62,7 @@ namespace cml {
  * least one compiler (Intel C++ 9.0) fails to optimize them away, and they
  * aren't needed anyway here.
  */
-template<typename Element, int Rows, int Cols, typename Layout>
+template<typename Element, int Rows, int Cols, typename Layout, int Align>
 class fixed_2D
 {
   public:
@@ -75,7 +80,7 @@ class fixed_2D
 
 
     /* Record the generator: */
-    typedef fixed<Rows,Cols> generator_type;
+    typedef fixed<Rows,Cols,Align> generator_type;
 
     /* Standard: */
     typedef Element value_type;
@@ -101,7 +106,7 @@ class fixed_2D
 
     /* To simplify the matrix transpose operator: */
     typedef fixed_2D<typename cml::remove_const<Element>::type,
-            Cols,Rows,Layout> transposed_type;
+            Cols,Rows,Layout,Align> transposed_type;
 
     /* To simplify the matrix row and column operators: */
     typedef fixed_1D<Element,Rows> row_array_type;
@@ -112,6 +117,9 @@ class fixed_2D
 
     enum { array_rows = Rows, array_cols = Cols };
 
+    /** The alignment of the array in bytes. */
+    enum { array_alignment = storage_alignment<Element,Align>::value };
+
 
   public:
 
@@ -194,7 +202,7 @@ class fixed_2D
         >::result array_data;
 
     /* Declare the data array: */
-    array_data                  m_data;
+    CML_ALIGNAS(array_alignment) array_data m_data;
 };
 
 } // namespace cml
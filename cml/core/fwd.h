@@ -20,10 +20,10 @@ Boost Software License, v1.0 (see cml/LICENSE for details).
 namespace cml {
 
 /* cml/core/fixed_1D.h */
-template<typename E, int S> class fixed_1D;
+template<typename E, int S, int A = 0> class fixed_1D;
 
 /* cml/core/fixed_2D.h */
-template<typename E, int R, int C, class L> class fixed_2D;
+template<typename E, int R, int C, class L, int A = 0> class fixed_2D;
 
 /* cml/core/dynamic_1D.h */
 template<typename E, class A> class dynamic_1D;
@@ -31,21 +31,50 @@ template<typename E, class A> class dynamic_1D;
 /* cml/core/dynamic_2D.h */
 template<typename E, class L, class A> class dynamic_2D;
 
+/* cml/core/hybrid_1D.h */
+template<typename E, int S, int A = 0> class hybrid_1D;
+
+/* cml/core/hybrid_2D.h */
+template<typename E, int R, int C, class L, int A = 0> class hybrid_2D;
+
 /* cml/core/external_1D.h */
 template<typename E, int S> class external_1D;
 
 /* cml/core/external_2D.h */
 template<typename E, int R, int C, class L> class external_2D;
 
+/* cml/core/packed_2D.h */
+template<typename E, class G, class L> class packed_2D;
+
+/* cml/core/banded_2D.h */
+template<typename E, class G, class L> class banded_2D;
+
+/* cml/core/strided_2D.h */
+template<typename E, int R, int C, class L> class strided_2D;
+
 /* cml/fixed.h */
-template<int Dim1, int Dim2> struct fixed;
+template<int Dim1, int Dim2, int Align> struct fixed;
 
 /* cml/dynamic.h */
 template<class Alloc> struct dynamic;
 
+/* cml/hybrid.h */
+template<int Dim1, int Dim2, int Align> struct hybrid;
+
 /* cml/external.h */
 template<int Dim1, int Dim2> struct external;
 
+/* cml/packed.h */
+template<class Alloc> struct symmetric;
+template<class Alloc> struct lower_triangular;
+template<class Alloc> struct upper_triangular;
+
+/* cml/banded.h */
+template<int Lower, int Upper, class Alloc> struct banded;
+
+/* cml/strided.h */
+template<int Dim1, int Dim2> struct strided;
+
 /* cml/vector.h */
 template<typename E, class AT> class vector;
 
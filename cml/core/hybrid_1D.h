@@ -0,0 +1,181 @@
+/* -*- C++ -*- ------------------------------------------------------------
+ 
+Copyright (c) 2007 Jesse Anders and Demian Nave http://cmldev.net/
+
+The Configurable Math Library (CML) is distributed under the terms of the
+Boost Software License, v1.0 (see cml/LICENSE for details).
+
+ *-----------------------------------------------------------------------*/
+/** @file
+ *  @brief
+ */
+
+#ifndef hybrid_1D_h
+#define hybrid_1D_h
+
+#include <stdexcept>
+#include <cml/core/common.h>
+#include <cml/core/cml_meta.h>
+#include <cml/core/cml_assert.h>
+#include <cml/core/alignment.h>
+#include <cml/core/fwd.h>
+#include <cml/hybrid.h>
+
+namespace cml {
+
+/** Dynamically-sized 1D array with inline storage for up to MaxSize
+ * elements.
+ *
+ * The array is aligned to Align bytes, or to the natural alignment of
+ * Element if Align is 0 (see cml/core/alignment.h).
+ *
+ * @sa cml::hybrid
+ */
+template<typename Element, int MaxSize, int Align>
+class hybrid_1D
+{
+  public:
+
+    /* Require MaxSize > 0: */
+    CML_STATIC_REQUIRE(MaxSize > 0);
+
+    /* Record the generator: */
+    typedef hybrid<MaxSize,-1,Align> generator_type;
+
+    /* Standard: */
+    typedef Element value_type;
+    typedef Element* pointer;
+    typedef Element& reference;
+    typedef const Element& const_reference;
+    typedef const Element* const_pointer;
+
+    /* Array implementation: */
+    typedef value_type array_impl[MaxSize];
+
+    /* For matching by memory type (the array can be resized): */
+    typedef dynamic_memory_tag memory_tag;
+
+    /* For matching by size type: */
+    typedef dynamic_size_tag size_tag;
+
+    /* For matching by resizability: */
+    typedef resizable_tag resizing_tag;
+
+    /* For matching by dimensions: */
+    typedef oned_tag dimension_tag;
+
+
+  public:
+
+    /** Hybrid arrays have no fixed size. */
+    enum { array_size = -1 };
+
+    /** The largest number of elements the array can hold. */
+    enum { array_max_size = MaxSize };
+
+    /** The alignment of the array in bytes. */
+    enum { array_alignment = storage_alignment<Element,Align>::value };
+
+
+  public:
+
+    /** Construct an array with no size. */
+    hybrid_1D() : m_size(0) {}
+
+    /** Construct an array given the size. */
+    explicit hybrid_1D(size_t size) : m_size(0) {
+      this->resize(size);
+    }
+
+    /** Copy construct an array, copying only the used elements. */
+    hybrid_1D(const hybrid_1D& other) : m_size(0) {
+      this->copy(other);
+    }
+
+
+  public:
+
+    /** Return the number of elements in the array. */
+    size_t size() const { return m_size; }
+
+    /** Return the largest number of elements the array can hold. */
+    size_t capacity() const { return size_t(MaxSize); }
+
+    /** Access to the data as a C array.
+     *
+     * @param i a size_t index into the array.
+     * @return a mutable reference to the array value at i.
+     *
+     * @note This function does not range-check the argument.
+     */
+    reference operator[](size_t i) { return m_data[i]; }
+
+    /** Const access to the data as a C array.
+     *
+     * @param i a size_t index into the array.
+     * @return a const reference to the array value at i.
+     *
+     * @note This function does not range-check the argument.
+     */
+    const_reference operator[](size_t i) const { return m_data[i]; }
+
+    /** Return access to the data as a raw pointer. */
+    pointer data() { return &m_data[0]; }
+
+    /** Return access to the data as a raw pointer. */
+    const_pointer data() const { return &m_data[0]; }
+
+
+  public:
+
+    /** Set the array size to the given value.  The elements are reset to
+     * value_type().  If s == size(), nothing happens.
+     *
+     * @throws std::invalid_argument if s > capacity().
+     */
+    void resize(size_t s) {
+      if(s == m_size) return;
+      this->resize_uninitialized(s);
+      for(size_t i = 0; i < s; ++ i) m_data[i] = value_type();
+    }
+
+    /** Set the array size to the given value, without resetting the
+     * elements.
+     *
+     * @throws std::invalid_argument if s > capacity().
+     */
+    void resize_uninitialized(size_t s) {
+      if(s > size_t(MaxSize))
+        throw std::invalid_argument("hybrid array capacity exceeded.");
+      m_size = s;
+    }
+
+    /** Copy the used elements of the other array. */
+    void copy(const hybrid_1D& other) {
+      if(&other == this) return;
+      for(size_t i = 0; i < other.m_size; ++ i) m_data[i] = other.m_data[i];
+      m_size = other.m_size;
+    }
+
+    /** Copy assignment of the used elements. */
+    hybrid_1D& operator=(const hybrid_1D& other) {
+      this->copy(other);
+      return *this;
+    }
+
+
+  protected:
+
+    /** Current array size (<= MaxSize). */
+    size_t			m_size;
+
+    /** The elements. */
+    CML_ALIGNAS(array_alignment) array_impl m_data;
+};
+
+} // namespace cml
+
+#endif
+
+// -------------------------------------------------------------------------
+// vim:ft=cpp
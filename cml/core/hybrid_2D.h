@@ -0,0 +1,222 @@
+/* -*- C++ -*- ------------------------------------------------------------
+ 
+Copyright (c) 2007 Jesse Anders and Demian Nave http://cmldev.net/
+
+The Configurable Math Library (CML) is distributed under the terms of the
+Boost Software License, v1.0 (see cml/LICENSE for details).
+
+ *-----------------------------------------------------------------------*/
+/** @file
+ *  @brief
+ */
+
+#ifndef hybrid_2D_h
+#define hybrid_2D_h
+
+#include <stdexcept>
+#include <cml/core/common.h>
+#include <cml/core/cml_meta.h>
+#include <cml/core/cml_assert.h>
+#include <cml/core/alignment.h>
+#include <cml/core/fwd.h>
+#include <cml/core/hybrid_1D.h>
+#include <cml/hybrid.h>
+
+namespace cml {
+
+/** Dynamically-sized 2D array with inline storage for up to MaxRows x
+ * MaxCols elements.
+ *
+ * The elements are packed in the given layout for the current size, as in
+ * dynamic_2D<>, so data() is a contiguous rows() x cols() array.
+ *
+ * @sa cml::hybrid
+ */
+template<typename Element, int MaxRows, int MaxCols, typename Layout,
+    int Align>
+class hybrid_2D
+{
+  public:
+
+    /* Require MaxRows > 0, MaxCols > 0: */
+    CML_STATIC_REQUIRE((MaxRows > 0) && (MaxCols > 0));
+
+    /* Record the generator: */
+    typedef hybrid<MaxRows,MaxCols,Align> generator_type;
+
+    /* Standard: */
+    typedef Element value_type;
+    typedef Element* pointer;
+    typedef Element& reference;
+    typedef const Element& const_reference;
+    typedef const Element* const_pointer;
+
+    /* Array implementation: */
+    typedef value_type array_impl[MaxRows*MaxCols];
+
+    /* For matching by memory layout: */
+    typedef Layout layout;
+
+    /* For matching by memory type (the array can be resized): */
+    typedef dynamic_memory_tag memory_tag;
+
+    /* For matching by size type: */
+    typedef dynamic_size_tag size_tag;
+
+    /* For matching by resizability: */
+    typedef resizable_tag resizing_tag;
+
+    /* For matching by dimensions: */
+    typedef twod_tag dimension_tag;
+
+    /* To simplify the matrix transpose operator: */
+    typedef hybrid_2D<typename cml::remove_const<Element>::type,
+            MaxCols,MaxRows,Layout,Align> transposed_type;
+
+    /* To simplify the matrix row and column operators: */
+    typedef hybrid_1D<Element,MaxCols> row_array_type;
+    typedef hybrid_1D<Element,MaxRows> col_array_type;
+
+
+  public:
+
+    enum { array_rows = -1, array_cols = -1 };
+
+    /** The largest numbers of rows and columns the array can hold. */
+    enum { array_max_rows = MaxRows, array_max_cols = MaxCols };
+
+    /** The alignment of the array in bytes. */
+    enum { array_alignment = storage_alignment<Element,Align>::value };
+
+
+  protected:
+
+    /** Construct an array with no size. */
+    hybrid_2D() : m_rows(0), m_cols(0) {}
+
+    /** Construct an array given the dimensions. */
+    explicit hybrid_2D(size_t rows, size_t cols) : m_rows(0), m_cols(0) {
+      this->resize(rows, cols);
+    }
+
+    /** Copy construct an array, copying only the used elements. */
+    hybrid_2D(const hybrid_2D& other) : m_rows(0), m_cols(0) {
+      this->copy(other);
+    }
+
+
+  public:
+
+    /** Return the number of rows in the array. */
+    size_t rows() const { return m_rows; }
+
+    /** Return the number of cols in the array. */
+    size_t cols() const { return m_cols; }
+
+    /** Return the largest number of elements the array can hold. */
+    size_t capacity() const { return size_t(MaxRows*MaxCols); }
+
+
+  public:
+
+    /** Access the given element of the matrix.
+     *
+     * @param row row of element.
+     * @param col column of element.
+     * @returns mutable reference.
+     */
+    reference operator()(size_t row, size_t col) {
+        return this->get_element(row, col, layout());
+    }
+
+    /** Access the given element of the matrix.
+     *
+     * @param row row of element.
+     * @param col column of element.
+     * @returns const reference.
+     */
+    const_reference operator()(size_t row, size_t col) const {
+        return this->get_element(row, col, layout());
+    }
+
+    /** Return access to the data as a raw pointer. */
+    pointer data() { return &m_data[0]; }
+
+    /** Return access to the data as a raw pointer. */
+    const_pointer data() const { return &m_data[0]; }
+
+
+  public:
+
+    /** Set the array dimensions.  The elements are reset to value_type().
+     * If the number of rows and columns isn't changing, nothing happens.
+     *
+     * @throws std::invalid_argument if rows > MaxRows or cols > MaxCols.
+     */
+    void resize(size_t rows, size_t cols) {
+      if(rows == m_rows && cols == m_cols) return;
+      this->resize_uninitialized(rows, cols);
+      for(size_t i = 0; i < rows*cols; ++ i) m_data[i] = value_type();
+    }
+
+    /** Set the array dimensions, without resetting the elements.
+     *
+     * @throws std::invalid_argument if rows > MaxRows or cols > MaxCols.
+     */
+    void resize_uninitialized(size_t rows, size_t cols) {
+      if(rows > size_t(MaxRows) || cols > size_t(MaxCols))
+        throw std::invalid_argument("hybrid array capacity exceeded.");
+      m_rows = rows;
+      m_cols = cols;
+    }
+
+    /** Copy the used elements of the other array. */
+    void copy(const hybrid_2D& other) {
+      if(&other == this) return;
+      size_t n = other.m_rows*other.m_cols;
+      for(size_t i = 0; i < n; ++ i) m_data[i] = other.m_data[i];
+      m_rows = other.m_rows;
+      m_cols = other.m_cols;
+    }
+
+    /** Copy assignment of the used elements. */
+    hybrid_2D& operator=(const hybrid_2D& other) {
+      this->copy(other);
+      return *this;
+    }
+
+
+  protected:
+
+    reference get_element(size_t row, size_t col, row_major) {
+        return m_data[row*m_cols + col];
+    }
+
+    const_reference get_element(size_t row, size_t col, row_major) const {
+        return m_data[row*m_cols + col];
+    }
+
+    reference get_element(size_t row, size_t col, col_major) {
+        return m_data[col*m_rows + row];
+    }
+
+    const_reference get_element(size_t row, size_t col, col_major) const {
+        return m_data[col*m_rows + row];
+    }
+
+
+  protected:
+
+    /** Current dimensions (<= MaxRows, MaxCols). */
+    size_t			m_rows, m_cols;
+
+    /** The elements, packed for the current dimensions. */
+    CML_ALIGNAS(array_alignment) array_impl m_data;
+};
+
+} // namespace cml
+
+#endif
+
+// -------------------------------------------------------------------------
+// vim:ft=cpp
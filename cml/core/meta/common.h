@@ -110,6 +110,41 @@ template<typename T> struct remove_const {
     typedef typename helper<T,void>::type type;
 };
 
+/** Determine if T needs no construction before it is assigned.
+ *
+ * This is true for the built-in arithmetic and pointer types.  It can be
+ * specialized for other plain-data element types, so that arrays of them
+ * can be allocated without initializing the elements first.
+ */
+template<typename T> struct has_trivial_constructor {
+    enum { is_true = false, is_false = true };
+};
+
+template<typename T> struct has_trivial_constructor<T*> {
+    enum { is_true = true, is_false = false };
+};
+
+#define CML_TRIVIAL_CONSTRUCTOR(_T_)                                    \
+template<> struct has_trivial_constructor<_T_> {                        \
+    enum { is_true = true, is_false = false };                          \
+};
+
+CML_TRIVIAL_CONSTRUCTOR(bool)
+CML_TRIVIAL_CONSTRUCTOR(char)
+CML_TRIVIAL_CONSTRUCTOR(signed char)
+CML_TRIVIAL_CONSTRUCTOR(unsigned char)
+CML_TRIVIAL_CONSTRUCTOR(short)
+CML_TRIVIAL_CONSTRUCTOR(unsigned short)
+CML_TRIVIAL_CONSTRUCTOR(int)
+CML_TRIVIAL_CONSTRUCTOR(unsigned int)
+CML_TRIVIAL_CONSTRUCTOR(long)
+CML_TRIVIAL_CONSTRUCTOR(unsigned long)
+CML_TRIVIAL_CONSTRUCTOR(float)
+CML_TRIVIAL_CONSTRUCTOR(double)
+CML_TRIVIAL_CONSTRUCTOR(long double)
+
+#undef CML_TRIVIAL_CONSTRUCTOR
+
 } // namespace cml
 
 #endif
@@ -0,0 +1,365 @@
+/* -*- C++ -*- ------------------------------------------------------------
+ 
+Copyright (c) 2007 Jesse Anders and Demian Nave http://cmldev.net/
+
+The Configurable Math Library (CML) is distributed under the terms of the
+Boost Software License, v1.0 (see cml/LICENSE for details).
+
+ *-----------------------------------------------------------------------*/
+/** @file
+ *  @brief
+ */
+
+#ifndef packed_2D_h
+#define packed_2D_h
+
+#include <memory>
+#include <algorithm>                // for std::swap
+#include <stdexcept>
+#include <cml/core/common.h>
+#include <cml/core/cml_meta.h>
+#include <cml/core/alignment.h>
+#include <cml/core/dynamic_1D.h>
+#include <cml/packed.h>
+
+namespace cml {
+
+/** Dynamically-sized and allocated packed triangular 2D array.
+ *
+ * The array is square, and stores only the n(n+1)/2 elements of one
+ * triangle, packed in the given layout: row by row for row_major, and
+ * column by column for col_major.  Generator is one of symmetric<>,
+ * lower_triangular<> or upper_triangular<>, which selects the triangle and
+ * the meaning of the other elements.
+ *
+ * @note Writing to an element that is not stored (e.g. above the diagonal
+ * of a lower triangular array) has no effect.
+ */
+template<typename Element, class Generator, typename Layout>
+class packed_2D
+{
+  public:
+
+    /* Record the structure of the array: */
+    typedef typename matrix_structure<Generator>::type structure_tag;
+
+    /* Record the allocator type: */
+    typedef typename Generator::allocator_type::template
+        rebind<Element>::other allocator_type;
+
+    /* Record the generator: */
+    typedef Generator generator_type;
+
+    /* Standard: */
+    typedef typename allocator_type::value_type value_type;
+    typedef typename allocator_type::pointer pointer;
+    typedef typename allocator_type::reference reference;
+    typedef typename allocator_type::const_reference const_reference;
+    typedef typename allocator_type::const_pointer const_pointer;
+
+    /* For matching by memory layout: */
+    typedef Layout layout;
+
+    /* For matching by memory type: */
+    typedef dynamic_memory_tag memory_tag;
+
+    /* For matching by size type: */
+    typedef dynamic_size_tag size_tag;
+
+    /* For matching by resizability: */
+    typedef resizable_tag resizing_tag;
+
+    /* For matching by dimensions: */
+    typedef twod_tag dimension_tag;
+
+    /* To simplify the matrix transpose operator: */
+    typedef packed_2D<typename cml::remove_const<Element>::type,
+            typename Generator::transposed_type, Layout> transposed_type;
+
+    /* To simplify the matrix row and column operators: */
+    typedef dynamic_1D<Element,typename Generator::allocator_type>
+        row_array_type;
+    typedef dynamic_1D<Element,typename Generator::allocator_type>
+        col_array_type;
+
+
+  protected:
+
+    /** Construct a packed array with no size. */
+    packed_2D() : m_n(0), m_capacity(0), m_data(0), m_alloc() {}
+
+    /** Construct a packed array given the dimensions.
+     *
+     * @throws std::invalid_argument if rows != cols.
+     */
+    explicit packed_2D(size_t rows, size_t cols)
+        : m_n(0), m_capacity(0), m_data(0), m_alloc()
+    {
+        this->resize(rows, cols);
+    }
+
+    /** Copy construct a packed array. */
+    packed_2D(const packed_2D& other)
+        : m_n(0), m_capacity(0), m_data(0), m_alloc()
+    {
+        this->copy(other);
+    }
+
+#if defined(CML_HAS_RVALUE_REFERENCES)
+    /** Move construct a packed array, taking the array of other. */
+    packed_2D(packed_2D&& other)
+        : m_n(0), m_capacity(0), m_data(0), m_alloc()
+    {
+        this->swap(other);
+    }
+#endif
+
+    ~packed_2D() {
+        this->destroy();
+    }
+
+
+  public:
+
+    enum { array_rows = -1, array_cols = -1 };
+
+    /** The alignment of the array in bytes, given by the allocator. */
+    enum { array_alignment = allocator_alignment<allocator_type>::value };
+
+
+  public:
+
+    /** Return the number of rows in the array. */
+    size_t rows() const { return m_n; }
+
+    /** Return the number of cols in the array. */
+    size_t cols() const { return m_n; }
+
+    /** Return the number of elements stored, n(n+1)/2. */
+    size_t packed_size() const { return m_n*(m_n+1)/2; }
+
+    /** Return the number of elements the array can hold without
+     * reallocating.
+     */
+    size_t capacity() const { return m_capacity; }
+
+
+  public:
+
+    /** Access the given element of the matrix.
+     *
+     * @param row row of element.
+     * @param col column of element.
+     * @returns mutable reference.
+     */
+    reference operator()(size_t row, size_t col) {
+        return this->get_element(row, col, structure_tag());
+    }
+
+    /** Access the given element of the matrix.
+     *
+     * @param row row of element.
+     * @param col column of element.
+     * @returns const reference.
+     */
+    const_reference operator()(size_t row, size_t col) const {
+        return this->get_element(row, col, structure_tag());
+    }
+
+    /** Return access to the packed elements as a raw pointer. */
+    pointer data() { return &m_data[0]; }
+
+    /** Return access to the packed elements as a raw pointer. */
+    const_pointer data() const { return &m_data[0]; }
+
+
+  public:
+
+    /** Set the array dimensions.  The elements are reset to value_type().
+     * The array is only reallocated if the new packed size exceeds
+     * capacity().  If the size isn't changing, nothing happens.
+     *
+     * @throws std::invalid_argument if rows != cols.
+     */
+    void resize(size_t rows, size_t cols) {
+      if(rows == m_n && cols == m_n) return;
+      this->resize_uninitialized(rows, cols);
+      for(size_t i = 0; i < this->packed_size(); ++ i)
+        m_data[i] = value_type();
+    }
+
+    /** Set the array dimensions, without resetting the elements.  The
+     * elements are left uninitialized if value_type has a trivial
+     * constructor.
+     *
+     * @throws std::invalid_argument if rows != cols.
+     */
+    void resize_uninitialized(size_t rows, size_t cols) {
+      if(rows != cols)
+        throw std::invalid_argument("packed matrices must be square.");
+
+      /* Reuse the current array if it's big enough: */
+      size_t n = rows*(rows+1)/2;
+      if(n <= m_capacity) {
+        m_n = rows;
+        return;
+      }
+
+      /* Otherwise, destroy the current array and allocate a new one: */
+      this->destroy();
+      value_type* data = m_alloc.allocate(n);
+      if(!has_trivial_constructor<value_type>::is_true) {
+        for(size_t i = 0; i < n; ++ i)
+          m_alloc.construct(&data[i], value_type());
+      }
+
+      /* Success, so save the new array and the size: */
+      m_n = rows;
+      m_capacity = n;
+      m_data = data;
+    }
+
+    /** Copy the other array, reusing the current array if it is big
+     * enough.
+     */
+    void copy(const packed_2D& other) {
+      if(&other == this) return;
+      this->resize_uninitialized(other.m_n, other.m_n);
+      for(size_t i = 0; i < this->packed_size(); ++ i)
+        m_data[i] = other.m_data[i];
+    }
+
+    /** Copy assignment, reusing the current array if possible. */
+    packed_2D& operator=(const packed_2D& other) {
+      this->copy(other);
+      return *this;
+    }
+
+#if defined(CML_HAS_RVALUE_REFERENCES)
+    /** Move assignment, exchanging the arrays of *this and other if their
+     * allocators are equal, and copying other otherwise.
+     */
+    packed_2D& operator=(packed_2D&& other) {
+      if(m_alloc == other.m_alloc) this->swap(other);
+      else this->copy(other);
+      return *this;
+    }
+#endif
+
+    /** Return a copy of the allocator. */
+    allocator_type get_allocator() const { return m_alloc; }
+
+    /** Exchange the arrays of *this and other, without copying. */
+    void swap(packed_2D& other) {
+      std::swap(m_n, other.m_n);
+      std::swap(m_capacity, other.m_capacity);
+      std::swap(m_data, other.m_data);
+      std::swap(m_alloc, other.m_alloc);
+    }
+
+
+  protected:
+
+    /* Offsets of the elements of a packed lower triangle, i >= j: */
+    size_t lower_offset(size_t i, size_t j, row_major) const {
+        return i*(i+1)/2 + j;
+    }
+
+    size_t lower_offset(size_t i, size_t j, col_major) const {
+        return j*(2*m_n-j+1)/2 + (i-j);
+    }
+
+    /* Offsets of the elements of a packed upper triangle, i <= j: */
+    size_t upper_offset(size_t i, size_t j, row_major) const {
+        return i*(2*m_n-i+1)/2 + (j-i);
+    }
+
+    size_t upper_offset(size_t i, size_t j, col_major) const {
+        return j*(j+1)/2 + i;
+    }
+
+    reference get_element(size_t i, size_t j, symmetric_tag) {
+        return (i >= j) ? m_data[lower_offset(i,j,layout())]
+            : m_data[lower_offset(j,i,layout())];
+    }
+
+    const_reference get_element(size_t i, size_t j, symmetric_tag) const {
+        return (i >= j) ? m_data[lower_offset(i,j,layout())]
+            : m_data[lower_offset(j,i,layout())];
+    }
+
+    reference get_element(size_t i, size_t j, lower_triangular_tag) {
+        if(i < j) return this->zero();
+        return m_data[lower_offset(i,j,layout())];
+    }
+
+    const_reference get_element(size_t i, size_t j,
+            lower_triangular_tag) const
+    {
+        if(i < j) return this->zero();
+        return m_data[lower_offset(i,j,layout())];
+    }
+
+    reference get_element(size_t i, size_t j, upper_triangular_tag) {
+        if(i > j) return this->zero();
+        return m_data[upper_offset(i,j,layout())];
+    }
+
+    const_reference get_element(size_t i, size_t j,
+            upper_triangular_tag) const
+    {
+        if(i > j) return this->zero();
+        return m_data[upper_offset(i,j,layout())];
+    }
+
+    /** Return a writable zero for elements that are not stored. */
+    reference zero() {
+        m_zero = value_type(0);
+        return m_zero;
+    }
+
+    /** Return a zero for elements that are not stored. */
+    const_reference zero() const {
+        static const value_type z(0);
+        return z;
+    }
+
+
+  protected:
+
+    /** Destroy the current contents of the array. */
+    void destroy() {
+      if(m_data) {
+        for(size_t i = 0; i < m_capacity; ++ i)
+          m_alloc.destroy(&m_data[i]);
+        m_alloc.deallocate(m_data, m_capacity);
+        m_n = m_capacity = 0;
+        m_data = 0;
+      }
+    }
+
+
+  protected:
+
+    /** Current number of rows and columns (may be 0). */
+    size_t                      m_n;
+
+    /** Number of elements allocated, all constructed (>= n(n+1)/2). */
+    size_t                      m_capacity;
+
+    /** Packed array data (may be NULL). */
+    value_type*                 m_data;
+
+    /** Allocator for the array. */
+    allocator_type              m_alloc;
+
+    /** Target for writes to elements that are not stored. */
+    value_type                  m_zero;
+};
+
+} // namespace cml
+
+#endif
+
+// -------------------------------------------------------------------------
+// vim:ft=cpp
@@ -0,0 +1,67 @@
+/* -*- C++ -*- ------------------------------------------------------------
+ 
+Copyright (c) 2007 Jesse Anders and Demian Nave http://cmldev.net/
+
+The Configurable Math Library (CML) is distributed under the terms of the
+Boost Software License, v1.0 (see cml/LICENSE for details).
+
+ *-----------------------------------------------------------------------*/
+/** @file
+ *  @brief Compile-time selection of SIMD instruction sets.
+ *
+ * Defines CML_SIMD_SSE, CML_SIMD_SSE2, CML_SIMD_SSE41, CML_SIMD_AVX,
+ * CML_SIMD_AVX2, and CML_SIMD_AVX512F according to the instruction sets
+ * enabled for the compiler (e.g. -msse2 or -mavx2 with GCC, /arch:AVX2 with
+ * MSVC), and includes the matching intrinsics header.  Each one implies the
+ * ones before it.  No SIMD code is used if CML_NO_SIMD is defined.
+ */
+
+#ifndef core_simd_h
+#define core_simd_h
+
+#include <cml/core/common.h>
+
+#if !defined(CML_NO_SIMD)
+
+#if defined(__AVX512F__)
+#define CML_SIMD_AVX512F
+#endif
+
+#if defined(__AVX2__) || defined(CML_SIMD_AVX512F)
+#define CML_SIMD_AVX2
+#endif
+
+#if defined(__AVX__) || defined(CML_SIMD_AVX2)
+#define CML_SIMD_AVX
+#endif
+
+#if defined(__SSE4_1__) || defined(CML_SIMD_AVX)
+#define CML_SIMD_SSE41
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) \
+    || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(CML_SIMD_AVX)
+#define CML_SIMD_SSE2
+#endif
+
+#if defined(__SSE__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1) \
+    || defined(CML_SIMD_SSE2)
+#define CML_SIMD_SSE
+#endif
+
+#if defined(CML_SIMD_AVX)
+#include <immintrin.h>
+#elif defined(CML_SIMD_SSE41)
+#include <smmintrin.h>
+#elif defined(CML_SIMD_SSE2)
+#include <emmintrin.h>
+#elif defined(CML_SIMD_SSE)
+#include <xmmintrin.h>
+#endif
+
+#endif // CML_NO_SIMD
+
+#endif
+
+// -------------------------------------------------------------------------
+// vim:ft=cpp
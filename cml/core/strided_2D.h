@@ -0,0 +1,352 @@
+/* -*- C++ -*- ------------------------------------------------------------
+ 
+Copyright (c) 2007 Jesse Anders and Demian Nave http://cmldev.net/
+
+The Configurable Math Library (CML) is distributed under the terms of the
+Boost Software License, v1.0 (see cml/LICENSE for details).
+
+ *-----------------------------------------------------------------------*/
+/** @file
+ *  @brief
+ *
+ * Defines the fixed-size and run-time sized external 2D arrays with a
+ * leading dimension.
+ */
+
+#ifndef strided_2D_h
+#define strided_2D_h
+
+#include <stdexcept>
+#include <cml/core/common.h>
+#include <cml/core/alignment.h>
+#include <cml/core/fixed_1D.h>
+#include <cml/core/fixed_2D.h>
+#include <cml/core/dynamic_1D.h>
+#include <cml/core/dynamic_2D.h>
+#include <cml/strided.h>
+
+namespace cml {
+
+/** Fixed-size external 2D array with a leading dimension.
+ *
+ * Element (i,j) of a row-major array is at data()[i*stride() + j], and
+ * element (i,j) of a col-major array is at data()[j*stride() + i].  The
+ * size is fixed at compile time, and the memory and stride at run time.
+ */
+template<typename Element, int Rows, int Cols, typename Layout>
+class strided_2D
+{
+  public:
+
+    /* Require Rows > 0, Cols > 0: */
+    CML_STATIC_REQUIRE((Rows > 0) && (Cols > 0));
+
+    /* Record the generator: */
+    typedef strided<Rows,Cols> generator_type;
+
+    /* Standard: */
+    typedef Element value_type;
+    typedef Element* pointer;
+    typedef Element& reference;
+    typedef const Element& const_reference;
+    typedef const Element* const_pointer;
+
+    /* For matching by memory layout: */
+    typedef Layout layout;
+
+    /* For matching by memory type: */
+    typedef external_memory_tag memory_tag;
+
+    /* For matching by size type: */
+    typedef fixed_size_tag size_tag;
+
+    /* For matching by resizability: */
+    typedef not_resizable_tag resizing_tag;
+
+    /* For matching by dimensions: */
+    typedef twod_tag dimension_tag;
+
+    /* To simplify the matrix transpose operator: */
+    typedef fixed_2D<typename cml::remove_const<Element>::type,
+            Cols,Rows,Layout> transposed_type;
+
+    /* To simplify the matrix row and column operators: */
+    typedef fixed_1D<Element,Rows> row_array_type;
+    typedef fixed_1D<Element,Cols> col_array_type;
+
+
+  public:
+
+    enum { array_rows = Rows, array_cols = Cols };
+
+    /** External arrays are only known to have natural alignment. */
+    enum { array_alignment = alignment_of<Element>::value };
+
+
+  public:
+
+    /** Construct a strided array.
+     *
+     * @param ptr the address of element (0,0).
+     * @param stride the distance in elements between consecutive rows
+     * (row-major) or columns (col-major).
+     *
+     * @throws std::invalid_argument if stride is less than the number of
+     * columns (row-major) or rows (col-major).
+     */
+    strided_2D(pointer const ptr, size_t stride)
+        : m_data(ptr), m_stride(stride)
+    {
+        if(stride < this->inner(layout()))
+            throw std::invalid_argument("stride is too small.");
+    }
+
+
+  public:
+
+    /** Return the number of rows in the array. */
+    size_t rows() const { return size_t(array_rows); }
+
+    /** Return the number of cols in the array. */
+    size_t cols() const { return size_t(array_cols); }
+
+    /** Return the distance in elements between consecutive rows (row-major)
+     * or columns (col-major).
+     */
+    size_t stride() const { return m_stride; }
+
+
+  public:
+
+    /** Access element (row,col) of the matrix.
+     *
+     * @param row row of element.
+     * @param col column of element.
+     * @returns mutable reference.
+     *
+     * @note This function does not range-check the arguments.
+     */
+    reference operator()(size_t row, size_t col) {
+        /* Dispatch to the right function based on layout: */
+        return get_element(row,col,layout());
+    }
+
+    /** Const access element (row,col) of the matrix.
+     *
+     * @param row row of element.
+     * @param col column of element.
+     * @returns const reference.
+     *
+     * @note This function does not range-check the arguments.
+     */
+    const_reference operator()(size_t row, size_t col) const {
+        /* Dispatch to the right function based on layout: */
+        return get_element(row,col,layout());
+    }
+
+    /** Return the address of element (0,0). */
+    pointer data() { return m_data; }
+
+    /** Return the address of element (0,0). */
+    const_pointer data() const { return m_data; }
+
+
+  protected:
+
+    size_t inner(row_major) const { return size_t(Cols); }
+    size_t inner(col_major) const { return size_t(Rows); }
+
+    reference get_element(size_t row, size_t col, row_major) {
+        return m_data[row*m_stride + col];
+    }
+
+    const_reference get_element(size_t row, size_t col, row_major) const {
+        return m_data[row*m_stride + col];
+    }
+
+    reference get_element(size_t row, size_t col, col_major) {
+        return m_data[col*m_stride + row];
+    }
+
+    const_reference get_element(size_t row, size_t col, col_major) const {
+        return m_data[col*m_stride + row];
+    }
+
+
+  protected:
+
+    /* Declare the data array: */
+    value_type*                 m_data;
+    size_t                      m_stride;
+
+
+  private:
+
+    strided_2D& operator=(const strided_2D&);
+};
+
+/** Run-time sized external 2D array with a leading dimension.
+ *
+ * This is a specialization for the case that Rows and Cols are not
+ * specified (i.e. given as the default of -1,-1).  The memory, size and
+ * stride are fixed at run time, and cannot be changed.
+ */
+template<typename Element, typename Layout>
+class strided_2D<Element,-1,-1,Layout>
+{
+  public:
+
+    /* Record the generator: */
+    typedef strided<> generator_type;
+
+    /* Standard: */
+    typedef Element value_type;
+    typedef Element* pointer;
+    typedef Element& reference;
+    typedef const Element& const_reference;
+    typedef const Element* const_pointer;
+
+    /* For matching by memory layout: */
+    typedef Layout layout;
+
+    /* For matching by memory type: */
+    typedef external_memory_tag memory_tag;
+
+    /* For matching by size type: */
+    typedef dynamic_size_tag size_tag;
+
+    /* For matching by resizability: */
+    typedef not_resizable_tag resizing_tag;
+
+    /* For matching by dimensions: */
+    typedef twod_tag dimension_tag;
+
+    /* To simplify the matrix transpose operator: */
+    typedef dynamic_2D<typename cml::remove_const<Element>::type,
+        Layout, CML_DEFAULT_ARRAY_ALLOC> transposed_type;
+
+    /* To simplify the matrix row and column operators: */
+    typedef dynamic_1D<Element, CML_DEFAULT_ARRAY_ALLOC> row_array_type;
+    typedef dynamic_1D<Element, CML_DEFAULT_ARRAY_ALLOC> col_array_type;
+
+
+  public:
+
+    enum { array_rows = -1, array_cols = -1 };
+
+    /** External arrays are only known to have natural alignment. */
+    enum { array_alignment = alignment_of<Element>::value };
+
+
+  public:
+
+    /** Construct a strided array.
+     *
+     * @param ptr the address of element (0,0).
+     * @param rows the number of rows.
+     * @param cols the number of columns.
+     * @param stride the distance in elements between consecutive rows
+     * (row-major) or columns (col-major).
+     *
+     * @throws std::invalid_argument if stride is less than the number of
+     * columns (row-major) or rows (col-major).
+     */
+    strided_2D(pointer const ptr, size_t rows, size_t cols, size_t stride)
+        : m_data(ptr), m_rows(rows), m_cols(cols), m_stride(stride)
+    {
+        if(stride < this->inner(layout()))
+            throw std::invalid_argument("stride is too small.");
+    }
+
+
+  public:
+
+    /** Return the number of rows in the array. */
+    size_t rows() const { return m_rows; }
+
+    /** Return the number of cols in the array. */
+    size_t cols() const { return m_cols; }
+
+    /** Return the distance in elements between consecutive rows (row-major)
+     * or columns (col-major).
+     */
+    size_t stride() const { return m_stride; }
+
+
+  public:
+
+    /** Access element (row,col) of the matrix.
+     *
+     * @param row row of element.
+     * @param col column of element.
+     * @returns mutable reference.
+     *
+     * @note This function does not range-check the arguments.
+     */
+    reference operator()(size_t row, size_t col) {
+        /* Dispatch to the right function based on layout: */
+        return get_element(row,col,layout());
+    }
+
+    /** Const access element (row,col) of the matrix.
+     *
+     * @param row row of element.
+     * @param col column of element.
+     * @returns const reference.
+     *
+     * @note This function does not range-check the arguments.
+     */
+    const_reference operator()(size_t row, size_t col) const {
+        /* Dispatch to the right function based on layout: */
+        return get_element(row,col,layout());
+    }
+
+    /** Return the address of element (0,0). */
+    pointer data() { return m_data; }
+
+    /** Return the address of element (0,0). */
+    const_pointer data() const { return m_data; }
+
+
+  protected:
+
+    size_t inner(row_major) const { return m_cols; }
+    size_t inner(col_major) const { return m_rows; }
+
+    reference get_element(size_t row, size_t col, row_major) {
+        return m_data[row*m_stride + col];
+    }
+
+    const_reference get_element(size_t row, size_t col, row_major) const {
+        return m_data[row*m_stride + col];
+    }
+
+    reference get_element(size_t row, size_t col, col_major) {
+        return m_data[col*m_stride + row];
+    }
+
+    const_reference get_element(size_t row, size_t col, col_major) const {
+        return m_data[col*m_stride + row];
+    }
+
+
+  protected:
+
+    /* Declare the data array: */
+    value_type*                 m_data;
+    size_t                      m_rows;
+    size_t                      m_cols;
+    size_t                      m_stride;
+
+
+  private:
+
+    strided_2D& operator=(const strided_2D&);
+};
+
+} // namespace cml
+
+#endif
+
+// -------------------------------------------------------------------------
+// vim:ft=cpp
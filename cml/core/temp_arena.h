@@ -0,0 +1,299 @@
+/* -*- C++ -*- ------------------------------------------------------------
+ 
+Copyright (c) 2007 Jesse Anders and Demian Nave http://cmldev.net/
+
+The Configurable Math Library (CML) is distributed under the terms of the
+Boost Software License, v1.0 (see cml/LICENSE for details).
+
+ *-----------------------------------------------------------------------*/
+/** @file
+ *  @brief A scoped bump allocator for short-lived vectors and matrices.
+ *
+ * A temp_arena hands out memory by advancing a pointer through large
+ * blocks, and releases all of it at once when it goes out of scope.  While
+ * it is alive, it is the current arena of the thread that created it, and
+ * arena_allocator<> takes its memory from it:
+ *
+ *   typedef matrix< double, dynamic< arena_allocator<void> > > matrix_type;
+ *
+ *   void handle(const request& r) {
+ *       cml::temp_arena arena;
+ *       matrix_type A = ..., B = ...;
+ *       matrix_type C = inverse(A*B);      // No calls to operator new.
+ *       ...
+ *   }
+ *
+ * Since the library's temporaries have the type of their operands, the
+ * temporaries of operator*(), transpose(), lu(), inverse() and friends
+ * are also taken from the arena.  Each arena_allocator<> remembers the
+ * arena that was current when it was constructed, so a vector or matrix
+ * created before the arena, or on another thread, keeps using operator new
+ * and operator delete.  Moving a temporary into such a vector or matrix
+ * copies it rather than taking its arena memory.
+ *
+ * @warning Vectors and matrices that took their memory from an arena must
+ * be destroyed before the arena, and must not be resized after it.
+ */
+
+#ifndef core_temp_arena_h
+#define core_temp_arena_h
+
+#include <cstddef>
+#include <new>
+#include <cml/defaults.h>
+#include <cml/core/alignment.h>
+
+/** Declare a variable with one instance per thread. */
+#if __cplusplus >= 201103L || (defined(_MSC_VER) && _MSC_VER >= 1900)
+#define CML_THREAD_LOCAL thread_local
+#elif defined(__GNUC__)
+#define CML_THREAD_LOCAL __thread
+#elif defined(_MSC_VER)
+#define CML_THREAD_LOCAL __declspec(thread)
+#else
+#error "CML_THREAD_LOCAL is not defined for this compiler."
+#endif
+
+namespace cml {
+
+/** A scoped bump allocator, current for its thread while it is alive.
+ *
+ * Memory is taken from blocks of at least block_size bytes, which are only
+ * freed by the destructor.  Arenas can be nested; the innermost one is the
+ * current arena.
+ */
+class temp_arena
+{
+  public:
+
+    /** Create an arena and make it the current arena of this thread. */
+    explicit temp_arena(size_t block_size = CML_TEMP_ARENA_BLOCK)
+      : m_blocks(0), m_next(0), m_end(0), m_used(0),
+        m_block_size(block_size), m_previous(current_ref())
+    {
+      current_ref() = this;
+    }
+
+    /** Free all of the memory, and restore the previous arena. */
+    ~temp_arena() {
+      while(m_blocks) {
+        block* b = m_blocks;
+        m_blocks = b->next;
+        ::operator delete(b);
+      }
+      current_ref() = m_previous;
+    }
+
+
+  public:
+
+    /** Return the current arena of this thread, or 0 if there is none. */
+    static temp_arena* current() { return current_ref(); }
+
+    /** Return n bytes aligned to align bytes (a power of two). */
+    void* allocate(size_t n, size_t align) {
+      size_t pad = (align - size_t(m_next) % align) % align;
+      if(size_t(m_end - m_next) < pad + n) {
+        this->grow(n + align);
+        pad = (align - size_t(m_next) % align) % align;
+      }
+      char* p = m_next + pad;
+      m_next = p + n;
+      m_used += n;
+      return p;
+    }
+
+    /** Return the number of bytes handed out so far. */
+    size_t used() const { return m_used; }
+
+
+  protected:
+
+    /** Header of each block of memory. */
+    struct block {
+      block* next;
+      size_t size;
+    };
+
+    /** Start a new block with room for at least n bytes. */
+    void grow(size_t n) {
+      size_t size = (n > m_block_size) ? n : m_block_size;
+      block* b = static_cast<block*>(
+          ::operator new(sizeof(block) + size));
+      b->next = m_blocks;
+      b->size = size;
+      m_blocks = b;
+      m_next = reinterpret_cast<char*>(b + 1);
+      m_end = m_next + size;
+    }
+
+    /** The current arena of this thread. */
+    static temp_arena*& current_ref() {
+      static CML_THREAD_LOCAL temp_arena* arena = 0;
+      return arena;
+    }
+
+
+  private:
+
+    /* Not copyable: */
+    temp_arena(const temp_arena&);
+    temp_arena& operator=(const temp_arena&);
+
+
+  protected:
+
+    /** Most recent block (may be NULL). */
+    block*			m_blocks;
+
+    /** Free space in the most recent block. */
+    char*			m_next;
+    char*			m_end;
+
+    /** Number of bytes handed out. */
+    size_t			m_used;
+
+    /** Minimum size of each block. */
+    size_t			m_block_size;
+
+    /** The enclosing arena (may be NULL). */
+    temp_arena*			m_previous;
+};
+
+/** An allocator taking memory from the temp_arena that was current when
+ * it was constructed.
+ *
+ * This can be used as the allocator of dynamic<>, like std::allocator<void>.
+ * The memory is aligned to Align bytes, or to the natural alignment of T if
+ * Align is 0.  Without a current arena, memory is taken from operator new.
+ * Two allocators compare equal if they use the same arena, or both use
+ * operator new, so that arrays only exchange memory between equal ones.
+ *
+ * @internal The word before each block records where it came from: 0 for
+ * an arena, otherwise the address returned by operator new.
+ */
+template<typename T, int Align = 0> class arena_allocator
+{
+  public:
+
+    typedef T value_type;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef size_t size_type;
+    typedef ptrdiff_t difference_type;
+
+    template<class U> struct rebind {
+        typedef arena_allocator<U,Align> other;
+    };
+
+    enum { alignment = storage_alignment<T,Align>::value };
+
+    /* The space needed for the header, keeping the alignment: */
+    enum { header = (int(alignment) > int(sizeof(void*)))
+        ? int(alignment) : int(sizeof(void*)) };
+
+
+  public:
+
+    arena_allocator() : m_arena(temp_arena::current()) {}
+    template<class U> arena_allocator(const arena_allocator<U,Align>& a)
+        : m_arena(a.arena()) {}
+
+    /** Return the arena used by this allocator, or 0 for operator new. */
+    temp_arena* arena() const { return m_arena; }
+
+    pointer address(reference x) const { return &x; }
+    const_pointer address(const_reference x) const { return &x; }
+
+    size_type max_size() const {
+        return (size_type(-1) - 2*header) / sizeof(T);
+    }
+
+    pointer allocate(size_type n, const void* = 0) {
+        if(n > max_size()) throw std::bad_alloc();
+        const size_t bytes = n*sizeof(T) + header;
+        char* p;
+        void* tag;
+        if(m_arena) {
+            p = static_cast<char*>(m_arena->allocate(bytes, header)) + header;
+            tag = 0;
+        } else {
+            char* raw = static_cast<char*>(::operator new(bytes + header));
+            p = raw + header;
+            p += (header - reinterpret_cast<size_t>(p) % header) % header;
+            tag = raw;
+        }
+        reinterpret_cast<void**>(p)[-1] = tag;
+        return reinterpret_cast<pointer>(p);
+    }
+
+    /** Free memory from operator new; arena memory is freed with the
+     * arena.
+     */
+    void deallocate(pointer p, size_type) {
+        if(p) {
+            void* raw = reinterpret_cast<void**>(p)[-1];
+            if(raw) ::operator delete(raw);
+        }
+    }
+
+    void construct(pointer p, const T& x) { new((void*) p) T(x); }
+    void destroy(pointer p) { p->~T(); }
+
+
+  protected:
+
+    /** The arena memory is taken from (may be NULL). */
+    temp_arena*			m_arena;
+};
+
+/** The void arena_allocator<>, used only to rebind to element types. */
+template<int Align> class arena_allocator<void,Align>
+{
+  public:
+
+    typedef void value_type;
+    typedef void* pointer;
+    typedef const void* const_pointer;
+
+    template<class U> struct rebind {
+        typedef arena_allocator<U,Align> other;
+    };
+
+    arena_allocator() : m_arena(temp_arena::current()) {}
+    template<class U> arena_allocator(const arena_allocator<U,Align>& a)
+        : m_arena(a.arena()) {}
+
+    temp_arena* arena() const { return m_arena; }
+
+
+  protected:
+
+    temp_arena*			m_arena;
+};
+
+template<typename T, typename U, int Align> inline bool operator==(
+        const arena_allocator<T,Align>& a, const arena_allocator<U,Align>& b)
+{
+    return a.arena() == b.arena();
+}
+
+template<typename T, typename U, int Align> inline bool operator!=(
+        const arena_allocator<T,Align>& a, const arena_allocator<U,Align>& b)
+{
+    return a.arena() != b.arena();
+}
+
+template<typename E, int Align>
+struct allocator_alignment<arena_allocator<E,Align>,E> {
+    enum { value = arena_allocator<E,Align>::alignment };
+};
+
+} // namespace cml
+
+#endif
+
+// -------------------------------------------------------------------------
+// vim:ft=cpp
@@ -0,0 +1,247 @@
+/* -*- C++ -*- ------------------------------------------------------------
+ 
+Copyright (c) 2007 Jesse Anders and Demian Nave http://cmldev.net/
+
+The Configurable Math Library (CML) is distributed under the terms of the
+Boost Software License, v1.0 (see cml/LICENSE for details).
+
+ *-----------------------------------------------------------------------*/
+/** @file
+ *  @brief A small work-stealing thread pool for fork-join parallelism.
+ *
+ * @note This header requires C++11 threads, and is only included by the
+ * rest of the CML when CML_PARALLEL is defined.
+ *
+ * @sa cml/matrix/parallel_mul.h
+ */
+
+#ifndef core_thread_pool_h
+#define core_thread_pool_h
+
+#if (__cplusplus < 201103L) && !(defined(_MSC_VER) && _MSC_VER >= 1900)
+#error "cml/core/thread_pool.h requires C++11 thread support."
+#endif
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <cml/core/common.h>
+
+namespace cml {
+
+/** A fixed-size pool of worker threads with per-worker task queues.
+ *
+ * Each worker takes tasks from the front of its own queue, and steals from
+ * the back of the other workers' queues when its own queue is empty.  The
+ * thread calling parallel_for() also executes tasks until all of the tasks
+ * it submitted have finished.
+ *
+ * @internal Tasks are type-erased with std::function<>, so they should be
+ * coarse-grained (e.g. a whole cache block of a matrix product).
+ */
+class thread_pool
+{
+  public:
+
+    typedef std::function<void()> task_type;
+
+
+  public:
+
+    /** Start a pool with the given number of worker threads.
+     *
+     * If threads is 0, one worker is started for each hardware thread
+     * except the calling one (which participates in parallel_for()).
+     */
+    explicit thread_pool(size_t threads = 0) : m_queued(0), m_stop(false) {
+        if(threads == 0) {
+            size_t hw = std::thread::hardware_concurrency();
+            threads = (hw > 1) ? hw-1 : 1;
+        }
+        m_queues.resize(threads);
+        for(size_t i = 0; i < threads; ++ i)
+            m_queues[i] = new queue_type;
+        for(size_t i = 0; i < threads; ++ i)
+            m_threads.push_back(std::thread(&thread_pool::worker, this, i));
+    }
+
+    /** Stop the workers after the queued tasks have been run. */
+    ~thread_pool() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        for(size_t i = 0; i < m_threads.size(); ++ i) m_threads[i].join();
+        for(size_t i = 0; i < m_queues.size(); ++ i) delete m_queues[i];
+    }
+
+
+  public:
+
+    /** Return the number of worker threads. */
+    size_t size() const { return m_threads.size(); }
+
+    /** Run f(0) ... f(n-1) in parallel, and return when all have finished.
+     *
+     * If any of the calls throws, the first exception caught is rethrown
+     * here after the remaining tasks have finished.
+     */
+    template<class Func> void parallel_for(size_t n, Func f) {
+        if(n == 0) return;
+
+        /* Completion state shared by the tasks of this call: */
+        join_state state(n);
+
+        /* Deal the tasks round-robin to the worker queues: */
+        for(size_t i = 0; i < n; ++ i)
+            this->push(i % m_queues.size(), make_task(f, i, state));
+
+        /* Help out until there is nothing left to take, then wait for the
+         * tasks still in flight on other threads:
+         */
+        task_type task;
+        while(state.remaining > 0 && this->pop(0, task)) {
+            task(); task = task_type();
+        }
+        {
+            std::unique_lock<std::mutex> lock(state.mutex);
+            while(state.remaining > 0) state.done.wait(lock);
+        }
+
+        if(state.error) std::rethrow_exception(state.error);
+    }
+
+
+  protected:
+
+    typedef std::deque<task_type> task_list;
+
+    /** A worker's task queue. */
+    struct queue_type {
+        std::mutex mutex;
+        task_list tasks;
+    };
+
+    /** Shared state for a parallel_for() call. */
+    struct join_state {
+        explicit join_state(size_t n) : remaining(n) {}
+        std::atomic<size_t> remaining;
+        std::mutex mutex;
+        std::condition_variable done;
+        std::exception_ptr error;
+    };
+
+    /** Wrap f(i) so that it signals state when it finishes. */
+    template<class Func> static task_type
+    make_task(Func f, size_t i, join_state& state) {
+        join_state* s = &state;
+        return [f, i, s]() {
+            std::exception_ptr error;
+            try { f(i); } catch(...) { error = std::current_exception(); }
+
+            /* Note: the caller may return as soon as remaining reaches 0,
+             * so s must not be touched after the lock is released:
+             */
+            std::lock_guard<std::mutex> lock(s->mutex);
+            if(error && !s->error) s->error = error;
+            if(-- s->remaining == 0) s->done.notify_all();
+        };
+    }
+
+    /** Queue a task on worker q. */
+    void push(size_t q, const task_type& task) {
+        {
+            std::lock_guard<std::mutex> lock(m_queues[q]->mutex);
+            m_queues[q]->tasks.push_back(task);
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ++ m_queued;
+        }
+        m_wake.notify_one();
+    }
+
+    /** Take a task from the front of queue q, or steal one from the back
+     * of another queue.
+     */
+    bool pop(size_t q, task_type& task) {
+        const size_t n = m_queues.size();
+        for(size_t k = 0; k < n; ++ k) {
+            queue_type& queue = *m_queues[(q+k)%n];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if(queue.tasks.empty()) continue;
+            if(k == 0) {
+                task = queue.tasks.front(); queue.tasks.pop_front();
+            } else {
+                task = queue.tasks.back(); queue.tasks.pop_back();
+            }
+            -- m_queued;
+            return true;
+        }
+        return false;
+    }
+
+    /** The worker loop. */
+    void worker(size_t q) {
+        task_type task;
+        for(;;) {
+            if(this->pop(q, task)) {
+                task(); task = task_type();
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(m_mutex);
+            while(!m_stop && m_queued == 0) m_wake.wait(lock);
+            if(m_stop && m_queued == 0) return;
+        }
+    }
+
+
+  protected:
+
+    /** The per-worker queues (not copyable, so held by pointer). */
+    std::vector<queue_type*>    m_queues;
+
+    /** The worker threads. */
+    std::vector<std::thread>    m_threads;
+
+    /** Number of queued tasks, used to put idle workers to sleep. */
+    std::atomic<size_t>         m_queued;
+
+    /** Set when the pool is being destroyed. */
+    bool                        m_stop;
+
+    /** Protects m_stop and the sleep/wake protocol. */
+    std::mutex                  m_mutex;
+    std::condition_variable     m_wake;
+
+
+  private:
+
+    /* Cannot be copied: */
+    thread_pool(const thread_pool&);
+    thread_pool& operator=(const thread_pool&);
+};
+
+/** Return the pool used for implicitly parallel operations.
+ *
+ * The pool is created on first use with CML_PARALLEL_THREADS workers (0
+ * selects one per hardware thread).
+ */
+inline thread_pool& default_thread_pool()
+{
+    static thread_pool pool(CML_PARALLEL_THREADS);
+    return pool;
+}
+
+} // namespace cml
+
+#endif
+
+// -------------------------------------------------------------------------
+// vim:ft=cpp
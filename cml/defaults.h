@@ -44,6 +44,80 @@ Boost Software License, v1.0 (see cml/LICENSE for details).
 #define CML_VECTOR_DOT_UNROLL_LIMIT CML_VECTOR_UNROLL_LIMIT
 #endif
 
+/* Assign large matrices from transposed or mixed-layout expressions in
+ * 16x16 tiles:
+ */
+#if !defined(CML_MATRIX_ASSIGN_TILE)
+#define CML_MATRIX_ASSIGN_TILE 16
+#endif
+
+/* With CML_PAIRWISE_REDUCTION, sum blocks of up to 128 terms directly: */
+#if !defined(CML_PAIRWISE_REDUCTION_BLOCK)
+#define CML_PAIRWISE_REDUCTION_BLOCK 128
+#endif
+
+/* Use the blocked matrix multiplication kernel for run-time sized products
+ * needing at least 32^3 multiply-adds:
+ */
+#if !defined(CML_BLOCKED_MUL_THRESHOLD)
+#define CML_BLOCKED_MUL_THRESHOLD 32
+#endif
+
+/* Factor run-time sized matrices in lu_pivot_inplace() by panels of 32
+ * columns, updating the rest of the matrix with the blocked product kernel:
+ */
+#if !defined(CML_LU_BLOCK_SIZE)
+#define CML_LU_BLOCK_SIZE 32
+#endif
+
+/* Factor run-time sized matrices in cholesky_inplace() by panels of 32
+ * columns:
+ */
+#if !defined(CML_CHOLESKY_BLOCK_SIZE)
+#define CML_CHOLESKY_BLOCK_SIZE 32
+#endif
+
+/* Factor run-time sized matrices in qr_inplace() by panels of 16 columns,
+ * applying the reflectors of each panel to the rest of the matrix at once:
+ */
+#if !defined(CML_QR_BLOCK_SIZE)
+#define CML_QR_BLOCK_SIZE 16
+#endif
+
+/* Invert run-time sized matrices in inverse_inplace() by panels of 32
+ * columns, updating the rest of the matrix with the blocked product kernel:
+ */
+#if !defined(CML_INVERSE_BLOCK_SIZE)
+#define CML_INVERSE_BLOCK_SIZE 32
+#endif
+
+/* Products needing at least CML_PARALLEL_MUL_THRESHOLD^3 multiply-adds are
+ * split across threads when CML_PARALLEL is defined, or when parallel_mul()
+ * is called directly:
+ */
+#if !defined(CML_PARALLEL_MUL_THRESHOLD)
+#define CML_PARALLEL_MUL_THRESHOLD 128
+#endif
+
+/* Sparse matrix-vector products with at least CML_PARALLEL_SPMV_THRESHOLD
+ * stored elements are split across threads when CML_PARALLEL is defined:
+ */
+#if !defined(CML_PARALLEL_SPMV_THRESHOLD)
+#define CML_PARALLEL_SPMV_THRESHOLD 65536
+#endif
+
+/* The number of worker threads in cml::default_thread_pool() (0 means one
+ * per hardware thread):
+ */
+#if !defined(CML_PARALLEL_THREADS)
+#define CML_PARALLEL_THREADS 0
+#endif
+
+/* temp_arena takes memory from the system in blocks of at least 64 KiB: */
+#if !defined(CML_TEMP_ARENA_BLOCK)
+#define CML_TEMP_ARENA_BLOCK 65536
+#endif
+
 /* The default array layout is the C/C++ row-major array layout: */
 #if !defined(CML_DEFAULT_ARRAY_LAYOUT)
 #define CML_DEFAULT_ARRAY_LAYOUT cml::row_major
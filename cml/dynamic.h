@@ -14,6 +14,8 @@ Boost Software License, v1.0 (see cml/LICENSE for details).
 #define dynamic_h
 
 #include <cml/defaults.h>
+#include <cml/core/alignment.h>
+#include <cml/core/temp_arena.h>
 
 namespace cml {
 
@@ -22,6 +24,10 @@ namespace cml {
  * The dynamic<> struct has no implementation; it is used only to select a
  * 1D or 2D array type as the base class of a vector or matrix.
  *
+ * Alloc is rebound to the element type.  Use aligned_allocator<void,N> for
+ * arrays aligned to N bytes, or arena_allocator<void> to take the arrays
+ * from the current temp_arena.
+ *
  * @sa fixed
  * @sa external
  */
@@ -28,6 +28,81 @@ namespace et {
 
 namespace detail {
 
+/* The allocator of a dynamic array argument, if any: */
+template<class A> struct dynamic_allocator {
+    typedef CML_DEFAULT_ARRAY_ALLOC type;
+    enum { is_true = false };
+};
+
+template<typename E, class Alloc>
+struct dynamic_allocator< dynamic_1D<E,Alloc> > {
+    typedef Alloc type;
+    enum { is_true = true };
+};
+
+template<typename E, class L, class Alloc>
+struct dynamic_allocator< dynamic_2D<E,L,Alloc> > {
+    typedef Alloc type;
+    enum { is_true = true };
+};
+
+template<typename E, class G, class L>
+struct dynamic_allocator< packed_2D<E,G,L> > {
+    typedef typename G::allocator_type type;
+    enum { is_true = true };
+};
+
+template<typename E, class G, class L>
+struct dynamic_allocator< banded_2D<E,G,L> > {
+    typedef typename G::allocator_type type;
+    enum { is_true = true };
+};
+
+/* Dynamic results use the allocator of the first dynamic argument, so that
+ * temporaries come from the same place as their operands (e.g. a
+ * temp_arena), or CML_DEFAULT_ARRAY_ALLOC if neither argument is dynamic:
+ */
+template<class A1, class A2, typename E> struct promote_allocator {
+    typedef typename select_if<
+        dynamic_allocator<A1>::is_true,
+        typename dynamic_allocator<A1>::type,
+        typename dynamic_allocator<A2>::type
+    >::result allocator;
+    typedef typename allocator::template rebind<E>::other type;
+};
+
+/* Promotions of fixed-size and hybrid arrays, at least one hybrid, are
+ * matched by this tag:
+ */
+struct bounded_size_tag {};
+
+/* The largest size of an array, or -1 if it is unbounded: */
+template<class A, class DTag = typename A::dimension_tag,
+    class SizeTag = typename A::size_tag>
+struct array_bounds {
+    enum { is_true = false, max_size = -1, max_rows = -1, max_cols = -1 };
+};
+
+template<class A> struct array_bounds<A,oned_tag,fixed_size_tag> {
+    enum { is_true = true, max_size = A::array_size };
+};
+
+template<class A> struct array_bounds<A,twod_tag,fixed_size_tag> {
+    enum {
+        is_true = true, max_rows = A::array_rows, max_cols = A::array_cols
+    };
+};
+
+template<typename E, int S, int Align>
+struct array_bounds<hybrid_1D<E,S,Align>,oned_tag,dynamic_size_tag> {
+    enum { is_true = true, max_size = S };
+};
+
+template<typename E, int R, int C, class L, int Align>
+struct array_bounds<hybrid_2D<E,R,C,L,Align>,twod_tag,dynamic_size_tag> {
+    enum { is_true = true, max_rows = R, max_cols = C };
+};
+
 /* This is specialized for 1D and 2D promotions: */
 template<class A1, class A2, typename DTag1, typename DTag2,
     typename PromotedSizeTag> struct promote;
@@ -62,8 +137,7 @@ struct promote<A1,A2,oned_tag,oned_tag,dynamic_size_tag>
         left_scalar,right_scalar>::type promoted_scalar;
 
     /* Next, rebind to get the proper allocator: */
-    typedef typename CML_DEFAULT_ARRAY_ALLOC
-        ::rebind<promoted_scalar>::other allocator;
+    typedef typename promote_allocator<A1,A2,promoted_scalar>::type allocator;
 
     /* Finally, generate the promoted array type: */
     typedef dynamic_1D<promoted_scalar,allocator> type;
@@ -117,8 +191,7 @@ struct promote<A1,A2,twod_tag,oned_tag,dynamic_size_tag>
         left_scalar,right_scalar>::type promoted_scalar;
 
     /* Next, rebind to get the proper allocator: */
-    typedef typename CML_DEFAULT_ARRAY_ALLOC
-        ::rebind<promoted_scalar>::other allocator;
+    typedef typename promote_allocator<A1,A2,promoted_scalar>::type allocator;
 
     /* Finally, generate the promoted array type: */
     typedef dynamic_1D<promoted_scalar,allocator> type;
@@ -136,8 +209,7 @@ struct promote<A1,A2,oned_tag,twod_tag,dynamic_size_tag>
         left_scalar,right_scalar>::type promoted_scalar;
 
     /* Next, rebind to get the proper allocator: */
-    typedef typename CML_DEFAULT_ARRAY_ALLOC
-        ::rebind<promoted_scalar>::other allocator;
+    typedef typename promote_allocator<A1,A2,promoted_scalar>::type allocator;
 
     /* Finally, generate the promoted array type: */
     typedef dynamic_1D<promoted_scalar,allocator> type;
@@ -197,8 +269,7 @@ struct promote<A1,A2,twod_tag,twod_tag,dynamic_size_tag>
         left_scalar,right_scalar>::type promoted_scalar;
 
     /* Next, rebind to get the proper allocator: */
-    typedef typename CML_DEFAULT_ARRAY_ALLOC
-        ::rebind<promoted_scalar>::other allocator;
+    typedef typename promote_allocator<A1,A2,promoted_scalar>::type allocator;
 
     /* Then deduce the array layout: */
     typedef typename A1::layout left_layout;
@@ -210,6 +281,90 @@ struct promote<A1,A2,twod_tag,twod_tag,dynamic_size_tag>
     typedef dynamic_2D<promoted_scalar,promoted_layout,allocator> type;
 };
 
+/* Promote 1D fixed-size and hybrid arrays to a 1D hybrid array: */
+template<class A1, class A2>
+struct promote<A1,A2,oned_tag,oned_tag,bounded_size_tag>
+{
+    typedef typename A1::value_type left_scalar;
+    typedef typename A2::value_type right_scalar;
+
+    /* First, promote the scalar type: */
+    typedef typename ScalarPromote<
+        left_scalar,right_scalar>::type promoted_scalar;
+
+    /* Next, deduce the largest array size: */
+    enum { Size = VAL_MAX((int)array_bounds<A1>::max_size,
+            (int)array_bounds<A2>::max_size) };
+
+    /* Finally, generate the promoted array type: */
+    typedef hybrid_1D<promoted_scalar,Size> type;
+};
+
+/* Promote 2D+1D fixed-size and hybrid arrays to a 1D hybrid array: */
+template<class A1, class A2>
+struct promote<A1,A2,twod_tag,oned_tag,bounded_size_tag>
+{
+    typedef typename A1::value_type left_scalar;
+    typedef typename A2::value_type right_scalar;
+
+    /* First, promote the scalar type: */
+    typedef typename ScalarPromote<
+        left_scalar,right_scalar>::type promoted_scalar;
+
+    /* Next, deduce the largest array size: */
+    enum { Size = array_bounds<A1>::max_rows };
+
+    /* Finally, generate the promoted array type: */
+    typedef hybrid_1D<promoted_scalar,Size> type;
+};
+
+/* Promote 1D+2D fixed-size and hybrid arrays to a 1D hybrid array: */
+template<class A1, class A2>
+struct promote<A1,A2,oned_tag,twod_tag,bounded_size_tag>
+{
+    typedef typename A1::value_type left_scalar;
+    typedef typename A2::value_type right_scalar;
+
+    /* First, promote the scalar type: */
+    typedef typename ScalarPromote<
+        left_scalar,right_scalar>::type promoted_scalar;
+
+    /* Next, deduce the largest array size: */
+    enum { Size = array_bounds<A2>::max_cols };
+
+    /* Finally, generate the promoted array type: */
+    typedef hybrid_1D<promoted_scalar,Size> type;
+};
+
+/* Promote 2D fixed-size and hybrid arrays to a 2D hybrid array.  The
+ * result can hold as many rows as A1, and as many columns as A2.
+ */
+template<class A1, class A2>
+struct promote<A1,A2,twod_tag,twod_tag,bounded_size_tag>
+{
+    typedef typename A1::value_type left_scalar;
+    typedef typename A2::value_type right_scalar;
+
+    /* First, promote the scalar type: */
+    typedef typename ScalarPromote<
+        left_scalar,right_scalar>::type promoted_scalar;
+
+    /* Next, deduce the largest array size: */
+    enum {
+        Rows = array_bounds<A1>::max_rows,
+        Cols = array_bounds<A2>::max_cols
+    };
+
+    /* Then deduce the array layout: */
+    typedef typename A1::layout left_layout;
+    typedef typename A2::layout right_layout;
+    typedef typename deduce_layout<left_layout,right_layout>
+        ::promoted_layout promoted_layout;
+
+    /* Finally, generate the promoted array type: */
+    typedef hybrid_2D<promoted_scalar,Rows,Cols,promoted_layout> type;
+};
+
 } // namespace detail
 
 /** Class to promote array types.
@@ -220,6 +375,8 @@ struct promote<A1,A2,twod_tag,twod_tag,dynamic_size_tag>
  * @sa fixed_2D
  * @sa dynamic_1D
  * @sa dynamic_2D
+ * @sa hybrid_1D
+ * @sa hybrid_2D
  */
 template<class A1, class A2>
 struct ArrayPromote
@@ -259,16 +416,26 @@ struct ArrayPromote
      * Note that if one argument is a dynamically-sized array, the result
      * must be a dynamically allocated and sized array.  Likewise, if both
      * arguments have fixed size, the result can be a fixed-sized array.
+     *
+     * Hybrid arrays are dynamically sized, but have a largest size.  If one
+     * argument is a hybrid array and the other is a hybrid or fixed-size
+     * array, the result is a hybrid array large enough for both.
      */
 
     /* Check if both arguments are fixed-size arrays.  If so, the promoted
-     * array will be a fixed array, and if not, it will be a dynamic array:
+     * array will be a fixed array.  If not, it will be a hybrid array if
+     * both arguments have a largest size, and a dynamic array otherwise:
      */
     typedef typename select_if<
         (same_type<typename A1::size_tag, fixed_size_tag>::is_true
          && same_type<typename A2::size_tag, fixed_size_tag>::is_true),
         fixed_size_tag,         /* True */
-        dynamic_size_tag        /* False */
+        typename select_if<
+            (detail::array_bounds<A1>::is_true
+             && detail::array_bounds<A2>::is_true),
+            detail::bounded_size_tag,
+            dynamic_size_tag
+        >::result               /* False */
     >::result promoted_size_tag;
 
     /* Deduce the promoted type: */
@@ -0,0 +1,323 @@
+/* -*- C++ -*- ------------------------------------------------------------
+ 
+Copyright (c) 2007 Jesse Anders and Demian Nave http://cmldev.net/
+
+The Configurable Math Library (CML) is distributed under the terms of the
+Boost Software License, v1.0 (see cml/LICENSE for details).
+
+ *-----------------------------------------------------------------------*/
+/** @file
+ *  @brief SIMD packets for evaluating expressions several elements at once.
+ *
+ * Packet<E> wraps the widest SIMD register type enabled for the element type
+ * E (see cml/core/simd.h): AVX-512, AVX/AVX2, or SSE/SSE2 for float, double
+ * and int.  Packet<E>::size is 1 if there is no packet type for E.
+ *
+ * Expressions are evaluated packet-wise only if every node in the tree
+ * supports it, as reported by PacketAccess<> for the nodes and PacketOp<>
+ * for the scalar operators.  Both default to false, so unknown expression
+ * types and operators are always evaluated one element at a time.
+ *
+ * @sa cml/vector/vector_unroller.h
+ */
+
+#ifndef et_packet_h
+#define et_packet_h
+
+#include <cml/core/simd.h>
+#include <cml/et/traits.h>
+
+namespace cml {
+namespace et {
+
+/** The SIMD packet type for elements of type E.
+ *
+ * This is the general case, with no packet type.  The specializations
+ * define:
+ *
+ *   type                      the SIMD register type
+ *   size                      the number of elements in a packet
+ *   has_add, has_sub, ...     which of the operations below are provided
+ *   load(p), store(p,x)       unaligned load and store of size elements
+ *   load_aligned(p), ...      the same, for p aligned to sizeof(type)
+ *   set1(s)                   a packet with every element set to s
+ *   add(x,y), sub(x,y), mul(x,y), div(x,y), neg(x), pos(x), assign(x,y)
+ */
+template<typename E> struct Packet {
+    typedef E value_type;
+    typedef E type;
+    enum { size = 1, has_add = 0, has_sub = 0, has_mul = 0, has_div = 0,
+        has_neg = 0, has_pos = 0, has_assign = 0 };
+};
+
+/* Shorthand for the operations provided by every packet type: */
+#define CML_PACKET_COMMON(_T_, _E_)                                     \
+    typedef _E_ value_type;                                             \
+    typedef _T_ type;                                                   \
+    enum { has_add = 1, has_sub = 1, has_neg = 1, has_pos = 1,          \
+        has_assign = 1 };                                               \
+    static type pos(type x) { return x; }                               \
+    static type assign(type, type y) { return y; }
+
+#if defined(CML_SIMD_AVX512F)
+
+/** AVX-512 packet of 16 floats. */
+template<> struct Packet<float> {
+    CML_PACKET_COMMON(__m512, float)
+    enum { size = 16, has_mul = 1, has_div = 1 };
+    static type load(const float* p) { return _mm512_loadu_ps(p); }
+    static type load_aligned(const float* p) { return _mm512_load_ps(p); }
+    static void store(float* p, type x) { _mm512_storeu_ps(p, x); }
+    static void store_aligned(float* p, type x) { _mm512_store_ps(p, x); }
+    static type set1(float s) { return _mm512_set1_ps(s); }
+    static type add(type x, type y) { return _mm512_add_ps(x, y); }
+    static type sub(type x, type y) { return _mm512_sub_ps(x, y); }
+    static type mul(type x, type y) { return _mm512_mul_ps(x, y); }
+    static type div(type x, type y) { return _mm512_div_ps(x, y); }
+    static type neg(type x) {
+        /* Flip the sign bits (_mm512_xor_ps requires AVX512DQ): */
+        return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(x),
+                    _mm512_set1_epi32(int(0x80000000))));
+    }
+};
+
+/** AVX-512 packet of 8 doubles. */
+template<> struct Packet<double> {
+    CML_PACKET_COMMON(__m512d, double)
+    enum { size = 8, has_mul = 1, has_div = 1 };
+    static type load(const double* p) { return _mm512_loadu_pd(p); }
+    static type load_aligned(const double* p) { return _mm512_load_pd(p); }
+    static void store(double* p, type x) { _mm512_storeu_pd(p, x); }
+    static void store_aligned(double* p, type x) { _mm512_store_pd(p, x); }
+    static type set1(double s) { return _mm512_set1_pd(s); }
+    static type add(type x, type y) { return _mm512_add_pd(x, y); }
+    static type sub(type x, type y) { return _mm512_sub_pd(x, y); }
+    static type mul(type x, type y) { return _mm512_mul_pd(x, y); }
+    static type div(type x, type y) { return _mm512_div_pd(x, y); }
+    static type neg(type x) {
+        return _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(x),
+                    _mm512_set1_epi64((long long)(0x8000000000000000ULL))));
+    }
+};
+
+/** AVX-512 packet of 16 ints. */
+template<> struct Packet<int> {
+    CML_PACKET_COMMON(__m512i, int)
+    enum { size = 16, has_mul = 1, has_div = 0 };
+    static type load(const int* p) { return _mm512_loadu_si512(p); }
+    static type load_aligned(const int* p) { return _mm512_load_si512(p); }
+    static void store(int* p, type x) { _mm512_storeu_si512(p, x); }
+    static void store_aligned(int* p, type x) { _mm512_store_si512(p, x); }
+    static type set1(int s) { return _mm512_set1_epi32(s); }
+    static type add(type x, type y) { return _mm512_add_epi32(x, y); }
+    static type sub(type x, type y) { return _mm512_sub_epi32(x, y); }
+    static type mul(type x, type y) { return _mm512_mullo_epi32(x, y); }
+    static type neg(type x) {
+        return _mm512_sub_epi32(_mm512_setzero_si512(), x);
+    }
+};
+
+#elif defined(CML_SIMD_AVX)
+
+/** AVX packet of 8 floats. */
+template<> struct Packet<float> {
+    CML_PACKET_COMMON(__m256, float)
+    enum { size = 8, has_mul = 1, has_div = 1 };
+    static type load(const float* p) { return _mm256_loadu_ps(p); }
+    static type load_aligned(const float* p) { return _mm256_load_ps(p); }
+    static void store(float* p, type x) { _mm256_storeu_ps(p, x); }
+    static void store_aligned(float* p, type x) { _mm256_store_ps(p, x); }
+    static type set1(float s) { return _mm256_set1_ps(s); }
+    static type add(type x, type y) { return _mm256_add_ps(x, y); }
+    static type sub(type x, type y) { return _mm256_sub_ps(x, y); }
+    static type mul(type x, type y) { return _mm256_mul_ps(x, y); }
+    static type div(type x, type y) { return _mm256_div_ps(x, y); }
+    static type neg(type x) {
+        return _mm256_xor_ps(x, _mm256_set1_ps(-0.f));
+    }
+};
+
+/** AVX packet of 4 doubles. */
+template<> struct Packet<double> {
+    CML_PACKET_COMMON(__m256d, double)
+    enum { size = 4, has_mul = 1, has_div = 1 };
+    static type load(const double* p) { return _mm256_loadu_pd(p); }
+    static type load_aligned(const double* p) { return _mm256_load_pd(p); }
+    static void store(double* p, type x) { _mm256_storeu_pd(p, x); }
+    static void store_aligned(double* p, type x) { _mm256_store_pd(p, x); }
+    static type set1(double s) { return _mm256_set1_pd(s); }
+    static type add(type x, type y) { return _mm256_add_pd(x, y); }
+    static type sub(type x, type y) { return _mm256_sub_pd(x, y); }
+    static type mul(type x, type y) { return _mm256_mul_pd(x, y); }
+    static type div(type x, type y) { return _mm256_div_pd(x, y); }
+    static type neg(type x) {
+        return _mm256_xor_pd(x, _mm256_set1_pd(-0.));
+    }
+};
+
+#if defined(CML_SIMD_AVX2)
+/** AVX2 packet of 8 ints. */
+template<> struct Packet<int> {
+    CML_PACKET_COMMON(__m256i, int)
+    enum { size = 8, has_mul = 1, has_div = 0 };
+    static type load(const int* p) {
+        return _mm256_loadu_si256((const __m256i*) p);
+    }
+    static type load_aligned(const int* p) {
+        return _mm256_load_si256((const __m256i*) p);
+    }
+    static void store(int* p, type x) { _mm256_storeu_si256((__m256i*) p, x); }
+    static void store_aligned(int* p, type x) {
+        _mm256_store_si256((__m256i*) p, x);
+    }
+    static type set1(int s) { return _mm256_set1_epi32(s); }
+    static type add(type x, type y) { return _mm256_add_epi32(x, y); }
+    static type sub(type x, type y) { return _mm256_sub_epi32(x, y); }
+    static type mul(type x, type y) { return _mm256_mullo_epi32(x, y); }
+    static type neg(type x) {
+        return _mm256_sub_epi32(_mm256_setzero_si256(), x);
+    }
+};
+#endif
+
+#elif defined(CML_SIMD_SSE)
+
+/** SSE packet of 4 floats. */
+template<> struct Packet<float> {
+    CML_PACKET_COMMON(__m128, float)
+    enum { size = 4, has_mul = 1, has_div = 1 };
+    static type load(const float* p) { return _mm_loadu_ps(p); }
+    static type load_aligned(const float* p) { return _mm_load_ps(p); }
+    static void store(float* p, type x) { _mm_storeu_ps(p, x); }
+    static void store_aligned(float* p, type x) { _mm_store_ps(p, x); }
+    static type set1(float s) { return _mm_set1_ps(s); }
+    static type add(type x, type y) { return _mm_add_ps(x, y); }
+    static type sub(type x, type y) { return _mm_sub_ps(x, y); }
+    static type mul(type x, type y) { return _mm_mul_ps(x, y); }
+    static type div(type x, type y) { return _mm_div_ps(x, y); }
+    static type neg(type x) { return _mm_xor_ps(x, _mm_set1_ps(-0.f)); }
+};
+
+#if defined(CML_SIMD_SSE2)
+/** SSE2 packet of 2 doubles. */
+template<> struct Packet<double> {
+    CML_PACKET_COMMON(__m128d, double)
+    enum { size = 2, has_mul = 1, has_div = 1 };
+    static type load(const double* p) { return _mm_loadu_pd(p); }
+    static type load_aligned(const double* p) { return _mm_load_pd(p); }
+    static void store(double* p, type x) { _mm_storeu_pd(p, x); }
+    static void store_aligned(double* p, type x) { _mm_store_pd(p, x); }
+    static type set1(double s) { return _mm_set1_pd(s); }
+    static type add(type x, type y) { return _mm_add_pd(x, y); }
+    static type sub(type x, type y) { return _mm_sub_pd(x, y); }
+    static type mul(type x, type y) { return _mm_mul_pd(x, y); }
+    static type div(type x, type y) { return _mm_div_pd(x, y); }
+    static type neg(type x) { return _mm_xor_pd(x, _mm_set1_pd(-0.)); }
+};
+#endif
+
+#endif
+
+#if defined(CML_SIMD_SSE2) && !defined(CML_SIMD_AVX2)
+/** SSE2 packet of 4 ints (multiplication requires SSE4.1). */
+template<> struct Packet<int> {
+    CML_PACKET_COMMON(__m128i, int)
+#if defined(CML_SIMD_SSE41)
+    enum { size = 4, has_mul = 1, has_div = 0 };
+    static type mul(type x, type y) { return _mm_mullo_epi32(x, y); }
+#else
+    enum { size = 4, has_mul = 0, has_div = 0 };
+#endif
+    static type load(const int* p) { return _mm_loadu_si128((const type*) p); }
+    static type load_aligned(const int* p) {
+        return _mm_load_si128((const type*) p);
+    }
+    static void store(int* p, type x) { _mm_storeu_si128((type*) p, x); }
+    static void store_aligned(int* p, type x) { _mm_store_si128((type*) p, x); }
+    static type set1(int s) { return _mm_set1_epi32(s); }
+    static type add(type x, type y) { return _mm_add_epi32(x, y); }
+    static type sub(type x, type y) { return _mm_sub_epi32(x, y); }
+    static type neg(type x) { return _mm_sub_epi32(_mm_setzero_si128(), x); }
+};
+#endif
+
+#undef CML_PACKET_COMMON
+
+/** Packets for matrix expressions with storage layout Layout.
+ *
+ * Matrix elements are accessed by their index in the storage order of the
+ * destination matrix, so only operands with the same layout can be loaded
+ * a packet at a time.
+ */
+template<typename E, class Layout> struct MatrixPacket : Packet<E> {
+    typedef Layout layout;
+};
+
+/** Whether the scalar operator OpT can be applied to packets of type
+ * PacketT.
+ *
+ * The operators in cml/et/scalar_ops.h specialize this, and provide a
+ * static packet_apply() member to do it.
+ */
+template<class OpT, class PacketT> struct PacketOp {
+    enum { is_true = false };
+};
+
+/** Packet access to the expression ExprT, evaluated with packet type
+ * PacketT.
+ *
+ * This is the general case, for expressions that are only evaluated one
+ * element at a time.  The specializations set is_true, and provide:
+ *
+ *   static typename PacketT::type load(const ExprT& e, size_t i);
+ *
+ * which returns elements i through i+PacketT::size-1 of e.  This is only
+ * true if every element of the expression has the type of the packet.  i is
+ * always a multiple of PacketT::size, so arrays aligned to at least
+ * sizeof(PacketT::type) bytes can be loaded with aligned loads (see
+ * PacketLoad<> below).
+ */
+template<class ExprT, class PacketT,
+    class ResultTag = typename ExprTraits<ExprT>::result_tag>
+struct PacketAccess {
+    enum { is_true = false };
+};
+
+/** Load packet i of an array aligned to Alignment bytes, with an aligned
+ * load if possible.
+ */
+template<class PacketT, int Alignment,
+    bool Aligned = (Alignment % sizeof(typename PacketT::type) == 0)>
+struct PacketLoad {
+    typedef typename PacketT::value_type value_type;
+    typedef typename PacketT::type type;
+    static type load(const value_type* p) { return PacketT::load(p); }
+    static void store(value_type* p, type x) { PacketT::store(p, x); }
+};
+
+template<class PacketT, int Alignment>
+struct PacketLoad<PacketT,Alignment,true> {
+    typedef typename PacketT::value_type value_type;
+    typedef typename PacketT::type type;
+    static type load(const value_type* p) { return PacketT::load_aligned(p); }
+    static void store(value_type* p, type x) { PacketT::store_aligned(p, x); }
+};
+
+/** Scalars are broadcast to every element of a packet. */
+template<class ScalarT, class PacketT>
+struct PacketAccess<ScalarT,PacketT,scalar_result_tag>
+{
+    typedef typename PacketT::value_type value_type;
+    enum { is_true = (PacketT::size > 1) };
+    static typename PacketT::type load(const ScalarT& s, size_t) {
+        return PacketT::set1(value_type(s));
+    }
+};
+
+} // namespace et
+} // namespace cml
+
+#endif
+
+// -------------------------------------------------------------------------
+// vim:ft=cpp
@@ -0,0 +1,179 @@
+/* -*- C++ -*- ------------------------------------------------------------
+ 
+Copyright (c) 2007 Jesse Anders and Demian Nave http://cmldev.net/
+
+The Configurable Math Library (CML) is distributed under the terms of the
+Boost Software License, v1.0 (see cml/LICENSE for details).
+
+ *-----------------------------------------------------------------------*/
+/** @file
+ *  @brief Summation of long sequences of terms, for dot() and trace().
+ *
+ * A serial sum is limited by the latency of each addition, since every add
+ * depends on the one before it.  ReduceSum<> instead keeps four independent
+ * accumulators, each a SIMD packet if the terms can be computed a packet at
+ * a time (see cml/et/packet.h), and adds them together at the end.
+ *
+ * The summation order can be selected at compile time:
+ *
+ * - By default, the multiple accumulators are summed as described above.
+ * - If CML_PAIRWISE_REDUCTION is defined, the terms are split in half
+ *   recursively down to blocks of CML_PAIRWISE_REDUCTION_BLOCK terms, which
+ *   are summed with multiple accumulators.  The error grows with log(N)
+ *   instead of N, at little extra cost.
+ * - If CML_KAHAN_REDUCTION is defined, compensated (Kahan) summation is
+ *   used, with one compensation term per accumulator.  This is the most
+ *   accurate, and about half as fast.
+ *
+ * @note Compensated summation is defeated by compiler options that allow
+ * reassociation of floating point arithmetic, like -ffast-math.
+ */
+
+#ifndef et_reduce_h
+#define et_reduce_h
+
+#include <cml/core/common.h>
+#include <cml/et/packet.h>
+
+namespace cml {
+namespace et {
+namespace detail {
+
+/** Sum terms with several independent accumulators.
+ *
+ * TermsT provides the type of the terms and of the sum as value_type,
+ * use_packets, and operator()(i), which returns term i.  If use_packets is
+ * true, it must also provide packet_type (a Packet<value_type>) and
+ * packet(i), which returns terms i through i+packet_type::size-1.
+ *
+ * This is the scalar version.
+ */
+template<class TermsT, bool UsePackets = TermsT::use_packets>
+struct ReduceSum
+{
+    typedef typename TermsT::value_type value_type;
+
+    /** Return the sum of terms [i0,i1). */
+    static value_type sum(const TermsT& t, size_t i0, size_t i1) {
+        value_type s0(0), s1(0), s2(0), s3(0);
+        size_t i = i0;
+        for(; i + 4 <= i1; i += 4) {
+            s0 += t(i); s1 += t(i+1); s2 += t(i+2); s3 += t(i+3);
+        }
+        for(; i < i1; ++i) s0 += t(i);
+        return (s0 + s1) + (s2 + s3);
+    }
+
+    /** Return the sum of terms [i0,i1), with compensated summation. */
+    static value_type kahan(const TermsT& t, size_t i0, size_t i1) {
+        value_type s(0), c(0);
+        for(size_t i = i0; i < i1; ++i) {
+            value_type y = t(i) - c;
+            value_type u = s + y;
+            c = (u - s) - y;
+            s = u;
+        }
+        return s;
+    }
+};
+
+/** Sum terms with several independent packet accumulators. */
+template<class TermsT>
+struct ReduceSum<TermsT,true>
+{
+    typedef typename TermsT::value_type value_type;
+    typedef typename TermsT::packet_type packet;
+    typedef typename packet::type packet_type;
+    typedef ReduceSum<TermsT,false> scalar_sum;
+
+    enum { P = packet::size };
+
+    /** Return the sum of the elements of a packet. */
+    static value_type hsum(packet_type x) {
+        value_type e[P];
+        packet::store(e, x);
+        value_type s(0);
+        for(int k = 0; k < P; ++ k) s += e[k];
+        return s;
+    }
+
+    /** Return the sum of terms [i0,i1). */
+    static value_type sum(const TermsT& t, size_t i0, size_t i1) {
+        if(i1 - i0 < size_t(P)) return scalar_sum::sum(t,i0,i1);
+        packet_type z = packet::set1(value_type(0));
+        packet_type s0 = z, s1 = z, s2 = z, s3 = z;
+        size_t i = i0;
+        for(; i + 4*P <= i1; i += 4*P) {
+            s0 = packet::add(s0, t.packet(i));
+            s1 = packet::add(s1, t.packet(i+P));
+            s2 = packet::add(s2, t.packet(i+2*P));
+            s3 = packet::add(s3, t.packet(i+3*P));
+        }
+        for(; i + P <= i1; i += P) s0 = packet::add(s0, t.packet(i));
+        s0 = packet::add(packet::add(s0,s1), packet::add(s2,s3));
+        return hsum(s0) + scalar_sum::sum(t,i,i1);
+    }
+
+    /** Return the sum of terms [i0,i1), with compensated summation in each
+     * packet element.
+     */
+    static value_type kahan(const TermsT& t, size_t i0, size_t i1) {
+        if(i1 - i0 < size_t(P)) return scalar_sum::kahan(t,i0,i1);
+        packet_type s = packet::set1(value_type(0)), c = s;
+        size_t i = i0;
+        for(; i + P <= i1; i += P) {
+            packet_type y = packet::sub(t.packet(i), c);
+            packet_type u = packet::add(s, y);
+            c = packet::sub(packet::sub(u, s), y);
+            s = u;
+        }
+
+        /* Combine the elements, and the remaining terms: */
+        value_type se[P], ce[P];
+        packet::store(se, s);
+        packet::store(ce, c);
+        value_type r = scalar_sum::kahan(t,i,i1), rc(0);
+        for(int k = 0; k < P; ++ k) {
+            value_type y = (se[k] - ce[k]) - rc;
+            value_type u = r + y;
+            rc = (u - r) - y;
+            r = u;
+        }
+        return r;
+    }
+};
+
+/** Return the sum of terms [i0,i1), split in half recursively. */
+template<class TermsT> inline typename TermsT::value_type
+ReducePairwise(const TermsT& t, size_t i0, size_t i1)
+{
+    const size_t N = i1 - i0;
+    if(N <= size_t(CML_PAIRWISE_REDUCTION_BLOCK))
+        return ReduceSum<TermsT>::sum(t,i0,i1);
+
+    /* Split on a multiple of 16, to keep whole packets together: */
+    size_t half = (N/2) & ~size_t(15);
+    return ReducePairwise(t,i0,i0+half) + ReducePairwise(t,i0+half,i1);
+}
+
+/** Return the sum of terms [0,N), using the configured summation order. */
+template<class TermsT> inline typename TermsT::value_type
+ReduceTerms(const TermsT& t, size_t N)
+{
+#if defined(CML_KAHAN_REDUCTION)
+    return ReduceSum<TermsT>::kahan(t,0,N);
+#elif defined(CML_PAIRWISE_REDUCTION)
+    return ReducePairwise(t,0,N);
+#else
+    return ReduceSum<TermsT>::sum(t,0,N);
+#endif
+}
+
+} // namespace detail
+} // namespace et
+} // namespace cml
+
+#endif
+
+// -------------------------------------------------------------------------
+// vim:ft=cpp
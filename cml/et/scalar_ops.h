@@ -15,19 +15,35 @@ Boost Software License, v1.0 (see cml/LICENSE for details).
 
 #include <cml/et/traits.h>
 #include <cml/et/scalar_promotions.h>
+#include <cml/et/packet.h>
 
-/** Declare a unary scalar operator, like negation. */
-#define CML_UNARY_SCALAR_OP(_op_, _op_name_)                            \
+/** Declare a unary scalar operator, like negation.
+ *
+ * _pkt_ names the equivalent operation on SIMD packets (see
+ * cml/et/packet.h).
+ */
+#define CML_UNARY_SCALAR_OP(_op_, _op_name_, _pkt_)                     \
 template<typename ArgT> struct _op_name_ {                              \
     typedef ExprTraits<ArgT> arg_traits;                                \
     typedef typename arg_traits::const_reference arg_reference;         \
     typedef typename arg_traits::value_type value_type;                 \
     typedef scalar_result_tag result_tag;                               \
     value_type apply(arg_reference arg) const { return _op_ arg; }      \
+    template<class PacketT> static typename PacketT::type               \
+    packet_apply(typename PacketT::type arg) {                          \
+        return PacketT::_pkt_(arg); }                                   \
+};                                                                      \
+template<typename ArgT, class PacketT>                                  \
+struct PacketOp< _op_name_ <ArgT>, PacketT > {                          \
+    enum { is_true = PacketT::has_##_pkt_ };                            \
 };
 
-/** Declare a binary scalar operator, like addition, s1+s2. */
-#define CML_BINARY_SCALAR_OP(_op_, _op_name_)                            \
+/** Declare a binary scalar operator, like addition, s1+s2.
+ *
+ * _pkt_ names the equivalent operation on SIMD packets (see
+ * cml/et/packet.h).
+ */
+#define CML_BINARY_SCALAR_OP(_op_, _op_name_, _pkt_)                     \
 template<typename LeftT, typename RightT> struct _op_name_ {             \
     typedef ExprTraits<LeftT> left_traits;                               \
     typedef ExprTraits<RightT> right_traits;                             \
@@ -39,15 +55,24 @@ template<typename LeftT, typename RightT> struct _op_name_ {             \
     typedef scalar_result_tag result_tag;                               \
     value_type apply(left_reference left, right_reference right) const { \
         return left _op_ right; }                                        \
+    template<class PacketT> static typename PacketT::type                \
+    packet_apply(typename PacketT::type left, typename PacketT::type right) \
+    { return PacketT::_pkt_(left, right); }                              \
+};                                                                       \
+template<typename LeftT, typename RightT, class PacketT>                 \
+struct PacketOp< _op_name_ <LeftT,RightT>, PacketT > {                   \
+    enum { is_true = PacketT::has_##_pkt_ };                             \
 };
 
 /** Declare an op-assignment operator.
  *
  * @note The ExprTraits for both argument types must be defined, LeftT must
  * have an assignment operator, and ExprTraits<LeftT>::reference must specify
- * a type that allows assignment.
+ * a type that allows assignment.  _pkt_ names the operation combining a
+ * packet of LeftT elements with a packet of RightT elements, the result of
+ * which is stored back.
  */
-#define CML_BINARY_SCALAR_OP_ASSIGN(_op_, _op_name_)                     \
+#define CML_BINARY_SCALAR_OP_ASSIGN(_op_, _op_name_, _pkt_)              \
 template<typename LeftT, typename RightT> struct _op_name_ {             \
     typedef ExprTraits<LeftT> left_traits;                               \
     typedef ExprTraits<RightT> right_traits;                             \
@@ -59,6 +84,13 @@ template<typename LeftT, typename RightT> struct _op_name_ {             \
     typedef scalar_result_tag result_tag;                                \
     value_type apply(left_reference left, right_reference right) const { \
         return left _op_ (LeftT) right; }                                \
+    template<class PacketT> static typename PacketT::type                \
+    packet_apply(typename PacketT::type left, typename PacketT::type right) \
+    { return PacketT::_pkt_(left, right); }                              \
+};                                                                       \
+template<typename LeftT, typename RightT, class PacketT>                 \
+struct PacketOp< _op_name_ <LeftT,RightT>, PacketT > {                   \
+    enum { is_true = PacketT::has_##_pkt_ };                             \
 };
 
 /** Declare a binary boolean operator, like less-than, s1 < s2.
@@ -84,36 +116,36 @@ namespace et {
 /* Define the operators: */
 
 /* Unary scalar ops: */
-CML_UNARY_SCALAR_OP(-, OpNeg)
-CML_UNARY_SCALAR_OP(+, OpPos)
+CML_UNARY_SCALAR_OP(-, OpNeg, neg)
+CML_UNARY_SCALAR_OP(+, OpPos, pos)
 
 /* Binary scalar ops: */
-CML_BINARY_SCALAR_OP(+, OpAdd)
-CML_BINARY_SCALAR_OP(-, OpSub)
-CML_BINARY_SCALAR_OP(*, OpMul)
+CML_BINARY_SCALAR_OP(+, OpAdd, add)
+CML_BINARY_SCALAR_OP(-, OpSub, sub)
+CML_BINARY_SCALAR_OP(*, OpMul, mul)
 
 #if defined(CML_RECIPROCAL_OPTIMIZATION)
 /* XXX Yikes... this should really be written out in full. *= 1./ is the
  * "_op_" parameter to the macro (see above):
  */
-CML_BINARY_SCALAR_OP(* value_type(1)/, OpDiv)
+CML_BINARY_SCALAR_OP(* value_type(1)/, OpDiv, div)
 #else
-CML_BINARY_SCALAR_OP(/, OpDiv)
+CML_BINARY_SCALAR_OP(/, OpDiv, div)
 #endif
 
 /* Binary scalar op-assigns: */
-CML_BINARY_SCALAR_OP_ASSIGN( =, OpAssign)
-CML_BINARY_SCALAR_OP_ASSIGN(+=, OpAddAssign)
-CML_BINARY_SCALAR_OP_ASSIGN(-=, OpSubAssign)
-CML_BINARY_SCALAR_OP_ASSIGN(*=, OpMulAssign)
+CML_BINARY_SCALAR_OP_ASSIGN( =, OpAssign, assign)
+CML_BINARY_SCALAR_OP_ASSIGN(+=, OpAddAssign, add)
+CML_BINARY_SCALAR_OP_ASSIGN(-=, OpSubAssign, sub)
+CML_BINARY_SCALAR_OP_ASSIGN(*=, OpMulAssign, mul)
 
 #if defined(CML_RECIPROCAL_OPTIMIZATION)
 /* XXX Yikes... this should really be written out in full. *= 1./ is the
  * "_op_" parameter to the macro (see above):
  */
-CML_BINARY_SCALAR_OP_ASSIGN(*= value_type(1)/, OpDivAssign)
+CML_BINARY_SCALAR_OP_ASSIGN(*= value_type(1)/, OpDivAssign, div)
 #else
-CML_BINARY_SCALAR_OP_ASSIGN(/=, OpDivAssign)
+CML_BINARY_SCALAR_OP_ASSIGN(/=, OpDivAssign, div)
 #endif
 
 /* Boolean operators for scalars: */
@@ -22,16 +22,21 @@ namespace cml {
  * class of a vector or matrix.  The rebind<> template is used by
  * quaternion<> to select its vector length in a generic way.
  *
+ * Align is the alignment of the array in bytes (a power of two), or 0 for
+ * the natural alignment of the element type.  For example, a 16-byte
+ * aligned 4-vector is vector< float, fixed<4,-1,16> >.
+ *
+ * @sa cml/core/alignment.h
  * @sa dynamic
  * @sa external
  */
-template<int Dim1 = -1, int Dim2 = -1> struct fixed {
+template<int Dim1 = -1, int Dim2 = -1, int Align = 0> struct fixed {
 
     /** Rebind to a 1D type.
      *
      * This is used by quaternion<>.
      */
-    template<int D> struct rebind { typedef fixed<D> other; };
+    template<int D> struct rebind { typedef fixed<D,-1,Align> other; };
 };
 
 } // namespace cml
@@ -0,0 +1,48 @@
+/* -*- C++ -*- ------------------------------------------------------------
+ 
+Copyright (c) 2007 Jesse Anders and Demian Nave http://cmldev.net/
+
+The Configurable Math Library (CML) is distributed under the terms of the
+Boost Software License, v1.0 (see cml/LICENSE for details).
+
+ *-----------------------------------------------------------------------*/
+/** @file
+ *  @brief
+ */
+
+#ifndef hybrid_h
+#define hybrid_h
+
+namespace cml {
+
+/** This is a selector for hybrid 1D and 2D arrays.
+ *
+ * A hybrid array has a size chosen at run time, like a dynamic<> array, but
+ * keeps its elements inline, like a fixed<> array, so that constructing one
+ * never allocates.  Dim1 and Dim2 are the largest numbers of elements (1D)
+ * or rows and columns (2D) that the array can hold.  For example, a vector
+ * of up to 8 elements is vector< double, hybrid<8> >, and a matrix of up to
+ * 4x4 elements is matrix< double, hybrid<4,4> >.  Resizing an array beyond
+ * its capacity throws std::invalid_argument.
+ *
+ * Align is the alignment of the array in bytes, as for fixed<>.
+ *
+ * @sa fixed
+ * @sa dynamic
+ * @sa external
+ */
+template<int Dim1 = -1, int Dim2 = -1, int Align = 0> struct hybrid {
+
+    /** Rebind to a 1D type.
+     *
+     * This is used by quaternion<>.
+     */
+    template<int D> struct rebind { typedef hybrid<D,-1,Align> other; };
+};
+
+} // namespace cml
+
+#endif
+
+// -------------------------------------------------------------------------
+// vim:ft=cpp
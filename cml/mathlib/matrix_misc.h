@@ -14,6 +14,7 @@ Boost Software License, v1.0 (see cml/LICENSE for details).
 #define matrix_misc_h
 
 #include <cml/mathlib/checking.h>
+#include <cml/et/reduce.h>
 
 /* Miscellaneous matrix functions. */
 
@@ -33,20 +34,30 @@ identity_transform(matrix<E,A,B,L>& m)
     }
 }
 
+namespace detail {
+
+/** The diagonal elements of a matrix, for et::detail::ReduceSum<> */
+template < class MatT > struct DiagonalTerms
+{
+    typedef typename MatT::value_type value_type;
+    enum { use_packets = false };
+
+    DiagonalTerms(const MatT& m) : m_m(m) {}
+    value_type operator()(size_t i) const { return m_m(i,i); }
+
+    const MatT& m_m;
+};
+
+} // namespace detail
+
 /** Trace of a square matrix */
 template < class MatT > typename MatT::value_type
 trace(const MatT& m)
 {
-    typedef typename MatT::value_type value_type;
-    
     /* Checking */
     detail::CheckMatSquare(m);
 
-    value_type t = value_type(0);
-    for (size_t i = 0; i < m.rows(); ++i) {
-        t += m(i,i);
-    }
-    return t;
+    return et::detail::ReduceTerms(detail::DiagonalTerms<MatT>(m), m.rows());
 }
 
 /** Trace of the upper-left 3x3 part of a matrix */
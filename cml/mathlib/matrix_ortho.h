@@ -24,6 +24,10 @@ Boost Software License, v1.0 (see cml/LICENSE for details).
  * Note: These functions pass off to the orthonormalization functions in
  * vector_ortho.h, so see that file for details on the optional parameters.
  *
+ * matrix_orthogonalize_3x3_polar() instead replaces the upper-left 3x3
+ * part with the rotation nearest to it, from its polar decomposition.  The
+ * result does not depend on the order of the basis vectors.
+ *
  * @todo: General NxN matrix orthogonalization.
  */
 
@@ -42,6 +46,30 @@ matrix_orthogonalize_3x3(matrix<E,A,B,L>& m, size_t stable_axis = 2,
     matrix_set_basis_vectors(m,x,y,z);
 }
 
+/** Replace the upper-left 3x3 portion of a matrix with the nearest rotation
+ *
+ * @returns false if the polar decomposition did not converge.
+ */
+template < typename E, class A, class B, class L > bool
+matrix_orthogonalize_3x3_polar(matrix<E,A,B,L>& m)
+{
+    typedef matrix< E, fixed<3,3> > linear_type;
+
+    linear_type linear, R, S;
+    for(size_t i = 0; i < 3; ++i) {
+        for(size_t j = 0; j < 3; ++j) {
+            linear(j,i) = m.basis_element(i,j);
+        }
+    }
+    bool converged = polar_decompose(linear, R, S);
+    for(size_t i = 0; i < 3; ++i) {
+        for(size_t j = 0; j < 3; ++j) {
+            m.set_basis_element(i,j,R(j,i));
+        }
+    }
+    return converged;
+}
+
 /** Orthogonalize the upper-left 2x2 portion of a matrix */
 template < typename E, class A, class B, class L > void
 matrix_orthogonalize_2x2(matrix<E,A,B,L>& m, size_t stable_axis = 0,
@@ -606,6 +606,67 @@ matrix_look_at_RH(matrix<E,A,B,L>& m, E eye_x, E eye_y, E eye_z,
         up_z,right_handed);
 }
 
+namespace detail {
+
+/** Copy the NxN linear transform part of a matrix into m, element by
+ * element
+ */
+template < int N, typename E, class A, class B, class L, class MatT > void
+CopyLinearElements(matrix<E,A,B,L>& m, const MatT& linear)
+{
+    for(size_t i = 0; i < N; ++i) {
+        for(size_t j = 0; j < N; ++j) {
+            m.set_basis_element(i,j,linear.basis_element(i,j));
+        }
+    }
+}
+
+/** Copy the NxN linear transform part of a matrix into m */
+template < int N, typename E, class A, class B, class L, class MatT > void
+CopyLinearPart(matrix<E,A,B,L>& m, const MatT& linear)
+{
+    CopyLinearElements<N>(m,linear);
+}
+
+/** Copy the NxN linear transform part of a dense matrix with the same
+ * basis orientation into dense m, as a block assignment with no temporary
+ */
+template < int N, typename E, class A, class B, class L,
+    typename E2, class A2, class L2 > void
+CopyLinearPart(matrix<E,A,B,L>& m, const matrix<E2,A2,B,L2>& linear,
+    true_type)
+{
+    submatrix<N,N>(m,0,0) = submatrix<N,N>(linear,0,0);
+}
+
+/** Packed and banded matrices have no blocks, so they are copied element
+ * by element
+ */
+template < int N, typename E, class A, class B, class L,
+    typename E2, class A2, class L2 > void
+CopyLinearPart(matrix<E,A,B,L>& m, const matrix<E2,A2,B,L2>& linear,
+    false_type)
+{
+    CopyLinearElements<N>(m,linear);
+}
+
+/** Copy the NxN linear transform part of a matrix with the same basis
+ * orientation into m
+ */
+template < int N, typename E, class A, class B, class L,
+    typename E2, class A2, class L2 > void
+CopyLinearPart(matrix<E,A,B,L>& m, const matrix<E2,A2,B,L2>& linear)
+{
+    typedef typename is_true<
+        same_type<typename matrix_structure<A>::type,
+            general_tag>::is_true &&
+        same_type<typename matrix_structure<A2>::type,
+            general_tag>::is_true>::result dense;
+    CopyLinearPart<N>(m,linear,dense());
+}
+
+} // namespace detail
+
 //////////////////////////////////////////////////////////////////////////////
 // 3D linear transform
 //////////////////////////////////////////////////////////////////////////////
@@ -619,12 +680,7 @@ matrix_linear_transform(matrix<E,A,B,L>& m, const MatT& linear)
     detail::CheckMatLinear3D(linear);
     
     identity_transform(m);
-    
-    for(size_t i = 0; i < 3; ++i) {
-        for(size_t j = 0; j < 3; ++j) {
-            m.set_basis_element(i,j,linear.basis_element(i,j));
-        }
-    }
+    detail::CopyLinearPart<3>(m,linear);
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -640,12 +696,7 @@ matrix_linear_transform_2D(matrix<E,A,B,L>& m, const MatT& linear)
     detail::CheckMatLinear2D(linear);
     
     identity_transform(m);
-    
-    for(size_t i = 0; i < 2; ++i) {
-        for(size_t j = 0; j < 2; ++j) {
-            m.set_basis_element(i,j,linear.basis_element(i,j));
-        }
-    }
+    detail::CopyLinearPart<2>(m,linear);
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -822,26 +873,36 @@ void matrix_decompose_SRT(
     matrix<ME,MA,B,L>& rotation,
     vector<VE,VA>& translation)
 {
-    typedef MatT matrix_type;
-    typedef typename matrix_type::value_type value_type;
-    typedef vector<value_type, fixed<3> > vector_type;
+    typedef matrix<ME,MA,B,L> rotation_type;
+    typedef typename rotation_type::value_type value_type;
 
     /* Checking */
     detail::CheckMatAffine3D(m);
     detail::CheckMatLinear3D(rotation);
     
-    vector_type x, y, z;
-    matrix_get_basis_vectors(m, x, y, z);
-    
-    scale_x = x.length();
-    scale_y = y.length();
-    scale_z = z.length();
+    /* Factor the linear part, with the basis vectors as columns, into a
+     * rotation and a symmetric stretch, and take the scales from the
+     * diagonal of the stretch.  Unlike normalizing the basis vectors, this
+     * does not depend on their order, and gives the rotation nearest to a
+     * skewed transform:
+     */
+    typedef matrix< value_type, fixed<3,3> > linear_type;
+    linear_type linear, R, S;
+    for(size_t i = 0; i < 3; ++i) {
+        for(size_t j = 0; j < 3; ++j) {
+            linear(j,i) = m.basis_element(i,j);
+        }
+    }
+    polar_decompose(linear, R, S);
     
-    x /= scale_x;
-    y /= scale_y;
-    z /= scale_z;
+    Real* scale[3] = { &scale_x, &scale_y, &scale_z };
+    for(size_t i = 0; i < 3; ++i) {
+        *scale[i] = S(i,i);
+        for(size_t j = 0; j < 3; ++j) {
+            rotation.set_basis_element(i,j,R(j,i));
+        }
+    }
     
-    matrix_set_basis_vectors(rotation, x, y, z);
     translation = matrix_get_translation(m);
 }
 
@@ -33,7 +33,7 @@ project_to_hplane(const VecT_1& v, const VecT_2& n)
         result_type;
         
     result_type result;
-    et::detail::Resize(result, v.size());
+    et::detail::ResizeUninitialized(result, v.size());
 
     result = v - dot(v,n) * n;
     return result;
@@ -49,13 +49,26 @@ template<typename Element, class ArrayType,
 #include <cml/matrix/matrix_functions.h>
 #include <cml/matrix/matrix_comparison.h>
 #include <cml/matrix/lu.h>
+#include <cml/matrix/triangular_solve.h>
+#include <cml/matrix/tridiagonal_solve.h>
 #include <cml/matrix/inverse.h>
 #include <cml/matrix/determinant.h>
 #include <cml/matrix/matrix_print.h>
 
 #include <cml/matrix/fixed.h>
 #include <cml/matrix/dynamic.h>
+#include <cml/matrix/hybrid.h>
 #include <cml/matrix/external.h>
+#include <cml/matrix/strided.h>
+#include <cml/matrix/packed.h>
+#include <cml/matrix/banded.h>
+#include <cml/matrix/matrix_block.h>
+#include <cml/matrix/lu_pivot.h>
+#include <cml/matrix/cholesky.h>
+#include <cml/matrix/qr.h>
+#include <cml/matrix/eigen_symmetric.h>
+#include <cml/matrix/svd.h>
+#include <cml/matrix/batch.h>
 
 #endif
 
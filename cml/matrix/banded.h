@@ -0,0 +1,257 @@
+/* -*- C++ -*- ------------------------------------------------------------
+ 
+Copyright (c) 2007 Jesse Anders and Demian Nave http://cmldev.net/
+
+The Configurable Math Library (CML) is distributed under the terms of the
+Boost Software License, v1.0 (see cml/LICENSE for details).
+
+ *-----------------------------------------------------------------------*/
+/** @file
+ *  @brief
+ */
+
+#ifndef banded_matrix_h
+#define banded_matrix_h
+
+#include <cml/core/banded_2D.h>
+#include <cml/matrix/matrix_expr.h>
+#include <cml/matrix/class_ops.h>
+#include <cml/matrix/matrix_unroller.h>
+#include <cml/matrix/dynamic.h>
+
+namespace cml {
+
+/** Resizeable, dynamic-memory banded matrix.
+ *
+ * The matrix is square, and only the elements inside the band are stored
+ * and assigned; see cml::banded_2D.  Products and mat-vec products skip the
+ * elements outside the band.  lu() returns a banded matrix in
+ * O(N*Lower*Upper) operations, and lu_solve() takes O(N*(Lower+Upper)).
+ *
+ * The temporaries of expressions on banded matrices are general dynamic
+ * matrices.
+ *
+ * @sa cml::tridiagonal_solve
+ */
+template<typename Element, int Lower, int Upper, class Alloc,
+    typename BasisOrient, typename Layout>
+class matrix<Element,banded<Lower,Upper,Alloc>,BasisOrient,Layout>
+: public banded_2D<Element,banded<Lower,Upper,Alloc>,Layout>
+{
+  public:
+
+    /* Shorthand for the generator: */
+    typedef banded<Lower,Upper,Alloc> generator_type;
+
+    /* Shorthand for the array type: */
+    typedef banded_2D<Element,generator_type,Layout> array_type;
+
+    /* Shorthand for the type of this matrix: */
+    typedef matrix<Element,generator_type,BasisOrient,Layout> matrix_type;
+
+    /* For integration into the expression template code: */
+    typedef matrix_type expr_type;
+
+    /* For integration into the expression template code: */
+    typedef matrix<Element,dynamic<Alloc>,BasisOrient,Layout> temporary_type;
+
+    /* Standard: */
+    typedef typename array_type::value_type value_type;
+    typedef typename array_type::reference reference;
+    typedef typename array_type::const_reference const_reference;
+
+    /* For integration into the expression templates code: */
+    typedef matrix_type& expr_reference;
+    typedef const matrix_type& expr_const_reference;
+
+    /* For matching by basis: */
+    typedef BasisOrient basis_orient;
+
+    /* For matching by memory layout: */
+    typedef typename array_type::layout layout;
+
+    /* For matching by storage type: */
+    typedef typename array_type::memory_tag memory_tag;
+
+    /* For matching by size type if necessary: */
+    typedef typename array_type::size_tag size_tag;
+
+    /* For matching by resizability: */
+    typedef typename array_type::resizing_tag resizing_tag;
+
+    /* For matching by result type: */
+    typedef cml::et::matrix_result_tag result_tag;
+
+    /* For matching by assignability: */
+    typedef cml::et::assignable_tag assignable_tag;
+
+    /* For matching by structure: */
+    typedef typename array_type::structure_tag structure_tag;
+
+    /* To simplify the matrix transpose operator: */
+    typedef matrix<
+        Element,
+        typename array_type::transposed_type::generator_type,
+        BasisOrient,
+        Layout
+    > transposed_type;
+
+    /* To simplify the matrix row and column operators: */
+    typedef vector<
+        Element,
+        typename array_type::row_array_type::generator_type
+    > row_vector_type;
+
+    typedef vector<
+        Element,
+        typename array_type::col_array_type::generator_type
+    > col_vector_type;
+
+
+  public:
+
+    /** Set this matrix to zero. */
+    matrix_type& zero() {
+        typedef cml::et::OpAssign<Element,Element> OpT;
+        cml::et::UnrollAssignment<OpT>(*this,Element(0));
+        return *this;
+    }
+
+    /** Set this matrix to the identity. */
+    matrix_type& identity() {
+        for(size_t i = 0; i < this->rows(); ++ i) {
+            for(size_t j = 0; j < this->cols(); ++ j) {
+                (*this)(i,j) = value_type((i == j)?1:0);
+            }
+        }
+        return *this;
+    }
+
+    /* Set each element to a random number in the range [min,max] */
+    void random(ELEMENT_ARG_TYPE min, ELEMENT_ARG_TYPE max) {
+      for(size_t i = 0; i < this->rows(); ++i) {
+        for(size_t j = 0; j < this->cols(); ++j) {
+          (*this)(i,j) = cml::random_real(min,max);
+        }
+      }
+    }
+
+
+  public:
+
+    /** Default constructor. */
+    matrix() {}
+
+    /** Constructor for dynamically-sized arrays.
+     *
+     * @param rows specify the number of rows.
+     * @param cols specify the number of cols.
+     *
+     * @throws std::invalid_argument if rows != cols.
+     */
+    explicit matrix(size_t rows, size_t cols)
+        : array_type(rows,cols) {}
+
+    /** Copy constructor, copying only the band. */
+    matrix(const matrix_type& m) : array_type(m) {}
+
+#if defined(CML_HAS_RVALUE_REFERENCES)
+    /** Move constructor, taking the array of m. */
+    matrix(matrix_type&& m) : array_type(std::move(m)) {}
+
+    /** Move assignment, taking the array of m if m has an equal allocator
+     * (e.g. the same temp_arena).  Otherwise, m is copied as usual.
+     */
+    matrix_type& operator=(matrix_type&& m) {
+        if(this->get_allocator() == m.get_allocator()) this->swap(m);
+        else this->copy(m);
+        return *this;
+    }
+#endif
+
+
+  public:
+
+    /** Return the matrix size as a pair. */
+    matrix_size size() const {
+        return matrix_size(this->rows(),this->cols());
+    }
+
+    /** Return element j of basis vector i. */
+    value_type basis_element(size_t i, size_t j) const {
+        return basis_element(i,j,basis_orient());
+    }
+
+    /** Set the given basis element. */
+    void set_basis_element(size_t i, size_t j, ELEMENT_ARG_TYPE s) {
+        set_basis_element(i,j,s,basis_orient());
+    }
+
+
+  public:
+
+    /* Define common class operators: */
+
+    CML_CONSTRUCT_MAT_22
+    CML_CONSTRUCT_MAT_33
+    CML_CONSTRUCT_MAT_44
+
+    CML_MAT_COPY_FROM_ARRAY(: array_type())
+    CML_MAT_COPY_FROM_MAT
+    CML_MAT_COPY_FROM_MATXPR
+
+    CML_ASSIGN_MAT_22
+    CML_ASSIGN_MAT_33
+    CML_ASSIGN_MAT_44
+
+    /** Copy assignment, copying only the band. */
+    matrix_type& operator=(const matrix_type& m) {
+        this->copy(m);
+        return *this;
+    }
+
+    CML_MAT_ASSIGN_FROM_MAT(=, et::OpAssign)
+    CML_MAT_ASSIGN_FROM_MAT(+=, et::OpAddAssign)
+    CML_MAT_ASSIGN_FROM_MAT(-=, et::OpSubAssign)
+
+    CML_MAT_ASSIGN_FROM_MATXPR(=, et::OpAssign)
+    CML_MAT_ASSIGN_FROM_MATXPR(+=, et::OpAddAssign)
+    CML_MAT_ASSIGN_FROM_MATXPR(-=, et::OpSubAssign)
+
+    CML_MAT_ASSIGN_FROM_SCALAR(*=, et::OpMulAssign)
+    CML_MAT_ASSIGN_FROM_SCALAR(/=, et::OpDivAssign)
+
+
+  protected:
+
+    value_type basis_element(size_t i, size_t j, row_basis) const {
+        return (*this)(i,j);
+    }
+
+    value_type basis_element(size_t i, size_t j, col_basis) const {
+        return (*this)(j,i);
+    }
+
+    void set_basis_element(size_t i, size_t j, ELEMENT_ARG_TYPE s, row_basis) {
+        (*this)(i,j) = s;
+    }
+
+    void set_basis_element(size_t i, size_t j, ELEMENT_ARG_TYPE s, col_basis) {
+        (*this)(j,i) = s;
+    }
+
+
+  public:
+
+    /* Braces should only be used for testing: */
+#if defined(CML_ENABLE_MATRIX_BRACES)
+    CML_MATRIX_BRACE_OPERATORS
+#endif
+};
+
+} // namespace cml
+
+#endif
+
+// -------------------------------------------------------------------------
+// vim:ft=cpp
@@ -0,0 +1,248 @@
+/* -*- C++ -*- ------------------------------------------------------------
+ 
+Copyright (c) 2007 Jesse Anders and Demian Nave http://cmldev.net/
+
+The Configurable Math Library (CML) is distributed under the terms of the
+Boost Software License, v1.0 (see cml/LICENSE for details).
+
+ *-----------------------------------------------------------------------*/
+/** @file
+ *  @brief Inverses and determinants of arrays of 3x3 and 4x4 matrices.
+ *
+ * inverse_batch() and determinant_batch() process an array of fixed-size
+ * 3x3 or 4x4 matrices in one call:
+ *
+ *   std::vector<matrix44f> models(n), inverses(n);
+ *   std::vector<float> dets(n);
+ *   inverse_batch(&models[0], &inverses[0], n);
+ *   determinant_batch(&models[0], &dets[0], n);
+ *
+ * The matrices are taken et::Packet<E>::size at a time (e.g. 8 floats or 4
+ * doubles with AVX), and transposed so that each packet holds the same
+ * element of each matrix.  The cofactor expressions of inverse() and
+ * determinant() are then evaluated on the packets, one matrix per lane.
+ * The matrices left over at the end are done one at a time, with the same
+ * expressions.
+ *
+ * Each lane performs the same IEEE operations in the same order as the
+ * scalar code.  Compiled in strict mode, i.e. with floating-point
+ * contraction disabled (-ffp-contract=off with GCC and Clang, /fp:strict
+ * with MSVC), the results are therefore bitwise identical to inverse() and
+ * determinant() of each matrix.  Otherwise, the compiler may fuse
+ * multiplies and adds differently in the two, and they can differ in the
+ * last bit.
+ *
+ * @sa cml/et/packet.h
+ */
+
+#ifndef matrix_batch_h
+#define matrix_batch_h
+
+#include <cml/et/packet.h>
+#include <cml/matrix/inverse.h>
+#include <cml/matrix/determinant.h>
+
+/* This is used below to create a more meaningful compile-time error when
+ * the batch functions are given matrices other than 3x3 or 4x4:
+ */
+struct batch_expects_3x3_or_4x4_matrices_error;
+
+namespace cml {
+namespace detail {
+
+/** A SIMD packet of E as a value, so that the cofactor expressions can be
+ * evaluated on packets as written for scalars.
+ */
+template<typename E> struct BatchPacket
+{
+    typedef et::Packet<E> packet_type;
+    typedef typename packet_type::type type;
+
+    BatchPacket() {}
+    BatchPacket(type p) : x(p) {}
+    BatchPacket(E s) : x(packet_type::set1(s)) {}
+
+    type x;
+};
+
+template<typename E> inline BatchPacket<E>
+operator+(const BatchPacket<E>& a, const BatchPacket<E>& b) {
+    return et::Packet<E>::add(a.x, b.x);
+}
+
+template<typename E> inline BatchPacket<E>
+operator-(const BatchPacket<E>& a, const BatchPacket<E>& b) {
+    return et::Packet<E>::sub(a.x, b.x);
+}
+
+template<typename E> inline BatchPacket<E>
+operator*(const BatchPacket<E>& a, const BatchPacket<E>& b) {
+    return et::Packet<E>::mul(a.x, b.x);
+}
+
+template<typename E> inline BatchPacket<E>
+operator/(const BatchPacket<E>& a, const BatchPacket<E>& b) {
+    return et::Packet<E>::div(a.x, b.x);
+}
+
+template<typename E> inline BatchPacket<E>
+operator-(const BatchPacket<E>& a) {
+    return et::Packet<E>::neg(a.x);
+}
+
+template<typename E> inline BatchPacket<E>
+operator+(const BatchPacket<E>& a) {
+    return a;
+}
+
+/** Use packets if E has a packet type with multiplication and division. */
+template<typename E> struct BatchUsePackets {
+    typedef et::Packet<E> packet_type;
+    typedef typename is_true<(packet_type::size > 1
+            && packet_type::has_mul && packet_type::has_div)>::result result;
+};
+
+/* Select the cofactor expressions by size: */
+template<typename V> inline void
+BatchInverse(const V (&m)[3][3], V (&z)[3][3]) { Inverse3x3(m, z); }
+
+template<typename V> inline void
+BatchInverse(const V (&m)[4][4], V (&z)[4][4]) { Inverse4x4(m, z); }
+
+template<typename V> inline V
+BatchDeterminant(const V (&m)[3][3]) { return Determinant3x3(m); }
+
+template<typename V> inline V
+BatchDeterminant(const V (&m)[4][4]) { return Determinant4x4(m); }
+
+/** Transpose matrices in[0..P) into packets, so that m[i][j] holds element
+ * (i,j) of each matrix.  The matrices are copied to a buffer one at a time
+ * first, to read them in order.
+ */
+template<int N, typename E, typename BO, typename L> inline void
+BatchGather(const matrix<E,fixed<N,N>,BO,L>* in, BatchPacket<E> (&m)[N][N])
+{
+    typedef et::Packet<E> packet_type;
+    const int P = int(packet_type::size);
+    E lanes[N][N][packet_type::size];
+    for(int l = 0; l < P; ++ l)
+        for(int i = 0; i < N; ++ i)
+            for(int j = 0; j < N; ++ j) lanes[i][j][l] = in[l](i,j);
+    for(int i = 0; i < N; ++ i)
+        for(int j = 0; j < N; ++ j) m[i][j] = packet_type::load(lanes[i][j]);
+}
+
+/** Transpose the packets z back into matrices out[0..P). */
+template<int N, typename E, typename BO, typename L> inline void
+BatchScatter(const BatchPacket<E> (&z)[N][N], matrix<E,fixed<N,N>,BO,L>* out)
+{
+    typedef et::Packet<E> packet_type;
+    const int P = int(packet_type::size);
+    E lanes[N][N][packet_type::size];
+    for(int i = 0; i < N; ++ i)
+        for(int j = 0; j < N; ++ j) packet_type::store(lanes[i][j], z[i][j].x);
+    for(int l = 0; l < P; ++ l)
+        for(int i = 0; i < N; ++ i)
+            for(int j = 0; j < N; ++ j) out[l](i,j) = lanes[i][j][l];
+}
+
+/** Invert the matrices one at a time. */
+template<int N, typename E, typename BO, typename L> inline void
+InverseBatch(const matrix<E,fixed<N,N>,BO,L>* in,
+        matrix<E,fixed<N,N>,BO,L>* out, size_t n, false_type)
+{
+    for(size_t k = 0; k < n; ++k) {
+        E m[N][N], z[N][N];
+        for(int i = 0; i < N; ++ i)
+            for(int j = 0; j < N; ++ j) m[i][j] = in[k](i,j);
+        BatchInverse(m, z);
+        for(int i = 0; i < N; ++ i)
+            for(int j = 0; j < N; ++ j) out[k](i,j) = z[i][j];
+    }
+}
+
+/** Invert the matrices a packet at a time, then the rest one at a time. */
+template<int N, typename E, typename BO, typename L> inline void
+InverseBatch(const matrix<E,fixed<N,N>,BO,L>* in,
+        matrix<E,fixed<N,N>,BO,L>* out, size_t n, true_type)
+{
+    typedef BatchPacket<E> V;
+    const size_t P = et::Packet<E>::size;
+
+    size_t k = 0;
+    for(; k + P <= n; k += P) {
+        V m[N][N], z[N][N];
+        BatchGather(in+k, m);
+        BatchInverse(m, z);
+        BatchScatter(z, out+k);
+    }
+    InverseBatch(in+k, out+k, n-k, false_type());
+}
+
+/** Compute the determinants one at a time. */
+template<int N, typename E, typename BO, typename L> inline void
+DeterminantBatch(const matrix<E,fixed<N,N>,BO,L>* in, E* out, size_t n,
+        false_type)
+{
+    for(size_t k = 0; k < n; ++k) {
+        E m[N][N];
+        for(int i = 0; i < N; ++ i)
+            for(int j = 0; j < N; ++ j) m[i][j] = in[k](i,j);
+        out[k] = BatchDeterminant(m);
+    }
+}
+
+/** Compute the determinants a packet at a time, then the rest one at a
+ * time.
+ */
+template<int N, typename E, typename BO, typename L> inline void
+DeterminantBatch(const matrix<E,fixed<N,N>,BO,L>* in, E* out, size_t n,
+        true_type)
+{
+    typedef BatchPacket<E> V;
+    const size_t P = et::Packet<E>::size;
+
+    size_t k = 0;
+    for(; k + P <= n; k += P) {
+        V m[N][N];
+        BatchGather(in+k, m);
+        et::Packet<E>::store(out+k, BatchDeterminant(m).x);
+    }
+    DeterminantBatch(in+k, out+k, n-k, false_type());
+}
+
+} // namespace detail
+
+/** Invert the n 3x3 or 4x4 matrices in, storing the inverses in out.
+ *
+ * out may be the same array as in.  As with inverse(), a singular matrix
+ * gives infinities or NaNs rather than an error.
+ */
+template<typename E, int N, typename BO, typename L> inline void
+inverse_batch(const matrix<E,fixed<N,N>,BO,L>* in,
+        matrix<E,fixed<N,N>,BO,L>* out, size_t n)
+{
+    CML_STATIC_REQUIRE_M(N == 3 || N == 4,
+            batch_expects_3x3_or_4x4_matrices_error);
+    typedef typename detail::BatchUsePackets<E>::result use_packets;
+    detail::InverseBatch(in, out, n, use_packets());
+}
+
+/** Compute the determinants of the n 3x3 or 4x4 matrices in, storing them
+ * in out.
+ */
+template<typename E, int N, typename BO, typename L> inline void
+determinant_batch(const matrix<E,fixed<N,N>,BO,L>* in, E* out, size_t n)
+{
+    CML_STATIC_REQUIRE_M(N == 3 || N == 4,
+            batch_expects_3x3_or_4x4_matrices_error);
+    typedef typename detail::BatchUsePackets<E>::result use_packets;
+    detail::DeterminantBatch(in, out, n, use_packets());
+}
+
+} // namespace cml
+
+#endif
+
+// -------------------------------------------------------------------------
+// vim:ft=cpp
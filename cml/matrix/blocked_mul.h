@@ -0,0 +1,239 @@
+/* -*- C++ -*- ------------------------------------------------------------
+ 
+Copyright (c) 2007 Jesse Anders and Demian Nave http://cmldev.net/
+
+The Configurable Math Library (CML) is distributed under the terms of the
+Boost Software License, v1.0 (see cml/LICENSE for details).
+
+ *-----------------------------------------------------------------------*/
+/** @file
+ *  @brief Cache-blocked matrix multiplication for large matrices.
+ *
+ * The product is computed block-by-block: a KCxNC block of the right-hand
+ * matrix and an MCxKC block of the left-hand matrix are first copied
+ * ("packed") into contiguous buffers, and then an MRxNR register tile of
+ * the result is computed at a time from the packed panels.  This keeps the
+ * working set in cache, and lets the compiler keep the tile accumulators
+ * in registers.
+ *
+ * @sa cml::detail::mul
+ */
+
+#ifndef blocked_mul_h
+#define blocked_mul_h
+
+#include <vector>
+#include <cml/core/common.h>
+#include <cml/et/traits.h>
+
+namespace cml {
+namespace detail {
+
+/** Blocking parameters for the packed multiplication kernel.
+ *
+ * MR and NR give the size of the register tile, and should be small enough
+ * that MR*NR accumulators fit into registers.  KC is chosen so that an
+ * MRxKC and a KCxNR panel fit into L1, MC so that an MCxKC block of the
+ * left operand fits into L2, and NC so that a KCxNC block of the right
+ * operand fits into L3.
+ *
+ * @note This can be specialized to tune the kernel for a particular element
+ * type.
+ */
+template<typename E> struct MatMulBlocking {
+    enum { MR = 4, NR = 8, MC = 128, KC = 256, NC = 4096 };
+};
+
+/** MatMulBlocking<> for double, which needs half the registers per tile
+ * of float.
+ */
+template<> struct MatMulBlocking<double> {
+    enum { MR = 4, NR = 4, MC = 96, KC = 256, NC = 2048 };
+};
+
+/** Pack rows [i0,i0+mc) and columns [p0,p0+kc) of A into MR-row panels.
+ *
+ * Within a panel, the MR elements of each column are contiguous.  Rows past
+ * the end of the block are zero-filled, so the micro-kernel never has to
+ * handle a partial panel.  This version reads a row-major A row by row.
+ */
+template<int MR, typename E, class MatT> inline void
+MatMulPackLeft(E* buf, const MatT& A,
+        size_t i0, size_t mc, size_t p0, size_t kc, row_major)
+{
+    for(size_t ir = 0; ir < mc; ir += MR) {
+        E* panel = buf + ir*kc;
+        for(size_t i = 0; i < size_t(MR); ++ i) {
+            if(ir+i < mc) {
+                for(size_t p = 0; p < kc; ++ p)
+                    panel[p*MR+i] = E(A(i0+ir+i,p0+p));
+            } else {
+                for(size_t p = 0; p < kc; ++ p)
+                    panel[p*MR+i] = E(0);
+            }
+        }
+    }
+}
+
+/** Pack a col-major A column by column.
+ *
+ * @sa MatMulPackLeft
+ */
+template<int MR, typename E, class MatT> inline void
+MatMulPackLeft(E* buf, const MatT& A,
+        size_t i0, size_t mc, size_t p0, size_t kc, col_major)
+{
+    for(size_t ir = 0; ir < mc; ir += MR) {
+        E* panel = buf + ir*kc;
+        size_t mr = (mc-ir < size_t(MR)) ? mc-ir : size_t(MR);
+        for(size_t p = 0; p < kc; ++ p) {
+            size_t i = 0;
+            for(; i < mr; ++ i) panel[p*MR+i] = E(A(i0+ir+i,p0+p));
+            for(; i < size_t(MR); ++ i) panel[p*MR+i] = E(0);
+        }
+    }
+}
+
+/** Pack rows [p0,p0+kc) and columns [j0,j0+nc) of B into NR-column panels.
+ *
+ * Within a panel, the NR elements of each row are contiguous.  Columns past
+ * the end of the block are zero-filled.  This version reads a row-major B
+ * row by row.
+ */
+template<int NR, typename E, class MatT> inline void
+MatMulPackRight(E* buf, const MatT& B,
+        size_t p0, size_t kc, size_t j0, size_t nc, row_major)
+{
+    for(size_t jr = 0; jr < nc; jr += NR) {
+        E* panel = buf + jr*kc;
+        size_t nr = (nc-jr < size_t(NR)) ? nc-jr : size_t(NR);
+        for(size_t p = 0; p < kc; ++ p) {
+            size_t j = 0;
+            for(; j < nr; ++ j) panel[p*NR+j] = E(B(p0+p,j0+jr+j));
+            for(; j < size_t(NR); ++ j) panel[p*NR+j] = E(0);
+        }
+    }
+}
+
+/** Pack a col-major B column by column.
+ *
+ * @sa MatMulPackRight
+ */
+template<int NR, typename E, class MatT> inline void
+MatMulPackRight(E* buf, const MatT& B,
+        size_t p0, size_t kc, size_t j0, size_t nc, col_major)
+{
+    for(size_t jr = 0; jr < nc; jr += NR) {
+        E* panel = buf + jr*kc;
+        for(size_t j = 0; j < size_t(NR); ++ j) {
+            if(jr+j < nc) {
+                for(size_t p = 0; p < kc; ++ p)
+                    panel[p*NR+j] = E(B(p0+p,j0+jr+j));
+            } else {
+                for(size_t p = 0; p < kc; ++ p)
+                    panel[p*NR+j] = E(0);
+            }
+        }
+    }
+}
+
+/** Compute an MRxNR tile of C from an MR-row panel of A and an NR-column
+ * panel of B.
+ *
+ * Only the leading mr x nr part of the tile, scaled by alpha, is written
+ * back to C.  If accumulate is false, the tile overwrites C; otherwise, it
+ * is added to C.
+ */
+template<int MR, int NR, typename E, class MatT> inline void
+MatMulMicroKernel(size_t kc, const E* a, const E* b,
+        MatT& C, size_t i0, size_t j0, size_t mr, size_t nr,
+        E alpha, bool accumulate)
+{
+    E ab[MR][NR];
+    for(int i = 0; i < MR; ++ i)
+        for(int j = 0; j < NR; ++ j) ab[i][j] = E(0);
+
+    /* The MR*NR accumulators are independent, and the bounds are constants,
+     * so this loop nest can be fully unrolled and vectorized:
+     */
+    for(size_t p = 0; p < kc; ++ p, a += MR, b += NR) {
+        for(int i = 0; i < MR; ++ i)
+            for(int j = 0; j < NR; ++ j) ab[i][j] += a[i]*b[j];
+    }
+
+    if(accumulate) {
+        for(size_t i = 0; i < mr; ++ i)
+            for(size_t j = 0; j < nr; ++ j) C(i0+i,j0+j) += alpha*ab[i][j];
+    } else {
+        for(size_t i = 0; i < mr; ++ i)
+            for(size_t j = 0; j < nr; ++ j) C(i0+i,j0+j) = alpha*ab[i][j];
+    }
+}
+
+/** Blocked computation of C(i0:i1,j0:j1) = alpha A(i0:i1,:) x B(:,j0:j1).
+ *
+ * If accumulate is true, the product is added to C instead.  C must already
+ * have the right size.  Only the given block of C is touched, so disjoint
+ * blocks can be computed independently.
+ *
+ * @note The inner dimension (A.cols() == B.rows()) must be non-zero.
+ */
+template<class ResultT, class LeftT, class RightT> void
+MatMulBlocked(ResultT& C, const LeftT& A, const RightT& B,
+        size_t i0, size_t i1, size_t j0, size_t j1,
+        typename ResultT::value_type alpha = 1, bool accumulate = false)
+{
+    /* Shorthand: */
+    typedef typename ResultT::value_type value_type;
+    typedef MatMulBlocking<value_type> params;
+    typedef typename et::ExprTraits<LeftT>::result_type::layout left_layout;
+    typedef typename et::ExprTraits<RightT>::result_type::layout right_layout;
+    enum {
+        MR = params::MR, NR = params::NR,
+        MC = params::MC, KC = params::KC, NC = params::NC
+    };
+
+    /* Panel buffers, rounded up to a whole number of register tiles: */
+    const size_t K = A.cols();
+    const size_t kc_max = (K < size_t(KC)) ? K : size_t(KC);
+    const size_t mc_max = ((i1-i0 < size_t(MC)) ? i1-i0 : size_t(MC));
+    const size_t nc_max = ((j1-j0 < size_t(NC)) ? j1-j0 : size_t(NC));
+    std::vector<value_type> abuf(((mc_max+MR-1)/MR)*MR*kc_max);
+    std::vector<value_type> bbuf(((nc_max+NR-1)/NR)*NR*kc_max);
+
+    for(size_t jc = j0; jc < j1; jc += NC) {
+        size_t nc = (j1-jc < size_t(NC)) ? j1-jc : size_t(NC);
+
+        for(size_t pc = 0; pc < K; pc += KC) {
+            size_t kc = (K-pc < size_t(KC)) ? K-pc : size_t(KC);
+            MatMulPackRight<NR>(&bbuf[0], B, pc, kc, jc, nc, right_layout());
+
+            for(size_t ic = i0; ic < i1; ic += MC) {
+                size_t mc = (i1-ic < size_t(MC)) ? i1-ic : size_t(MC);
+                MatMulPackLeft<MR>(&abuf[0], A, ic, mc, pc, kc, left_layout());
+
+                /* The first block of the inner dimension initializes C,
+                 * unless accumulating:
+                 */
+                for(size_t jr = 0; jr < nc; jr += NR) {
+                    size_t nr = (nc-jr < size_t(NR)) ? nc-jr : size_t(NR);
+                    for(size_t ir = 0; ir < mc; ir += MR) {
+                        size_t mr = (mc-ir < size_t(MR)) ? mc-ir : size_t(MR);
+                        MatMulMicroKernel<MR,NR>(kc,
+                                &abuf[ir*kc], &bbuf[jr*kc],
+                                C, ic+ir, jc+jr, mr, nr,
+                                alpha, accumulate || pc > 0);
+                    }
+                }
+            }
+        }
+    }
+}
+
+} // namespace detail
+} // namespace cml
+
+#endif
+
+// -------------------------------------------------------------------------
+// vim:ft=cpp
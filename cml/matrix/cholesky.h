@@ -0,0 +1,508 @@
+/* -*- C++ -*- ------------------------------------------------------------
+ 
+Copyright (c) 2007 Jesse Anders and Demian Nave http://cmldev.net/
+
+The Configurable Math Library (CML) is distributed under the terms of the
+Boost Software License, v1.0 (see cml/LICENSE for details).
+
+ *-----------------------------------------------------------------------*/
+/** @file
+ *  @brief Cholesky (LL^T) and LDL^T factorizations of symmetric matrices.
+ *
+ * cholesky_inplace(A) factors a symmetric positive definite A = LL^T, and
+ * ldlt_inplace(A) factors a symmetric A = LDL^T with L unit lower
+ * triangular and D diagonal.  Both read only the lower triangle of A, and
+ * leave the factors in it, with zeros above the diagonal; ldlt_inplace()
+ * stores D on the diagonal.  They take about half the work of lu(), and
+ * need no pivoting:
+ *
+ *   matrix_type L = cholesky(A);
+ *   x = cholesky_solve(L, b);
+ *   X = cholesky_solve(L, B);          // One for each column of B.
+ *
+ * The factors of a packed symmetric<> matrix are returned as a packed
+ * lower_triangular<> matrix.  Fixed-size matrices are factored by a kernel
+ * with compile-time loop bounds, and large run-time sized matrices by
+ * panels of CML_CHOLESKY_BLOCK_SIZE columns, updating the rest of the
+ * matrix with the blocked product kernel.
+ */
+
+#ifndef cholesky_h
+#define cholesky_h
+
+#include <cmath>
+#include <stdexcept>
+#include <cml/et/size_checking.h>
+#include <cml/matrix/matrix_expr.h>
+#include <cml/matrix/matrix_mul.h>
+#include <cml/matrix/matrix_block.h>
+#include <cml/matrix/fixed_mul.h>
+#include <cml/matvec/matvec_promotions.h>
+#include <cml/packed.h>
+
+/* This is used below to create a more meaningful compile-time error when
+ * cholesky_inplace or ldlt_inplace is given a packed symmetric or upper
+ * triangular matrix, which cannot hold the lower triangular factor:
+ */
+struct cholesky_inplace_expects_a_lower_triangle_error;
+
+namespace cml {
+namespace detail {
+
+/** Factor columns [k0,k1) of A = LL^T, given that the columns before k0
+ * have already been factored and subtracted from the rest of A.
+ *
+ * Only the lower triangle of A is read.  Returns false if A is not
+ * positive definite.
+ */
+template<class MatT> inline bool
+CholeskyPanel(MatT& A, size_t k0, size_t k1)
+{
+    typedef typename MatT::value_type value_type;
+    const size_t N = A.rows();
+    for(size_t j = k0; j < k1; ++j) {
+        value_type d = A(j,j);
+        for(size_t k = k0; k < j; ++k) d -= A(j,k)*A(j,k);
+        if(!(d > value_type(0))) return false;
+        const value_type ljj = value_type(std::sqrt(d));
+        const value_type inv = value_type(1)/ljj;
+        A(j,j) = ljj;
+        for(size_t i = j+1; i < N; ++i) {
+            value_type s = A(i,j);
+            for(size_t k = k0; k < j; ++k) s -= A(i,k)*A(j,k);
+            A(i,j) = s*inv;
+        }
+    }
+    return true;
+}
+
+/** Factor an NxN array a = LL^T, with the loops unrolled by the compiler.
+ *
+ * The lower triangle is factored in a local copy, so a is only written if
+ * the factorization succeeds.
+ */
+template<int N, class Index> struct CholeskyFixed
+{
+    template<typename E> static bool compute(E* a) {
+        E l[N][N];
+        for(int j = 0; j < N; ++ j) {
+            E d = a[Index::at(j,j)];
+            for(int k = 0; k < j; ++ k) d -= l[j][k]*l[j][k];
+            if(!(d > E(0))) return false;
+            l[j][j] = E(std::sqrt(d));
+            const E inv = E(1)/l[j][j];
+            for(int i = j+1; i < N; ++ i) {
+                E s = a[Index::at(i,j)];
+                for(int k = 0; k < j; ++ k) s -= l[i][k]*l[j][k];
+                l[i][j] = s*inv;
+            }
+        }
+        for(int i = 0; i < N; ++ i)
+            for(int j = 0; j < N; ++ j)
+                a[Index::at(i,j)] = (i >= j) ? l[i][j] : E(0);
+        return true;
+    }
+};
+
+/** Set the elements above the diagonal of A to zero. */
+template<class MatT> inline void
+ZeroUpper(MatT& A)
+{
+    typedef typename MatT::value_type value_type;
+    for(size_t i = 0; i < A.rows(); ++i)
+        for(size_t j = i+1; j < A.cols(); ++j) A(i,j) = value_type(0);
+}
+
+/** Fixed-size contiguous matrices use the unrolled kernel. */
+template<typename E, class AT, typename BO, typename L> inline bool
+CholeskyInplace(matrix<E,AT,BO,L>& A, fixed_size_tag)
+{
+    typedef matrix<E,AT,BO,L> matrix_type;
+    enum { N = matrix_type::array_rows };
+    if(contiguous_storage<AT>::is_true) {
+        return CholeskyFixed< N, FixedElement<N,N,L> >::compute(A.data());
+    }
+    if(!CholeskyPanel(A, 0, N)) return false;
+    ZeroUpper(A);
+    return true;
+}
+
+/** Packed and banded matrices have no blocks, and are factored as one
+ * panel.
+ */
+template<typename E, class AT, typename BO, typename L> inline bool
+CholeskyBlocked(matrix<E,AT,BO,L>& A, false_type)
+{
+    if(!CholeskyPanel(A, 0, A.rows())) return false;
+    ZeroUpper(A);
+    return true;
+}
+
+/** Dense matrices are factored by panels, with the trailing lower
+ * triangle updated by the matrix product kernel a block column at a time.
+ */
+template<typename E, class AT, typename BO, typename L> inline bool
+CholeskyBlocked(matrix<E,AT,BO,L>& A, true_type)
+{
+    typedef matrix<E,strided<>,BO,L> block_type;
+    typedef typename select_if<same_type<L,row_major>::is_true,
+            col_major, row_major>::result transposed_layout;
+    typedef matrix<E,strided<>,BO,transposed_layout> transposed_type;
+
+    const size_t N = A.rows(), NB = CML_CHOLESKY_BLOCK_SIZE;
+    if(N <= NB) return CholeskyBlocked(A, false_type());
+
+    for(size_t k0 = 0; k0 < N; k0 += NB) {
+        const size_t k1 = (N-k0 < NB) ? N : k0+NB, kb = k1-k0;
+
+        /* Factor the panel [A11; A21] = [L11; L21] L11^T: */
+        if(!CholeskyPanel(A, k0, k1)) return false;
+
+        /* Update the lower triangle of A22 -= L21 L21^T, one block column
+         * at a time.  The transpose of a block of L21 is a strided view
+         * of the same elements with the other layout:
+         */
+        for(size_t j0 = k1; j0 < N; j0 += NB) {
+            const size_t jb = (N-j0 < NB) ? N-j0 : NB;
+            block_type C = block(A, j0, j0, N-j0, jb);
+            transposed_type Rt(BlockOrigin(A, j0, k0, jb, kb),
+                    kb, jb, BlockStride(A));
+            MatMulUpdate(C, block(A, j0, k0, N-j0, kb), Rt,
+                    E(-1), true, dynamic_size_tag());
+        }
+    }
+    ZeroUpper(A);
+    return true;
+}
+
+/** Run-time sized dense matrices larger than CML_CHOLESKY_BLOCK_SIZE are
+ * factored by panels.
+ */
+template<typename E, class AT, typename BO, typename L> inline bool
+CholeskyInplace(matrix<E,AT,BO,L>& A, dynamic_size_tag)
+{
+    typedef typename is_true<
+        same_type<typename matrix_structure<AT>::type,
+        general_tag>::is_true>::result dense;
+    return CholeskyBlocked(A, dense());
+}
+
+/** Solve LL^T X = X in place, for each column of X. */
+template<class MatT, class RhsT> inline void
+CholeskySubstitute(const MatT& L, RhsT& X)
+{
+    typedef typename RhsT::value_type value_type;
+    const size_t N = L.rows(), M = X.cols();
+
+    /* Solve LY = X: */
+    for(size_t i = 0; i < N; ++i) {
+        for(size_t k = 0; k < i; ++k) {
+            const value_type l = L(i,k);
+            for(size_t j = 0; j < M; ++j) X(i,j) -= l*X(k,j);
+        }
+        const value_type inv = value_type(1)/L(i,i);
+        for(size_t j = 0; j < M; ++j) X(i,j) *= inv;
+    }
+
+    /* Solve L^T X = Y: */
+    for(size_t i = N; i-- > 0; ) {
+        for(size_t k = i+1; k < N; ++k) {
+            const value_type l = L(k,i);
+            for(size_t j = 0; j < M; ++j) X(i,j) -= l*X(k,j);
+        }
+        const value_type inv = value_type(1)/L(i,i);
+        for(size_t j = 0; j < M; ++j) X(i,j) *= inv;
+    }
+}
+
+/** Solve LDL^T X = X in place, for each column of X. */
+template<class MatT, class RhsT> inline void
+LDLTSubstitute(const MatT& LD, RhsT& X)
+{
+    typedef typename RhsT::value_type value_type;
+    const size_t N = LD.rows(), M = X.cols();
+
+    /* Solve LY = X, with the unit diagonal of L understood: */
+    for(size_t i = 0; i < N; ++i) {
+        for(size_t k = 0; k < i; ++k) {
+            const value_type l = LD(i,k);
+            for(size_t j = 0; j < M; ++j) X(i,j) -= l*X(k,j);
+        }
+    }
+
+    /* Solve DZ = Y: */
+    for(size_t i = 0; i < N; ++i) {
+        const value_type inv = value_type(1)/LD(i,i);
+        for(size_t j = 0; j < M; ++j) X(i,j) *= inv;
+    }
+
+    /* Solve L^T X = Z: */
+    for(size_t i = N; i-- > 0; ) {
+        for(size_t k = i+1; k < N; ++k) {
+            const value_type l = LD(k,i);
+            for(size_t j = 0; j < M; ++j) X(i,j) -= l*X(k,j);
+        }
+    }
+}
+
+/** Present a vector as an Nx1 matrix, for the substitution functions. */
+template<class VecT> struct ColumnOf
+{
+    typedef typename VecT::value_type value_type;
+    ColumnOf(VecT& v) : m_v(v) {}
+    size_t cols() const { return 1; }
+    value_type& operator()(size_t i, size_t) const { return m_v[i]; }
+    VecT& m_v;
+};
+
+} // namespace detail
+
+/** Factor the symmetric positive definite matrix A = LL^T in place.
+ *
+ * Only the lower triangle of A is read.  On success, A holds L, with
+ * zeros above the diagonal.  A packed symmetric matrix cannot hold L, and
+ * is rejected at compile time; use cholesky() instead.
+ *
+ * @returns false if A is not positive definite, leaving A partially
+ * factored.
+ *
+ * @throws std::invalid_argument if A is not square.
+ */
+template<typename E, class AT, typename BO, typename L> inline bool
+cholesky_inplace(matrix<E,AT,BO,L>& A)
+{
+    typedef typename matrix<E,AT,BO,L>::size_tag size_tag;
+
+    /* A packed symmetric or upper triangular matrix cannot hold L: */
+    CML_STATIC_REQUIRE_M(
+        (!same_type<typename matrix_structure<AT>::type,
+         symmetric_tag>::is_true
+         && !same_type<typename matrix_structure<AT>::type,
+         upper_triangular_tag>::is_true),
+        cholesky_inplace_expects_a_lower_triangle_error);
+
+    cml::et::CheckedSquare(A, size_tag());
+    return detail::CholeskyInplace(A, size_tag());
+}
+
+/** Factor the symmetric matrix A = LDL^T in place, with L unit lower
+ * triangular and D diagonal.
+ *
+ * Only the lower triangle of A is read.  On success, A holds L below the
+ * diagonal and D on the diagonal, with zeros above the diagonal.  A does
+ * not have to be positive definite, but without pivoting the
+ * factorization is only stable if it is.  As for cholesky_inplace(), A
+ * cannot be a packed symmetric matrix; use ldlt() instead.
+ *
+ * @returns false if a pivot was zero, leaving A partially factored.
+ *
+ * @throws std::invalid_argument if A is not square.
+ */
+template<typename E, class AT, typename BO, typename L> inline bool
+ldlt_inplace(matrix<E,AT,BO,L>& A)
+{
+    typedef typename matrix<E,AT,BO,L>::size_tag size_tag;
+    typedef typename matrix<E,AT,BO,L>::value_type value_type;
+
+    /* A packed symmetric or upper triangular matrix cannot hold L: */
+    CML_STATIC_REQUIRE_M(
+        (!same_type<typename matrix_structure<AT>::type,
+         symmetric_tag>::is_true
+         && !same_type<typename matrix_structure<AT>::type,
+         upper_triangular_tag>::is_true),
+        cholesky_inplace_expects_a_lower_triangle_error);
+
+    const size_t N = cml::et::CheckedSquare(A, size_tag());
+    for(size_t j = 0; j < N; ++j) {
+        value_type d = A(j,j);
+        for(size_t k = 0; k < j; ++k) d -= A(j,k)*A(j,k)*A(k,k);
+        if(d == value_type(0)) return false;
+        A(j,j) = d;
+        const value_type inv = value_type(1)/d;
+        for(size_t i = j+1; i < N; ++i) {
+            value_type s = A(i,j);
+            for(size_t k = 0; k < j; ++k) s -= A(i,k)*A(j,k)*A(k,k);
+            A(i,j) = s*inv;
+        }
+    }
+    detail::ZeroUpper(A);
+    return true;
+}
+
+/** Return the Cholesky factor L of a symmetric positive definite matrix.
+ *
+ * @throws std::invalid_argument if m is not positive definite.
+ */
+template<typename E, class AT, typename BO, class L>
+inline typename matrix<E,AT,BO,L>::temporary_type
+cholesky(const matrix<E,AT,BO,L>& m)
+{
+    typename matrix<E,AT,BO,L>::temporary_type C;
+    cml::et::detail::ResizeUninitialized(C,m.rows(),m.cols());
+    C = m;
+    if(!cholesky_inplace(C))
+        throw std::invalid_argument("matrix is not positive definite.");
+    return C;
+}
+
+/** Return the Cholesky factor of a packed symmetric matrix, as a packed
+ * lower triangular matrix.
+ *
+ * @throws std::invalid_argument if m is not positive definite.
+ */
+template<typename E, class A, typename BO, class L>
+inline matrix<E,lower_triangular<A>,BO,L>
+cholesky(const matrix<E,symmetric<A>,BO,L>& m)
+{
+    matrix<E,lower_triangular<A>,BO,L> C = m;
+    if(!cholesky_inplace(C))
+        throw std::invalid_argument("matrix is not positive definite.");
+    return C;
+}
+
+/** Return the Cholesky factor of a symmetric positive definite matrix
+ * expression.
+ *
+ * @throws std::invalid_argument if e is not positive definite.
+ */
+template<typename XprT>
+inline typename et::MatrixXpr<XprT>::temporary_type
+cholesky(const et::MatrixXpr<XprT>& e)
+{
+    typename et::MatrixXpr<XprT>::temporary_type C;
+    cml::et::detail::ResizeUninitialized(C,e.rows(),e.cols());
+    C = e;
+    if(!cholesky_inplace(C))
+        throw std::invalid_argument("matrix is not positive definite.");
+    return C;
+}
+
+/** Return the LDL^T factorization of a symmetric matrix.
+ *
+ * @throws std::invalid_argument if a pivot is zero.
+ */
+template<typename E, class AT, typename BO, class L>
+inline typename matrix<E,AT,BO,L>::temporary_type
+ldlt(const matrix<E,AT,BO,L>& m)
+{
+    typename matrix<E,AT,BO,L>::temporary_type LD;
+    cml::et::detail::ResizeUninitialized(LD,m.rows(),m.cols());
+    LD = m;
+    if(!ldlt_inplace(LD))
+        throw std::invalid_argument("matrix has no LDLT factorization.");
+    return LD;
+}
+
+/** Return the LDL^T factorization of a packed symmetric matrix, as a
+ * packed lower triangular matrix.
+ *
+ * @throws std::invalid_argument if a pivot is zero.
+ */
+template<typename E, class A, typename BO, class L>
+inline matrix<E,lower_triangular<A>,BO,L>
+ldlt(const matrix<E,symmetric<A>,BO,L>& m)
+{
+    matrix<E,lower_triangular<A>,BO,L> LD = m;
+    if(!ldlt_inplace(LD))
+        throw std::invalid_argument("matrix has no LDLT factorization.");
+    return LD;
+}
+
+/** Solve LL^T x = b for x, given the Cholesky factor L. */
+template<typename MatT, typename VecT> inline
+typename et::MatVecPromote<MatT,VecT>::temporary_type
+cholesky_solve(const MatT& L, const VecT& b)
+{
+  typedef typename et::MatVecPromote<MatT,VecT>::temporary_type vector_type;
+  typedef et::ExprTraits<MatT> matrix_traits;
+
+  /* Verify that the matrix is square, and that b has the same size: */
+  const size_t N = cml::et::CheckedSquare(
+    L, typename matrix_traits::size_tag());
+  et::CheckedSize(L, b, typename vector_type::size_tag());
+
+  vector_type x; cml::et::detail::ResizeUninitialized(x,N);
+  x = b;
+  detail::ColumnOf<vector_type> X(x);
+  detail::CholeskySubstitute(L, X);
+  return x;
+}
+
+/** Solve LL^T X = B for X, given the Cholesky factor L, for all of the
+ * columns of B at once.
+ */
+template<typename MatT, typename E, class AT, typename BO, typename L> inline
+typename et::MatrixPromote<
+    matrix<E,AT,BO,L>, typename MatT::value_type>::temporary_type
+cholesky_solve(const MatT& C, const matrix<E,AT,BO,L>& B)
+{
+  typedef typename et::MatrixPromote<
+    matrix<E,AT,BO,L>, typename MatT::value_type>::temporary_type
+    result_type;
+  typedef et::ExprTraits<MatT> matrix_traits;
+
+  /* Verify that the matrix is square, and that B has as many rows: */
+  const size_t N = cml::et::CheckedSquare(
+    C, typename matrix_traits::size_tag());
+  if(B.rows() != N)
+    throw std::invalid_argument("expressions have incompatible sizes.");
+
+  result_type X;
+  cml::et::detail::ResizeUninitialized(X,B.rows(),B.cols());
+  X = B;
+  detail::CholeskySubstitute(C, X);
+  return X;
+}
+
+/** Solve LDL^T x = b for x, given the factorization from ldlt(). */
+template<typename MatT, typename VecT> inline
+typename et::MatVecPromote<MatT,VecT>::temporary_type
+ldlt_solve(const MatT& LD, const VecT& b)
+{
+  typedef typename et::MatVecPromote<MatT,VecT>::temporary_type vector_type;
+  typedef et::ExprTraits<MatT> matrix_traits;
+
+  /* Verify that the matrix is square, and that b has the same size: */
+  const size_t N = cml::et::CheckedSquare(
+    LD, typename matrix_traits::size_tag());
+  et::CheckedSize(LD, b, typename vector_type::size_tag());
+
+  vector_type x; cml::et::detail::ResizeUninitialized(x,N);
+  x = b;
+  detail::ColumnOf<vector_type> X(x);
+  detail::LDLTSubstitute(LD, X);
+  return x;
+}
+
+/** Solve LDL^T X = B for X, given the factorization from ldlt(), for all
+ * of the columns of B at once.
+ */
+template<typename MatT, typename E, class AT, typename BO, typename L> inline
+typename et::MatrixPromote<
+    matrix<E,AT,BO,L>, typename MatT::value_type>::temporary_type
+ldlt_solve(const MatT& LD, const matrix<E,AT,BO,L>& B)
+{
+  typedef typename et::MatrixPromote<
+    matrix<E,AT,BO,L>, typename MatT::value_type>::temporary_type
+    result_type;
+  typedef et::ExprTraits<MatT> matrix_traits;
+
+  /* Verify that the matrix is square, and that B has as many rows: */
+  const size_t N = cml::et::CheckedSquare(
+    LD, typename matrix_traits::size_tag());
+  if(B.rows() != N)
+    throw std::invalid_argument("expressions have incompatible sizes.");
+
+  result_type X;
+  cml::et::detail::ResizeUninitialized(X,B.rows(),B.cols());
+  X = B;
+  detail::LDLTSubstitute(LD, X);
+  return X;
+}
+
+} // namespace cml
+
+#endif
+
+// -------------------------------------------------------------------------
+// vim:ft=cpp
@@ -9,13 +9,29 @@ Boost Software License, v1.0 (see cml/LICENSE for details).
 /** @file
  *  @brief Compute the determinant of a square matrix using LU factorization.
  *
- *  @todo This should be specialized on the matrix size for small matrices.
+ * Up to 4x4, the determinant is expanded by cofactors.  Larger matrices are
+ * factored by lu_pivot_inplace(), which is looked up when the functions are
+ * instantiated (see cml/matrix/lu_pivot.h).
+ *
+ * The determinant of a large matrix easily overflows or underflows, e.g.
+ * for a 500x500 covariance matrix.  log_determinant() and
+ * signed_log_determinant() sum the logarithms of the pivots instead, and can
+ * reuse a factorization the caller already has:
+ *
+ *   vector< size_t, dynamic<> > piv;
+ *   lu_pivot_inplace(LU, piv);        // LU is a copy of A.
+ *   double logdet = log_determinant(LU, piv);
+ *   x = lu_solve(LU, piv, b);
  */
 
 #ifndef determinant_h
 #define determinant_h
 
+#include <cmath>
+#include <limits>
+#include <stdexcept>
 #include <cml/matrix/lu.h>
+#include <cml/matrix/inverse.h>
 
 namespace cml {
 namespace detail {
@@ -39,21 +55,93 @@ struct determinant_f<MatT,2>
 
 };
 
+/** Compute the determinant of the 3x3 matrix m.  V is the element type,
+ * or a SIMD packet of the same element of several matrices (see
+ * cml/matrix/batch.h), so each operation must be written the same way for
+ * both:
+ *
+ *     [00 01 02]
+ * m = [10 11 12]
+ *     [20 21 22]
+ */
+template<typename V> inline V
+Determinant3x3(const V (&m)[3][3])
+{
+    return m[0][0]*(m[1][1]*m[2][2] - m[1][2]*m[2][1])
+         + m[0][1]*(m[1][2]*m[2][0] - m[1][0]*m[2][2])
+         + m[0][2]*(m[1][0]*m[2][1] - m[1][1]*m[2][0]);
+}
+
+/** Compute the determinant of the 4x4 matrix m, with V as for
+ * Determinant3x3():
+ *
+ *     [00 01 02 03]
+ * m = [10 11 12 13]
+ *     [20 21 22 23]
+ *     [30 31 32 33]
+ *
+ *       |11 12 13|         |10 12 13|
+ * C00 = |21 22 23|   C01 = |20 22 23|
+ *       |31 32 33|         |30 32 33|
+ *
+ *       |10 11 13|         |10 11 12|
+ * C02 = |20 21 23|   C03 = |20 21 22|
+ *       |30 31 33|         |30 31 32|
+ *
+ * d00 =   11 * (22*33 - 23*32)  d01 =   10 * (22*33 - 23*32)
+ *       + 12 * (23*31 - 21*33)        + 12 * (23*30 - 20*33)
+ *       + 13 * (21*32 - 22*31)        + 13 * (20*32 - 22*30)
+ *
+ * d02 =   10 * (21*33 - 23*31)  d03 =   10 * (21*32 - 22*31)
+ *       + 11 * (23*30 - 20*33)        + 11 * (22*30 - 20*32)
+ *       + 13 * (20*31 - 21*30)        + 12 * (20*31 - 21*30)
+ */
+template<typename V> inline V
+Determinant4x4(const V (&m)[4][4])
+{
+    /* Common cofactors: */
+    V m_22_33_23_32 = m[2][2]*m[3][3] - m[2][3]*m[3][2];
+    V m_23_30_20_33 = m[2][3]*m[3][0] - m[2][0]*m[3][3];
+    V m_20_31_21_30 = m[2][0]*m[3][1] - m[2][1]*m[3][0];
+    V m_21_32_22_31 = m[2][1]*m[3][2] - m[2][2]*m[3][1];
+    V m_23_31_21_33 = m[2][3]*m[3][1] - m[2][1]*m[3][3];
+    V m_20_32_22_30 = m[2][0]*m[3][2] - m[2][2]*m[3][0];
+
+    V d00 = m[0][0]*(
+            m[1][1] * m_22_33_23_32
+          + m[1][2] * m_23_31_21_33
+          + m[1][3] * m_21_32_22_31);
+
+    V d01 = m[0][1]*(
+            m[1][0] * m_22_33_23_32
+          + m[1][2] * m_23_30_20_33
+          + m[1][3] * m_20_32_22_30);
+
+    V d02 = m[0][2]*(
+            m[1][0] * - m_23_31_21_33
+          + m[1][1] * m_23_30_20_33
+          + m[1][3] * m_20_31_21_30);
+
+    V d03 = m[0][3]*(
+            m[1][0] * m_21_32_22_31
+          + m[1][1] * - m_20_32_22_30
+          + m[1][2] * m_20_31_21_30);
+
+    return d00 - d01 + d02 - d03;
+}
+
 /* 3x3 determinant.  Despite being marked for fixed_size matrices, this can
  * be used for dynamic-sized ones also:
  */
 template<typename MatT>
 struct determinant_f<MatT,3>
 {
-    /*     [00 01 02]
-     * M = [10 11 12]
-     *     [20 21 22]
-     */
     typename MatT::value_type operator()(const MatT& M) const
     {
-        return M(0,0)*(M(1,1)*M(2,2) - M(1,2)*M(2,1))
-             + M(0,1)*(M(1,2)*M(2,0) - M(1,0)*M(2,2))
-             + M(0,2)*(M(1,0)*M(2,1) - M(1,1)*M(2,0));
+        typename MatT::value_type m[3][3];
+        for(int i = 0; i < 3; ++ i)
+            for(int j = 0; j < 3; ++ j) m[i][j] = M(i,j);
+        return Determinant3x3(m);
     }
 
 };
@@ -64,83 +152,113 @@ struct determinant_f<MatT,3>
 template<typename MatT>
 struct determinant_f<MatT,4>
 {
-    /*     [00 01 02 03]
-     * M = [10 11 12 13]
-     *     [20 21 22 23]
-     *     [30 31 32 33]
-     *
-     *       |11 12 13|         |10 12 13|
-     * C00 = |21 22 23|   C01 = |20 22 23|
-     *       |31 32 33|         |30 32 33|
-     *
-     *       |10 11 13|         |10 11 12|
-     * C02 = |20 21 23|   C03 = |20 21 22|
-     *       |30 31 33|         |30 31 32|
-     *
-     * d00 =   11 * (22*33 - 23*32)  d01 =   10 * (22*33 - 23*32)
-     *       + 12 * (23*31 - 21*33)        + 12 * (23*30 - 20*33)
-     *       + 13 * (21*32 - 22*31)        + 13 * (20*32 - 22*30)
-     *
-     * d02 =   10 * (21*33 - 23*31)  d03 =   10 * (21*32 - 22*31)
-     *       + 11 * (23*30 - 20*33)        + 11 * (22*30 - 20*32)
-     *       + 13 * (20*31 - 21*30)        + 12 * (20*31 - 21*30)
-     */
     typename MatT::value_type operator()(const MatT& M) const
     {
-        /* Shorthand. */
-        typedef typename MatT::value_type value_type;
-
-        /* Common cofactors: */
-        value_type m_22_33_23_32 = M(2,2)*M(3,3) - M(2,3)*M(3,2);
-        value_type m_23_30_20_33 = M(2,3)*M(3,0) - M(2,0)*M(3,3);
-        value_type m_20_31_21_30 = M(2,0)*M(3,1) - M(2,1)*M(3,0);
-        value_type m_21_32_22_31 = M(2,1)*M(3,2) - M(2,2)*M(3,1);
-        value_type m_23_31_21_33 = M(2,3)*M(3,1) - M(2,1)*M(3,3);
-        value_type m_20_32_22_30 = M(2,0)*M(3,2) - M(2,2)*M(3,0);
-
-        value_type d00 = M(0,0)*(
-                M(1,1) * m_22_33_23_32
-              + M(1,2) * m_23_31_21_33
-              + M(1,3) * m_21_32_22_31);
-
-        value_type d01 = M(0,1)*(
-                M(1,0) * m_22_33_23_32
-              + M(1,2) * m_23_30_20_33
-              + M(1,3) * m_20_32_22_30);
-
-        value_type d02 = M(0,2)*(
-                M(1,0) * - m_23_31_21_33
-              + M(1,1) * m_23_30_20_33
-              + M(1,3) * m_20_31_21_30);
-
-        value_type d03 = M(0,3)*(
-                M(1,0) * m_21_32_22_31
-              + M(1,1) * - m_20_32_22_30
-              + M(1,2) * m_20_31_21_30);
-
-        return d00 - d01 + d02 - d03;
+        typename MatT::value_type m[4][4];
+        for(int i = 0; i < 4; ++ i)
+            for(int j = 0; j < 4; ++ j) m[i][j] = M(i,j);
+        return Determinant4x4(m);
     }
 
 };
 
-/* General NxN determinant by LU factorization:  */
+/* General NxN determinant by LU factorization with partial pivoting: */
 template<typename MatT, int N>
 struct determinant_f
 {
     typename MatT::value_type operator()(const MatT& M) const
     {
+        typedef typename MatT::temporary_type temporary_type;
+        typedef typename MatT::value_type value_type;
+        typedef typename InversePivots<
+            typename temporary_type::col_vector_type>::type pivot_type;
+
         /* Compute the LU factorization: */
-        typename MatT::temporary_type LU = lu(M);
+        temporary_type LU;
+        cml::et::detail::ResizeUninitialized(LU,M.rows(),M.cols());
+        LU = M;
+        pivot_type piv;
+        const int sign = lu_pivot_inplace(LU, piv);
+        if(sign == 0) return value_type(0);
 
-        /* The product of the diagonal entries is the determinant: */
-        typename MatT::value_type det = LU(0,0);
-        for(size_t i = 1; i < LU.rows(); ++ i)
+        /* The product of the diagonal entries is the determinant, up to
+         * the sign of the row interchanges:
+         */
+        value_type det = value_type(sign);
+        for(size_t i = 0; i < LU.rows(); ++ i)
             det *= LU(i,i);
         return det;
     }
 
 };
 
+/** Add log|u| over the diagonal entries u of the factor U to the
+ * logarithm of a determinant, and their signs to sign.
+ *
+ * Returns -infinity, with sign set to 0, if an entry is zero.
+ */
+template<class MatT> inline typename MatT::value_type
+LogAbsDiagonal(const MatT& LU, int& sign)
+{
+    typedef typename MatT::value_type value_type;
+    value_type logdet = value_type(0);
+    for(size_t i = 0; i < LU.rows(); ++ i) {
+        const value_type u = LU(i,i);
+        if(u == value_type(0)) {
+            sign = 0;
+            return -std::numeric_limits<value_type>::infinity();
+        }
+        if(u < value_type(0)) sign = -sign;
+        logdet += value_type(std::log(std::fabs(u)));
+    }
+    return logdet;
+}
+
+/** Factor M, and return log|det M| with its sign in sign. */
+template<typename MatT> inline typename MatT::value_type
+SignedLogDeterminant(const MatT& M, int& sign)
+{
+    typedef typename MatT::temporary_type temporary_type;
+    typedef typename InversePivots<
+        typename temporary_type::col_vector_type>::type pivot_type;
+
+    /* Require a square matrix: */
+    cml::et::CheckedSquare(M, typename MatT::size_tag());
+
+    temporary_type LU;
+    cml::et::detail::ResizeUninitialized(LU,M.rows(),M.cols());
+    LU = M;
+    pivot_type piv;
+    sign = lu_pivot_inplace(LU, piv);
+    if(sign == 0)
+        return -std::numeric_limits<typename MatT::value_type>::infinity();
+    return LogAbsDiagonal(LU, sign);
+}
+
+/** Return log|det A| with its sign in sign, given the factorization
+ * PA = LU and its row interchanges piv.
+ */
+template<typename MatT, typename PivT> inline typename MatT::value_type
+SignedLogDeterminant(const MatT& LU, const PivT& piv, int& sign)
+{
+    /* Require a square matrix: */
+    const size_t N = cml::et::CheckedSquare(LU, typename MatT::size_tag());
+
+    sign = 1;
+    for(size_t k = 0; k < N; ++ k)
+        if(size_t(piv[k]) != k) sign = -sign;
+    return LogAbsDiagonal(LU, sign);
+}
+
+/* The logarithm of a positive determinant: */
+template<typename E> inline E
+PositiveLogDeterminant(E logdet, int sign)
+{
+    if(sign <= 0)
+        throw std::invalid_argument("determinant is not positive.");
+    return logdet;
+}
+
 /* Generator for the determinant functional for fixed-size matrices: */
 template<typename MatT> typename MatT::value_type
 determinant(const MatT& M, fixed_size_tag)
@@ -184,6 +302,85 @@ determinant(const et::MatrixXpr<XprT>& e)
     return detail::determinant(e,size_tag());
 }
 
+/** Logarithm of the absolute value of the determinant of a matrix.
+ *
+ * sign is set to the sign of the determinant, +1 or -1, or to 0 if the
+ * matrix is singular, in which case -infinity is returned.  det(M) is
+ * sign*exp(signed_log_determinant(M,sign)), but the determinant itself is
+ * never formed, so this does not overflow or underflow.
+ *
+ * @throws std::invalid_argument if M is not square.
+ */
+template<typename E, class AT, class BO, class L> inline E
+signed_log_determinant(const matrix<E,AT,BO,L>& M, int& sign)
+{
+    return detail::SignedLogDeterminant(M, sign);
+}
+
+/** Logarithm of the absolute value of the determinant of a matrix
+ * expression.
+ *
+ * @sa signed_log_determinant(const matrix<E,AT,BO,L>&,int&)
+ */
+template<typename XprT> inline typename XprT::value_type
+signed_log_determinant(const et::MatrixXpr<XprT>& e, int& sign)
+{
+    return detail::SignedLogDeterminant(e, sign);
+}
+
+/** Logarithm of the absolute value of the determinant of A, given the
+ * factorization PA = LU and its row interchanges piv from
+ * lu_pivot_inplace().
+ *
+ * @sa signed_log_determinant(const matrix<E,AT,BO,L>&,int&)
+ */
+template<typename E, class AT, class BO, class L, class PivT> inline E
+signed_log_determinant(
+        const matrix<E,AT,BO,L>& LU, const PivT& piv, int& sign)
+{
+    return detail::SignedLogDeterminant(LU, piv, sign);
+}
+
+/** Logarithm of the determinant of a matrix.
+ *
+ * @throws std::invalid_argument if M is not square, or if its determinant
+ * is not positive.
+ *
+ * @sa signed_log_determinant
+ */
+template<typename E, class AT, class BO, class L> inline E
+log_determinant(const matrix<E,AT,BO,L>& M)
+{
+    int sign;
+    E logdet = detail::SignedLogDeterminant(M, sign);
+    return detail::PositiveLogDeterminant(logdet, sign);
+}
+
+/** Logarithm of the determinant of a matrix expression.
+ *
+ * @sa log_determinant(const matrix<E,AT,BO,L>&)
+ */
+template<typename XprT> inline typename XprT::value_type
+log_determinant(const et::MatrixXpr<XprT>& e)
+{
+    int sign;
+    typename XprT::value_type logdet = detail::SignedLogDeterminant(e, sign);
+    return detail::PositiveLogDeterminant(logdet, sign);
+}
+
+/** Logarithm of the determinant of A, given the factorization PA = LU and
+ * its row interchanges piv from lu_pivot_inplace().
+ *
+ * @sa log_determinant(const matrix<E,AT,BO,L>&)
+ */
+template<typename E, class AT, class BO, class L, class PivT> inline E
+log_determinant(const matrix<E,AT,BO,L>& LU, const PivT& piv)
+{
+    int sign;
+    E logdet = detail::SignedLogDeterminant(LU, piv, sign);
+    return detail::PositiveLogDeterminant(logdet, sign);
+}
+
 } // namespace cml
 
 #endif
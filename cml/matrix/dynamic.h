@@ -187,6 +187,29 @@ class matrix<Element,dynamic<Alloc>,BasisOrient,Layout>
     explicit matrix(size_t rows, size_t cols)
         : array_type(rows,cols) {}
 
+#if defined(CML_HAS_RVALUE_REFERENCES) \
+    && !defined(CML_USE_GENERATED_MATRIX_ASSIGN_OP)
+    /* Note: declaring these would delete the generated assignment. */
+
+    /** Move constructor, taking the array of m. */
+    matrix(matrix_type&& m) : array_type(std::move(m)) {}
+
+    /** Move assignment, taking the array of m if the result would have the
+     * size of m anyway, and m has an equal allocator (e.g. the same
+     * temp_arena).  Otherwise, m is copied as usual.
+     */
+    matrix_type& operator=(matrix_type&& m) {
+#if defined(CML_AUTOMATIC_MATRIX_RESIZE_ON_ASSIGNMENT)
+        bool take = true;
+#else
+        bool take = (this->size() == m.size());
+#endif
+        take = take && (this->get_allocator() == m.get_allocator());
+        if(take) { this->swap(m); return *this; }
+        return (*this = static_cast<const matrix_type&>(m));
+    }
+#endif
+
 
   public:
 
@@ -0,0 +1,460 @@
+/* -*- C++ -*- ------------------------------------------------------------
+ 
+Copyright (c) 2007 Jesse Anders and Demian Nave http://cmldev.net/
+
+The Configurable Math Library (CML) is distributed under the terms of the
+Boost Software License, v1.0 (see cml/LICENSE for details).
+
+ *-----------------------------------------------------------------------*/
+/** @file
+ *  @brief Eigenvalues and eigenvectors of symmetric matrices.
+ *
+ * eigen_symmetric(A,values,vectors) computes A = V diag(values) V^T for a
+ * symmetric matrix A, with the eigenvalues in ascending order and the
+ * orthonormal eigenvectors in the columns of V.  Only the lower triangle
+ * of A is read:
+ *
+ *   vector< double, fixed<3> > values;
+ *   matrix< double, fixed<3,3> > axes;
+ *   eigen_symmetric(inertia, values, axes);
+ *   eigen_symmetric(covariance, values);      // Eigenvalues only.
+ *
+ * Fixed-size matrices are diagonalized by cyclic Jacobi rotations in local
+ * arrays, without allocating; a 2x2 matrix takes a single rotation, and a
+ * 3x3 matrix a few sweeps.  The eigenvalues alone of a 3x3 matrix are
+ * found in closed form instead, unless two of them nearly coincide.
+ * Run-time sized matrices are reduced to tridiagonal form by Householder
+ * reflections, and then diagonalized by the implicit QL algorithm (tred2
+ * and tql2 from EISPACK).  When only the eigenvalues are wanted, the
+ * transformations are not accumulated.
+ */
+
+#ifndef eigen_symmetric_h
+#define eigen_symmetric_h
+
+#include <cmath>
+#include <limits>
+#include <algorithm>                // for std::swap
+#include <cml/et/size_checking.h>
+#include <cml/matrix/matrix_expr.h>
+
+namespace cml {
+namespace detail {
+
+/** Return sqrt(a*a + b*b) without overflow. */
+template<typename E> inline E
+EigenHypot(E a, E b)
+{
+    a = std::fabs(a); b = std::fabs(b);
+    if(a < b) std::swap(a,b);
+    if(a == E(0)) return E(0);
+    const E r = b/a;
+    return a*E(std::sqrt(E(1) + r*r));
+}
+
+/** Diagonalize the symmetric NxN array a by cyclic Jacobi rotations,
+ * accumulating them in v if vectors is true.
+ *
+ * An element a[p][q] is annihilated unless it is negligible next to
+ * a[p][p] and a[q][q], in which case it is set to zero; the iteration
+ * stops after a sweep with no rotations.  Returns false if that took more
+ * than max_sweeps sweeps.
+ */
+template<int N, typename E> struct EigenJacobi
+{
+    enum { max_sweeps = 32 };
+
+    static bool compute(E a[N][N], E v[N][N], bool vectors) {
+        const E eps = std::numeric_limits<E>::epsilon();
+        if(vectors) {
+            for(int i = 0; i < N; ++ i)
+                for(int j = 0; j < N; ++ j) v[i][j] = E(i == j);
+        }
+
+        for(int sweep = 0; sweep < max_sweeps; ++ sweep) {
+            bool rotated = false;
+            for(int p = 0; p < N-1; ++ p) {
+                for(int q = p+1; q < N; ++ q) {
+                    const E apq = a[p][q];
+                    const E app = a[p][p], aqq = a[q][q];
+                    if(std::fabs(apq) <=
+                            eps*E(.5)*(std::fabs(app) + std::fabs(aqq)))
+                    {
+                        a[p][q] = a[q][p] = E(0);
+                        continue;
+                    }
+                    rotated = true;
+
+                    /* The rotation annihilating a[p][q], with |t| <= 1; for
+                     * very large theta, t is 1/(2 theta) to working
+                     * precision:
+                     */
+                    const E theta = (aqq - app)/(E(2)*apq);
+                    const E at = std::fabs(theta);
+                    E t = (at < E(1)/eps)
+                        ? E(1)/(at + E(std::sqrt(at*at + E(1))))
+                        : E(.5)/at;
+                    if(theta < E(0)) t = -t;
+                    const E c = E(1)/E(std::sqrt(t*t + E(1))), s = t*c;
+
+                    a[p][p] = app - t*apq;
+                    a[q][q] = aqq + t*apq;
+                    a[p][q] = a[q][p] = E(0);
+                    for(int r = 0; r < N; ++ r) {
+                        if(r == p || r == q) continue;
+                        const E arp = a[r][p], arq = a[r][q];
+                        a[r][p] = a[p][r] = c*arp - s*arq;
+                        a[r][q] = a[q][r] = s*arp + c*arq;
+                    }
+                    if(vectors) {
+                        for(int r = 0; r < N; ++ r) {
+                            const E vrp = v[r][p], vrq = v[r][q];
+                            v[r][p] = c*vrp - s*vrq;
+                            v[r][q] = s*vrp + c*vrq;
+                        }
+                    }
+                }
+            }
+            if(!rotated) return true;
+        }
+        return false;
+    }
+};
+
+/** Eigenvalues of fixed-size matrices with a closed form, in ascending
+ * order.  There is none by default.
+ */
+template<int N, typename E> struct EigenClosedForm
+{
+    enum { is_true = false };
+    static bool compute(E (&)[N][N], E*) { return false; }
+};
+
+/** The eigenvalues of a symmetric 3x3 matrix are the roots of its
+ * characteristic cubic, found by the trigonometric method.  With
+ * B = (A - qI)/p for q the mean eigenvalue and 6p^2 = |A - qI|^2, the
+ * eigenvalues are q + 2p cos(phi + 2k pi/3), where cos(3 phi) = det(B)/2.
+ *
+ * Near a double eigenvalue, |det(B)/2| is near 1, where acos() turns the
+ * rounding error of det(B) into an error of order sqrt(epsilon) in the
+ * eigenvalues.  compute() returns false in that case, so that the Jacobi
+ * kernel is used instead.
+ */
+template<typename E> struct EigenClosedForm<3,E>
+{
+    enum { is_true = true };
+    static bool compute(E (&a)[3][3], E* d) {
+        const E p1 = a[0][1]*a[0][1] + a[0][2]*a[0][2] + a[1][2]*a[1][2];
+        const E q = (a[0][0] + a[1][1] + a[2][2])/E(3);
+        const E b00 = a[0][0] - q, b11 = a[1][1] - q, b22 = a[2][2] - q;
+        const E p2 = b00*b00 + b11*b11 + b22*b22 + E(2)*p1;
+        if(p2 == E(0)) {
+            d[0] = d[1] = d[2] = q;
+            return true;
+        }
+        const E p = E(std::sqrt(p2/E(6)));
+
+        /* det(A - qI)/(2p^3), clamped against rounding: */
+        E r = (b00*(b11*b22 - a[1][2]*a[1][2])
+            - a[0][1]*(a[0][1]*b22 - a[1][2]*a[0][2])
+            + a[0][2]*(a[0][1]*a[1][2] - b11*a[0][2]))/(E(2)*p*p*p);
+        if(E(1) - std::fabs(r) < E(std::sqrt(
+                    std::numeric_limits<E>::epsilon()))) return false;
+
+        const E phi = E(std::acos(r))/E(3);
+        const E two_pi_3 = E(2.09439510239319549230842892218633526);
+        d[2] = q + E(2)*p*E(std::cos(phi));
+        d[0] = q + E(2)*p*E(std::cos(phi + two_pi_3));
+        d[1] = E(3)*q - d[0] - d[2];
+        return true;
+    }
+};
+
+/** Reduce the symmetric matrix in the lower triangle of V to tridiagonal
+ * form by Householder reflections, leaving the diagonal in d and the
+ * subdiagonal in e[1..N-1].  If vectors is true, V is replaced by the
+ * orthogonal transformation; otherwise V is left holding the reflectors.
+ */
+template<class MatT, class VecT, class WorkT> inline void
+EigenTridiagonalize(MatT& V, VecT& d, WorkT& e, size_t N, bool vectors)
+{
+    typedef typename MatT::value_type value_type;
+    for(size_t j = 0; j < N; ++j) d[j] = V(N-1,j);
+
+    for(size_t i = N-1; i > 0; --i) {
+
+        /* Scale to avoid underflow and overflow: */
+        value_type scale = value_type(0), h = value_type(0);
+        for(size_t k = 0; k < i; ++k) scale += std::fabs(d[k]);
+        if(scale == value_type(0)) {
+            e[i] = d[i-1];
+            for(size_t j = 0; j < i; ++j) {
+                d[j] = V(i-1,j);
+                V(i,j) = V(j,i) = value_type(0);
+            }
+            d[i] = h;
+            continue;
+        }
+
+        /* Generate the Householder vector: */
+        for(size_t k = 0; k < i; ++k) {
+            d[k] /= scale;
+            h += d[k]*d[k];
+        }
+        value_type f = d[i-1], g = value_type(std::sqrt(h));
+        if(f > value_type(0)) g = -g;
+        e[i] = scale*g;
+        h -= f*g;
+        d[i-1] = f - g;
+        for(size_t j = 0; j < i; ++j) e[j] = value_type(0);
+
+        /* Apply the similarity transformation to the remaining columns: */
+        for(size_t j = 0; j < i; ++j) {
+            f = d[j];
+            V(j,i) = f;
+            g = e[j] + V(j,j)*f;
+            for(size_t k = j+1; k < i; ++k) {
+                g += V(k,j)*d[k];
+                e[k] += V(k,j)*f;
+            }
+            e[j] = g;
+        }
+        f = value_type(0);
+        for(size_t j = 0; j < i; ++j) {
+            e[j] /= h;
+            f += e[j]*d[j];
+        }
+        const value_type hh = f/(h + h);
+        for(size_t j = 0; j < i; ++j) e[j] -= hh*d[j];
+        for(size_t j = 0; j < i; ++j) {
+            f = d[j];
+            g = e[j];
+            for(size_t k = j; k < i; ++k) V(k,j) -= f*e[k] + g*d[k];
+            d[j] = V(i-1,j);
+            V(i,j) = value_type(0);
+        }
+        d[i] = h;
+    }
+
+    /* Without the eigenvectors, the diagonal is all that is needed: */
+    e[0] = value_type(0);
+    if(!vectors) {
+        for(size_t j = 0; j < N; ++j) d[j] = V(j,j);
+        return;
+    }
+
+    /* Accumulate the transformations: */
+    for(size_t i = 0; i+1 < N; ++i) {
+        V(N-1,i) = V(i,i);
+        V(i,i) = value_type(1);
+        const value_type h = d[i+1];
+        if(h != value_type(0)) {
+            for(size_t k = 0; k <= i; ++k) d[k] = V(k,i+1)/h;
+            for(size_t j = 0; j <= i; ++j) {
+                value_type g = value_type(0);
+                for(size_t k = 0; k <= i; ++k) g += V(k,i+1)*V(k,j);
+                for(size_t k = 0; k <= i; ++k) V(k,j) -= g*d[k];
+            }
+        }
+        for(size_t k = 0; k <= i; ++k) V(k,i+1) = value_type(0);
+    }
+    for(size_t j = 0; j < N; ++j) {
+        d[j] = V(N-1,j);
+        V(N-1,j) = value_type(0);
+    }
+    V(N-1,N-1) = value_type(1);
+}
+
+/** Diagonalize the symmetric tridiagonal matrix with diagonal d and
+ * subdiagonal e[1..N-1] by the implicit QL algorithm, applying the
+ * rotations to the columns of V if vectors is true.
+ *
+ * Returns false if an eigenvalue needed more than 30 iterations.
+ */
+template<class MatT, class VecT, class WorkT> inline bool
+EigenTridiagonalQL(MatT& V, VecT& d, WorkT& e, size_t N, bool vectors)
+{
+    typedef typename MatT::value_type value_type;
+    const value_type eps = std::numeric_limits<value_type>::epsilon();
+    if(N == 0) return true;
+    for(size_t i = 1; i < N; ++i) e[i-1] = e[i];
+    e[N-1] = value_type(0);
+
+    value_type f = value_type(0), tst1 = value_type(0);
+    for(size_t l = 0; l < N; ++l) {
+
+        /* Find a negligible subdiagonal element: */
+        tst1 = std::max(tst1, value_type(std::fabs(d[l]) + std::fabs(e[l])));
+        size_t m = l;
+        while(m < N-1 && std::fabs(e[m]) > eps*tst1) ++m;
+
+        /* Unless d[l] is already an eigenvalue, iterate: */
+        for(int iter = 0; m > l && std::fabs(e[l]) > eps*tst1; ++iter) {
+            if(iter == 30) return false;
+
+            /* Compute the implicit shift: */
+            value_type g = d[l];
+            value_type p = (d[l+1] - g)/(value_type(2)*e[l]);
+            value_type r = EigenHypot(p, value_type(1));
+            if(p < value_type(0)) r = -r;
+            d[l] = e[l]/(p + r);
+            d[l+1] = e[l]*(p + r);
+            const value_type dl1 = d[l+1];
+            value_type h = g - d[l];
+            for(size_t i = l+2; i < N; ++i) d[i] -= h;
+            f += h;
+
+            /* Implicit QL transformation: */
+            p = d[m];
+            value_type c = value_type(1), c2 = c, c3 = c;
+            value_type s = value_type(0), s2 = value_type(0);
+            const value_type el1 = e[l+1];
+            for(size_t i = m; i-- > l; ) {
+                c3 = c2;
+                c2 = c;
+                s2 = s;
+                g = c*e[i];
+                h = c*p;
+                r = EigenHypot(p, e[i]);
+                e[i+1] = s*r;
+                s = e[i]/r;
+                c = p/r;
+                p = c*d[i] - s*g;
+                d[i+1] = h + s*(c*g + s*d[i]);
+                if(vectors) {
+                    for(size_t k = 0; k < N; ++k) {
+                        h = V(k,i+1);
+                        V(k,i+1) = s*V(k,i) + c*h;
+                        V(k,i) = c*V(k,i) - s*h;
+                    }
+                }
+            }
+            p = -s*s2*c3*el1*e[l]/dl1;
+            e[l] = s*p;
+            d[l] = c*p;
+        }
+        d[l] += f;
+        e[l] = value_type(0);
+    }
+    return true;
+}
+
+/** Sort the eigenvalues into ascending order, along with the columns of V
+ * if vectors is true.
+ */
+template<class VecT, class MatT> inline void
+EigenSort(VecT& d, MatT& V, size_t N, bool vectors)
+{
+    for(size_t i = 0; i+1 < N; ++i) {
+        size_t k = i;
+        for(size_t j = i+1; j < N; ++j) if(d[j] < d[k]) k = j;
+        if(k == i) continue;
+        std::swap(d[i], d[k]);
+        if(vectors) {
+            for(size_t j = 0; j < N; ++j) std::swap(V(j,i), V(j,k));
+        }
+    }
+}
+
+/** Fixed-size matrices are diagonalized by Jacobi rotations. */
+template<typename E, class AT, typename BO, typename L,
+    class VecT, class MatT> inline bool
+EigenSymmetric(const matrix<E,AT,BO,L>& A, VecT& d, MatT& V, bool vectors,
+        fixed_size_tag)
+{
+    enum { N = matrix<E,AT,BO,L>::array_rows };
+    E a[N][N], v[N][N];
+    for(int i = 0; i < N; ++ i)
+        for(int j = 0; j <= i; ++ j) a[i][j] = a[j][i] = A(i,j);
+    cml::et::detail::ResizeUninitialized(d, N);
+
+    /* Use the closed form for the eigenvalues alone, if there is one: */
+    E w[N];
+    if(!vectors && EigenClosedForm<N,E>::is_true
+            && EigenClosedForm<N,E>::compute(a, w))
+    {
+        for(int i = 0; i < N; ++ i) d[i] = w[i];
+        return true;
+    }
+
+    const bool converged = EigenJacobi<N,E>::compute(a, v, vectors);
+    for(int i = 0; i < N; ++ i) d[i] = a[i][i];
+    if(vectors) {
+        cml::et::detail::ResizeUninitialized(V, N, N);
+        for(int i = 0; i < N; ++ i)
+            for(int j = 0; j < N; ++ j) V(i,j) = v[i][j];
+    }
+    EigenSort(d, V, N, vectors);
+    return converged;
+}
+
+/** Run-time sized matrices are tridiagonalized, and then diagonalized by
+ * the implicit QL algorithm.  V is used as the work array.
+ */
+template<typename E, class AT, typename BO, typename L,
+    class VecT, class MatT> inline bool
+EigenSymmetric(const matrix<E,AT,BO,L>& A, VecT& d, MatT& V, bool vectors,
+        dynamic_size_tag)
+{
+    const size_t N = A.rows();
+    cml::et::detail::ResizeUninitialized(d, N);
+    cml::et::detail::ResizeUninitialized(V, N, N);
+    for(size_t i = 0; i < N; ++i)
+        for(size_t j = 0; j <= i; ++j) V(i,j) = A(i,j);
+    if(N == 0) return true;
+
+    typename matrix<E,AT,BO,L>::temporary_type::col_vector_type e;
+    cml::et::detail::ResizeUninitialized(e, N);
+    EigenTridiagonalize(V, d, e, N, vectors);
+    const bool converged = EigenTridiagonalQL(V, d, e, N, vectors);
+    EigenSort(d, V, N, vectors);
+    return converged;
+}
+
+} // namespace detail
+
+/** Compute the eigenvalues and eigenvectors of the symmetric matrix A.
+ *
+ * values is resized to N and receives the eigenvalues in ascending order;
+ * vectors is resized to NxN and receives the corresponding orthonormal
+ * eigenvectors in its columns, so that A = vectors * diag(values) *
+ * transpose(vectors).  Only the lower triangle of A is read.
+ *
+ * @returns false if the iteration did not converge, which should not
+ * happen for finite A.
+ *
+ * @throws std::invalid_argument if A is not square.
+ */
+template<typename E, class AT, typename BO, typename L,
+    class VecT, class MatT> inline bool
+eigen_symmetric(const matrix<E,AT,BO,L>& A, VecT& values, MatT& vectors)
+{
+    typedef typename matrix<E,AT,BO,L>::size_tag size_tag;
+    cml::et::CheckedSquare(A, size_tag());
+    return detail::EigenSymmetric(A, values, vectors, true, size_tag());
+}
+
+/** Compute only the eigenvalues of the symmetric matrix A, in ascending
+ * order.  This skips accumulating the transformations, which is most of
+ * the work for run-time sized matrices.
+ *
+ * @returns false if the iteration did not converge.
+ *
+ * @throws std::invalid_argument if A is not square.
+ */
+template<typename E, class AT, typename BO, typename L, class VecT>
+inline bool
+eigen_symmetric(const matrix<E,AT,BO,L>& A, VecT& values)
+{
+    typedef typename matrix<E,AT,BO,L>::size_tag size_tag;
+    cml::et::CheckedSquare(A, size_tag());
+    typename matrix<E,AT,BO,L>::temporary_type work;
+    return detail::EigenSymmetric(A, values, work, false, size_tag());
+}
+
+} // namespace cml
+
+#endif
+
+// -------------------------------------------------------------------------
+// vim:ft=cpp
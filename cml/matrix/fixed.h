@@ -20,19 +20,21 @@ Boost Software License, v1.0 (see cml/LICENSE for details).
 
 namespace cml {
 
-/** Fixed-size, fixed-memory matrix. */
+/** Fixed-size, fixed-memory matrix, aligned to Align bytes (0 for the
+ * natural alignment of Element).
+ */
 template<typename Element, int Rows, int Cols,
-    typename BasisOrient, typename Layout>
-class matrix<Element,fixed<Rows,Cols>,BasisOrient,Layout>
-: public fixed_2D<Element,Rows,Cols,Layout>
+    typename BasisOrient, typename Layout, int Align>
+class matrix<Element,fixed<Rows,Cols,Align>,BasisOrient,Layout>
+: public fixed_2D<Element,Rows,Cols,Layout,Align>
 {
   public:
 
     /* Shorthand for the generator: */
-    typedef fixed<Rows,Cols> generator_type;
+    typedef fixed<Rows,Cols,Align> generator_type;
 
     /* Shorthand for the array type: */
-    typedef fixed_2D<Element,Rows,Cols,Layout> array_type;
+    typedef fixed_2D<Element,Rows,Cols,Layout,Align> array_type;
 
     /* Shorthand for the type of this matrix: */
     typedef matrix<Element,generator_type,BasisOrient,Layout> matrix_type;
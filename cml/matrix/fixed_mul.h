@@ -0,0 +1,203 @@
+/* -*- C++ -*- ------------------------------------------------------------
+ 
+Copyright (c) 2007 Jesse Anders and Demian Nave http://cmldev.net/
+
+The Configurable Math Library (CML) is distributed under the terms of the
+Boost Software License, v1.0 (see cml/LICENSE for details).
+
+ *-----------------------------------------------------------------------*/
+/** @file
+ *  @brief Unrolled and SIMD kernels for products of fixed-size matrices.
+ *
+ * The kernels work directly on the arrays of the operands, with all of the
+ * sizes and layouts known at compile time.  When the result is row-major
+ * with 4 columns (e.g. 4x4 or 3x4) and the right-hand operand is row-major,
+ * each row of the result is computed as a sum of rows of the right-hand
+ * operand, scaled by elements of the left-hand one.  This maps directly
+ * onto 4-wide SSE registers for float, and onto AVX (or pairs of SSE2)
+ * registers for double.  The col-major case is handled the same way, with
+ * the roles of the operands swapped.  All other products use a scalar
+ * kernel that the compiler can fully unroll.
+ *
+ * @note The SIMD kernels sum in the same order as the scalar ones, and do
+ * not use fused multiply-adds, so they give the same results.
+ *
+ * @sa cml/core/simd.h
+ */
+
+#ifndef fixed_mul_h
+#define fixed_mul_h
+
+#include <cml/core/common.h>
+#include <cml/core/simd.h>
+
+namespace cml {
+namespace detail {
+
+/** Index of element (i,j) of a fixed-size RxC array with layout L. */
+template<int R, int C, class L> struct FixedElement;
+
+/** Index of element (i,j) of a row-major RxC array. */
+template<int R, int C> struct FixedElement<R,C,row_major> {
+    static size_t at(size_t i, size_t j) { return i*C + j; }
+};
+
+/** Index of element (i,j) of a col-major RxC array. */
+template<int R, int C> struct FixedElement<R,C,col_major> {
+    static size_t at(size_t i, size_t j) { return j*R + i; }
+};
+
+/** Index of element (i,j) of the transpose of an array. */
+template<class Index> struct FixedTransposed {
+    static size_t at(size_t i, size_t j) { return Index::at(j,i); }
+};
+
+/** Scalar kernel for c = a x b, where a is MxK and b is KxN.
+ *
+ * The indexing of c, a and b is given by CIndex, AIndex and BIndex.  The
+ * loop bounds are constants, so the compiler can unroll the loops.
+ */
+template<int M, int K, int N, class CIndex, class AIndex, class BIndex>
+struct MatMulFixedScalar
+{
+    template<typename E> static void compute(E* c, const E* a, const E* b) {
+        for(int i = 0; i < M; ++ i) {
+            for(int j = 0; j < N; ++ j) {
+                E sum = a[AIndex::at(i,0)]*b[BIndex::at(0,j)];
+                for(int k = 1; k < K; ++ k)
+                    sum += a[AIndex::at(i,k)]*b[BIndex::at(k,j)];
+                c[CIndex::at(i,j)] = sum;
+            }
+        }
+    }
+};
+
+/** Kernel for a row-major Mx4 c = a x b, where b is a row-major Kx4
+ * array, and a is an MxK array indexed by AIndex.
+ *
+ * Row i of c is the sum over k of a(i,k) times row k of b.  This is the
+ * scalar version, for element types without a SIMD kernel.
+ */
+template<int M, int K, class AIndex>
+struct MatMulFixedRows4
+{
+    typedef FixedElement<M,4,row_major> c_index;
+    typedef FixedElement<K,4,row_major> b_index;
+
+    template<typename E> static void compute(E* c, const E* a, const E* b) {
+        MatMulFixedScalar<M,K,4,c_index,AIndex,b_index>::compute(c,a,b);
+    }
+
+#if defined(CML_SIMD_SSE)
+    /** SSE kernel for float, keeping all of b in registers. */
+    static void compute(float* c, const float* a, const float* b) {
+        __m128 brow[K];
+        for(int k = 0; k < K; ++ k) brow[k] = _mm_loadu_ps(b + 4*k);
+        for(int i = 0; i < M; ++ i) {
+            __m128 r = _mm_mul_ps(_mm_set1_ps(a[AIndex::at(i,0)]), brow[0]);
+            for(int k = 1; k < K; ++ k)
+                r = _mm_add_ps(r,
+                        _mm_mul_ps(_mm_set1_ps(a[AIndex::at(i,k)]), brow[k]));
+            _mm_storeu_ps(c + 4*i, r);
+        }
+    }
+#endif
+
+#if defined(CML_SIMD_AVX)
+    /** AVX kernel for double, keeping all of b in registers. */
+    static void compute(double* c, const double* a, const double* b) {
+        __m256d brow[K];
+        for(int k = 0; k < K; ++ k) brow[k] = _mm256_loadu_pd(b + 4*k);
+        for(int i = 0; i < M; ++ i) {
+            __m256d r = _mm256_mul_pd(
+                    _mm256_set1_pd(a[AIndex::at(i,0)]), brow[0]);
+            for(int k = 1; k < K; ++ k)
+                r = _mm256_add_pd(r, _mm256_mul_pd(
+                            _mm256_set1_pd(a[AIndex::at(i,k)]), brow[k]));
+            _mm256_storeu_pd(c + 4*i, r);
+        }
+    }
+#elif defined(CML_SIMD_SSE2)
+    /** SSE2 kernel for double, with each row of b in two registers. */
+    static void compute(double* c, const double* a, const double* b) {
+        __m128d blo[K], bhi[K];
+        for(int k = 0; k < K; ++ k) {
+            blo[k] = _mm_loadu_pd(b + 4*k);
+            bhi[k] = _mm_loadu_pd(b + 4*k + 2);
+        }
+        for(int i = 0; i < M; ++ i) {
+            __m128d s = _mm_set1_pd(a[AIndex::at(i,0)]);
+            __m128d lo = _mm_mul_pd(s, blo[0]), hi = _mm_mul_pd(s, bhi[0]);
+            for(int k = 1; k < K; ++ k) {
+                s = _mm_set1_pd(a[AIndex::at(i,k)]);
+                lo = _mm_add_pd(lo, _mm_mul_pd(s, blo[k]));
+                hi = _mm_add_pd(hi, _mm_mul_pd(s, bhi[k]));
+            }
+            _mm_storeu_pd(c + 4*i, lo);
+            _mm_storeu_pd(c + 4*i + 2, hi);
+        }
+    }
+#endif
+};
+
+/** Compute c = a x b for an MxK a and a KxN b, with layouts LC, LA and LB.
+ *
+ * This is the general case, which uses the unrolled scalar kernel.
+ */
+template<int M, int K, int N, class LC, class LA, class LB>
+struct MatMulFixed
+{
+    template<typename E> static void compute(E* c, const E* a, const E* b) {
+        MatMulFixedScalar<M,K,N,
+            FixedElement<M,N,LC>, FixedElement<M,K,LA>, FixedElement<K,N,LB>
+        >::compute(c,a,b);
+    }
+};
+
+/** Row-major Mx4 results with a row-major right-hand side. */
+template<int M, int K, class LA>
+struct MatMulFixed<M,K,4,row_major,LA,row_major>
+{
+    template<typename E> static void compute(E* c, const E* a, const E* b) {
+        MatMulFixedRows4<M,K,FixedElement<M,K,LA> >::compute(c,a,b);
+    }
+};
+
+/** Col-major 4xN results with a col-major left-hand side.
+ *
+ * A col-major 4xN array is laid out like a row-major Nx4 array, so this
+ * computes the transposed product, c' = b' x a', using the row kernel.
+ */
+template<int K, int N, class LB>
+struct MatMulFixed<4,K,N,col_major,col_major,LB>
+{
+    template<typename E> static void compute(E* c, const E* a, const E* b) {
+        MatMulFixedRows4<N,K,
+            FixedTransposed< FixedElement<K,N,LB> > >::compute(c,b,a);
+    }
+};
+
+/** Row-major 4x4 results with col-major operands.
+ *
+ * This is what col-major 4x4 operands produce when the result is promoted
+ * to the default layout.  The product is computed col-major with the row
+ * kernel, and then transposed into c.
+ */
+template<int K>
+struct MatMulFixed<4,K,4,row_major,col_major,col_major>
+{
+    template<typename E> static void compute(E* c, const E* a, const E* b) {
+        E t[16];
+        MatMulFixed<4,K,4,col_major,col_major,col_major>::compute(t,a,b);
+        for(int i = 0; i < 4; ++ i)
+            for(int j = 0; j < 4; ++ j) c[i*4+j] = t[j*4+i];
+    }
+};
+
+} // namespace detail
+} // namespace cml
+
+#endif
+
+// -------------------------------------------------------------------------
+// vim:ft=cpp
@@ -7,14 +7,30 @@ Boost Software License, v1.0 (see cml/LICENSE for details).
 
  *-----------------------------------------------------------------------*/
 /** @file
- *  @brief Compute the inverse of a matrix by LU factorization.
+ *  @brief Compute the inverse of a matrix.
+ *
+ * 2x2, 3x3 and 4x4 matrices are inverted by their cofactors.  Larger ones
+ * are inverted by Gauss-Jordan elimination with partial pivoting, with an
+ * unrolled kernel for fixed sizes up to 8x8, and a blocked one that does
+ * most of its work in the matrix product kernel otherwise:
+ *
+ *   B = inverse(A);                    // Throws if A is singular.
+ *   if(!inverse_inplace(A)) ...        // Reports a singular A instead.
  */
 
 #ifndef matrix_inverse_h
 #define matrix_inverse_h
 
-#include <vector>
+#include <cmath>
+#include <algorithm>                // for std::swap
+#include <stdexcept>
 #include <cml/matrix/lu.h>
+#include <cml/matrix/matrix_mul.h>
+
+/* This is used below to create a more meaningful compile-time error when
+ * inverse_inplace is given a packed or banded matrix:
+ */
+struct inverse_inplace_expects_a_general_matrix_error;
 
 namespace cml {
 namespace detail {
@@ -40,7 +56,7 @@ struct inverse_f<MatT,2>
 
         /* Matrix containing the inverse: */
         temporary_type Z;
-        cml::et::detail::Resize(Z,2,2);
+        cml::et::detail::ResizeUninitialized(Z,2,2);
 
         /* Compute determinant and inverse: */
         value_type D = value_type(1) / (M(0,0)*M(1,1) - M(0,1)*M(1,0));
@@ -51,47 +67,162 @@ struct inverse_f<MatT,2>
     }
 };
 
+/** Compute the inverse z of the 3x3 matrix m from its cofactors.  V is
+ * the element type, or a SIMD packet of the same element of several
+ * matrices (see cml/matrix/batch.h), so each operation must be written
+ * the same way for both:
+ *
+ *     [00 01 02]
+ * m = [10 11 12]
+ *     [20 21 22]
+ */
+template<typename V> inline void
+Inverse3x3(const V (&m)[3][3], V (&z)[3][3])
+{
+    /* Compute cofactors for each entry: */
+    V m_00 = m[1][1]*m[2][2] - m[1][2]*m[2][1];
+    V m_01 = m[1][2]*m[2][0] - m[1][0]*m[2][2];
+    V m_02 = m[1][0]*m[2][1] - m[1][1]*m[2][0];
+
+    V m_10 = m[0][2]*m[2][1] - m[0][1]*m[2][2];
+    V m_11 = m[0][0]*m[2][2] - m[0][2]*m[2][0];
+    V m_12 = m[0][1]*m[2][0] - m[0][0]*m[2][1];
+
+    V m_20 = m[0][1]*m[1][2] - m[0][2]*m[1][1];
+    V m_21 = m[0][2]*m[1][0] - m[0][0]*m[1][2];
+    V m_22 = m[0][0]*m[1][1] - m[0][1]*m[1][0];
+
+    /* Compute determinant from the minors: */
+    V D = V(1) / (m[0][0]*m_00 + m[0][1]*m_01 + m[0][2]*m_02);
+
+    /* Assign the inverse as (1/D) * (cofactor matrix)^T: */
+    z[0][0] = m_00*D;  z[0][1] = m_10*D;  z[0][2] = m_20*D;
+    z[1][0] = m_01*D;  z[1][1] = m_11*D;  z[1][2] = m_21*D;
+    z[2][0] = m_02*D;  z[2][1] = m_12*D;  z[2][2] = m_22*D;
+}
+
+/** Compute the inverse z of the 4x4 matrix m from its cofactors, with V
+ * as for Inverse3x3():
+ *
+ *     [00 01 02 03]
+ * m = [10 11 12 13]
+ *     [20 21 22 23]
+ *     [30 31 32 33]
+ *
+ *       |11 12 13|         |10 12 13|
+ * C00 = |21 22 23|   C01 = |20 22 23|
+ *       |31 32 33|         |30 32 33|
+ *
+ *       |10 11 13|         |10 11 12|
+ * C02 = |20 21 23|   C03 = |20 21 22|
+ *       |30 31 33|         |30 31 32|
+ */
+template<typename V> inline void
+Inverse4x4(const V (&m)[4][4], V (&z)[4][4])
+{
+    /* Common cofactors, rows 0,1: */
+    V m_22_33_23_32 = m[2][2]*m[3][3] - m[2][3]*m[3][2];
+    V m_23_30_20_33 = m[2][3]*m[3][0] - m[2][0]*m[3][3];
+    V m_20_31_21_30 = m[2][0]*m[3][1] - m[2][1]*m[3][0];
+    V m_21_32_22_31 = m[2][1]*m[3][2] - m[2][2]*m[3][1];
+    V m_23_31_21_33 = m[2][3]*m[3][1] - m[2][1]*m[3][3];
+    V m_20_32_22_30 = m[2][0]*m[3][2] - m[2][2]*m[3][0];
+
+    /* Compute minors: */
+    V d00
+        = m[1][1]*m_22_33_23_32+m[1][2]*m_23_31_21_33+m[1][3]*m_21_32_22_31;
+
+    V d01
+        = m[1][0]*m_22_33_23_32+m[1][2]*m_23_30_20_33+m[1][3]*m_20_32_22_30;
+
+    V d02
+        = m[1][0]*-m_23_31_21_33+m[1][1]*m_23_30_20_33+m[1][3]*m_20_31_21_30;
+
+    V d03
+        = m[1][0]*m_21_32_22_31+m[1][1]*-m_20_32_22_30+m[1][2]*m_20_31_21_30;
+
+    /* Compute minors: */
+    V d10
+        = m[0][1]*m_22_33_23_32+m[0][2]*m_23_31_21_33+m[0][3]*m_21_32_22_31;
+
+    V d11
+        = m[0][0]*m_22_33_23_32+m[0][2]*m_23_30_20_33+m[0][3]*m_20_32_22_30;
+
+    V d12
+        = m[0][0]*-m_23_31_21_33+m[0][1]*m_23_30_20_33+m[0][3]*m_20_31_21_30;
+
+    V d13
+        = m[0][0]*m_21_32_22_31+m[0][1]*-m_20_32_22_30+m[0][2]*m_20_31_21_30;
+
+    /* Common cofactors, rows 2,3: */
+    V m_02_13_03_12 = m[0][2]*m[1][3] - m[0][3]*m[1][2];
+    V m_03_10_00_13 = m[0][3]*m[1][0] - m[0][0]*m[1][3];
+    V m_00_11_01_10 = m[0][0]*m[1][1] - m[0][1]*m[1][0];
+    V m_01_12_02_11 = m[0][1]*m[1][2] - m[0][2]*m[1][1];
+    V m_03_11_01_13 = m[0][3]*m[1][1] - m[0][1]*m[1][3];
+    V m_00_12_02_10 = m[0][0]*m[1][2] - m[0][2]*m[1][0];
+
+    /* Compute minors (uses row 3 as the multipliers instead of row 0,
+     * which uses the same signs as row 0):
+     */
+    V d20
+        = m[3][1]*m_02_13_03_12+m[3][2]*m_03_11_01_13+m[3][3]*m_01_12_02_11;
+
+    V d21
+        = m[3][0]*m_02_13_03_12+m[3][2]*m_03_10_00_13+m[3][3]*m_00_12_02_10;
+
+    V d22
+        = m[3][0]*-m_03_11_01_13+m[3][1]*m_03_10_00_13+m[3][3]*m_00_11_01_10;
+
+    V d23
+        = m[3][0]*m_01_12_02_11+m[3][1]*-m_00_12_02_10+m[3][2]*m_00_11_01_10;
+
+    /* Compute minors: */
+    V d30
+        = m[2][1]*m_02_13_03_12+m[2][2]*m_03_11_01_13+m[2][3]*m_01_12_02_11;
+
+    V d31
+        = m[2][0]*m_02_13_03_12+m[2][2]*m_03_10_00_13+m[2][3]*m_00_12_02_10;
+
+    V d32
+        = m[2][0]*-m_03_11_01_13+m[2][1]*m_03_10_00_13+m[2][3]*m_00_11_01_10;
+
+    V d33
+        = m[2][0]*m_01_12_02_11+m[2][1]*-m_00_12_02_10+m[2][2]*m_00_11_01_10;
+
+    /* Finally, compute determinant from the minors, and assign the
+     * inverse as (1/D) * (cofactor matrix)^T:
+     */
+    V D = V(1) /
+        (m[0][0]*d00 - m[0][1]*d01 + m[0][2]*d02 - m[0][3]*d03);
+    z[0][0] = +d00*D; z[0][1] = -d10*D; z[0][2] = +d20*D; z[0][3] = -d30*D;
+    z[1][0] = -d01*D; z[1][1] = +d11*D; z[1][2] = -d21*D; z[1][3] = +d31*D;
+    z[2][0] = +d02*D; z[2][1] = -d12*D; z[2][2] = +d22*D; z[2][3] = -d32*D;
+    z[3][0] = -d03*D; z[3][1] = +d13*D; z[3][2] = -d23*D; z[3][3] = +d33*D;
+}
+
 /* 3x3 inverse.  Despite being marked for fixed_size matrices, this can
  * be used for dynamic-sized ones also:
  */
 template<typename MatT>
 struct inverse_f<MatT,3>
 {
-    /*     [00 01 02]
-     * M = [10 11 12]
-     *     [20 21 22]
-     */
     typename MatT::temporary_type operator()(const MatT& M) const
     {
         /* Shorthand. */
         typedef typename MatT::value_type value_type;
 
-        /* Compute cofactors for each entry: */
-        value_type m_00 = M(1,1)*M(2,2) - M(1,2)*M(2,1);
-        value_type m_01 = M(1,2)*M(2,0) - M(1,0)*M(2,2);
-        value_type m_02 = M(1,0)*M(2,1) - M(1,1)*M(2,0);
-
-        value_type m_10 = M(0,2)*M(2,1) - M(0,1)*M(2,2);
-        value_type m_11 = M(0,0)*M(2,2) - M(0,2)*M(2,0);
-        value_type m_12 = M(0,1)*M(2,0) - M(0,0)*M(2,1);
-
-        value_type m_20 = M(0,1)*M(1,2) - M(0,2)*M(1,1);
-        value_type m_21 = M(0,2)*M(1,0) - M(0,0)*M(1,2);
-        value_type m_22 = M(0,0)*M(1,1) - M(0,1)*M(1,0);
-
-        /* Compute determinant from the minors: */
-        value_type D =
-            value_type(1) / (M(0,0)*m_00 + M(0,1)*m_01 + M(0,2)*m_02);
+        /* Invert a copy in a local array: */
+        value_type m[3][3], z[3][3];
+        for(int i = 0; i < 3; ++ i)
+            for(int j = 0; j < 3; ++ j) m[i][j] = M(i,j);
+        Inverse3x3(m, z);
 
         /* Matrix containing the inverse: */
         typename MatT::temporary_type Z;
-        cml::et::detail::Resize(Z,3,3);
-
-        /* Assign the inverse as (1/D) * (cofactor matrix)^T: */
-        Z(0,0) = m_00*D;  Z(0,1) = m_10*D;  Z(0,2) = m_20*D;
-        Z(1,0) = m_01*D;  Z(1,1) = m_11*D;  Z(1,2) = m_21*D;
-        Z(2,0) = m_02*D;  Z(2,1) = m_12*D;  Z(2,2) = m_22*D;
-
+        cml::et::detail::ResizeUninitialized(Z,3,3);
+        for(int i = 0; i < 3; ++ i)
+            for(int j = 0; j < 3; ++ j) Z(i,j) = z[i][j];
         return Z;
     }
 };
@@ -102,267 +233,239 @@ struct inverse_f<MatT,3>
 template<typename MatT>
 struct inverse_f<MatT,4>
 {
-    /*     [00 01 02 03]
-     * M = [10 11 12 13]
-     *     [20 21 22 23]
-     *     [30 31 32 33]
-     *
-     *       |11 12 13|         |10 12 13|
-     * C00 = |21 22 23|   C01 = |20 22 23|
-     *       |31 32 33|         |30 32 33|
-     *
-     *       |10 11 13|         |10 11 12|
-     * C02 = |20 21 23|   C03 = |20 21 22|
-     *       |30 31 33|         |30 31 32|
-     */
     typename MatT::temporary_type operator()(const MatT& M) const
     {
         /* Shorthand. */
         typedef typename MatT::value_type value_type;
 
-        /* Common cofactors, rows 0,1: */
-        value_type m_22_33_23_32 = M(2,2)*M(3,3) - M(2,3)*M(3,2);
-        value_type m_23_30_20_33 = M(2,3)*M(3,0) - M(2,0)*M(3,3);
-        value_type m_20_31_21_30 = M(2,0)*M(3,1) - M(2,1)*M(3,0);
-        value_type m_21_32_22_31 = M(2,1)*M(3,2) - M(2,2)*M(3,1);
-        value_type m_23_31_21_33 = M(2,3)*M(3,1) - M(2,1)*M(3,3);
-        value_type m_20_32_22_30 = M(2,0)*M(3,2) - M(2,2)*M(3,0);
-
-        /* Compute minors: */
-        value_type d00
-            = M(1,1)*m_22_33_23_32+M(1,2)*m_23_31_21_33+M(1,3)*m_21_32_22_31;
-
-        value_type d01
-            = M(1,0)*m_22_33_23_32+M(1,2)*m_23_30_20_33+M(1,3)*m_20_32_22_30;
-
-        value_type d02
-            = M(1,0)*-m_23_31_21_33+M(1,1)*m_23_30_20_33+M(1,3)*m_20_31_21_30;
+        /* Invert a copy in a local array: */
+        value_type m[4][4], z[4][4];
+        for(int i = 0; i < 4; ++ i)
+            for(int j = 0; j < 4; ++ j) m[i][j] = M(i,j);
+        Inverse4x4(m, z);
 
-        value_type d03
-            = M(1,0)*m_21_32_22_31+M(1,1)*-m_20_32_22_30+M(1,2)*m_20_31_21_30;
-
-        /* Compute minors: */
-        value_type d10
-            = M(0,1)*m_22_33_23_32+M(0,2)*m_23_31_21_33+M(0,3)*m_21_32_22_31;
-
-        value_type d11
-            = M(0,0)*m_22_33_23_32+M(0,2)*m_23_30_20_33+M(0,3)*m_20_32_22_30;
-
-        value_type d12
-            = M(0,0)*-m_23_31_21_33+M(0,1)*m_23_30_20_33+M(0,3)*m_20_31_21_30;
-
-        value_type d13
-            = M(0,0)*m_21_32_22_31+M(0,1)*-m_20_32_22_30+M(0,2)*m_20_31_21_30;
-
-        /* Common cofactors, rows 2,3: */
-        value_type m_02_13_03_12 = M(0,2)*M(1,3) - M(0,3)*M(1,2);
-        value_type m_03_10_00_13 = M(0,3)*M(1,0) - M(0,0)*M(1,3);
-        value_type m_00_11_01_10 = M(0,0)*M(1,1) - M(0,1)*M(1,0);
-        value_type m_01_12_02_11 = M(0,1)*M(1,2) - M(0,2)*M(1,1);
-        value_type m_03_11_01_13 = M(0,3)*M(1,1) - M(0,1)*M(1,3);
-        value_type m_00_12_02_10 = M(0,0)*M(1,2) - M(0,2)*M(1,0);
-
-        /* Compute minors (uses row 3 as the multipliers instead of row 0,
-         * which uses the same signs as row 0):
-         */
-        value_type d20
-            = M(3,1)*m_02_13_03_12+M(3,2)*m_03_11_01_13+M(3,3)*m_01_12_02_11;
-
-        value_type d21
-            = M(3,0)*m_02_13_03_12+M(3,2)*m_03_10_00_13+M(3,3)*m_00_12_02_10;
-
-        value_type d22
-            = M(3,0)*-m_03_11_01_13+M(3,1)*m_03_10_00_13+M(3,3)*m_00_11_01_10;
-
-        value_type d23
-            = M(3,0)*m_01_12_02_11+M(3,1)*-m_00_12_02_10+M(3,2)*m_00_11_01_10;
-
-        /* Compute minors: */
-        value_type d30
-            = M(2,1)*m_02_13_03_12+M(2,2)*m_03_11_01_13+M(2,3)*m_01_12_02_11;
-
-        value_type d31
-            = M(2,0)*m_02_13_03_12+M(2,2)*m_03_10_00_13+M(2,3)*m_00_12_02_10;
-
-        value_type d32
-            = M(2,0)*-m_03_11_01_13+M(2,1)*m_03_10_00_13+M(2,3)*m_00_11_01_10;
-
-        value_type d33
-            = M(2,0)*m_01_12_02_11+M(2,1)*-m_00_12_02_10+M(2,2)*m_00_11_01_10;
-
-        /* Finally, compute determinant from the minors, and assign the
-         * inverse as (1/D) * (cofactor matrix)^T:
-         */
+        /* Matrix containing the inverse: */
         typename MatT::temporary_type Z;
-        cml::et::detail::Resize(Z,4,4);
-
-        value_type D = value_type(1) /
-            (M(0,0)*d00 - M(0,1)*d01 + M(0,2)*d02 - M(0,3)*d03);
-        Z(0,0) = +d00*D; Z(0,1) = -d10*D; Z(0,2) = +d20*D; Z(0,3) = -d30*D;
-        Z(1,0) = -d01*D; Z(1,1) = +d11*D; Z(1,2) = -d21*D; Z(1,3) = +d31*D;
-        Z(2,0) = +d02*D; Z(2,1) = -d12*D; Z(2,2) = +d22*D; Z(2,3) = -d32*D;
-        Z(3,0) = -d03*D; Z(3,1) = +d13*D; Z(3,2) = -d23*D; Z(3,3) = +d33*D;
-
+        cml::et::detail::ResizeUninitialized(Z,4,4);
+        for(int i = 0; i < 4; ++ i)
+            for(int j = 0; j < 4; ++ j) Z(i,j) = z[i][j];
         return Z;
     }
 };
 
-/* If more extensive general linear algebra functionality is offered in
- * future versions it may be useful to make the elementary row and column
- * operations separate functions. For now they're simply performed in place,
- * but the commented-out lines of code show where the calls to these functions
- * should go if and when they become available.
- */
- 
-/* @todo: In-place version, and address memory allocation for pivot vector.
+/** Invert the local array a in place by Gauss-Jordan elimination with
+ * partial pivoting.  The loop bounds are constants, so the compiler can
+ * unroll them for the small fixed sizes this is used for.
+ *
+ * Returns false, leaving a partially inverted, if a pivot was zero.
  */
-
-/* General NxN inverse by Gauss-Jordan elimination with full pivoting:  */
-template<typename MatT, int _tag>
-struct inverse_f
+template<int N, typename E> struct GaussJordanFixed
 {
-    typename MatT::temporary_type operator()(const MatT& M) const
-    {
-        /* Shorthand. */
-        typedef typename MatT::value_type value_type;
-        
-        /* Size of matrix */
-        size_t N = M.rows();
-
-        /* Matrix containing the inverse: */
-        typename MatT::temporary_type Z;
-        cml::et::detail::Resize(Z,N,N);
-        Z = M;
-
-        /* For tracking pivots */
-        std::vector<size_t> row_index(N);
-        std::vector<size_t> col_index(N);
-        std::vector<size_t> pivoted(N,0);
-
-        /* For each column */
-        for (size_t i = 0; i < N; ++i) {
-        
-            /* Find the pivot */
-            size_t row = 0, col = 0;
-            value_type max = value_type(0);
-            for (size_t j = 0; j < N; ++j) {
-                if (!pivoted[j]) {
-                    for (size_t k = 0; k < N; ++k) {
-                        if (!pivoted[k]) {
-                            value_type mag = std::fabs(Z(j,k));
-                            if (mag > max) {
-                                max = mag;
-                                row = j;
-                                col = k;
-                            }
-                        }
-                    }
-                }
-            }
-
-            /* TODO: Check max against epsilon here to catch singularity */
-
-            row_index[i] = row;
-            col_index[i] = col;
-
-            /* Swap rows if necessary */
-            if (row != col) {
-                /*Z.row_op_swap(row,col);*/
-                for (size_t j = 0; j < Z.cols(); ++j) {
-                    std::swap(Z(row,j),Z(col,j));
-                }
+    static bool invert(E a[N][N]) {
+        int piv[N];
+        for(int k = 0; k < N; ++ k) {
+
+            /* Exchange the row with the largest element of column k: */
+            int p = k;
+            E max = E(std::fabs(a[k][k]));
+            for(int i = k+1; i < N; ++ i) {
+                const E mag = E(std::fabs(a[i][k]));
+                if(mag > max) { max = mag; p = i; }
             }
-            
-            /* Process pivot row */
-            pivoted[col] = true;
-            value_type pivot = Z(col,col);
-            Z(col,col) = value_type(1);
-            /*Z.row_op_mult(col,value_type(1)/pivot);*/
-            value_type k = value_type(1)/pivot;
-            for (size_t j = 0; j < Z.cols(); ++j) {
-                Z(col,j) *= k;
+            piv[k] = p;
+            if(max == E(0)) return false;
+            if(p != k) {
+                for(int j = 0; j < N; ++ j) std::swap(a[k][j], a[p][j]);
             }
 
-            /* Process other rows */
-            for (size_t j = 0; j < N; ++j) {
-                if (j != col) {
-                    value_type mult = -Z(j,col);
-                    Z(j,col) = value_type(0);
-                    /*Z.row_op_add_mult(col,j,mult);*/
-                    for (size_t k = 0; k < Z.cols(); ++k) {
-                        Z(j,k) += mult * Z(col,k);
-                    }
-                }
+            /* Eliminate column k from the other rows: */
+            const E inv = E(1)/a[k][k];
+            a[k][k] = E(1);
+            for(int j = 0; j < N; ++ j) a[k][j] *= inv;
+            for(int i = 0; i < N; ++ i) {
+                if(i == k) continue;
+                const E m = a[i][k];
+                a[i][k] = E(0);
+                for(int j = 0; j < N; ++ j) a[i][j] -= m*a[k][j];
             }
         }
 
-        /* Swap columns if necessary */
-        for (int i = N-1; i >= 0; --i) {
-            if (row_index[i] != col_index[i]) {
-                /*Z.col_op_swap(row_index[i],col_index[i]);*/
-                for (size_t j = 0; j < Z.rows(); ++j) {
-                    std::swap(Z(j,row_index[i]),Z(j,col_index[i]));
-                }
+        /* Undo the row exchanges as column exchanges, in reverse: */
+        for(int k = N-1; k >= 0; -- k) {
+            if(piv[k] != k) {
+                for(int i = 0; i < N; ++ i) std::swap(a[i][k], a[i][piv[k]]);
             }
         }
-
-        /* Return result */
-        return Z;
+        return true;
     }
 };
 
-/* Inversion by LU factorization is turned off for now due to lack of
- * pivoting in the implementation, but we may switch back to it at some future
- * time.
+/** Apply Gauss-Jordan elimination with partial pivoting to the columns
+ * [k0,k1) of A, so that the diagonal block of the panel is inverted.
+ *
+ * Rows are exchanged across the whole matrix, and recorded in piv as by
+ * lu_pivot_inplace(): at step k, row k was exchanged with row piv[k].
+ * Only the panel itself is updated; the other columns are left to the
+ * caller.  Returns false if a pivot was zero.
  */
- 
-#if 0
+template<class MatT, class PivT> inline bool
+GaussJordanPanel(MatT& A, PivT& piv, size_t k0, size_t k1)
+{
+    typedef typename MatT::value_type value_type;
+    const size_t N = A.rows();
+    for(size_t k = k0; k < k1; ++k) {
+
+        /* Find the largest element of column k on or below the diagonal: */
+        size_t p = k;
+        value_type max = value_type(std::fabs(A(k,k)));
+        for(size_t i = k+1; i < N; ++i) {
+            value_type mag = value_type(std::fabs(A(i,k)));
+            if(mag > max) { max = mag; p = i; }
+        }
+        piv[k] = p;
+        if(max == value_type(0)) return false;
+        if(p != k) {
+            for(size_t j = 0; j < N; ++j) std::swap(A(k,j), A(p,j));
+        }
 
-/* General NxN inverse by LU factorization:  */
-template<typename MatT, int _tag>
-struct inverse_f
+        /* Eliminate column k from the other rows of the panel: */
+        const value_type inv = value_type(1)/A(k,k);
+        A(k,k) = value_type(1);
+        for(size_t j = k0; j < k1; ++j) A(k,j) *= inv;
+        for(size_t i = 0; i < N; ++i) {
+            if(i == k) continue;
+            const value_type m = A(i,k);
+            A(i,k) = value_type(0);
+            for(size_t j = k0; j < k1; ++j) A(i,j) -= m*A(k,j);
+        }
+    }
+    return true;
+}
+
+/** Apply the elimination of the panel [k0,k1) to the columns [j0,j1) of
+ * A, given in W a copy of the pivot rows of A before the update.
+ *
+ * With the panel holding -A21 inv(A11) above and below the inverted
+ * diagonal block inv(A11), the pivot rows become inv(A11) A12, and every
+ * other row A22 + (-A21 inv(A11)) A12.
+ */
+template<typename E, class AT, typename BO, typename L, class WorkT>
+inline void
+GaussJordanUpdate(matrix<E,AT,BO,L>& A, const WorkT& W,
+        size_t k0, size_t k1, size_t j0, size_t j1)
 {
-    typename MatT::temporary_type operator()(const MatT& M) const
-    {
-        /* Shorthand. */
-        typedef typename MatT::value_type value_type;
+    typedef matrix<E,strided<>,BO,L> block_type;
+    const size_t N = A.rows(), kb = k1-k0, nj = j1-j0;
+    if(nj == 0) return;
+
+    if(k0 > 0) {
+        block_type C = block(A, 0, j0, k0, nj);
+        MatMulUpdate(C, block(A, 0, k0, k0, kb), block(W, 0, j0, kb, nj),
+                E(1), true, dynamic_size_tag());
+    }
+    if(k1 < N) {
+        block_type C = block(A, k1, j0, N-k1, nj);
+        MatMulUpdate(C, block(A, k1, k0, N-k1, kb),
+                block(W, 0, j0, kb, nj), E(1), true, dynamic_size_tag());
+    }
+    block_type C = block(A, k0, j0, kb, nj);
+    MatMulUpdate(C, block(A, k0, k0, kb, kb), block(W, 0, j0, kb, nj),
+            E(1), false, dynamic_size_tag());
+}
 
-        /* Compute LU factorization: */
-        size_t N = M.rows();
-        typename MatT::temporary_type LU;
-        cml::et::detail::Resize(LU,N,N);
-        LU = lu(M);
+/** An integer vector with the size and allocator of the columns of the
+ * temporaries of MatT, for recording the pivots of an inversion.
+ */
+template<class VecT> struct InversePivots;
+template<typename E, class AT> struct InversePivots< vector<E,AT> > {
+    typedef vector<size_t,AT> type;
+};
 
-        /* Matrix containing the inverse: */
-        typename MatT::temporary_type Z;
-        cml::et::detail::Resize(Z,N,N);
+/** Use the unrolled kernel for fixed sizes from 5x5 to 8x8, and the
+ * blocked one for everything else.
+ */
+template<class MatT> struct InverseUseFixed {
+    typedef typename is_true<
+        same_type<typename MatT::size_tag, fixed_size_tag>::is_true
+        && MatT::array_rows >= 5 && MatT::array_rows <= 8>::result result;
+};
 
-        typename MatT::col_vector_type v, x;
-        cml::et::detail::Resize(v,N);
-        cml::et::detail::Resize(x,N);
-        for(size_t i = 0; i < N; ++i)
-            v[i] = value_type(0);
-        /* XXX Need a fill() function here. */
+/** Invert a fixed-size matrix in place, using a local array. */
+template<class MatT> inline bool
+InverseInplace(MatT& A, true_type)
+{
+    typedef typename MatT::value_type value_type;
+    enum { N = MatT::array_rows };
+    value_type a[N][N];
+    for(int i = 0; i < N; ++ i)
+        for(int j = 0; j < N; ++ j) a[i][j] = A(i,j);
+    if(!GaussJordanFixed<N,value_type>::invert(a)) return false;
+    for(int i = 0; i < N; ++ i)
+        for(int j = 0; j < N; ++ j) A(i,j) = a[i][j];
+    return true;
+}
 
-        /* Use lu_solve to solve M*x = v for x, where v = [0 ... 1 ... 0]^T: */
-        for(size_t i = 0; i < N; ++i) {
-            v[i] = 1.;
-            x = lu_solve(LU,v);
+/** Invert a matrix in place by blocked Gauss-Jordan elimination with
+ * partial pivoting (Quintana-Orti et al., "A note on parallel matrix
+ * inversion", 2001).
+ *
+ * Each panel of CML_INVERSE_BLOCK_SIZE columns is eliminated, and then
+ * applied to the rest of the matrix by the matrix product kernel, so most
+ * of the 2N^3 operations run at the speed of a matrix product.
+ */
+template<class MatT> inline bool
+InverseInplace(MatT& A, false_type)
+{
+    typedef typename MatT::temporary_type temporary_type;
+    typedef typename InversePivots<
+        typename temporary_type::col_vector_type>::type pivot_type;
+    const size_t N = A.rows(), NB = CML_INVERSE_BLOCK_SIZE;
+
+    pivot_type piv;
+    cml::et::detail::ResizeUninitialized(piv, N);
+    temporary_type W;
+    for(size_t k0 = 0; k0 < N; k0 += NB) {
+        const size_t k1 = (N-k0 < NB) ? N : k0+NB;
+        if(!GaussJordanPanel(A, piv, k0, k1)) return false;
+        if(k1-k0 == N) break;
+
+        /* Update the columns on either side of the panel: */
+        cml::et::detail::ResizeUninitialized(W, k1-k0, N);
+        for(size_t i = k0; i < k1; ++i)
+            for(size_t j = 0; j < N; ++j) W(i-k0,j) = A(i,j);
+        GaussJordanUpdate(A, W, k0, k1, 0, k0);
+        GaussJordanUpdate(A, W, k0, k1, k1, N);
+    }
 
-            /* x is column i of the inverse of LU: */
-            for(size_t k = 0; k < N; ++ k) {
-                Z(k,i) = x[k];
-            }
-            v[i] = 0.;
+    /* Undo the row exchanges as column exchanges, in reverse: */
+    for(size_t k = N; k-- > 0; ) {
+        const size_t p = size_t(piv[k]);
+        if(p != k) {
+            for(size_t i = 0; i < N; ++i) std::swap(A(i,k), A(i,p));
         }
+    }
+    return true;
+}
+
+/* General NxN inverse by Gauss-Jordan elimination with partial pivoting: */
+template<typename MatT, int _tag>
+struct inverse_f
+{
+    typename MatT::temporary_type operator()(const MatT& M) const
+    {
+        typedef typename MatT::temporary_type temporary_type;
+        typedef typename InverseUseFixed<temporary_type>::result use_fixed;
 
+        /* Matrix containing the inverse: */
+        temporary_type Z;
+        cml::et::detail::ResizeUninitialized(Z,M.rows(),M.cols());
+        Z = M;
+        if(!InverseInplace(Z, use_fixed()))
+            throw std::invalid_argument("matrix is singular.");
         return Z;
     }
-
 };
 
-#endif
-
 /* Note: force_NxN is for checking general NxN inversion against the special-
  * case 2x2, 3x3 and 4x4 code. I'm leaving it in for now since we may need to
  * test the NxN code further if the implementation changes. At some future
@@ -418,7 +521,42 @@ inverse(const MatT& M, dynamic_size_tag/*, bool force_NxN*/)
 
 } // namespace detail
 
-/** Inverse of a matrix. */
+/** Invert A in place.
+ *
+ * Matrices larger than 4x4 are inverted by Gauss-Jordan elimination with
+ * partial pivoting: fixed sizes up to 8x8 in an unrolled kernel, and
+ * everything else by panels of CML_INVERSE_BLOCK_SIZE columns, with the
+ * rest of the matrix updated by the matrix product kernel.  The pivots
+ * are kept in a vector with the allocator of A's temporaries, so nothing
+ * is taken from the heap inside a temp_arena.
+ *
+ * @returns false if A is singular, i.e. a pivot was exactly zero.  A is
+ * then left partially inverted.
+ *
+ * @throws std::invalid_argument if A is not square.
+ */
+template<typename E, class AT, typename BO, typename L> inline bool
+inverse_inplace(matrix<E,AT,BO,L>& A)
+{
+    typedef matrix<E,AT,BO,L> matrix_type;
+    typedef typename matrix_type::size_tag size_tag;
+    typedef typename detail::InverseUseFixed<matrix_type>::result use_fixed;
+
+    /* The inverse does not fit in packed or banded storage: */
+    CML_STATIC_REQUIRE_M(
+        (same_type<typename matrix_structure<AT>::type,
+         general_tag>::is_true),
+        inverse_inplace_expects_a_general_matrix_error);
+
+    cml::et::CheckedSquare(A, size_tag());
+    return detail::InverseInplace(A, use_fixed());
+}
+
+/** Inverse of a matrix.
+ *
+ * @throws std::invalid_argument if M is not square, or if it is larger
+ * than 4x4 and singular.
+ */
 template<typename E, class AT, typename BO, typename L> inline
 typename matrix<E,AT,BO,L>::temporary_type
 inverse(const matrix<E,AT,BO,L>& M/*, bool force_NxN = false*/)
@@ -427,7 +565,11 @@ inverse(const matrix<E,AT,BO,L>& M/*, bool force_NxN = false*/)
     return detail::inverse(M,size_tag()/*,force_NxN*/);
 }
 
-/** Inverse of a matrix expression. */
+/** Inverse of a matrix expression.
+ *
+ * @throws std::invalid_argument if e is not square, or if it is larger
+ * than 4x4 and singular.
+ */
 template<typename XprT> inline
 typename et::MatrixXpr<XprT>::temporary_type
 inverse(const et::MatrixXpr<XprT>& e/*, bool force_NxN = false*/)
@@ -27,6 +27,7 @@ Boost Software License, v1.0 (see cml/LICENSE for details).
 #include <cml/et/size_checking.h>
 #include <cml/matrix/matrix_expr.h>
 #include <cml/matvec/matvec_promotions.h>
+#include <cml/banded.h>
 
 /* This is used below to create a more meaningful compile-time error when
  * lu is not provided with a matrix or MatrixExpr argument:
@@ -67,20 +68,35 @@ void lu_inplace(MatT& A)
    */
 
   /* Verify that the matrix is square, and get the size: */
-  ssize_t N = (ssize_t) cml::et::CheckedSquare(A, size_tag());
-  for(ssize_t k = 0; k < N; ++k) {
+  size_t N = cml::et::CheckedSquare(A, size_tag());
+
+  /* The factors of a banded matrix keep its band, so the loops below skip
+   * the elements outside of the band:
+   */
+  typedef typename et::MatrixStructure<MatT>::type structure;
+  for(size_t k = 0; k < N; ++k) {
 
     /* Compute the upper triangle: */
-    for(ssize_t j = k; j < N; ++j) {
+    size_t j0 = k, j1 = N;
+    NonZeroCols(k, j0, j1, structure());
+    for(size_t j = j0; j < j1; ++j) {
+      size_t p0 = 0, p1 = k;
+      NonZeroCols(k, p0, p1, structure());
+      NonZeroRows(j, p0, p1, structure());
       value_type sum(0);
-      for(ssize_t p = 0; p < k; ++ p) sum += A(k,p)*A(p,j);
+      for(size_t p = p0; p < p1; ++ p) sum += A(k,p)*A(p,j);
       A(k,j) -= sum;
     }
 
     /* Compute the lower triangle: */
-    for(ssize_t i = k+1; i < N; ++i) {
+    size_t i0 = k+1, i1 = N;
+    NonZeroRows(k, i0, i1, structure());
+    for(size_t i = i0; i < i1; ++i) {
+      size_t p0 = 0, p1 = k;
+      NonZeroCols(i, p0, p1, structure());
+      NonZeroRows(k, p0, p1, structure());
       value_type sum(0);
-      for(ssize_t p = 0; p < k; ++p) sum += A(i,p)*A(p,k);
+      for(size_t p = p0; p < p1; ++p) sum += A(i,p)*A(p,k);
       A(i,k) = (A(i,k) - sum) / A(k,k);
     }
   }
@@ -109,7 +125,7 @@ lu_copy(const MatT& M)
 
     /* Use the in-place LU function, and return the result: */
     typename MatT::temporary_type A;
-    cml::et::detail::Resize(A,M.rows(),M.cols());
+    cml::et::detail::ResizeUninitialized(A,M.rows(),M.cols());
     A = M;
     lu_inplace(A);
     return A;
@@ -128,6 +144,24 @@ lu(const matrix<E,AT,BO,L>& m)
     return detail::lu_copy(m);
 }
 
+/** LU factorization for a banded matrix, with L a unit lower triangular
+ * matrix.
+ *
+ * Without pivoting, L and U fit in the band of the matrix, so the result is
+ * a banded matrix of the same type, computed in O(N*Lower*Upper)
+ * operations.
+ *
+ * @sa cml/banded.h
+ */
+template<typename E, int Lower, int Upper, class A, typename BO, class L>
+inline matrix<E,banded<Lower,Upper,A>,BO,L>
+lu(const matrix<E,banded<Lower,Upper,A>,BO,L>& m)
+{
+    matrix<E,banded<Lower,Upper,A>,BO,L> LU(m);
+    detail::lu_inplace(LU);
+    return LU;
+}
+
 /** LU factorization for a matrix expression, with L a unit lower
  * triangular matrix.
  *
@@ -164,24 +198,31 @@ lu_solve(const MatT& LU, const VecT& b)
   /* Verify that the matrix and vector have compatible sizes: */
   et::CheckedSize(LU, b, typename vector_type::size_tag());
 
+  /* The substitutions skip the elements outside the band of a banded LU: */
+  typedef typename et::MatrixStructure<MatT>::type structure;
+
   /* Solve Ly = b for y by forward substitution.  The entries below the
    * diagonal of LU correspond to L, understood to be below a diagonal of
    * 1's:
    */
-  vector_type y; cml::et::detail::Resize(y,N);
+  vector_type y; cml::et::detail::ResizeUninitialized(y,N);
   for(ssize_t i = 0; i < N; ++i) {
+    size_t j0 = 0, j1 = i;
+    cml::detail::NonZeroCols(i, j0, j1, structure());
     value_type yi = b[i];
-    for(ssize_t j = 0; j < i; ++j) yi -= LU(i,j)*y[j];
+    for(size_t j = j0; j < j1; ++j) yi -= LU(i,j)*y[j];
     y[i] = yi;
   }
 
   /* Solve Ux = y for x by backward substitution.  The entries at and above
    * the diagonal of LU correspond to U:
    */
-  vector_type x; cml::et::detail::Resize(x,N);
+  vector_type x; cml::et::detail::ResizeUninitialized(x,N);
   for(ssize_t i = N-1; i >= 0; --i) {
+    size_t j0 = i+1, j1 = N;
+    cml::detail::NonZeroCols(i, j0, j1, structure());
     value_type xi = y[i];
-    for(ssize_t j = i+1; j < N; ++j) xi -= LU(i,j)*x[j];
+    for(size_t j = j0; j < j1; ++j) xi -= LU(i,j)*x[j];
     x[i] = xi/LU(i,i);
   }
 
@@ -0,0 +1,350 @@
+/* -*- C++ -*- ------------------------------------------------------------
+ 
+Copyright (c) 2007 Jesse Anders and Demian Nave http://cmldev.net/
+
+The Configurable Math Library (CML) is distributed under the terms of the
+Boost Software License, v1.0 (see cml/LICENSE for details).
+
+ *-----------------------------------------------------------------------*/
+/** @file
+ *  @brief LU decomposition with partial pivoting, and solvers using it.
+ *
+ * lu_pivot_inplace(A,piv) factors PA = LU in place, with L a unit lower
+ * triangular matrix, choosing the largest element of each column as the
+ * pivot.  The row interchanges are recorded in piv as in LAPACK: at step k,
+ * row k was exchanged with row piv[k] >= k.  piv is a vector of an integer
+ * type, e.g. vector< size_t, dynamic<> > or vector< int, fixed<4> >.
+ *
+ * Run-time sized matrices are factored by panels of CML_LU_BLOCK_SIZE
+ * columns (right-looking), so most of the work is done by the matrix
+ * product kernel updating the trailing block:
+ *
+ *   vector< size_t, dynamic<> > piv;
+ *   lu_pivot_inplace(A, piv);
+ *   x = lu_solve(A, piv, b);          // One right-hand side.
+ *   X = lu_solve(A, piv, B);          // One for each column of B.
+ */
+
+#ifndef lu_pivot_h
+#define lu_pivot_h
+
+#include <cmath>
+#include <algorithm>                // for std::swap
+#include <cml/et/size_checking.h>
+#include <cml/matrix/matrix_expr.h>
+#include <cml/matrix/matrix_mul.h>
+#include <cml/matrix/matrix_block.h>
+#include <cml/matrix/lu.h>
+#include <cml/matvec/matvec_promotions.h>
+
+/* This is used below to create a more meaningful compile-time error when
+ * lu_pivot_inplace is given a packed or banded matrix:
+ */
+struct lu_pivot_inplace_expects_a_general_matrix_error;
+
+namespace cml {
+namespace detail {
+
+/** Exchange rows i and p of A. */
+template<class MatT> inline void
+LUSwapRows(MatT& A, size_t i, size_t p)
+{
+    for(size_t j = 0; j < A.cols(); ++j) std::swap(A(i,j), A(p,j));
+}
+
+/** Factor columns [k0,k1) of A by unblocked, right-looking elimination
+ * with partial pivoting.
+ *
+ * Rows are exchanged across the whole matrix.  Only the panel itself is
+ * updated; the columns past k1 are left to the caller.  Returns false if a
+ * pivot was zero.
+ */
+template<class MatT, class PivT> inline bool
+LUPivotPanel(MatT& A, PivT& piv, size_t k0, size_t k1, int& sign)
+{
+    typedef typename MatT::value_type value_type;
+    const size_t N = A.rows();
+    bool regular = true;
+    for(size_t k = k0; k < k1; ++k) {
+
+        /* Find the largest element of column k on or below the diagonal: */
+        size_t p = k;
+        value_type max = value_type(std::fabs(A(k,k)));
+        for(size_t i = k+1; i < N; ++i) {
+            value_type mag = value_type(std::fabs(A(i,k)));
+            if(mag > max) { max = mag; p = i; }
+        }
+        piv[k] = p;
+        if(p != k) {
+            LUSwapRows(A, k, p);
+            sign = -sign;
+        }
+
+        /* A zero column leaves nothing to eliminate: */
+        const value_type pivot = A(k,k);
+        if(pivot == value_type(0)) {
+            regular = false;
+            continue;
+        }
+
+        /* Compute column k of L, and update the rest of the panel: */
+        const value_type inv = value_type(1)/pivot;
+        for(size_t i = k+1; i < N; ++i) {
+            const value_type l = (A(i,k) *= inv);
+            for(size_t j = k+1; j < k1; ++j) A(i,j) -= l*A(k,j);
+        }
+    }
+    return regular;
+}
+
+/** Apply the row interchanges recorded in piv to X, in order. */
+template<class VecT, class PivT> inline void
+LUPermute(VecT& x, const PivT& piv, size_t N, et::vector_result_tag)
+{
+    for(size_t k = 0; k < N; ++k) {
+        size_t p = size_t(piv[k]);
+        if(p != k) std::swap(x[k], x[p]);
+    }
+}
+
+template<class MatT, class PivT> inline void
+LUPermute(MatT& X, const PivT& piv, size_t N, et::matrix_result_tag)
+{
+    for(size_t k = 0; k < N; ++k) {
+        size_t p = size_t(piv[k]);
+        if(p != k) LUSwapRows(X, k, p);
+    }
+}
+
+/** Solve LUX = X in place, for each column of X, by forward and backward
+ * substitution.  The loops skip the elements outside the band of a banded
+ * LU.
+ */
+template<class MatT, class RhsT> inline void
+LUSubstitute(const MatT& LU, RhsT& X)
+{
+    typedef typename RhsT::value_type value_type;
+    typedef typename et::MatrixStructure<MatT>::type structure;
+    const size_t N = LU.rows(), M = X.cols();
+
+    /* Solve LY = X, with the unit diagonal of L understood: */
+    for(size_t i = 0; i < N; ++i) {
+        size_t k0 = 0, k1 = i;
+        NonZeroCols(i, k0, k1, structure());
+        for(size_t k = k0; k < k1; ++k) {
+            const value_type l = LU(i,k);
+            for(size_t j = 0; j < M; ++j) X(i,j) -= l*X(k,j);
+        }
+    }
+
+    /* Solve UX = Y: */
+    for(size_t i = N; i-- > 0; ) {
+        size_t k0 = i+1, k1 = N;
+        NonZeroCols(i, k0, k1, structure());
+        for(size_t k = k0; k < k1; ++k) {
+            const value_type u = LU(i,k);
+            for(size_t j = 0; j < M; ++j) X(i,j) -= u*X(k,j);
+        }
+        const value_type inv = value_type(1)/LU(i,i);
+        for(size_t j = 0; j < M; ++j) X(i,j) *= inv;
+    }
+}
+
+} // namespace detail
+
+/** Factor PA = LU in place with partial pivoting, recording the row
+ * interchanges in piv (resized to A.rows() if it is resizable).
+ *
+ * A can be any fixed, dynamic, external or strided matrix.  Run-time sized
+ * matrices larger than CML_LU_BLOCK_SIZE are factored by panels, with the
+ * trailing block updated by the matrix product kernel.
+ *
+ * @returns the sign of the permutation (+1 or -1), or 0 if A is singular,
+ * i.e. a pivot was exactly zero.  The factorization is still completed,
+ * but U has a zero on its diagonal.
+ *
+ * @throws std::invalid_argument if A is not square, or if piv is a fixed or
+ * external vector with fewer than A.rows() elements.
+ */
+template<typename E, class AT, typename BO, typename L, class PivT> inline int
+lu_pivot_inplace(matrix<E,AT,BO,L>& A, PivT& piv)
+{
+    /* Shorthand: */
+    typedef matrix<E,AT,BO,L> matrix_type;
+    typedef typename matrix_type::size_tag size_tag;
+    typedef typename matrix_type::value_type value_type;
+    typedef matrix<E,strided<>,BO,L> block_type;
+
+    /* The factors do not fit in packed or banded storage: */
+    CML_STATIC_REQUIRE_M(
+        (same_type<typename matrix_structure<AT>::type,
+         general_tag>::is_true),
+        lu_pivot_inplace_expects_a_general_matrix_error);
+
+    /* Verify that the matrix is square, and get the size: */
+    const size_t N = cml::et::CheckedSquare(A, size_tag());
+
+    /* Fixed and external pivot vectors are not resized: */
+    cml::et::detail::ResizeUninitialized(piv, N);
+    if(piv.size() < N)
+        throw std::invalid_argument("pivot vector is too small.");
+
+    int sign = 1;
+    bool regular = true;
+    const size_t NB = CML_LU_BLOCK_SIZE;
+    for(size_t k0 = 0; k0 < N; k0 += NB) {
+        const size_t k1 = (N-k0 < NB) ? N : k0+NB;
+
+        /* Factor the panel [A11; A21] = [L11; L21] U11: */
+        regular = detail::LUPivotPanel(A, piv, k0, k1, sign) && regular;
+        if(k1 == N) break;
+
+        /* Compute the block row U12 = L11^-1 A12: */
+        for(size_t k = k0; k < k1; ++k) {
+            for(size_t i = k+1; i < k1; ++i) {
+                const value_type l = A(i,k);
+                for(size_t j = k1; j < N; ++j) A(i,j) -= l*A(k,j);
+            }
+        }
+
+        /* Update the trailing block, A22 -= L21 U12: */
+        const size_t n2 = N-k1, kb = k1-k0;
+        block_type A22 = block(A, k1, k1, n2, n2);
+        detail::MatMulUpdate(A22,
+                block(A, k1, k0, n2, kb), block(A, k0, k1, kb, n2),
+                value_type(-1), true, dynamic_size_tag());
+    }
+    return regular ? sign : 0;
+}
+
+/** Return the LU factorization of m with partial pivoting, recording the
+ * row interchanges in piv.
+ *
+ * @sa lu_pivot_inplace
+ */
+template<typename E, class AT, typename BO, class L, class PivT>
+inline typename matrix<E,AT,BO,L>::temporary_type
+lu_pivot(const matrix<E,AT,BO,L>& m, PivT& piv)
+{
+    typename matrix<E,AT,BO,L>::temporary_type LU;
+    cml::et::detail::ResizeUninitialized(LU,m.rows(),m.cols());
+    LU = m;
+    lu_pivot_inplace(LU, piv);
+    return LU;
+}
+
+/** Return the LU factorization of a matrix expression with partial
+ * pivoting, recording the row interchanges in piv.
+ *
+ * @sa lu_pivot_inplace
+ */
+template<typename XprT, class PivT>
+inline typename et::MatrixXpr<XprT>::temporary_type
+lu_pivot(const et::MatrixXpr<XprT>& e, PivT& piv)
+{
+    typename et::MatrixXpr<XprT>::temporary_type LU;
+    cml::et::detail::ResizeUninitialized(LU,e.rows(),e.cols());
+    LU = e;
+    lu_pivot_inplace(LU, piv);
+    return LU;
+}
+
+/** Solve Ax = b for x, given the factorization PA = LU and its row
+ * interchanges piv from lu_pivot_inplace().
+ */
+template<typename MatT, typename PivT, typename VecT> inline
+typename et::MatVecPromote<MatT,VecT>::temporary_type
+lu_solve(const MatT& LU, const PivT& piv, const VecT& b)
+{
+  /* Shorthand. */
+  typedef et::ExprTraits<MatT> lu_traits;
+  typedef typename et::MatVecPromote<MatT,VecT>::temporary_type vector_type;
+  typedef typename vector_type::value_type value_type;
+
+  /* Verify that the matrix is square, and get the size: */
+  const size_t N = cml::et::CheckedSquare(LU, typename lu_traits::size_tag());
+
+  /* Verify that the matrix and vector have compatible sizes: */
+  et::CheckedSize(LU, b, typename vector_type::size_tag());
+
+  /* Permute b into x: */
+  vector_type x; cml::et::detail::ResizeUninitialized(x,N);
+  for(size_t i = 0; i < N; ++i) x[i] = b[i];
+  detail::LUPermute(x, piv, N, et::vector_result_tag());
+
+  /* Solve Ly = Pb by forward substitution: */
+  for(size_t i = 0; i < N; ++i) {
+    value_type xi = x[i];
+    for(size_t j = 0; j < i; ++j) xi -= LU(i,j)*x[j];
+    x[i] = xi;
+  }
+
+  /* Solve Ux = y by backward substitution: */
+  for(size_t i = N; i-- > 0; ) {
+    value_type xi = x[i];
+    for(size_t j = i+1; j < N; ++j) xi -= LU(i,j)*x[j];
+    x[i] = xi/LU(i,i);
+  }
+  return x;
+}
+
+/** Solve AX = B for X, given the factorization PA = LU and its row
+ * interchanges piv, for all of the columns of B at once.
+ */
+template<typename MatT, typename PivT,
+    typename E, class AT, typename BO, typename L> inline
+typename et::MatrixPromote<
+    matrix<E,AT,BO,L>, typename MatT::value_type>::temporary_type
+lu_solve(const MatT& LU, const PivT& piv, const matrix<E,AT,BO,L>& B)
+{
+  typedef typename et::MatrixPromote<
+    matrix<E,AT,BO,L>, typename MatT::value_type>::temporary_type
+    result_type;
+  typedef et::ExprTraits<MatT> lu_traits;
+
+  /* Verify that the matrix is square, and that B has as many rows: */
+  const size_t N = cml::et::CheckedSquare(LU, typename lu_traits::size_tag());
+  if(B.rows() != N)
+    throw std::invalid_argument("expressions have incompatible sizes.");
+
+  result_type X;
+  cml::et::detail::ResizeUninitialized(X,B.rows(),B.cols());
+  X = B;
+  detail::LUPermute(X, piv, N, et::matrix_result_tag());
+  detail::LUSubstitute(LU, X);
+  return X;
+}
+
+/** Solve AX = B for X, given the factorization A = LU from lu(), for all
+ * of the columns of B at once.
+ *
+ * @sa lu
+ */
+template<typename MatT, typename E, class AT, typename BO, typename L> inline
+typename et::MatrixPromote<
+    matrix<E,AT,BO,L>, typename MatT::value_type>::temporary_type
+lu_solve(const MatT& LU, const matrix<E,AT,BO,L>& B)
+{
+  typedef typename et::MatrixPromote<
+    matrix<E,AT,BO,L>, typename MatT::value_type>::temporary_type
+    result_type;
+  typedef et::ExprTraits<MatT> lu_traits;
+
+  /* Verify that the matrix is square, and that B has as many rows: */
+  const size_t N = cml::et::CheckedSquare(LU, typename lu_traits::size_tag());
+  if(B.rows() != N)
+    throw std::invalid_argument("expressions have incompatible sizes.");
+
+  result_type X;
+  cml::et::detail::ResizeUninitialized(X,B.rows(),B.cols());
+  X = B;
+  detail::LUSubstitute(LU, X);
+  return X;
+}
+
+} // namespace cml
+
+#endif
+
+// -------------------------------------------------------------------------
+// vim:ft=cpp
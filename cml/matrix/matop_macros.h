@@ -73,7 +73,7 @@ template<typename E1, class AT1, typename L1,                            \
          typename E2, class AT2, typename L2, typename BO>               \
 inline et::MatrixXpr<                                                    \
     et::BinaryMatrixOp<                                                  \
-        matrix<E1,AT1,BO,L2>, matrix<E2,AT2,BO,L2>, _OpT_<E1,E2> >       \
+        matrix<E1,AT1,BO,L1>, matrix<E2,AT2,BO,L2>, _OpT_<E1,E2> >       \
 >                                                                        \
                                                                          \
 _op_ (                                                                   \
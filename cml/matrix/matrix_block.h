@@ -0,0 +1,159 @@
+/* -*- C++ -*- ------------------------------------------------------------
+ 
+Copyright (c) 2007 Jesse Anders and Demian Nave http://cmldev.net/
+
+The Configurable Math Library (CML) is distributed under the terms of the
+Boost Software License, v1.0 (see cml/LICENSE for details).
+
+ *-----------------------------------------------------------------------*/
+/** @file
+ *  @brief Views of rectangular blocks of a matrix.
+ *
+ * block(A,i,j,r,c) returns the r x c block of A starting at element (i,j)
+ * as a strided matrix sharing A's memory.  Assigning to the block assigns
+ * to those elements of A, so blocked algorithms can update A in place:
+ *
+ *   block(A,0,0,2,2).zero();
+ *   block(C,i,j,4,4) += block(A,i,0,4,K)*block(B,0,j,K,4);
+ *
+ * submatrix(A,i,j,r,c) is the same as block(A,i,j,r,c), and
+ * submatrix<R,C>(A,i,j) returns a view with a size fixed at compile time,
+ * e.g. the upper 3x3 block of a 4x4 transform:
+ *
+ *   submatrix<3,3>(M,0,0) = rotation;
+ *
+ * The block is only valid while A exists, and keeps its memory.  A must be
+ * a dense matrix, i.e. fixed, dynamic, external, hybrid or strided; packed
+ * and banded matrices do not store their elements in rows and columns, and
+ * are rejected at compile time.
+ */
+
+#ifndef matrix_block_h
+#define matrix_block_h
+
+#include <stdexcept>
+#include <cml/matrix/strided.h>
+
+/* This is used below to create a more meaningful compile-time error when
+ * block() or submatrix() is given a packed or banded matrix:
+ */
+struct block_expects_a_dense_matrix_error;
+
+namespace cml {
+namespace detail {
+
+/** The leading dimension of a dense matrix. */
+template<typename E, class AT, typename BO, typename L> inline size_t
+BlockStride(const matrix<E,AT,BO,L>& m) {
+    return same_type<L,row_major>::is_true ? m.cols() : m.rows();
+}
+
+/** The leading dimension of a strided matrix. */
+template<typename E, int R, int C, typename BO, typename L> inline size_t
+BlockStride(const matrix<E,strided<R,C>,BO,L>& m) { return m.stride(); }
+
+/** Return the address of element (i,j) of m, after checking that the
+ * block fits in m.
+ */
+template<typename E, class AT, typename BO, typename L> inline E*
+BlockOrigin(const matrix<E,AT,BO,L>& m,
+        size_t i, size_t j, size_t rows, size_t cols)
+{
+    /* Packed and banded storage has no leading dimension: */
+    CML_STATIC_REQUIRE_M(
+        (same_type<typename matrix_structure<AT>::type,
+         general_tag>::is_true),
+        block_expects_a_dense_matrix_error);
+
+    if(i + rows > m.rows() || j + cols > m.cols())
+        throw std::invalid_argument("block exceeds the matrix size.");
+    const size_t offset = same_type<L,row_major>::is_true
+        ? i*BlockStride(m) + j : j*BlockStride(m) + i;
+    return const_cast<E*>(m.data()) + offset;
+}
+
+} // namespace detail
+
+/** Return a view of the rows x cols block of m starting at element (i,j).
+ *
+ * @throws std::invalid_argument if the block does not fit in m.
+ */
+template<typename E, class AT, typename BO, typename L>
+inline matrix<E,strided<>,BO,L>
+block(matrix<E,AT,BO,L>& m, size_t i, size_t j, size_t rows, size_t cols)
+{
+    return matrix<E,strided<>,BO,L>(
+            detail::BlockOrigin(m,i,j,rows,cols),
+            rows, cols, detail::BlockStride(m));
+}
+
+/** Return a read-only view of the rows x cols block of m starting at
+ * element (i,j).
+ *
+ * @throws std::invalid_argument if the block does not fit in m.
+ */
+template<typename E, class AT, typename BO, typename L>
+inline const matrix<E,strided<>,BO,L>
+block(const matrix<E,AT,BO,L>& m,
+        size_t i, size_t j, size_t rows, size_t cols)
+{
+    return matrix<E,strided<>,BO,L>(
+            detail::BlockOrigin(m,i,j,rows,cols),
+            rows, cols, detail::BlockStride(m));
+}
+
+/** Return a view of the rows x cols block of m starting at element (i,j).
+ *
+ * @throws std::invalid_argument if the block does not fit in m.
+ */
+template<typename E, class AT, typename BO, typename L>
+inline matrix<E,strided<>,BO,L>
+submatrix(matrix<E,AT,BO,L>& m, size_t i, size_t j, size_t rows, size_t cols)
+{
+    return block(m,i,j,rows,cols);
+}
+
+/** Return a read-only view of the rows x cols block of m starting at
+ * element (i,j).
+ *
+ * @throws std::invalid_argument if the block does not fit in m.
+ */
+template<typename E, class AT, typename BO, typename L>
+inline const matrix<E,strided<>,BO,L>
+submatrix(const matrix<E,AT,BO,L>& m,
+        size_t i, size_t j, size_t rows, size_t cols)
+{
+    return block(m,i,j,rows,cols);
+}
+
+/** Return a view of the Rows x Cols block of m starting at element (i,j).
+ *
+ * @throws std::invalid_argument if the block does not fit in m.
+ */
+template<int Rows, int Cols, typename E, class AT, typename BO, typename L>
+inline matrix<E,strided<Rows,Cols>,BO,L>
+submatrix(matrix<E,AT,BO,L>& m, size_t i, size_t j)
+{
+    return matrix<E,strided<Rows,Cols>,BO,L>(
+            detail::BlockOrigin(m,i,j,Rows,Cols), detail::BlockStride(m));
+}
+
+/** Return a read-only view of the Rows x Cols block of m starting at
+ * element (i,j).
+ *
+ * @throws std::invalid_argument if the block does not fit in m.
+ */
+template<int Rows, int Cols, typename E, class AT, typename BO, typename L>
+inline const matrix<E,strided<Rows,Cols>,BO,L>
+submatrix(const matrix<E,AT,BO,L>& m, size_t i, size_t j)
+{
+    return matrix<E,strided<Rows,Cols>,BO,L>(
+            detail::BlockOrigin(m,i,j,Rows,Cols), detail::BlockStride(m));
+}
+
+} // namespace cml
+
+#endif
+
+// -------------------------------------------------------------------------
+// vim:ft=cpp
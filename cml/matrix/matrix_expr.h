@@ -162,6 +162,22 @@ struct ExprTraits< MatrixXpr<ExprT> >
     size_t cols(const expr_type& e) const { return e.cols(); }
 };
 
+/** Packet access to a MatrixXpr<>, if its expression has it. */
+template<class ExprT, class PacketT>
+struct PacketAccess< MatrixXpr<ExprT>, PacketT, matrix_result_tag >
+{
+    typedef PacketAccess<ExprT,PacketT> expr_access;
+    enum { is_true = expr_access::is_true };
+    static typename PacketT::type load(const MatrixXpr<ExprT>& e, size_t k) {
+        return expr_access::load(e.expression(), k);
+    }
+};
+
+template<class ExprT, class Layout>
+struct MatrixLayoutMatch< MatrixXpr<ExprT>, Layout, matrix_result_tag > {
+    enum { is_true = MatrixLayoutMatch<ExprT,Layout>::is_true };
+};
+
 
 /** A unary matrix expression operating on matrix elements as a list.
  *
@@ -232,6 +248,9 @@ class UnaryMatrixOp
         return OpT().apply(expr_traits().get(m_expr,i,j));
     }
 
+    /** Return reference to contained expression. */
+    expr_reference expression() const { return m_expr; }
+
 
   public:
 
@@ -277,6 +296,30 @@ struct ExprTraits< UnaryMatrixOp<ExprT,OpT> >
     size_t cols(const expr_type& e) const { return e.cols(); }
 };
 
+/** Packet access to a UnaryMatrixOp<>, if its subexpression has it and the
+ * operator can be applied to packets.
+ */
+template<class ExprT, class OpT, class PacketT>
+struct PacketAccess< UnaryMatrixOp<ExprT,OpT>, PacketT, matrix_result_tag >
+{
+    typedef UnaryMatrixOp<ExprT,OpT> expr_type;
+    typedef PacketAccess<ExprT,PacketT> expr_access;
+    enum { is_true = expr_access::is_true && PacketOp<OpT,PacketT>::is_true
+        && same_type<typename OpT::value_type,
+                     typename PacketT::value_type>::is_true };
+    static typename PacketT::type load(const expr_type& e, size_t k) {
+        return OpT::template packet_apply<PacketT>(
+                expr_access::load(e.expression(), k));
+    }
+};
+
+template<class ExprT, class OpT, class Layout>
+struct MatrixLayoutMatch<
+    UnaryMatrixOp<ExprT,OpT>, Layout, matrix_result_tag >
+{
+    enum { is_true = MatrixLayoutMatch<ExprT,Layout>::is_true };
+};
+
 
 /** A binary matrix expression. */
 template<class LeftT, class RightT, class OpT>
@@ -376,6 +419,12 @@ class BinaryMatrixOp
                 right_traits().get(m_right,i,j));
     }
 
+    /** Return reference to left expression. */
+    left_reference left_expression() const { return m_left; }
+
+    /** Return reference to right expression. */
+    right_reference right_expression() const { return m_right; }
+
 
   public:
 
@@ -435,6 +484,35 @@ struct ExprTraits< BinaryMatrixOp<LeftT,RightT,OpT> >
     size_t cols(const expr_type& e) const { return e.cols(); }
 };
 
+/** Packet access to a BinaryMatrixOp<>, if both subexpressions have it and
+ * the operator can be applied to packets.
+ */
+template<class LeftT, class RightT, class OpT, class PacketT>
+struct PacketAccess<
+    BinaryMatrixOp<LeftT,RightT,OpT>, PacketT, matrix_result_tag >
+{
+    typedef BinaryMatrixOp<LeftT,RightT,OpT> expr_type;
+    typedef PacketAccess<LeftT,PacketT> left_access;
+    typedef PacketAccess<RightT,PacketT> right_access;
+    enum { is_true = left_access::is_true && right_access::is_true
+        && PacketOp<OpT,PacketT>::is_true
+        && same_type<typename OpT::value_type,
+                     typename PacketT::value_type>::is_true };
+    static typename PacketT::type load(const expr_type& e, size_t k) {
+        return OpT::template packet_apply<PacketT>(
+                left_access::load(e.left_expression(), k),
+                right_access::load(e.right_expression(), k));
+    }
+};
+
+template<class LeftT, class RightT, class OpT, class Layout>
+struct MatrixLayoutMatch<
+    BinaryMatrixOp<LeftT,RightT,OpT>, Layout, matrix_result_tag >
+{
+    enum { is_true = MatrixLayoutMatch<LeftT,Layout>::is_true
+        && MatrixLayoutMatch<RightT,Layout>::is_true };
+};
+
 /* Helper struct to verify that both arguments are matrix expressions: */
 template<typename LeftTraits, typename RightTraits>
 struct MatrixExpressions
@@ -472,6 +550,31 @@ void Resize(MatT& m, matrix_size N) {
             typename MatT::size_tag(), typename MatT::memory_tag());
 }
 
+/* Like Resize(), but for temporaries that are overwritten next, so the
+ * elements need not be reset:
+ */
+template<typename MatT, typename MT> inline
+void ResizeUninitialized(MatT&, size_t, size_t, fixed_size_tag, MT) {}
+
+template<typename MatT> inline
+void ResizeUninitialized(MatT& m,
+        size_t R, size_t C, dynamic_size_tag, dynamic_memory_tag)
+{
+    m.resize_uninitialized(R,C);
+}
+
+template<typename MatT> inline
+void ResizeUninitialized(MatT& m, size_t R, size_t C) {
+    ResizeUninitialized(m, R, C,
+            typename MatT::size_tag(), typename MatT::memory_tag());
+}
+
+template<typename MatT> inline
+void ResizeUninitialized(MatT& m, matrix_size N) {
+    ResizeUninitialized(m, N.first, N.second,
+            typename MatT::size_tag(), typename MatT::memory_tag());
+}
+
 } // namespace detail
 
 } // namespace et
@@ -30,7 +30,7 @@ identity(const matrix<E,AT,BO,L>& m)
     typename matrix<E,AT,BO,L>::temporary_type result;
 
     /* This is a no-op for fixed-size matrices: */
-    cml::et::detail::Resize(result, m.size());
+    cml::et::detail::ResizeUninitialized(result, m.size());
     result.identity();
     return result;
 }
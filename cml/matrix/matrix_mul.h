@@ -9,13 +9,15 @@ Boost Software License, v1.0 (see cml/LICENSE for details).
 /** @file
  *  @brief Multiply two matrices.
  *
- * @todo Does it make sense to put mat-mat multiplication as a node into the
- * expression tree?
+ * The product of two matrices is a MatrixProductOp<> node in the expression
+ * tree.  When a product is assigned to a matrix, as in C = A*B, C += A*B,
+ * C -= A*B, or C = A*B + D, it is computed directly into C with no
+ * temporary.  The kernels compute the whole product at once, so in any
+ * other context (or if C is also one of the operands) the node evaluates
+ * the product into a temporary the first time one of its elements is read.
  *
- * @internal This does not need to return an expression type, since the
- * temporary generation for the matrix result is handled automatically by the
- * compiler.  i.e. when used in an expression, the result is automatically
- * included in the expression tree as a temporary by the compiler.
+ * @internal Products with a MatrixXpr<> operand evaluate that operand into a
+ * temporary first, since the kernels need random access to both operands.
  */
 
 #ifndef	matrix_mul_h
@@ -23,6 +25,13 @@ Boost Software License, v1.0 (see cml/LICENSE for details).
 
 #include <cml/et/size_checking.h>
 #include <cml/matrix/matrix_expr.h>
+#include <cml/matrix/matrix_unroller.h>
+#include <cml/matrix/blocked_mul.h>
+#include <cml/matrix/fixed_mul.h>
+
+#if defined(CML_PARALLEL)
+#include <cml/core/thread_pool.h>
+#endif
 
 /* This is used below to create a more meaningful compile-time error when
  * mul is not provided with matrix or MatrixExpr arguments:
@@ -64,9 +73,196 @@ MatMulCheckedSize(const LeftT& left, const RightT& right, dynamic_size_tag)
 }
 
 
+/** Compute C = alpha A x B using a straightforward loop (O(N^3),
+ * non-blocked algorithm).
+ *
+ * If accumulate is true, the product is added to C instead.  C must already
+ * have the right size.  For packed triangular operands, the inner products
+ * skip the elements known to be zero, and for a packed C only the stored
+ * triangle is computed.
+ *
+ * @sa cml/packed.h
+ */
+template<class ResultT, class LeftT, class RightT> inline void
+MatMulSimple(ResultT& C, const LeftT& left, const RightT& right,
+        typename ResultT::value_type alpha = 1, bool accumulate = false)
+{
+    typedef typename ResultT::value_type value_type;
+    typedef typename et::MatrixStructure<ResultT>::type result_structure;
+    typedef typename et::MatrixStructure<LeftT>::type left_structure;
+    typedef typename et::MatrixStructure<RightT>::type right_structure;
+    for(size_t i = 0; i < left.rows(); ++i) {               /* rows */
+        size_t j0 = 0, j1 = right.cols();
+        StoredCols(i, j0, j1, result_structure());
+        for(size_t j = j0; j < j1; ++j) {                   /* cols */
+            size_t k0 = 0, k1 = right.rows();
+            NonZeroCols(i, k0, k1, left_structure());
+            NonZeroRows(j, k0, k1, right_structure());
+            value_type sum(0);
+            for(size_t k = k0; k < k1; ++k) {
+                sum += (left(i,k)*right(k,j));
+            }
+            if(accumulate) C(i,j) += alpha*sum; else C(i,j) = alpha*sum;
+        }
+    }
+}
+
+/** True if any of the matrices of a product is a packed symmetric or
+ * triangular matrix, so that the product is computed by MatMulSimple().
+ */
+template<class ResultT, class LeftT, class RightT> struct MatMulStructured {
+    enum { is_true =
+        !same_type<typename et::MatrixStructure<ResultT>::type,
+            general_tag>::is_true
+        || !same_type<typename et::MatrixStructure<LeftT>::type,
+            general_tag>::is_true
+        || !same_type<typename et::MatrixStructure<RightT>::type,
+            general_tag>::is_true
+    };
+};
+
+/** Fixed-size products of mixed element types use the simple loop. */
+template<class ResultT, class LeftT, class RightT> inline void
+MatMulCompute(ResultT& C, const LeftT& left, const RightT& right,
+        fixed_size_tag)
+{
+    MatMulSimple(C,left,right);
+}
+
+/** Fixed-size products involving strided matrices use the simple loop. */
+template<class ResultT, class LeftT, class RightT> inline void
+MatMulContiguous(ResultT& C, const LeftT& left, const RightT& right,
+        false_type)
+{
+    MatMulSimple(C,left,right);
+}
+
+/** Fixed-size products of contiguous matrices work directly on the arrays,
+ * using unrolled (and, where possible, SIMD) kernels.
+ *
+ * @sa MatMulFixed
+ */
+template<class ResultT, class LeftT, class RightT> inline void
+MatMulContiguous(ResultT& C, const LeftT& left, const RightT& right,
+        true_type)
+{
+    MatMulFixed<
+        LeftT::array_rows, LeftT::array_cols, RightT::array_cols,
+        typename ResultT::layout,
+        typename LeftT::layout, typename RightT::layout
+    >::compute(C.data(), left.data(), right.data());
+}
+
+/** Fixed-size products with a single element type work directly on the
+ * arrays, unless one of the matrices is strided.
+ */
+template<typename E, class AT1, class AT2, class AT3, typename BO,
+    typename L1, typename L2, typename L3> inline void
+MatMulCompute(matrix<E,AT1,BO,L1>& C,
+        const matrix<E,AT2,BO,L2>& left, const matrix<E,AT3,BO,L3>& right,
+        fixed_size_tag)
+{
+    typedef typename is_true<contiguous_storage<AT1>::is_true
+        && contiguous_storage<AT2>::is_true
+        && contiguous_storage<AT3>::is_true>::result contiguous;
+    MatMulContiguous(C,left,right,contiguous());
+}
+
+#if defined(CML_PARALLEL)
+/* Defined in cml/matrix/parallel_mul.h: */
+template<class ResultT, class LeftT, class RightT> void
+MatMulParallel(ResultT& C, const LeftT& left, const RightT& right,
+        thread_pool& pool,
+        typename ResultT::value_type alpha, bool accumulate);
+#endif
+
+/** Compute C = alpha A x B, or C += alpha A x B if accumulate is true, for
+ * fixed-size A and B.
+ *
+ * The product is computed into a fixed-size temporary first.
+ */
+template<class ResultT, class LeftT, class RightT> inline void
+MatMulUpdate(ResultT& C, const LeftT& left, const RightT& right,
+        typename ResultT::value_type alpha, bool accumulate, fixed_size_tag)
+{
+    typedef typename et::MatrixStructure<ResultT>::type result_structure;
+    typename et::MatrixPromote<LeftT,RightT>::temporary_type T;
+    MatMulCompute(T, left, right, fixed_size_tag());
+    for(size_t i = 0; i < T.rows(); ++i) {
+        size_t j0 = 0, j1 = T.cols();
+        StoredCols(i, j0, j1, result_structure());
+        for(size_t j = j0; j < j1; ++j) {
+            if(accumulate) C(i,j) += alpha*T(i,j); else C(i,j) = alpha*T(i,j);
+        }
+    }
+}
+
+/** Compute C = alpha A x B, or C += alpha A x B if accumulate is true, for
+ * run-time sized A and B.
+ *
+ * This uses the cache-blocked kernel, unless the product is too small for
+ * blocking to pay off, or involves a packed matrix.  If CML_PARALLEL is
+ * defined, large products are split across the default thread pool.
+ *
+ * @sa CML_BLOCKED_MUL_THRESHOLD
+ * @sa CML_PARALLEL_MUL_THRESHOLD
+ */
+template<class ResultT, class LeftT, class RightT> inline void
+MatMulUpdate(ResultT& C, const LeftT& left, const RightT& right,
+        typename ResultT::value_type alpha, bool accumulate, dynamic_size_tag)
+{
+    const size_t M = C.rows(), N = C.cols(), K = left.cols();
+    const size_t T = CML_BLOCKED_MUL_THRESHOLD;
+    if(MatMulStructured<ResultT,LeftT,RightT>::is_true || M*N*K < T*T*T) {
+        MatMulSimple(C,left,right,alpha,accumulate);
+#if defined(CML_PARALLEL)
+    } else if(M*N*K >= size_t(CML_PARALLEL_MUL_THRESHOLD)
+            *CML_PARALLEL_MUL_THRESHOLD*CML_PARALLEL_MUL_THRESHOLD)
+    {
+        MatMulParallel(C,left,right,default_thread_pool(),alpha,accumulate);
+#endif
+    } else {
+        MatMulBlocked(C,left,right,0,M,0,N,alpha,accumulate);
+    }
+}
+
+/** Run-time sized products use the cache-blocked kernel, unless the
+ * product is too small for blocking to pay off.
+ *
+ * @sa MatMulUpdate
+ */
+template<class ResultT, class LeftT, class RightT> inline void
+MatMulCompute(ResultT& C, const LeftT& left, const RightT& right,
+        dynamic_size_tag)
+{
+    MatMulUpdate(C,left,right,1,false,dynamic_size_tag());
+}
+
+/** Return true if C shares storage with the matrix X.
+ *
+ * The storage of each matrix is taken to run from its first to its last
+ * element, which also covers strided matrices.
+ */
+template<class MatT, class OtherT> inline bool
+MatMulAliases(const MatT& C, const OtherT& X)
+{
+    if(C.rows() == 0 || C.cols() == 0 || X.rows() == 0 || X.cols() == 0)
+        return false;
+    const char* c0 = (const char*) &C(0,0);
+    const char* c1 = (const char*) (&C(C.rows()-1,C.cols()-1) + 1);
+    const char* x0 = (const char*) &X(0,0);
+    const char* x1 = (const char*) (&X(X.rows()-1,X.cols()-1) + 1);
+    return c0 < x1 && x0 < c1;
+}
+
+
 /** Matrix multiplication.
  *
- * Computes C = A x B (O(N^3), non-blocked algorithm).
+ * Computes C = A x B (O(N^3)).  Large run-time sized products are computed
+ * with a cache-blocked algorithm, and fixed-size products with unrolled
+ * kernels.
+ *
+ * @sa MatMulBlocked
  */
 template<class LeftT, class RightT>
 inline typename et::MatrixPromote<
@@ -108,37 +304,211 @@ mul(const LeftT& left, const RightT& right)
      * fixed-size matrices):
      */
     result_type C;
-    cml::et::detail::Resize(C, N);
+    cml::et::detail::ResizeUninitialized(C, N);
+
+    /* Compute the product with the algorithm for the result size type: */
+    MatMulCompute(C, left, right, size_tag());
+
+    return C;
+}
+
+} // namespace detail
+
+namespace et {
 
-    /* XXX Specialize this for fixed-size matrices: */
+/** A matrix product node in the expression tree.
+ *
+ * The operands are matrices, held by reference.  Assignments compute the
+ * product directly into the destination matrix via MatrixDirectEval<>.
+ * Otherwise, the whole product is computed into a temporary when the first
+ * element is read.
+ *
+ * @sa cml::et::detail::MatrixDirectEval
+ */
+template<class LeftT, class RightT>
+class MatrixProductOp
+{
+  public:
+
+    typedef MatrixProductOp<LeftT,RightT> expr_type;
+
+    /* Copy the expression by value into parent expression tree nodes: */
+    typedef expr_type expr_const_reference;
+
+    /* Record the expression traits for the two operands: */
+    typedef ExprTraits<LeftT> left_traits;
+    typedef ExprTraits<RightT> right_traits;
+
+    /* Reference types for the two operands: */
+    typedef typename left_traits::const_reference left_reference;
+    typedef typename right_traits::const_reference right_reference;
+
+    /* The product's result type and temporary type: */
+    typedef typename MatrixPromote<LeftT,RightT>::type result_type;
+    typedef typename result_type::temporary_type temporary_type;
     typedef typename result_type::value_type value_type;
-    for(size_t i = 0; i < left.rows(); ++i) {               /* rows */
-        for(size_t j = 0; j < right.cols(); ++j) {          /* cols */
-            value_type sum(left(i,0)*right(0,j));
-            for(size_t k = 1; k < right.rows(); ++k) {
-                sum += (left(i,k)*right(k,j));
-            }
-            C(i,j) = sum;
+    typedef typename result_type::size_tag size_tag;
+    typedef matrix_result_tag result_tag;
+
+    /* For matching by assignability: */
+    typedef cml::et::not_assignable_tag assignable_tag;
+
+
+  public:
+
+    /** Record result size as an enum (if applicable). */
+    enum {
+        array_rows = result_type::array_rows,
+        array_cols = result_type::array_cols
+    };
+
+
+  public:
+
+    /** Return the expression size as a pair. */
+    matrix_size size() const {
+        return matrix_size(this->rows(),this->cols());
+    }
+
+    /** Return number of rows in the result. */
+    size_t rows() const { return m_left.rows(); }
+
+    /** Return number of cols in the result. */
+    size_t cols() const { return m_right.cols(); }
+
+    /** Compute value at index i,j of the result matrix.
+     *
+     * @note The first call computes the whole product.
+     */
+    value_type operator()(size_t i, size_t j) const {
+        if(!m_evaluated) {
+            cml::et::detail::ResizeUninitialized(m_result, this->size());
+            cml::detail::MatMulCompute(m_result, m_left, m_right, size_tag());
+            m_evaluated = true;
         }
+        return m_result(i,j);
     }
 
-    return C;
-}
+    /** Return reference to left operand. */
+    left_reference left_expression() const { return m_left; }
+
+    /** Return reference to right operand. */
+    right_reference right_expression() const { return m_right; }
+
+
+  public:
+
+    /** Construct from the two operands.
+     *
+     * @throws std::invalid_argument if the operand sizes don't match.
+     */
+    explicit MatrixProductOp(left_reference left, right_reference right)
+        : m_left(left), m_right(right), m_evaluated(false)
+    {
+        cml::detail::MatMulCheckedSize(left, right, size_tag());
+    }
+
+    /** Copy constructor (the computed product is not copied). */
+    MatrixProductOp(const expr_type& e)
+        : m_left(e.m_left), m_right(e.m_right), m_evaluated(false) {}
+
+
+  protected:
+
+    left_reference m_left;
+    right_reference m_right;
+
+    /* The product, once computed: */
+    mutable temporary_type m_result;
+    mutable bool m_evaluated;
+
+
+  private:
+
+    /* Cannot be assigned to: */
+    expr_type& operator=(const expr_type&);
+};
+
+/** Expression traits for MatrixProductOp<>. */
+template<class LeftT, class RightT>
+struct ExprTraits< MatrixProductOp<LeftT,RightT> >
+{
+    typedef MatrixProductOp<LeftT,RightT> expr_type;
+    typedef LeftT left_type;
+    typedef RightT right_type;
+
+    typedef typename expr_type::value_type value_type;
+    typedef typename expr_type::expr_const_reference const_reference;
+    typedef typename expr_type::result_tag result_tag;
+    typedef typename expr_type::size_tag size_tag;
+    typedef typename expr_type::result_type result_type;
+    typedef typename expr_type::assignable_tag assignable_tag;
+    typedef expr_node_tag node_tag;
+
+    value_type get(const expr_type& e, size_t i, size_t j) const {
+        return e(i,j);
+    }
+
+    matrix_size size(const expr_type& e) const { return e.size(); }
+    size_t rows(const expr_type& e) const { return e.rows(); }
+    size_t cols(const expr_type& e) const { return e.cols(); }
+};
+
+namespace detail {
+
+/** Compute products directly into the destination matrix. */
+template<class LeftT, class RightT>
+struct MatrixDirectEval< MatrixProductOp<LeftT,RightT> >
+{
+    typedef MatrixProductOp<LeftT,RightT> expr_type;
+    typedef typename expr_type::value_type value_type;
+    typedef typename expr_type::size_tag size_tag;
+
+    enum { is_true = true };
+
+    /** The kernels need the same element type, and no aliasing. */
+    template<class MatT> static bool
+    direct(const MatT& dest, const expr_type& e) {
+        return same_type<typename MatT::value_type, value_type>::is_true
+            && !cml::detail::MatMulAliases(dest, e.left_expression())
+            && !cml::detail::MatMulAliases(dest, e.right_expression());
+    }
+
+    template<class MatT> static void
+    eval(MatT& dest, const expr_type& e, bool accumulate, bool negate) {
+        if(!accumulate && !negate) {
+            cml::detail::MatMulCompute(dest,
+                    e.left_expression(), e.right_expression(), size_tag());
+        } else {
+            cml::detail::MatMulUpdate(dest,
+                    e.left_expression(), e.right_expression(),
+                    typename MatT::value_type(negate ? -1 : 1), accumulate,
+                    size_tag());
+        }
+    }
+};
 
 } // namespace detail
+} // namespace et
 
 
-/** operator*() for two matrices. */
+/** operator*() for two matrices.
+ *
+ * The product is not computed until the expression is assigned, or an
+ * element of it is read.
+ */
 template<typename E1, class AT1, typename L1,
          typename E2, class AT2, typename L2,
          typename BO>
-inline typename et::MatrixPromote<
-    matrix<E1,AT1,BO,L1>, matrix<E2,AT2,BO,L2>
->::temporary_type
+inline et::MatrixXpr<
+    et::MatrixProductOp< matrix<E1,AT1,BO,L1>, matrix<E2,AT2,BO,L2> >
+>
 operator*(const matrix<E1,AT1,BO,L1>& left,
           const matrix<E2,AT2,BO,L2>& right)
 {
-    return detail::mul(left,right);
+    typedef et::MatrixProductOp<
+        matrix<E1,AT1,BO,L1>, matrix<E2,AT2,BO,L2> > ExprT;
+    return et::MatrixXpr<ExprT>(ExprT(left,right));
 }
 
 /** operator*() for a matrix and a MatrixXpr. */
@@ -152,7 +522,7 @@ operator*(const matrix<E,AT,BO,L>& left,
     /* Generate a temporary, and compute the right-hand expression: */
     typedef typename et::MatrixXpr<XprT>::temporary_type expr_tmp;
     expr_tmp tmp;
-    cml::et::detail::Resize(tmp,right.rows(),right.cols());
+    cml::et::detail::ResizeUninitialized(tmp,right.rows(),right.cols());
     tmp = right;
 
     return detail::mul(left,tmp);
@@ -169,7 +539,7 @@ operator*(const et::MatrixXpr<XprT>& left,
     /* Generate a temporary, and compute the left-hand expression: */
     typedef typename et::MatrixXpr<XprT>::temporary_type expr_tmp;
     expr_tmp tmp;
-    cml::et::detail::Resize(tmp,left.rows(),left.cols());
+    cml::et::detail::ResizeUninitialized(tmp,left.rows(),left.cols());
     tmp = left;
 
     return detail::mul(tmp,right);
@@ -186,12 +556,12 @@ operator*(const et::MatrixXpr<XprT1>& left,
     /* Generate temporaries and compute expressions: */
     typedef typename et::MatrixXpr<XprT1>::temporary_type left_tmp;
     left_tmp ltmp;
-    cml::et::detail::Resize(ltmp,left.rows(),left.cols());
+    cml::et::detail::ResizeUninitialized(ltmp,left.rows(),left.cols());
     ltmp = left;
 
     typedef typename et::MatrixXpr<XprT2>::temporary_type right_tmp;
     right_tmp rtmp;
-    cml::et::detail::Resize(rtmp,right.rows(),right.cols());
+    cml::et::detail::ResizeUninitialized(rtmp,right.rows(),right.cols());
     rtmp = right;
 
     return detail::mul(ltmp,rtmp);
@@ -199,6 +569,10 @@ operator*(const et::MatrixXpr<XprT1>& left,
 
 } // namespace cml
 
+#if defined(CML_PARALLEL)
+#include <cml/matrix/parallel_mul.h>
+#endif
+
 #endif
 
 // -------------------------------------------------------------------------
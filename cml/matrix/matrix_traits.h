@@ -14,6 +14,9 @@ Boost Software License, v1.0 (see cml/LICENSE for details).
 #define matrix_traits_h
 
 #include <cml/et/traits.h>
+#include <cml/et/packet.h>
+#include <cml/packed.h>
+#include <cml/banded.h>
 
 namespace cml {
 namespace et {
@@ -31,6 +34,9 @@ struct ExprTraits< cml::matrix<E,AT,BO,L> >
     typedef expr_type result_type;
     typedef expr_leaf_tag node_tag;
 
+    /* The alignment of the matrix's array in bytes: */
+    enum { alignment = expr_type::array_alignment };
+
     value_type get(const expr_type& m, size_t i, size_t j) const {
         return m(i,j);
     }
@@ -40,6 +46,64 @@ struct ExprTraits< cml::matrix<E,AT,BO,L> >
     size_t cols(const expr_type& m) const { return m.cols(); }
 };
 
+/** Packet access to a matrix<> type, when the packets are in the matrix's
+ * storage order.  Element k is at offset k in the matrix's array.  Aligned
+ * loads are used if the array is aligned to the packet size.  Strided
+ * matrices have gaps in their arrays, and are read one element at a time.
+ */
+template<typename E, class AT, typename BO, typename L>
+struct PacketAccess<
+    cml::matrix<E,AT,BO,L>, MatrixPacket<E,L>, matrix_result_tag >
+{
+    typedef MatrixPacket<E,L> packet;
+    enum { is_true = (packet::size > 1) && contiguous_storage<AT>::is_true };
+    enum { alignment = ExprTraits< cml::matrix<E,AT,BO,L> >::alignment };
+    static typename packet::type
+    load(const cml::matrix<E,AT,BO,L>& m, size_t k) {
+        return PacketLoad<packet,alignment>::load(m.data() + k);
+    }
+};
+
+/** Whether every matrix in the expression ExprT is stored with layout
+ * Layout, so that the expression can be traversed in that storage order
+ * without striding through any operand.
+ *
+ * This is the general case, for expressions (like transposes) that are
+ * assumed to access their operands out of order.  Scalars always match.
+ */
+template<class ExprT, class Layout,
+    class ResultTag = typename ExprTraits<ExprT>::result_tag>
+struct MatrixLayoutMatch {
+    enum { is_true = false };
+};
+
+template<class ScalarT, class Layout>
+struct MatrixLayoutMatch<ScalarT,Layout,scalar_result_tag> {
+    enum { is_true = true };
+};
+
+template<typename E, class AT, typename BO, typename L>
+struct MatrixLayoutMatch<cml::matrix<E,AT,BO,L>,L,matrix_result_tag> {
+    enum { is_true = true };
+};
+
+/** The structure of the matrix expression ExprT: general_tag for
+ * expressions and general matrices, and symmetric_tag,
+ * lower_triangular_tag or upper_triangular_tag for packed matrices, and
+ * banded_tag<> for banded matrices.
+ *
+ * @sa cml/packed.h
+ * @sa cml/banded.h
+ */
+template<class ExprT> struct MatrixStructure {
+    typedef general_tag type;
+};
+
+template<typename E, class AT, typename BO, typename L>
+struct MatrixStructure< cml::matrix<E,AT,BO,L> > {
+    typedef typename matrix_structure<AT>::type type;
+};
+
 } // namespace et
 } // namespace cml
 
@@ -183,7 +183,7 @@ transpose(const matrix<E,AT,BO,L>& expr)
 
     /* Create the temporary and return it: */
     tmp_type tmp;
-    cml::et::detail::Resize(tmp,expr.rows(),expr.cols());
+    cml::et::detail::ResizeUninitialized(tmp,expr.cols(),expr.rows());
     tmp = ExprT(Op(expr));
     return tmp;
 }
@@ -210,7 +210,7 @@ transpose(MATXPR_ARG_TYPE expr)
 
     /* Create the temporary and return it: */
     tmp_type tmp;
-    cml::et::detail::Resize(tmp,expr.rows(),expr.cols());
+    cml::et::detail::ResizeUninitialized(tmp,expr.cols(),expr.rows());
     tmp = ExprT(Op(expr.expression()));
     return tmp;
 }
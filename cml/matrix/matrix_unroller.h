@@ -7,9 +7,15 @@ Boost Software License, v1.0 (see cml/LICENSE for details).
 
  *-----------------------------------------------------------------------*/
 /** @file
- *  @brief
+ *  @brief Elementwise assignment of matrix expressions.
  *
- * @todo Need to implement unrolling for efficient col-major array access.
+ * Elements are assigned in the storage order of the destination matrix
+ * (along rows for row_major, along columns for col_major).  If every matrix
+ * in the source expression has the same layout, contiguous runs of elements
+ * are assigned a SIMD packet at a time (see cml/et/packet.h).  Otherwise,
+ * large matrices are assigned in square tiles of CML_MATRIX_ASSIGN_TILE
+ * elements, so that transposes and mixed layouts don't stride through
+ * memory.
  *
  * @todo Does it make sense to unroll an assignment if either side of the
  * assignment has a fixed size, or just when the target matrix is fixed
@@ -19,9 +25,13 @@ Boost Software License, v1.0 (see cml/LICENSE for details).
 #ifndef matrix_unroller_h
 #define matrix_unroller_h
 
+#include <algorithm>
 #include <cml/et/traits.h>
 #include <cml/et/size_checking.h>
+#include <cml/packed.h>
+#include <cml/banded.h>
 #include <cml/et/scalar_ops.h>
+#include <cml/matrix/matrix_expr.h>
 
 #if !defined(CML_2D_UNROLLER) && !defined(CML_NO_2D_UNROLLER)
 #error "The matrix unroller has not been defined."
@@ -33,18 +43,218 @@ Boost Software License, v1.0 (see cml/LICENSE for details).
 
 namespace cml {
 namespace et {
+
+/* Forward declare for the direct assignment helpers below: */
+template<class OpT, class SrcT, typename E, class AT, typename BO, typename L>
+inline void UnrollAssignment(cml::matrix<E,AT,BO,L>& dest, const SrcT& src);
+
 namespace detail {
 
+/** The row and column of element K of a Rows x Cols matrix, counting in
+ * the storage order given by Layout.
+ */
+template<class Layout, int Rows, int Cols, int K> struct MatrixStorageIndex;
+
+template<int Rows, int Cols, int K>
+struct MatrixStorageIndex<row_major,Rows,Cols,K> {
+    enum { row = K / Cols, col = K % Cols };
+};
+
+template<int Rows, int Cols, int K>
+struct MatrixStorageIndex<col_major,Rows,Cols,K> {
+    enum { row = K % Rows, col = K / Rows };
+};
+
+/** Apply OpT to the elements of a row-major dest, from element k in
+ * storage order to the end.
+ */
+template<class OpT, class MatT, class SrcT> inline void
+MatrixAssignRange(MatT& dest, const SrcT& src,
+        size_t k, size_t rows, size_t cols, row_major)
+{
+    typedef ExprTraits<SrcT> src_traits;
+    if(cols == 0) return;
+    size_t j = k % cols;
+    for(size_t i = k / cols; i < rows; ++i, j = 0) {
+        for(; j < cols; ++j) {
+            OpT().apply(dest(i,j), src_traits().get(src,i,j));
+        }
+    }
+}
+
+/** Apply OpT to the elements of a col-major dest, from element k in
+ * storage order to the end.
+ */
+template<class OpT, class MatT, class SrcT> inline void
+MatrixAssignRange(MatT& dest, const SrcT& src,
+        size_t k, size_t rows, size_t cols, col_major)
+{
+    typedef ExprTraits<SrcT> src_traits;
+    if(rows == 0) return;
+    size_t i = k % rows;
+    for(size_t j = k / rows; j < cols; ++j, i = 0) {
+        for(; i < rows; ++i) {
+            OpT().apply(dest(i,j), src_traits().get(src,i,j));
+        }
+    }
+}
+
+/** Apply OpT to every element of dest, one CML_MATRIX_ASSIGN_TILE square
+ * tile at a time.
+ *
+ * This is used when src reads some operand out of dest's storage order
+ * (e.g. a transpose, or a matrix with the other layout), so that the lines
+ * of that operand touched by a tile are still in the cache when the next
+ * line of the tile is assigned.  The tiles are visited, and the elements in
+ * each tile are assigned, in dest's storage order.
+ */
+template<class OpT, class MatT, class SrcT, class Layout> inline void
+MatrixAssignTiled(MatT& dest, const SrcT& src,
+        size_t rows, size_t cols, Layout)
+{
+    typedef ExprTraits<SrcT> src_traits;
+    const bool by_row = same_type<Layout,row_major>::is_true;
+    const size_t T = CML_MATRIX_ASSIGN_TILE;
+    const size_t outer = by_row ? rows : cols, inner = by_row ? cols : rows;
+    for(size_t o0 = 0; o0 < outer; o0 += T) {
+        const size_t o1 = std::min(o0 + T, outer);
+        for(size_t n0 = 0; n0 < inner; n0 += T) {
+            const size_t n1 = std::min(n0 + T, inner);
+            for(size_t o = o0; o < o1; ++o) {
+                for(size_t n = n0; n < n1; ++n) {
+                    const size_t i = by_row ? o : n, j = by_row ? n : o;
+                    OpT().apply(dest(i,j), src_traits().get(src,i,j));
+                }
+            }
+        }
+    }
+}
+
+/** Apply OpT to every element of dest in the best order for src. */
+template<class OpT, class MatT, class SrcT, class Layout> inline void
+MatrixAssignLoop(MatT& dest, const SrcT& src,
+        size_t rows, size_t cols, Layout)
+{
+    const size_t T = CML_MATRIX_ASSIGN_TILE;
+    if(!MatrixLayoutMatch<SrcT,Layout>::is_true && rows > T && cols > T) {
+        MatrixAssignTiled<OpT>(dest,src,rows,cols,Layout());
+    } else {
+        MatrixAssignRange<OpT>(dest,src,0,rows,cols,Layout());
+    }
+}
+
+/** Apply OpT to the stored elements of a packed row-major dest. */
+template<class OpT, class MatT, class SrcT, class Structure> inline void
+MatrixAssignStored(MatT& dest, const SrcT& src,
+        size_t rows, size_t cols, Structure, row_major)
+{
+    typedef ExprTraits<SrcT> src_traits;
+    for(size_t i = 0; i < rows; ++i) {
+        size_t j0 = 0, j1 = cols;
+        cml::detail::StoredCols(i, j0, j1, Structure());
+        for(size_t j = j0; j < j1; ++j) {
+            OpT().apply(dest(i,j), src_traits().get(src,i,j));
+        }
+    }
+}
+
+/** Apply OpT to the stored elements of a packed col-major dest. */
+template<class OpT, class MatT, class SrcT, class Structure> inline void
+MatrixAssignStored(MatT& dest, const SrcT& src,
+        size_t rows, size_t cols, Structure, col_major)
+{
+    typedef ExprTraits<SrcT> src_traits;
+    for(size_t j = 0; j < cols; ++j) {
+        size_t i0 = 0, i1 = rows;
+        cml::detail::StoredRows(j, i0, i1, Structure());
+        for(size_t i = i0; i < i1; ++i) {
+            OpT().apply(dest(i,j), src_traits().get(src,i,j));
+        }
+    }
+}
+
+/** Apply an assignment operator a packet at a time.
+ *
+ * This is the general case, for element types, operators, or source
+ * expressions that can't be evaluated with SIMD packets, including any
+ * source expression that reads a matrix with a different layout than dest,
+ * and strided destinations.
+ *
+ * @sa cml/et/packet.h
+ */
+template<class OpT, typename E, class AT, typename BO, typename L,
+    class SrcT,
+    bool UsePackets = (MatrixPacket<E,L>::size > 1
+            && contiguous_storage<AT>::is_true
+            && PacketOp<OpT, MatrixPacket<E,L> >::is_true
+            && PacketAccess<SrcT, MatrixPacket<E,L> >::is_true)>
+struct MatrixPacketAssign
+{
+    enum { is_true = false, size = 1 };
+
+    /** Returns the number of elements assigned, here 0. */
+    size_t operator()(cml::matrix<E,AT,BO,L>&, const SrcT&, size_t) const {
+        return 0;
+    }
+};
+
+/** Apply an assignment operator to as many whole packets as fit in the
+ * first N elements of dest, in storage order.
+ */
+template<class OpT, typename E, class AT, typename BO, typename L,
+    class SrcT>
+struct MatrixPacketAssign<OpT,E,AT,BO,L,SrcT,true>
+{
+    typedef MatrixPacket<E,L> packet;
+    typedef PacketAccess<SrcT,packet> src_access;
+    typedef PacketLoad<packet,
+            ExprTraits< cml::matrix<E,AT,BO,L> >::alignment> dest_access;
+
+    enum { is_true = true, size = packet::size };
+
+    /** Returns the number of elements assigned.  The rest must be assigned
+     * one at a time by the caller.
+     */
+    size_t operator()(
+            cml::matrix<E,AT,BO,L>& dest, const SrcT& src, size_t N) const
+    {
+        const size_t Last = N - N % size;
+        if(Last == 0) return 0;
+        E* d = dest.data();
+        for(size_t k = 0; k < Last; k += size) {
+            dest_access::store(d + k, OpT::template packet_apply<packet>(
+                        dest_access::load(d + k), src_access::load(src,k)));
+        }
+        return Last;
+    }
+};
+
+/** Resize dest before it is assigned by OpT.
+ *
+ * Plain assignment overwrites every element, so the elements are not reset
+ * first.
+ */
+template<class OpT> struct MatrixAssignResize {
+    template<class MatT> static void resize(MatT& dest, matrix_size N) {
+        Resize(dest,N);
+    }
+};
+
+template<class L, class R> struct MatrixAssignResize< OpAssign<L,R> > {
+    template<class MatT> static void resize(MatT& dest, matrix_size N) {
+        ResizeUninitialized(dest,N);
+    }
+};
+
 /** Unroll a binary assignment operator on a fixed-size matrix.
  *
- * This uses a forward iteration to make better use of the cache.
+ * Elements are assigned in the storage order of the destination matrix, a
+ * SIMD packet at a time if possible.
  *
  * @sa cml::matrix
  * @sa cml::et::OpAssign
  *
  * @bug Need to verify that OpT is actually an assignment operator.
- * @bug The 2D unroller needs to be specified for efficient col-major
- * access.
  */
 template<class OpT, typename E, class AT, typename BO, typename L, class SrcT>
 class MatrixAssignmentUnroller
@@ -58,92 +268,54 @@ class MatrixAssignmentUnroller
     typedef ExprTraits<matrix_type> dest_traits;
     typedef ExprTraits<SrcT> src_traits;
 
+    enum {
+        Rows = matrix_type::array_rows,
+        Cols = matrix_type::array_cols
+    };
+
 #if defined(CML_2D_UNROLLER)
 
     /* Forward declare: */
-    template<int R, int C, int LastRow, int LastCol, bool can_unroll>
-        struct Eval;
-
-    /* XXX This needs to be specified for efficient col-major access also! */
+    template<int K, int Last, bool can_unroll> struct Eval;
 
-    /** Evaluate the binary operator at element R,C. */
-    template<int R, int C, int LastRow, int LastCol>
-        struct Eval<R,C,LastRow,LastCol,true> {
-            void operator()(matrix_type& dest, const SrcT& src) const {
-
-                /* Apply to current R,C: */
-                OpT().apply(dest(R,C), src_traits().get(src,R,C));
-
-                /* Evaluate at R,C+1: */
-                Eval<R,C+1,LastRow,LastCol,true>()(dest,src);
-            }
-        };
-
-    /** Evaluate the binary operator at element R,LastCol. */
-    template<int R, int LastRow, int LastCol>
-        struct Eval<R,LastCol,LastRow,LastCol,true> {
-            void operator()(matrix_type& dest, const SrcT& src) const {
-
-                /* Apply to R,LastCol: */
-                OpT().apply(dest(R,LastCol), src_traits().get(src,R,LastCol));
-
-                /* Evaluate at R+1,0; i.e. move to next row and start the
-                 * col iteration from 0:
-                 */
-                Eval<R+1,0,LastRow,LastCol,true>()(dest,src);
-            }
-        };
-
-    /** Evaluate the binary operator at element LastRow,C. */
-    template<int C, int LastRow, int LastCol>
-        struct Eval<LastRow,C,LastRow,LastCol,true> {
-            void operator()(matrix_type& dest, const SrcT& src) const {
-
-                /* Apply to LastRow,C: */
-                OpT().apply(dest(LastRow,C), src_traits().get(src,LastRow,C));
-
-                /* Evaluate at LastRow,C+1: */
-                Eval<LastRow,C+1,LastRow,LastCol,true>()(dest,src);
-            }
-        };
+    /** Evaluate the binary operator at element K in storage order. */
+    template<int K, int Last> struct Eval<K,Last,true> {
+        void operator()(matrix_type& dest, const SrcT& src) const {
+            typedef MatrixStorageIndex<L,Rows,Cols,K> index;
 
-    /** Evaluate the binary operator at element LastRow,LastCol. */
-    template<int LastRow, int LastCol>
-        struct Eval<LastRow,LastCol,LastRow,LastCol,true> {
-            void operator()(matrix_type& dest, const SrcT& src) const {
+            /* Apply to the current element: */
+            OpT().apply(dest(index::row,index::col),
+                    src_traits().get(src,index::row,index::col));
 
-                /* Apply to LastRow,LastCol: */
-                OpT().apply(
-                        dest(LastRow,LastCol),
-                        src_traits().get(src,LastRow,LastCol));
-            }
-        };
+            /* Evaluate at the next element: */
+            Eval<K+1,Last,true>()(dest,src);
+        }
+    };
 
+    /** Evaluate the binary operator at the last element. */
+    template<int Last> struct Eval<Last,Last,true> {
+        void operator()(matrix_type& dest, const SrcT& src) const {
+            typedef MatrixStorageIndex<L,Rows,Cols,Last> index;
+            OpT().apply(dest(index::row,index::col),
+                    src_traits().get(src,index::row,index::col));
+        }
+    };
 
     /** Evaluate operators on large matrices using a loop. */
-    template<int R, int C, int LastRow, int LastCol>
-        struct Eval<R,C,LastRow,LastCol,false> {
-            void operator()(matrix_type& dest, const SrcT& src) const {
-                for(size_t i = 0; i <= LastRow; ++i) {
-                    for(size_t j = 0; j <= LastCol; ++j) {
-                        OpT().apply(dest(i,j), src_traits().get(src,i,j));
-                    }
-                }
-            }
-        };
+    template<int K, int Last> struct Eval<K,Last,false> {
+        void operator()(matrix_type& dest, const SrcT& src) const {
+            MatrixAssignLoop<OpT>(dest,src,Rows,Cols,L());
+        }
+    };
 
 #endif // CML_2D_UNROLLER
 
 #if defined(CML_NO_2D_UNROLLER)
 
     /** Evaluate the binary operator using a loop. */
-    template<int R, int C, int LastRow, int LastCol> struct Eval {
+    template<int K, int Last> struct Eval {
         void operator()(matrix_type& dest, const SrcT& src) const {
-            for(size_t i = 0; i <= LastRow; ++i) {
-                for(size_t j = 0; j <= LastCol; ++j) {
-                    OpT().apply(dest(i,j), src_traits().get(src,i,j));
-                }
-            }
+            MatrixAssignLoop<OpT>(dest,src,Rows,Cols,L());
         }
     };
 
@@ -156,23 +328,18 @@ class MatrixAssignmentUnroller
     void operator()(
             cml::matrix<E,AT,BO,L>& dest, const SrcT& src, cml::fixed_size_tag)
     {
-        typedef cml::matrix<E,AT,BO,L> matrix_type;
-        enum {
-            LastRow = matrix_type::array_rows-1,
-            LastCol = matrix_type::array_cols-1,
-            Max = (LastRow+1)*(LastCol+1)
-        };
+        enum { Max = Rows*Cols };
 
 #if defined(CML_2D_UNROLLER)
         typedef typename MatrixAssignmentUnroller<OpT,E,AT,BO,L,SrcT>
-            ::template Eval<0, 0, LastRow, LastCol,
-            (Max <= CML_MATRIX_UNROLL_LIMIT)> Unroller;
+            ::template Eval<0, Max-1, (Max <= CML_MATRIX_UNROLL_LIMIT)>
+            Unroller;
 #endif
 
 #if defined(CML_NO_2D_UNROLLER)
         /* Use a loop: */
         typedef typename MatrixAssignmentUnroller<OpT,E,AT,BO,L,SrcT>
-            ::template Eval<0, 0, LastRow, LastCol> Unroller;
+            ::template Eval<0, Max-1> Unroller;
 #endif
 
         /* Use a run-time check if src is a run-time sized expression: */
@@ -188,6 +355,17 @@ class MatrixAssignmentUnroller
          * src is a dynamic-sized expression, the check will still happen.
          */
 
+        /* Use SIMD packets for matrices with at least a packet of elements,
+         * with any remainder assigned one element at a time:
+         */
+        typedef MatrixPacketAssign<OpT,E,AT,BO,L,SrcT> packets;
+        if(packets::is_true && int(Max) >= int(packets::size)) {
+            size_t k = packets()(dest,src,Max);
+            MatrixAssignRange<OpT>(dest,src,k,Rows,Cols,L());
+            return;
+        }
+
+        /* Otherwise, call the unroller: */
         Unroller()(dest,src);
     }
 
@@ -219,7 +397,7 @@ class MatrixAssignmentUnroller
             dest, src, typename src_traits::result_tag());
 
         /* Set the destination matrix's size: */
-        dest.resize(N.first,N.second);
+        MatrixAssignResize<OpT>::resize(dest,N);
 #else
         matrix_size N = CheckedSize(dest,src,dynamic_size_tag());
 #endif
@@ -236,24 +414,239 @@ class MatrixAssignmentUnroller
   public:
 
 
-    /** Use a loop for dynamic-sized matrix assignment.
+    /** Use a loop for dynamic-sized matrix assignment, with SIMD packets if
+     * possible.
      *
      * @note The target matrix must already have the correct size.
-     *
-     * @todo This needs to be specialized for efficient row-major or col-major
-     * layout access.
      */
     void operator()(matrix_type& dest, const SrcT& src, cml::dynamic_size_tag)
     {
-        typedef ExprTraits<SrcT> src_traits;
         matrix_size N = this->CheckOrResize(
                 dest,src,typename matrix_type::resizing_tag());
-        for(size_t i = 0; i < N.first; ++i) {
-            for(size_t j = 0; j < N.second; ++j) {
-                OpT().apply(dest(i,j), src_traits().get(src,i,j));
-                /* Note: we don't need get(), since dest is a matrix. */
+
+        /* Packed symmetric and triangular matrices are assigned only their
+         * stored triangle:
+         */
+        typedef typename matrix_structure<AT>::type structure;
+        if(!same_type<structure,general_tag>::is_true) {
+            MatrixAssignStored<OpT>(
+                    dest,src,N.first,N.second,structure(),L());
+            return;
+        }
+
+        /* Assign whole packets in storage order, then the remaining
+         * elements:
+         */
+        typedef MatrixPacketAssign<OpT,E,AT,BO,L,SrcT> packets;
+        if(packets::is_true) {
+            size_t k = packets()(dest,src,N.first*N.second);
+            MatrixAssignRange<OpT>(dest,src,k,N.first,N.second,L());
+        } else {
+            MatrixAssignLoop<OpT>(dest,src,N.first,N.second,L());
+        }
+    }
+};
+
+/** Expressions that are computed as a whole directly into the destination
+ * matrix, rather than element by element.
+ *
+ * By default, expressions are evaluated elementwise.  This is specialized
+ * for expressions, like matrix products, that are much cheaper to compute as
+ * a whole.  A specialization sets is_true, and provides:
+ *
+ *   template<class MatT> static bool direct(const MatT& dest, const ExprT& e);
+ *   template<class MatT> static void eval(MatT& dest, const ExprT& e,
+ *       bool accumulate, bool negate);
+ *
+ * direct() returns false if e cannot be computed directly into dest (e.g.
+ * because dest is also an operand of e).  eval() computes dest = e, or dest
+ * += e if accumulate is true, with e negated if negate is true.  dest must
+ * already have the right size.
+ *
+ * @sa cml::et::MatrixProductOp
+ */
+template<class ExprT> struct MatrixDirectEval {
+    enum { is_true = false };
+};
+
+/** Classify an assignment operator: 1 for =, 2 for +=, 3 for -=, and 0 for
+ * anything else.
+ */
+template<class OpT> struct MatrixAssignKind { enum { value = 0 }; };
+template<class L, class R> struct MatrixAssignKind< OpAssign<L,R> > {
+    enum { value = 1 };
+};
+template<class L, class R> struct MatrixAssignKind< OpAddAssign<L,R> > {
+    enum { value = 2 };
+};
+template<class L, class R> struct MatrixAssignKind< OpSubAssign<L,R> > {
+    enum { value = 3 };
+};
+
+/** Resize (if allowed) and check dest before it is assigned from e. */
+template<class MatT, class ExprT> inline void
+MatrixDirectSize(MatT& dest, const ExprT& e, bool resize, dynamic_memory_tag)
+{
+#if defined(CML_AUTOMATIC_MATRIX_RESIZE_ON_ASSIGNMENT)
+    if(resize) {
+        matrix_size N = ExprTraits<ExprT>().size(e);
+        dest.resize_uninitialized(N.first,N.second);
+    }
+#endif
+    CheckedSize(dest,e,dynamic_size_tag());
+}
+
+/** Check fixed-size and external dest before it is assigned from e. */
+template<class MatT, class ExprT, class MemoryTag> inline void
+MatrixDirectSize(MatT& dest, const ExprT& e, bool, MemoryTag)
+{
+    /* Check at compile time if both are fixed-size: */
+    typedef typename select_if<
+        same_type<typename MatT::size_tag,fixed_size_tag>::is_true
+        && same_type<typename ExprTraits<ExprT>::size_tag,
+                     fixed_size_tag>::is_true,
+        fixed_size_tag, dynamic_size_tag>::result size_tag;
+    CheckedSize(dest,e,size_tag());
+}
+
+/** Dispatch to MatrixDirectEval<> for a single term, if it exists. */
+template<class ExprT, bool Direct = MatrixDirectEval<ExprT>::is_true>
+struct MatrixDirectTerm
+{
+    template<class MatT> static bool direct(const MatT&, const ExprT&) {
+        return false;
+    }
+    template<class MatT> static void eval(MatT&, const ExprT&, bool, bool) {}
+};
+
+/** MatrixDirectTerm<> for a directly computable term. */
+template<class ExprT> struct MatrixDirectTerm<ExprT,true>
+{
+    typedef MatrixDirectEval<ExprT> eval_type;
+
+    template<class MatT> static bool direct(const MatT& dest, const ExprT& e) {
+        return eval_type::direct(dest,e);
+    }
+    template<class MatT> static void
+    eval(MatT& dest, const ExprT& e, bool accumulate, bool negate) {
+        eval_type::eval(dest,e,accumulate,negate);
+    }
+};
+
+/** Try to compute dest op= e without evaluating e element by element.
+ *
+ * This handles "dest = e", "dest += e" and "dest -= e" for a single direct
+ * term.  Returns false if e must be evaluated elementwise instead.
+ */
+template<class OpT, class ExprT,
+    bool Direct = MatrixDirectEval<ExprT>::is_true>
+struct MatrixDirectAssign
+{
+    template<class MatT> static bool assign(MatT&, const ExprT&) {
+        return false;
+    }
+};
+
+/** MatrixDirectAssign<> for a single direct term. */
+template<class OpT, class ExprT> struct MatrixDirectAssign<OpT,ExprT,true>
+{
+    template<class MatT> static bool assign(MatT& dest, const ExprT& e) {
+        typedef MatrixDirectTerm<ExprT> term;
+        enum { kind = MatrixAssignKind<OpT>::value };
+        if(kind == 0 || !term::direct(dest,e)) return false;
+        MatrixDirectSize(dest, e, kind == 1, typename MatT::memory_tag());
+        term::eval(dest, e, kind != 1, kind == 3);
+        return true;
+    }
+};
+
+/** Unwrap a matrix expression. */
+template<class OpT, class ExprT>
+struct MatrixDirectAssign< OpT, MatrixXpr<ExprT>, false >
+{
+    template<class MatT> static bool
+    assign(MatT& dest, const MatrixXpr<ExprT>& e) {
+        return MatrixDirectAssign<OpT,ExprT>::assign(dest, e.expression());
+    }
+};
+
+/** Compute "dest = a + b" or "dest = a - b" as "dest = a" followed by
+ * "dest += b" or "dest -= b", when b is a direct term, or as "dest = b"
+ * followed by "dest += a" when a is a direct term (negating the result for
+ * a - b).
+ *
+ * This is only done if at least one of the terms is a direct term; the
+ * other term is evaluated (elementwise, or directly if possible) first.
+ */
+template<class OpT, class LeftT, class RightT, bool Subtract,
+    bool Direct = (MatrixDirectEval<LeftT>::is_true
+            || MatrixDirectEval<RightT>::is_true)>
+struct MatrixDirectSum
+{
+    template<class MatT, class ExprT> static bool
+    assign(MatT&, const ExprT&, const LeftT&, const RightT&) {
+        return false;
+    }
+};
+
+/** MatrixDirectSum<> with at least one direct term. */
+template<class OpT, class LeftT, class RightT, bool Subtract>
+struct MatrixDirectSum<OpT,LeftT,RightT,Subtract,true>
+{
+    template<class MatT, class ExprT> static bool
+    assign(MatT& dest, const ExprT& e, const LeftT& left, const RightT& right)
+    {
+        typedef typename MatT::value_type value_type;
+        typedef typename ExprTraits<LeftT>::value_type left_value;
+        typedef typename ExprTraits<RightT>::value_type right_value;
+
+        /* Only plain assignment is split: */
+        if(MatrixAssignKind<OpT>::value != 1) return false;
+
+        if(MatrixDirectTerm<RightT>::direct(dest,right)) {
+            MatrixDirectSize(dest, e, true, typename MatT::memory_tag());
+            UnrollAssignment< OpAssign<value_type,left_value> >(dest,left);
+            MatrixDirectTerm<RightT>::eval(dest, right, true, Subtract);
+            return true;
+        }
+
+        if(MatrixDirectTerm<LeftT>::direct(dest,left)) {
+            MatrixDirectSize(dest, e, true, typename MatT::memory_tag());
+            UnrollAssignment< OpAssign<value_type,right_value> >(dest,right);
+            MatrixDirectTerm<LeftT>::eval(dest, left, true, Subtract);
+            if(Subtract) {
+                /* dest = b - a, so negate it: */
+                UnrollAssignment< OpMulAssign<value_type,value_type> >(
+                        dest, value_type(-1));
             }
+            return true;
         }
+
+        return false;
+    }
+};
+
+/** Split the sum of two matrix expressions. */
+template<class OpT, class LeftT, class RightT, class L, class R>
+struct MatrixDirectAssign<
+    OpT, BinaryMatrixOp<LeftT,RightT,OpAdd<L,R> >, false >
+{
+    typedef BinaryMatrixOp<LeftT,RightT,OpAdd<L,R> > expr_type;
+    template<class MatT> static bool assign(MatT& dest, const expr_type& e) {
+        return MatrixDirectSum<OpT,LeftT,RightT,false>::assign(
+                dest, e, e.left_expression(), e.right_expression());
+    }
+};
+
+/** Split the difference of two matrix expressions. */
+template<class OpT, class LeftT, class RightT, class L, class R>
+struct MatrixDirectAssign<
+    OpT, BinaryMatrixOp<LeftT,RightT,OpSub<L,R> >, false >
+{
+    typedef BinaryMatrixOp<LeftT,RightT,OpSub<L,R> > expr_type;
+    template<class MatT> static bool assign(MatT& dest, const expr_type& e) {
+        return MatrixDirectSum<OpT,LeftT,RightT,true>::assign(
+                dest, e, e.left_expression(), e.right_expression());
     }
 };
 
@@ -265,6 +658,9 @@ class MatrixAssignmentUnroller
  * sense).  Also, automatic unrolling is only performed for fixed-size
  * matrices; a loop is used for dynamic-sized matrices.
  *
+ * Expressions with a MatrixDirectEval<> specialization (i.e. products) are
+ * computed directly into dest instead, if possible.
+ *
  * @sa cml::matrix
  * @sa cml::et::OpAssign
  *
@@ -279,9 +675,11 @@ inline void UnrollAssignment(cml::matrix<E,AT,BO,L>& dest, const SrcT& src)
     /* Record the type of the unroller: */
     typedef detail::MatrixAssignmentUnroller<OpT,E,AT,BO,L,SrcT> unroller;
 
-    /* Finally, do the unroll call: */
+    /* Compute expressions like products directly into dest if possible: */
+    if(detail::MatrixDirectAssign<OpT,SrcT>::assign(dest,src)) return;
+
+    /* Otherwise, do the unroll call: */
     unroller()(dest, src, typename matrix_type::size_tag());
-    /* XXX It may make sense to unroll if either side is a fixed size. */
 }
 
 } // namespace et
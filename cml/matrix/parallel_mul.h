@@ -0,0 +1,175 @@
+/* -*- C++ -*- ------------------------------------------------------------
+ 
+Copyright (c) 2007 Jesse Anders and Demian Nave http://cmldev.net/
+
+The Configurable Math Library (CML) is distributed under the terms of the
+Boost Software License, v1.0 (see cml/LICENSE for details).
+
+ *-----------------------------------------------------------------------*/
+/** @file
+ *  @brief Multithreaded matrix multiplication for large matrices.
+ *
+ * The result is split into disjoint tiles, and each tile is computed with
+ * the cache-blocked kernel as a separate task on a cml::thread_pool.
+ *
+ * This header is included automatically when CML_PARALLEL is defined, in
+ * which case large run-time sized products computed by operator*() use the
+ * default thread pool.  Otherwise, it can be included directly to use
+ * parallel_mul() with an explicit pool.
+ *
+ * @note Requires C++11 threads.
+ *
+ * @sa cml/matrix/blocked_mul.h
+ * @sa cml/core/thread_pool.h
+ */
+
+#ifndef parallel_mul_h
+#define parallel_mul_h
+
+#include <algorithm>
+#include <cml/core/thread_pool.h>
+#include <cml/matrix/matrix_mul.h>
+
+/* This is used below to create a more meaningful compile-time error when
+ * parallel_mul is not provided with matrix or MatrixExpr arguments:
+ */
+struct parallel_mul_expects_matrix_args_error;
+
+namespace cml {
+namespace detail {
+
+/** Compute one tile of a parallel product. */
+template<class ResultT, class LeftT, class RightT>
+struct MatMulTile
+{
+    typedef typename ResultT::value_type value_type;
+
+    MatMulTile(ResultT& C, const LeftT& A, const RightT& B,
+            size_t row_tiles, size_t tile_rows, size_t tile_cols,
+            value_type alpha, bool accumulate)
+        : m_C(&C), m_A(&A), m_B(&B),
+        m_row_tiles(row_tiles), m_tile_rows(tile_rows), m_tile_cols(tile_cols),
+        m_alpha(alpha), m_accumulate(accumulate)
+    {}
+
+    void operator()(size_t tile) const {
+        size_t i0 = (tile % m_row_tiles)*m_tile_rows;
+        size_t j0 = (tile / m_row_tiles)*m_tile_cols;
+        size_t i1 = std::min(i0 + m_tile_rows, m_C->rows());
+        size_t j1 = std::min(j0 + m_tile_cols, m_C->cols());
+        MatMulBlocked(*m_C, *m_A, *m_B, i0, i1, j0, j1,
+                m_alpha, m_accumulate);
+    }
+
+    ResultT* m_C;
+    const LeftT* m_A;
+    const RightT* m_B;
+    size_t m_row_tiles, m_tile_rows, m_tile_cols;
+    value_type m_alpha;
+    bool m_accumulate;
+};
+
+/** Compute C = alpha A x B (or C += alpha A x B if accumulate is true)
+ * with one task per tile of C.
+ *
+ * C must already have the right size, and must not share storage with A or
+ * B.  The tiles are whole multiples of the register tile, and are split
+ * until there are a few tiles per thread, so that work-stealing can balance
+ * the load.
+ *
+ * @note The inner dimension (A.cols() == B.rows()) must be non-zero.
+ */
+template<class ResultT, class LeftT, class RightT> void
+MatMulParallel(ResultT& C, const LeftT& left, const RightT& right,
+        thread_pool& pool,
+        typename ResultT::value_type alpha, bool accumulate)
+{
+    typedef typename ResultT::value_type value_type;
+    typedef MatMulBlocking<value_type> params;
+
+    const size_t M = C.rows(), N = C.cols();
+    const size_t min_tiles = 4*(pool.size()+1);
+    size_t tile_rows = params::MC, tile_cols = params::NC;
+    size_t row_tiles = (M+tile_rows-1)/tile_rows;
+    size_t col_tiles = (N+tile_cols-1)/tile_cols;
+
+    /* Halve the tile columns, then the tile rows, until there are enough
+     * tiles (or the tiles are getting too small to pay for packing):
+     */
+    while(row_tiles*col_tiles < min_tiles
+            && tile_cols > size_t(8*params::NR))
+    {
+        tile_cols /= 2;
+        col_tiles = (N+tile_cols-1)/tile_cols;
+    }
+    while(row_tiles*col_tiles < min_tiles
+            && tile_rows > size_t(4*params::MR))
+    {
+        tile_rows /= 2;
+        row_tiles = (M+tile_rows-1)/tile_rows;
+    }
+
+    pool.parallel_for(row_tiles*col_tiles,
+            MatMulTile<ResultT,LeftT,RightT>(C, left, right,
+                row_tiles, tile_rows, tile_cols, alpha, accumulate));
+}
+
+/** Prepare the result of parallel_mul(), which can be resized. */
+template<class MatT> inline void
+ParallelMulResult(MatT& C, matrix_size N, dynamic_memory_tag)
+{
+    cml::et::detail::ResizeUninitialized(C, N);
+}
+
+/** Prepare the result of parallel_mul(), which must have the right size. */
+template<class MatT, class MemoryTag> inline void
+ParallelMulResult(MatT& C, matrix_size N, MemoryTag)
+{
+    et::GetCheckedSize<MatT,MatT,dynamic_size_tag>()
+        .equal_or_fail(C.size(), N);
+}
+
+} // namespace detail
+
+
+/** Multithreaded matrix multiplication, C = A x B.
+ *
+ * Dynamic results are resized if necessary; external<> and fixed<> results
+ * must already have the right size.  C must not share storage with A or B.
+ *
+ * Products smaller than CML_PARALLEL_MUL_THRESHOLD^3 multiply-adds are
+ * computed on the calling thread.
+ *
+ * @throws std::invalid_argument if the sizes of A, B, and C do not match.
+ */
+template<class LeftT, class RightT, class ResultT> void
+parallel_mul(const LeftT& A, const RightT& B, ResultT& C, thread_pool& pool)
+{
+    /* Require matrix expressions: */
+    CML_STATIC_REQUIRE_M(
+            (et::MatrixExpressions<LeftT,RightT>::is_true),
+            parallel_mul_expects_matrix_args_error);
+
+    matrix_size N = detail::MatMulCheckedSize(A, B, dynamic_size_tag());
+    detail::ParallelMulResult(C, N, typename ResultT::memory_tag());
+
+    const size_t M = N.first, K = A.cols(), P = N.second;
+    const size_t T = CML_BLOCKED_MUL_THRESHOLD;
+    const size_t TP = CML_PARALLEL_MUL_THRESHOLD;
+    if(detail::MatMulStructured<ResultT,LeftT,RightT>::is_true
+            || M*P*K < T*T*T)
+    {
+        detail::MatMulSimple(C,A,B);
+    } else if(M*P*K < TP*TP*TP) {
+        detail::MatMulBlocked(C,A,B,0,M,0,P);
+    } else {
+        detail::MatMulParallel(C,A,B,pool,1,false);
+    }
+}
+
+} // namespace cml
+
+#endif
+
+// -------------------------------------------------------------------------
+// vim:ft=cpp
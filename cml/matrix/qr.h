@@ -0,0 +1,506 @@
+/* -*- C++ -*- ------------------------------------------------------------
+ 
+Copyright (c) 2007 Jesse Anders and Demian Nave http://cmldev.net/
+
+The Configurable Math Library (CML) is distributed under the terms of the
+Boost Software License, v1.0 (see cml/LICENSE for details).
+
+ *-----------------------------------------------------------------------*/
+/** @file
+ *  @brief Householder QR factorization, and least-squares solvers using it.
+ *
+ * qr_inplace(A,tau) factors the MxN matrix A = QR in place, with Q the
+ * product of min(M,N) Householder reflectors H_k = I - tau[k] v_k v_k^T.
+ * As in LAPACK, R is left on and above the diagonal of A, and v_k below
+ * it, with v_k[k] = 1 understood.  Q is never formed unless asked for;
+ * qr_apply_qt() and qr_apply_q() apply the reflectors to a vector or a
+ * matrix instead:
+ *
+ *   vector< double, dynamic<> > tau;
+ *   qr_inplace(A, tau);
+ *   x = qr_solve(A, tau, b);          // Minimizes |Ax - b|, for M >= N.
+ *   X = qr_solve(A, tau, B);          // One for each column of B.
+ *
+ * Unlike solving the normal equations transpose(A)*A*x = transpose(A)*b,
+ * this does not square the condition number of A.  Run-time sized
+ * matrices are factored by panels of CML_QR_BLOCK_SIZE columns, with the
+ * reflectors of each panel applied to the rest of the matrix at once by
+ * the matrix product kernel.
+ */
+
+#ifndef qr_h
+#define qr_h
+
+#include <cmath>
+#include <stdexcept>
+#include <cml/et/size_checking.h>
+#include <cml/matrix/matrix_expr.h>
+#include <cml/matrix/matrix_mul.h>
+#include <cml/matrix/matrix_block.h>
+#include <cml/matvec/matvec_promotions.h>
+
+/* This is used below to create a more meaningful compile-time error when
+ * qr_inplace is given a packed or banded matrix:
+ */
+struct qr_inplace_expects_a_general_matrix_error;
+
+namespace cml {
+namespace detail {
+
+/** Replace column k of A, from row k down, by the Householder reflector
+ * H = I - tau v v^T that maps it to (beta,0,...,0), storing v below the
+ * diagonal and beta on it.
+ *
+ * @returns tau, which is 0 if the column is already zero below the
+ * diagonal (H = I).
+ */
+template<class MatT> inline typename MatT::value_type
+QRHouseholder(MatT& A, size_t k)
+{
+    typedef typename MatT::value_type value_type;
+    const size_t M = A.rows();
+    const value_type alpha = A(k,k);
+    value_type s = value_type(0);
+    for(size_t i = k+1; i < M; ++i) s += A(i,k)*A(i,k);
+    if(s == value_type(0)) return value_type(0);
+
+    value_type beta = value_type(std::sqrt(alpha*alpha + s));
+    if(alpha >= value_type(0)) beta = -beta;
+    const value_type scale = value_type(1)/(alpha - beta);
+    for(size_t i = k+1; i < M; ++i) A(i,k) *= scale;
+    A(k,k) = beta;
+    return (beta - alpha)/beta;
+}
+
+/** Apply the reflector H = I - tau v v^T stored in column k of V to
+ * columns [j0,j1) of X, from row k down.
+ *
+ * The rows are read in order, so tall matrices are streamed through the
+ * cache once for each reflector.  w is scratch for at least j1-j0 values.
+ * X may be V, provided column k is not in [j0,j1).
+ */
+template<class RefT, class MatT, class WorkT> inline void
+QRReflect(const RefT& V, size_t k, typename MatT::value_type tau,
+        MatT& X, size_t j0, size_t j1, WorkT& w)
+{
+    typedef typename MatT::value_type value_type;
+    if(tau == value_type(0)) return;
+    const size_t M = X.rows();
+
+    /* w = tau X^T v: */
+    for(size_t j = j0; j < j1; ++j) w[j-j0] = X(k,j);
+    for(size_t i = k+1; i < M; ++i) {
+        const value_type v = V(i,k);
+        for(size_t j = j0; j < j1; ++j) w[j-j0] += v*X(i,j);
+    }
+    for(size_t j = j0; j < j1; ++j) w[j-j0] *= tau;
+
+    /* X -= v w^T: */
+    for(size_t j = j0; j < j1; ++j) X(k,j) -= w[j-j0];
+    for(size_t i = k+1; i < M; ++i) {
+        const value_type v = V(i,k);
+        for(size_t j = j0; j < j1; ++j) X(i,j) -= v*w[j-j0];
+    }
+}
+
+/** Factor columns [k0,k1) of A, applying each reflector to the columns
+ * up to j1 only.
+ */
+template<class MatT, class TauT, class WorkT> inline void
+QRPanel(MatT& A, TauT& tau, size_t k0, size_t k1, size_t j1, WorkT& w)
+{
+    for(size_t k = k0; k < k1; ++k) {
+        tau[k] = QRHouseholder(A, k);
+        QRReflect(A, k, tau[k], A, k+1, j1, w);
+    }
+}
+
+/** Fixed-size matrices are factored one column at a time. */
+template<typename E, class AT, typename BO, typename L, class TauT>
+inline void
+QRInplace(matrix<E,AT,BO,L>& A, TauT& tau, size_t K, fixed_size_tag)
+{
+    typename matrix<E,AT,BO,L>::col_vector_type w;
+    QRPanel(A, tau, 0, K, A.cols(), w);
+}
+
+/** Run-time sized matrices are factored by panels.  After each panel, its
+ * reflectors H_k0...H_k1-1 = I - Y T Y^T (compact WY form, as in LAPACK)
+ * are applied to the trailing columns C by C -= Y (T^T (Y^T C)), where the
+ * products are done by the matrix product kernel.
+ */
+template<typename E, class AT, typename BO, typename L, class TauT>
+inline void
+QRInplace(matrix<E,AT,BO,L>& A, TauT& tau, size_t K, dynamic_size_tag)
+{
+    typedef matrix<E,AT,BO,L> matrix_type;
+    typedef typename matrix_type::temporary_type temporary_type;
+    typedef matrix<E,strided<>,BO,L> block_type;
+    typedef typename select_if<same_type<L,row_major>::is_true,
+            col_major, row_major>::result transposed_layout;
+    typedef matrix<E,strided<>,BO,transposed_layout> transposed_type;
+
+    const size_t M = A.rows(), N = A.cols(), NB = CML_QR_BLOCK_SIZE;
+    typename matrix_type::col_vector_type w;
+    cml::et::detail::ResizeUninitialized(w, N);
+    if(K <= NB || N <= NB) {
+        QRPanel(A, tau, 0, K, N, w);
+        return;
+    }
+
+    temporary_type Y, T, W;
+    for(size_t k0 = 0; k0 < K; k0 += NB) {
+        const size_t k1 = (K-k0 < NB) ? K : k0+NB, kb = k1-k0;
+        const size_t m2 = M-k0, n2 = N-k1;
+
+        /* Factor the panel: */
+        QRPanel(A, tau, k0, k1, k1, w);
+        if(n2 == 0) break;
+
+        /* Copy the reflectors to Y, with the unit diagonal and zeros above
+         * it filled in:
+         */
+        cml::et::detail::ResizeUninitialized(Y, m2, kb);
+        for(size_t i = 0; i < m2; ++i)
+            for(size_t j = 0; j < kb; ++j)
+                Y(i,j) = (i > j) ? A(k0+i,k0+j) : E(i == j);
+
+        /* Form the upper triangular T, column by column, from
+         * T(0:j,j) = -tau[j] T(0:j,0:j) Y(:,0:j)^T Y(:,j), with the
+         * products Y^T Y in the lower triangle of T to start with:
+         */
+        transposed_type Yt(BlockOrigin(Y, 0, 0, m2, kb), kb, m2,
+                BlockStride(Y));
+        cml::et::detail::ResizeUninitialized(T, kb, kb);
+        MatMulUpdate(T, Yt, Y, E(1), false, dynamic_size_tag());
+        for(size_t j = 0; j < kb; ++j) {
+            const E tj = tau[k0+j];
+            for(size_t p = 0; p < j; ++p) w[p] = -tj*T(j,p);
+            for(size_t p = 0; p < j; ++p) {
+                E s = E(0);
+                for(size_t q = p; q < j; ++q) s += T(p,q)*w[q];
+                T(p,j) = s;
+            }
+            T(j,j) = tj;
+        }
+
+        /* W = Y^T C, through a transposed view of Y: */
+        block_type C = block(A, k0, k1, m2, n2);
+        cml::et::detail::ResizeUninitialized(W, kb, n2);
+        MatMulUpdate(W, Yt, C, E(1), false, dynamic_size_tag());
+
+        /* W = T^T W, from the last row up so that W can be overwritten: */
+        for(size_t i = kb; i-- > 0; ) {
+            for(size_t j = 0; j < n2; ++j) {
+                E s = E(0);
+                for(size_t p = 0; p <= i; ++p) s += T(p,i)*W(p,j);
+                W(i,j) = s;
+            }
+        }
+
+        /* C -= Y W: */
+        MatMulUpdate(C, Y, W, E(-1), true, dynamic_size_tag());
+    }
+}
+
+/** Apply the first K reflectors of QR to the vector x, as Q^T x (Forward)
+ * or as Q x.
+ */
+template<class MatT, class TauT, class VecT> inline void
+QRApply(const MatT& QR, const TauT& tau, VecT& x, size_t K, bool Forward,
+        et::vector_result_tag)
+{
+    typedef typename VecT::value_type value_type;
+    const size_t M = QR.rows();
+    for(size_t n = 0; n < K; ++n) {
+        const size_t k = Forward ? n : K-1-n;
+        value_type s = x[k];
+        for(size_t i = k+1; i < M; ++i) s += QR(i,k)*x[i];
+        s *= tau[k];
+        x[k] -= s;
+        for(size_t i = k+1; i < M; ++i) x[i] -= QR(i,k)*s;
+    }
+}
+
+/** Apply the first K reflectors of QR to the columns of X, as Q^T X
+ * (Forward) or as Q X.
+ */
+template<class MatT, class TauT, class RhsT> inline void
+QRApply(const MatT& QR, const TauT& tau, RhsT& X, size_t K, bool Forward,
+        et::matrix_result_tag)
+{
+    typename RhsT::col_vector_type w;
+    cml::et::detail::ResizeUninitialized(w, X.cols());
+    for(size_t n = 0; n < K; ++n) {
+        const size_t k = Forward ? n : K-1-n;
+        QRReflect(QR, k, tau[k], X, 0, X.cols(), w);
+    }
+}
+
+/** Solve RX = X in place for the first N rows of X, where R is the upper
+ * triangle of the leading NxN block of QR.
+ */
+template<class MatT, class RhsT> inline void
+QRSubstitute(const MatT& QR, RhsT& X, size_t N)
+{
+    typedef typename RhsT::value_type value_type;
+    const size_t C = X.cols();
+    for(size_t i = N; i-- > 0; ) {
+        for(size_t k = i+1; k < N; ++k) {
+            const value_type r = QR(i,k);
+            for(size_t j = 0; j < C; ++j) X(i,j) -= r*X(k,j);
+        }
+        const value_type inv = value_type(1)/QR(i,i);
+        for(size_t j = 0; j < C; ++j) X(i,j) *= inv;
+    }
+}
+
+/** Return the number of elements of a vector, or rows of a matrix. */
+template<class VecT> inline size_t
+QRRows(const VecT& x, et::vector_result_tag) { return x.size(); }
+
+template<class MatT> inline size_t
+QRRows(const MatT& X, et::matrix_result_tag) { return X.rows(); }
+
+/** Return the number of reflectors in the factorization, and verify
+ * that tau has (at least) as many elements.
+ */
+template<class MatT, class TauT> inline size_t
+QRReflectors(const MatT& QR, const TauT& tau)
+{
+    const size_t K = (QR.rows() < QR.cols()) ? QR.rows() : QR.cols();
+    if(tau.size() < K)
+        throw std::invalid_argument("expressions have incompatible sizes.");
+    return K;
+}
+
+} // namespace detail
+
+/** Factor A = QR in place by Householder reflections, storing R on and
+ * above the diagonal, the reflectors below it, and their scale factors in
+ * tau.  tau is resized to min(M,N) if it is resizable.
+ *
+ * @returns false if A has less than full rank, i.e. a diagonal element of
+ * R is exactly zero.  The factorization is still completed.
+ */
+template<typename E, class AT, typename BO, typename L, class TauT>
+inline bool
+qr_inplace(matrix<E,AT,BO,L>& A, TauT& tau)
+{
+    typedef typename matrix<E,AT,BO,L>::size_tag size_tag;
+
+    /* The reflectors do not fit in packed or banded storage: */
+    CML_STATIC_REQUIRE_M(
+        (same_type<typename matrix_structure<AT>::type,
+         general_tag>::is_true),
+        qr_inplace_expects_a_general_matrix_error);
+
+    const size_t K = (A.rows() < A.cols()) ? A.rows() : A.cols();
+    cml::et::detail::ResizeUninitialized(tau, K);
+    detail::QRInplace(A, tau, K, size_tag());
+
+    for(size_t k = 0; k < K; ++k)
+        if(A(k,k) == E(0)) return false;
+    return true;
+}
+
+/** Return the QR factorization of m, with the reflector scale factors in
+ * tau.
+ *
+ * @sa qr_inplace
+ */
+template<typename E, class AT, typename BO, class L, class TauT>
+inline typename matrix<E,AT,BO,L>::temporary_type
+qr(const matrix<E,AT,BO,L>& m, TauT& tau)
+{
+    typename matrix<E,AT,BO,L>::temporary_type QR;
+    cml::et::detail::ResizeUninitialized(QR,m.rows(),m.cols());
+    QR = m;
+    qr_inplace(QR, tau);
+    return QR;
+}
+
+/** Return the QR factorization of a matrix expression, with the reflector
+ * scale factors in tau.
+ *
+ * @sa qr_inplace
+ */
+template<typename XprT, class TauT>
+inline typename et::MatrixXpr<XprT>::temporary_type
+qr(const et::MatrixXpr<XprT>& e, TauT& tau)
+{
+    typename et::MatrixXpr<XprT>::temporary_type QR;
+    cml::et::detail::ResizeUninitialized(QR,e.rows(),e.cols());
+    QR = e;
+    qr_inplace(QR, tau);
+    return QR;
+}
+
+/** Return R from the factorization m = QR, discarding the reflectors.
+ *
+ * The result has the size of m, with R in its upper triangle and zeros
+ * below; for M >= N, R is its leading NxN block.  transpose(R)*R equals
+ * transpose(m)*m, without forming the latter.
+ */
+template<typename E, class AT, typename BO, class L>
+inline typename matrix<E,AT,BO,L>::temporary_type
+qr_r(const matrix<E,AT,BO,L>& m)
+{
+    typedef typename matrix<E,AT,BO,L>::temporary_type temporary_type;
+    temporary_type R;
+    cml::et::detail::ResizeUninitialized(R,m.rows(),m.cols());
+    R = m;
+    typename temporary_type::col_vector_type tau;
+    qr_inplace(R, tau);
+    for(size_t j = 0; j < R.cols(); ++j)
+        for(size_t i = j+1; i < R.rows(); ++i) R(i,j) = E(0);
+    return R;
+}
+
+/** Replace the vector or matrix X by Q^T X, given the factorization from
+ * qr_inplace().  X must have as many rows as QR.
+ */
+template<typename MatT, typename TauT, typename RhsT> inline void
+qr_apply_qt(const MatT& QR, const TauT& tau, RhsT& X)
+{
+    typedef typename RhsT::result_tag result_tag;
+    if(detail::QRRows(X, result_tag()) != QR.rows())
+        throw std::invalid_argument("expressions have incompatible sizes.");
+    detail::QRApply(QR, tau, X, detail::QRReflectors(QR, tau), true,
+            result_tag());
+}
+
+/** Replace the vector or matrix X by Q X, given the factorization from
+ * qr_inplace().  X must have as many rows as QR.
+ */
+template<typename MatT, typename TauT, typename RhsT> inline void
+qr_apply_q(const MatT& QR, const TauT& tau, RhsT& X)
+{
+    typedef typename RhsT::result_tag result_tag;
+    if(detail::QRRows(X, result_tag()) != QR.rows())
+        throw std::invalid_argument("expressions have incompatible sizes.");
+    detail::QRApply(QR, tau, X, detail::QRReflectors(QR, tau), false,
+            result_tag());
+}
+
+/** Return the first N columns of Q, given the MxN factorization from
+ * qr_inplace() with M >= N, so that A = QR with R the leading NxN block.
+ */
+template<typename E, class AT, typename BO, class L, class TauT>
+inline typename matrix<E,AT,BO,L>::temporary_type
+qr_q(const matrix<E,AT,BO,L>& QR, const TauT& tau)
+{
+    typename matrix<E,AT,BO,L>::temporary_type Q;
+    cml::et::detail::ResizeUninitialized(Q,QR.rows(),QR.cols());
+    for(size_t i = 0; i < Q.rows(); ++i)
+        for(size_t j = 0; j < Q.cols(); ++j) Q(i,j) = E(i == j);
+    detail::QRApply(QR, tau, Q, detail::QRReflectors(QR, tau), false,
+            et::matrix_result_tag());
+    return Q;
+}
+
+/** Return the least-squares solution x of Ax = b, minimizing |Ax - b|,
+ * given the MxN factorization A = QR from qr_inplace(), with M >= N.
+ *
+ * @throws std::invalid_argument if M < N, or if b does not have M
+ * elements.
+ */
+template<typename MatT, typename TauT, typename VecT> inline
+typename et::MatVecPromote<VecT,MatT>::temporary_type
+qr_solve(const MatT& QR, const TauT& tau, const VecT& b)
+{
+  /* Shorthand. */
+  typedef typename et::MatVecPromote<VecT,MatT>::temporary_type vector_type;
+  typedef typename VecT::temporary_type rhs_type;
+
+  /* Verify that the system is not underdetermined: */
+  const size_t M = QR.rows(), N = QR.cols();
+  if(M < N)
+    throw std::invalid_argument("qr_solve needs at least as many rows "
+        "as columns.");
+
+  /* Form y = Q^T b: */
+  rhs_type y; cml::et::detail::ResizeUninitialized(y,M);
+  y = b;
+  qr_apply_qt(QR, tau, y);
+
+  /* Solve Rx = y(0:N) by backward substitution: */
+  vector_type x; cml::et::detail::ResizeUninitialized(x,N);
+  for(size_t i = N; i-- > 0; ) {
+    typename vector_type::value_type xi = y[i];
+    for(size_t j = i+1; j < N; ++j) xi -= QR(i,j)*x[j];
+    x[i] = xi/QR(i,i);
+  }
+  return x;
+}
+
+/** Return the least-squares solution X of AX = B, given the MxN
+ * factorization A = QR from qr_inplace() with M >= N, for all of the
+ * columns of B at once.
+ *
+ * @throws std::invalid_argument if M < N, or if B does not have M rows.
+ */
+template<typename MatT, typename TauT,
+    typename E, class AT, typename BO, typename L> inline
+typename et::MatrixPromote<
+    typename MatT::transposed_type, matrix<E,AT,BO,L> >::temporary_type
+qr_solve(const MatT& QR, const TauT& tau, const matrix<E,AT,BO,L>& B)
+{
+  typedef typename et::MatrixPromote<
+    typename MatT::transposed_type, matrix<E,AT,BO,L> >::temporary_type
+    result_type;
+  typedef typename matrix<E,AT,BO,L>::temporary_type rhs_type;
+
+  /* Verify that the system is not underdetermined: */
+  const size_t M = QR.rows(), N = QR.cols();
+  if(M < N)
+    throw std::invalid_argument("qr_solve needs at least as many rows "
+        "as columns.");
+  if(B.rows() != M)
+    throw std::invalid_argument("expressions have incompatible sizes.");
+
+  /* Form Y = Q^T B, and solve RX = Y(0:N,:): */
+  rhs_type Y;
+  cml::et::detail::ResizeUninitialized(Y,B.rows(),B.cols());
+  Y = B;
+  qr_apply_qt(QR, tau, Y);
+  detail::QRSubstitute(QR, Y, N);
+
+  result_type X;
+  cml::et::detail::ResizeUninitialized(X,N,B.cols());
+  for(size_t i = 0; i < N; ++i)
+    for(size_t j = 0; j < B.cols(); ++j) X(i,j) = Y(i,j);
+  return X;
+}
+
+/** Return the least-squares solution of Ax = b (or AX = B, for all of the
+ * columns of B at once), for an MxN matrix A with M >= N.  A is factored
+ * into a temporary.
+ *
+ * @sa qr_inplace
+ */
+template<typename E, class AT, typename BO, class L, typename RhsT> inline
+typename et::MatVecPromote<RhsT, matrix<E,AT,BO,L> >::temporary_type
+qr_solve(const matrix<E,AT,BO,L>& A, const RhsT& b)
+{
+  typename matrix<E,AT,BO,L>::temporary_type::col_vector_type tau;
+  return qr_solve(qr(A, tau), tau, b);
+}
+
+template<typename E1, class AT1, typename BO, class L1,
+    typename E2, class AT2, class L2> inline
+typename et::MatrixPromote<
+    typename matrix<E1,AT1,BO,L1>::transposed_type, matrix<E2,AT2,BO,L2>
+    >::temporary_type
+qr_solve(const matrix<E1,AT1,BO,L1>& A, const matrix<E2,AT2,BO,L2>& B)
+{
+  typename matrix<E1,AT1,BO,L1>::temporary_type::col_vector_type tau;
+  return qr_solve(qr(A, tau), tau, B);
+}
+
+} // namespace cml
+
+#endif
+
+// -------------------------------------------------------------------------
+// vim:ft=cpp
@@ -0,0 +1,562 @@
+/* -*- C++ -*- ------------------------------------------------------------
+ 
+Copyright (c) 2007 Jesse Anders and Demian Nave http://cmldev.net/
+
+The Configurable Math Library (CML) is distributed under the terms of the
+Boost Software License, v1.0 (see cml/LICENSE for details).
+
+ *-----------------------------------------------------------------------*/
+/** @file
+ *  @brief Singular value and polar decompositions.
+ *
+ * svd(A,U,s,V) computes the thin singular value decomposition A = U
+ * diag(s) V^T of an MxN matrix, with K = min(M,N) singular values in
+ * descending order, U MxK and V NxK.  polar_decompose(A,R,S) factors a
+ * square matrix as A = RS, with R a rotation and S symmetric:
+ *
+ *   matrix_type U, V, R, S;
+ *   vector_type s;
+ *   svd(A, U, s, V);
+ *   singular_values(A, s);            // Without U and V.
+ *   polar_decompose(F, R, S);         // R is the rotation nearest to F.
+ *
+ * Matrices are decomposed by one-sided (Hestenes) Jacobi rotations of
+ * their columns, which gives singular values with high relative accuracy.
+ * Fixed 3x3 matrices use a kernel in local arrays instead, as in McAdams
+ * et al., "Computing the Singular Value Decomposition of 3x3 matrices with
+ * minimal branching and elementary floating point operations" (2011):
+ * V is found by Jacobi rotations of transpose(A)*A, and U by a Givens QR
+ * factorization of AV.  polar_decompose() of a fixed 3x3 matrix with a
+ * safely positive determinant, such as a deformed rotation, takes Newton's
+ * iteration for the rotation instead.  Neither allocates, and both are
+ * meant for calling once per object per frame.
+ */
+
+#ifndef svd_h
+#define svd_h
+
+#include <cmath>
+#include <limits>
+#include <algorithm>                // for std::swap
+#include <stdexcept>
+#include <cml/et/size_checking.h>
+#include <cml/matrix/matrix_expr.h>
+#include <cml/matrix/lu_pivot.h>
+#include <cml/matrix/eigen_symmetric.h>
+
+namespace cml {
+namespace detail {
+
+/** Orthogonalize the columns of the MxN matrix W, M >= N, by one-sided
+ * Jacobi rotations, accumulating the rotations in V if vectors is true.
+ * Then store the column norms in s, the normalized columns in U, and sort
+ * both into descending order of s.
+ *
+ * A pair of columns is left alone once they are orthogonal to working
+ * precision, or once either is negligible next to the largest column,
+ * since a column of roundoff cannot be made orthogonal to the others.  A
+ * zero singular value gives a zero column of U.  Returns false if the
+ * rotations did not converge within 60 sweeps.
+ */
+template<class WorkT, class MatU, class VecT, class MatV> inline bool
+SVDOneSided(WorkT& W, MatU& U, VecT& s, MatV& V, bool vectors)
+{
+    typedef typename WorkT::value_type value_type;
+    const value_type eps = std::numeric_limits<value_type>::epsilon();
+    const size_t M = W.rows(), N = W.cols();
+
+    if(vectors) {
+        cml::et::detail::ResizeUninitialized(V, N, N);
+        for(size_t i = 0; i < N; ++i)
+            for(size_t j = 0; j < N; ++j) V(i,j) = value_type(i == j);
+    }
+
+    /* The squared column norms, recomputed each sweep: */
+    cml::et::detail::ResizeUninitialized(s, N);
+    bool converged = false;
+    for(int sweep = 0; sweep < 60 && !converged; ++ sweep) {
+        value_type largest = value_type(0);
+        for(size_t j = 0; j < N; ++j) {
+            value_type n = value_type(0);
+            for(size_t i = 0; i < M; ++i) n += W(i,j)*W(i,j);
+            s[j] = n;
+            if(n > largest) largest = n;
+        }
+        const value_type negligible = eps*eps*largest;
+
+        converged = true;
+        for(size_t p = 0; p+1 < N; ++p) {
+            for(size_t q = p+1; q < N; ++q) {
+                const value_type alpha = s[p], beta = s[q];
+                value_type gamma = value_type(0);
+                for(size_t i = 0; i < M; ++i) gamma += W(i,p)*W(i,q);
+                if(std::fabs(gamma) <= eps*value_type(std::sqrt(alpha*beta))
+                        || alpha <= negligible || beta <= negligible)
+                    continue;
+                converged = false;
+
+                /* The rotation making columns p and q orthogonal: */
+                const value_type zeta = (beta - alpha)/(value_type(2)*gamma);
+                const value_type az = std::fabs(zeta);
+                value_type t = (az < value_type(1)/eps)
+                    ? value_type(1)/(az + value_type(std::sqrt(az*az + 1)))
+                    : value_type(.5)/az;
+                if(zeta < value_type(0)) t = -t;
+                const value_type c = value_type(1)/
+                    value_type(std::sqrt(t*t + value_type(1)));
+                const value_type sn = t*c;
+
+                for(size_t i = 0; i < M; ++i) {
+                    const value_type wp = W(i,p), wq = W(i,q);
+                    W(i,p) = c*wp - sn*wq;
+                    W(i,q) = sn*wp + c*wq;
+                }
+                if(vectors) {
+                    for(size_t i = 0; i < N; ++i) {
+                        const value_type vp = V(i,p), vq = V(i,q);
+                        V(i,p) = c*vp - sn*vq;
+                        V(i,q) = sn*vp + c*vq;
+                    }
+                }
+                s[p] = alpha - t*gamma;
+                s[q] = beta + t*gamma;
+            }
+        }
+    }
+
+    /* The singular values are the norms of the columns of W: */
+    for(size_t j = 0; j < N; ++j) {
+        value_type n = value_type(0);
+        for(size_t i = 0; i < M; ++i) n += W(i,j)*W(i,j);
+        s[j] = value_type(std::sqrt(n));
+    }
+    if(vectors) {
+        cml::et::detail::ResizeUninitialized(U, M, N);
+        for(size_t j = 0; j < N; ++j) {
+            const value_type inv = (s[j] > value_type(0))
+                ? value_type(1)/s[j] : value_type(0);
+            for(size_t i = 0; i < M; ++i) U(i,j) = W(i,j)*inv;
+        }
+    }
+
+    /* Sort into descending order: */
+    for(size_t i = 0; i+1 < N; ++i) {
+        size_t k = i;
+        for(size_t j = i+1; j < N; ++j) if(s[j] > s[k]) k = j;
+        if(k == i) continue;
+        std::swap(s[i], s[k]);
+        if(vectors) {
+            for(size_t j = 0; j < M; ++j) std::swap(U(j,i), U(j,k));
+            for(size_t j = 0; j < N; ++j) std::swap(V(j,i), V(j,k));
+        }
+    }
+    return converged;
+}
+
+/** The SVD of a 3x3 matrix a = u diag(s) v^T in local arrays, with u and
+ * v rotations.  s[0] >= s[1] >= |s[2]|, and s[2] has the sign of det(a).
+ *
+ * Since v is found from transpose(a)*a, singular values much smaller than
+ * s[0] have absolute errors of about epsilon*s[0].
+ */
+template<typename E> struct SVD3
+{
+    /* Rotate rows i and j of b by the Givens rotation zeroing b[j][k],
+     * and accumulate its transpose in the columns of u:
+     */
+    static void givens(E b[3][3], E u[3][3], int i, int j, int k) {
+        const E x = b[i][k], y = b[j][k];
+        const E r = E(std::sqrt(x*x + y*y));
+        if(r == E(0)) return;
+        const E c = x/r, s = y/r;
+        for(int m = 0; m < 3; ++ m) {
+            const E bi = b[i][m], bj = b[j][m];
+            b[i][m] = c*bi + s*bj;
+            b[j][m] = c*bj - s*bi;
+            const E ui = u[m][i], uj = u[m][j];
+            u[m][i] = c*ui + s*uj;
+            u[m][j] = c*uj - s*ui;
+        }
+    }
+
+    /* Order columns i and j of b (and v) by descending norm, negating one
+     * of them when they are exchanged so that v stays a rotation:
+     */
+    static void order(E b[3][3], E v[3][3], E* rho, int i, int j) {
+        if(!(rho[i] < rho[j])) return;
+        std::swap(rho[i], rho[j]);
+        for(int m = 0; m < 3; ++ m) {
+            const E bi = b[m][i], vi = v[m][i];
+            b[m][i] = b[m][j]; b[m][j] = -bi;
+            v[m][i] = v[m][j]; v[m][j] = -vi;
+        }
+    }
+
+    static bool compute(const E a[3][3], E u[3][3], E* s, E v[3][3]) {
+
+        /* Diagonalize transpose(a)*a to find v: */
+        E ata[3][3];
+        for(int i = 0; i < 3; ++ i)
+            for(int j = 0; j < 3; ++ j)
+                ata[i][j] = a[0][i]*a[0][j] + a[1][i]*a[1][j]
+                    + a[2][i]*a[2][j];
+        const bool converged = EigenJacobi<3,E>::compute(ata, v, true);
+
+        /* b = a*v has orthogonal columns; sort them by norm: */
+        E b[3][3], rho[3];
+        for(int i = 0; i < 3; ++ i)
+            for(int j = 0; j < 3; ++ j)
+                b[i][j] = a[i][0]*v[0][j] + a[i][1]*v[1][j]
+                    + a[i][2]*v[2][j];
+        for(int j = 0; j < 3; ++ j)
+            rho[j] = b[0][j]*b[0][j] + b[1][j]*b[1][j] + b[2][j]*b[2][j];
+        order(b, v, rho, 0, 1);
+        order(b, v, rho, 0, 2);
+        order(b, v, rho, 1, 2);
+
+        /* Factor b = u*r by Givens rotations; r is then diagonal: */
+        for(int i = 0; i < 3; ++ i)
+            for(int j = 0; j < 3; ++ j) u[i][j] = E(i == j);
+        givens(b, u, 0, 1, 0);
+        givens(b, u, 0, 2, 0);
+        givens(b, u, 1, 2, 1);
+        for(int i = 0; i < 3; ++ i) s[i] = b[i][i];
+        return converged;
+    }
+};
+
+/** The rotation factor r of a 3x3 matrix a = r*s, by Newton's iteration
+ * x <- (g*x + inverse(transpose(x))/g)/2 with Frobenius norm scaling g
+ * (Higham, "Computing the polar decomposition -- with applications",
+ * 1986).  Each step needs only the cofactors of x, and a matrix near a
+ * rotation converges in 3 or 4 steps.
+ *
+ * Returns false, leaving r undefined, if det(a) is not safely positive:
+ * the iteration converges to a reflection for det(a) < 0, and slowly and
+ * inaccurately for nearly singular a.
+ */
+template<typename E> struct Polar3
+{
+    static bool newton(const E a[3][3], E r[3][3]) {
+        const E eps = std::numeric_limits<E>::epsilon();
+        for(int i = 0; i < 3; ++ i)
+            for(int j = 0; j < 3; ++ j) r[i][j] = a[i][j];
+
+        bool scale = true;
+        for(int step = 0; step < 16; ++ step) {
+            E c[3][3];
+            c[0][0] = r[1][1]*r[2][2] - r[1][2]*r[2][1];
+            c[0][1] = r[1][2]*r[2][0] - r[1][0]*r[2][2];
+            c[0][2] = r[1][0]*r[2][1] - r[1][1]*r[2][0];
+            c[1][0] = r[2][1]*r[0][2] - r[2][2]*r[0][1];
+            c[1][1] = r[2][2]*r[0][0] - r[2][0]*r[0][2];
+            c[1][2] = r[2][0]*r[0][1] - r[2][1]*r[0][0];
+            c[2][0] = r[0][1]*r[1][2] - r[0][2]*r[1][1];
+            c[2][1] = r[0][2]*r[1][0] - r[0][0]*r[1][2];
+            c[2][2] = r[0][0]*r[1][1] - r[0][1]*r[1][0];
+            const E det = r[0][0]*c[0][0] + r[0][1]*c[0][1]
+                + r[0][2]*c[0][2];
+
+            /* Scale by g = sqrt(|inverse(x)|/|x|) until x is near a
+             * rotation, where g is 1 to about the same precision:
+             */
+            E nx = E(0), nc = E(0);
+            for(int i = 0; i < 3; ++ i) {
+                for(int j = 0; j < 3; ++ j) {
+                    nx += r[i][j]*r[i][j];
+                    nc += c[i][j]*c[i][j];
+                }
+            }
+            if(!(det > E(0) && det*det > eps*nx*nx*nx)) return false;
+            E f = E(.5), h = E(.5)/det;
+            if(scale) {
+                const E g = E(std::sqrt(std::sqrt(nc/(nx*det*det))));
+                f *= g;
+                h /= g;
+            }
+
+            E delta = E(0);
+            for(int i = 0; i < 3; ++ i) {
+                for(int j = 0; j < 3; ++ j) {
+                    const E x = f*r[i][j] + h*c[i][j];
+                    delta += (x - r[i][j])*(x - r[i][j]);
+                    r[i][j] = x;
+                }
+            }
+
+            /* Convergence is quadratic, so the error after a step smaller
+             * than sqrt(epsilon) is about epsilon:
+             */
+            if(delta <= E(3)*eps) return true;
+            scale = (delta > E(1e-4));
+        }
+        return false;
+    }
+};
+
+/** Use the 3x3 kernel for fixed-size 3x3 matrices, and one-sided Jacobi
+ * for everything else.
+ */
+template<class MatT> struct SVDUse3x3 {
+    typedef typename is_true<
+        same_type<typename MatT::size_tag, fixed_size_tag>::is_true
+        && MatT::array_rows == 3 && MatT::array_cols == 3>::result result;
+};
+
+/** Compute the signed SVD of a 3x3 matrix: V is a rotation, and the last
+ * singular value has the sign of det(A).
+ */
+template<class MatT, class MatU, class VecT, class MatV> inline bool
+SVDSigned(const MatT& A, MatU& U, VecT& s, MatV& V, true_type)
+{
+    typedef typename MatT::value_type value_type;
+    value_type a[3][3], u[3][3], w[3], v[3][3];
+    for(int i = 0; i < 3; ++ i)
+        for(int j = 0; j < 3; ++ j) a[i][j] = A(i,j);
+    const bool converged = SVD3<value_type>::compute(a, u, w, v);
+
+    cml::et::detail::ResizeUninitialized(U, 3, 3);
+    cml::et::detail::ResizeUninitialized(V, 3, 3);
+    cml::et::detail::ResizeUninitialized(s, 3);
+    for(int i = 0; i < 3; ++ i) {
+        s[i] = w[i];
+        for(int j = 0; j < 3; ++ j) {
+            U(i,j) = u[i][j];
+            V(i,j) = v[i][j];
+        }
+    }
+    return converged;
+}
+
+/** Compute the SVD of a general matrix, by one-sided Jacobi rotations of
+ * the columns of A, or of the rows if A has more columns than rows.
+ */
+template<class MatT, class MatU, class VecT, class MatV> inline bool
+SVDSigned(const MatT& A, MatU& U, VecT& s, MatV& V, false_type,
+        bool vectors = true)
+{
+    const size_t M = A.rows(), N = A.cols();
+    if(M >= N) {
+        typename MatT::temporary_type W;
+        cml::et::detail::ResizeUninitialized(W, M, N);
+        W = A;
+        return SVDOneSided(W, U, s, V, vectors);
+    }
+
+    /* transpose(A) = V diag(s) U^T: */
+    typename MatT::transposed_type::temporary_type W;
+    cml::et::detail::ResizeUninitialized(W, N, M);
+    for(size_t i = 0; i < N; ++i)
+        for(size_t j = 0; j < M; ++j) W(i,j) = A(j,i);
+    return SVDOneSided(W, V, s, U, vectors);
+}
+
+/** Return the sign of det(Q) for an orthogonal matrix Q, from its LU
+ * factorization with partial pivoting.
+ */
+template<class MatT> inline int
+SVDOrientation(const MatT& Q)
+{
+    typename MatT::temporary_type LU = Q;
+    vector< size_t, dynamic<> > piv;
+    int sign = lu_pivot_inplace(LU, piv);
+    for(size_t i = 0; i < LU.rows(); ++i)
+        if(LU(i,i) < typename MatT::value_type(0)) sign = -sign;
+    return sign;
+}
+
+/** Complete the columns of the square matrix U to an orthonormal basis.
+ *
+ * s holds the singular values in descending order of magnitude.  The
+ * columns of U for the values negligible next to s[0] are zero or
+ * roundoff, and are replaced in order by the unit vector most orthogonal
+ * to the columns before them, orthogonalized by Gram-Schmidt.
+ */
+template<class MatU, class VecT> inline void
+SVDCompleteBasis(MatU& U, const VecT& s)
+{
+    typedef typename MatU::value_type value_type;
+    const value_type eps = std::numeric_limits<value_type>::epsilon();
+    const size_t N = U.rows();
+    const value_type negligible = value_type(N)*eps*std::fabs(s[0]);
+
+    for(size_t k = 0; k < N; ++k) {
+        if(std::fabs(s[k]) > negligible) continue;
+
+        /* The unit vector with the smallest part in columns 0..k-1: */
+        size_t m = 0;
+        value_type least = value_type(2);
+        for(size_t i = 0; i < N; ++i) {
+            value_type n = value_type(0);
+            for(size_t j = 0; j < k; ++j) n += U(i,j)*U(i,j);
+            if(n < least) { least = n; m = i; }
+        }
+        for(size_t i = 0; i < N; ++i) U(i,k) = value_type(i == m);
+
+        /* Orthogonalize it twice, then normalize it: */
+        for(int pass = 0; pass < 2; ++ pass) {
+            for(size_t j = 0; j < k; ++j) {
+                value_type d = value_type(0);
+                for(size_t i = 0; i < N; ++i) d += U(i,j)*U(i,k);
+                for(size_t i = 0; i < N; ++i) U(i,k) -= d*U(i,j);
+            }
+        }
+        value_type n = value_type(0);
+        for(size_t i = 0; i < N; ++i) n += U(i,k)*U(i,k);
+        n = value_type(1)/value_type(std::sqrt(n));
+        for(size_t i = 0; i < N; ++i) U(i,k) *= n;
+    }
+}
+
+/** Compute the polar decomposition of A from its SVD. */
+template<class MatT, class MatR, class MatS, class Use3x3> inline bool
+PolarSVD(const MatT& A, MatR& R, MatS& S, Use3x3)
+{
+    typedef typename MatT::value_type value_type;
+    typedef typename MatT::temporary_type temporary_type;
+    const size_t N = A.rows();
+
+    temporary_type U, V;
+    typename temporary_type::col_vector_type s;
+    const bool converged = SVDSigned(A, U, s, V, Use3x3());
+
+    /* Complete U for the zero singular values, then make U V^T a rotation
+     * by negating the smallest singular value.  The 3x3 kernel gives a
+     * rotation U already:
+     */
+    if(!same_type<Use3x3,true_type>::is_true && N > 0) {
+        SVDCompleteBasis(U, s);
+        if(SVDOrientation(U) != SVDOrientation(V)) {
+            s[N-1] = -s[N-1];
+            for(size_t i = 0; i < N; ++i) U(i,N-1) = -U(i,N-1);
+        }
+    }
+
+    /* R = U V^T, and S = V diag(s) V^T: */
+    cml::et::detail::ResizeUninitialized(R, N, N);
+    cml::et::detail::ResizeUninitialized(S, N, N);
+    for(size_t i = 0; i < N; ++i) {
+        for(size_t j = 0; j < N; ++j) {
+            value_type r = value_type(0), t = value_type(0);
+            for(size_t k = 0; k < N; ++k) {
+                r += U(i,k)*V(j,k);
+                t += V(i,k)*s[k]*V(j,k);
+            }
+            R(i,j) = r;
+            S(i,j) = t;
+        }
+    }
+    return converged;
+}
+
+/** Compute the polar decomposition of a general square matrix. */
+template<class MatT, class MatR, class MatS> inline bool
+PolarDecompose(const MatT& A, MatR& R, MatS& S, false_type)
+{
+    return PolarSVD(A, R, S, false_type());
+}
+
+/** Compute the polar decomposition of a 3x3 matrix by Newton's iteration,
+ * or from its SVD if det(A) is not safely positive.
+ */
+template<class MatT, class MatR, class MatS> inline bool
+PolarDecompose(const MatT& A, MatR& R, MatS& S, true_type)
+{
+    typedef typename MatT::value_type value_type;
+    value_type a[3][3], r[3][3];
+    for(int i = 0; i < 3; ++ i)
+        for(int j = 0; j < 3; ++ j) a[i][j] = A(i,j);
+    if(!Polar3<value_type>::newton(a, r))
+        return PolarSVD(A, R, S, true_type());
+
+    /* S = transpose(R)*A, symmetrized: */
+    value_type s[3][3];
+    for(int i = 0; i < 3; ++ i)
+        for(int j = 0; j < 3; ++ j)
+            s[i][j] = r[0][i]*a[0][j] + r[1][i]*a[1][j] + r[2][i]*a[2][j];
+    cml::et::detail::ResizeUninitialized(R, 3, 3);
+    cml::et::detail::ResizeUninitialized(S, 3, 3);
+    for(int i = 0; i < 3; ++ i) {
+        for(int j = 0; j < 3; ++ j) {
+            R(i,j) = r[i][j];
+            S(i,j) = value_type(.5)*(s[i][j] + s[j][i]);
+        }
+    }
+    return true;
+}
+
+} // namespace detail
+
+/** Compute the thin singular value decomposition A = U diag(s) V^T.
+ *
+ * For an MxN matrix A and K = min(M,N), s is resized to K and receives
+ * the singular values in descending order, U is resized to MxK and V to
+ * NxK, with orthonormal columns.  If A has rank less than K, the columns
+ * of U for its zero singular values are zero.
+ *
+ * @returns false if the iteration did not converge, which should not
+ * happen for finite A.
+ */
+template<typename E, class AT, typename BO, typename L,
+    class MatU, class VecT, class MatV> inline bool
+svd(const matrix<E,AT,BO,L>& A, MatU& U, VecT& s, MatV& V)
+{
+    typedef matrix<E,AT,BO,L> matrix_type;
+    typedef typename detail::SVDUse3x3<matrix_type>::result use_3x3;
+    const bool converged = detail::SVDSigned(A, U, s, V, use_3x3());
+
+    /* The 3x3 kernel leaves the sign of det(A) on the last value: */
+    if(same_type<use_3x3,true_type>::is_true && s[2] < E(0)) {
+        s[2] = -s[2];
+        for(size_t i = 0; i < 3; ++i) U(i,2) = -U(i,2);
+    }
+    return converged;
+}
+
+/** Compute the singular values of A, in descending order, without the
+ * singular vectors.
+ *
+ * @returns false if the iteration did not converge.
+ */
+template<typename E, class AT, typename BO, typename L, class VecT>
+inline bool
+singular_values(const matrix<E,AT,BO,L>& A, VecT& s)
+{
+    typedef matrix<E,AT,BO,L> matrix_type;
+    typename matrix_type::temporary_type U;
+    typename matrix_type::transposed_type::temporary_type V;
+    return detail::SVDSigned(A, U, s, V, false_type(), false);
+}
+
+/** Factor the square matrix A = RS, with R a rotation (an orthogonal
+ * matrix with determinant +1) and S symmetric.
+ *
+ * R is the rotation nearest to A, or one of them if A is singular.  S is
+ * positive semidefinite if det(A) >= 0; otherwise, it has one negative
+ * eigenvalue, the one of smallest magnitude, rather than R being a
+ * reflection.
+ *
+ * Fixed 3x3 matrices with a safely positive determinant take Newton's
+ * iteration instead of the SVD, which is several times faster.
+ *
+ * @returns false if the iteration did not converge.
+ *
+ * @throws std::invalid_argument if A is not square.
+ */
+template<typename E, class AT, typename BO, typename L,
+    class MatR, class MatS> inline bool
+polar_decompose(const matrix<E,AT,BO,L>& A, MatR& R, MatS& S)
+{
+    typedef matrix<E,AT,BO,L> matrix_type;
+    typedef typename matrix_type::size_tag size_tag;
+    typedef typename detail::SVDUse3x3<matrix_type>::result use_3x3;
+    cml::et::CheckedSquare(A, size_tag());
+    return detail::PolarDecompose(A, R, S, use_3x3());
+}
+
+} // namespace cml
+
+#endif
+
+// -------------------------------------------------------------------------
+// vim:ft=cpp
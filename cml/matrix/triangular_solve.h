@@ -0,0 +1,134 @@
+/* -*- C++ -*- ------------------------------------------------------------
+ 
+Copyright (c) 2007 Jesse Anders and Demian Nave http://cmldev.net/
+
+The Configurable Math Library (CML) is distributed under the terms of the
+Boost Software License, v1.0 (see cml/LICENSE for details).
+
+ *-----------------------------------------------------------------------*/
+/** @file
+ *  @brief Solve triangular systems by substitution.
+ */
+
+#ifndef triangular_solve_h
+#define triangular_solve_h
+
+#include <cml/et/size_checking.h>
+#include <cml/matrix/matrix_expr.h>
+#include <cml/matvec/matvec_promotions.h>
+#include <cml/packed.h>
+
+/* This is used below to create a more meaningful compile-time error when
+ * triangular_solve is given a matrix that is not known to be triangular:
+ */
+struct triangular_solve_expects_a_triangular_matrix_error;
+
+namespace cml {
+namespace detail {
+
+/** Solve Tx = b for x by forward substitution, reading only the lower
+ * triangle of T.
+ */
+template<typename MatT, typename VecT> inline
+typename et::MatVecPromote<MatT,VecT>::temporary_type
+triangular_solve(const MatT& T, const VecT& b, lower_triangular_tag)
+{
+  /* Shorthand. */
+  typedef et::ExprTraits<MatT> matrix_traits;
+  typedef typename et::MatVecPromote<MatT,VecT>::temporary_type vector_type;
+  typedef typename vector_type::value_type value_type;
+
+  /* Verify that the matrix is square, and get the size: */
+  size_t N = cml::et::CheckedSquare(T, typename matrix_traits::size_tag());
+
+  /* Verify that the matrix and vector have compatible sizes: */
+  et::CheckedSize(T, b, typename vector_type::size_tag());
+
+  vector_type x; cml::et::detail::ResizeUninitialized(x,N);
+  for(size_t i = 0; i < N; ++i) {
+    value_type xi = b[i];
+    for(size_t j = 0; j < i; ++j) xi -= T(i,j)*x[j];
+    x[i] = xi/T(i,i);
+  }
+  return x;
+}
+
+/** Solve Tx = b for x by backward substitution, reading only the upper
+ * triangle of T.
+ */
+template<typename MatT, typename VecT> inline
+typename et::MatVecPromote<MatT,VecT>::temporary_type
+triangular_solve(const MatT& T, const VecT& b, upper_triangular_tag)
+{
+  /* Shorthand. */
+  typedef et::ExprTraits<MatT> matrix_traits;
+  typedef typename et::MatVecPromote<MatT,VecT>::temporary_type vector_type;
+  typedef typename vector_type::value_type value_type;
+
+  /* Verify that the matrix is square, and get the size: */
+  ssize_t N = (ssize_t) cml::et::CheckedSquare(
+    T, typename matrix_traits::size_tag());
+
+  /* Verify that the matrix and vector have compatible sizes: */
+  et::CheckedSize(T, b, typename vector_type::size_tag());
+
+  vector_type x; cml::et::detail::ResizeUninitialized(x,N);
+  for(ssize_t i = N-1; i >= 0; --i) {
+    value_type xi = b[i];
+    for(ssize_t j = i+1; j < N; ++j) xi -= T(i,j)*x[j];
+    x[i] = xi/T(i,i);
+  }
+  return x;
+}
+
+} // namespace detail
+
+/** Solve Tx = b for x, where T is a packed lower_triangular<> or
+ * upper_triangular<> matrix.
+ *
+ * Lower triangular systems are solved by forward substitution, and upper
+ * triangular systems by backward substitution, in O(N^2) operations.  The
+ * diagonal of T must not have zeros.
+ *
+ * @sa cml/packed.h
+ */
+template<typename MatT, typename VecT> inline
+typename et::MatVecPromote<MatT,VecT>::temporary_type
+triangular_solve(const MatT& T, const VecT& b)
+{
+  typedef typename et::MatrixStructure<MatT>::type structure;
+  CML_STATIC_REQUIRE_M(
+    (same_type<structure,lower_triangular_tag>::is_true
+     || same_type<structure,upper_triangular_tag>::is_true),
+    triangular_solve_expects_a_triangular_matrix_error);
+  return detail::triangular_solve(T, b, structure());
+}
+
+/** Solve Tx = b for x, using only the lower triangle of T.
+ *
+ * This can be used with the triangular factors of a general matrix.
+ */
+template<typename MatT, typename VecT> inline
+typename et::MatVecPromote<MatT,VecT>::temporary_type
+triangular_solve(const MatT& T, const VecT& b, lower_triangular_tag)
+{
+  return detail::triangular_solve(T, b, lower_triangular_tag());
+}
+
+/** Solve Tx = b for x, using only the upper triangle of T.
+ *
+ * This can be used with the triangular factors of a general matrix.
+ */
+template<typename MatT, typename VecT> inline
+typename et::MatVecPromote<MatT,VecT>::temporary_type
+triangular_solve(const MatT& T, const VecT& b, upper_triangular_tag)
+{
+  return detail::triangular_solve(T, b, upper_triangular_tag());
+}
+
+} // namespace cml
+
+#endif
+
+// -------------------------------------------------------------------------
+// vim:ft=cpp
@@ -0,0 +1,128 @@
+/* -*- C++ -*- ------------------------------------------------------------
+ 
+Copyright (c) 2007 Jesse Anders and Demian Nave http://cmldev.net/
+
+The Configurable Math Library (CML) is distributed under the terms of the
+Boost Software License, v1.0 (see cml/LICENSE for details).
+
+ *-----------------------------------------------------------------------*/
+/** @file
+ *  @brief Solve tridiagonal systems with the Thomas algorithm.
+ *
+ * Like lu(), the solver does not pivot, and does not check for a zero
+ * pivot, so it is only stable for diagonally dominant or symmetric positive
+ * definite matrices.  Other tridiagonal matrices should be copied to a
+ * dense matrix and solved with lu_pivot_inplace() and lu_solve().
+ */
+
+#ifndef tridiagonal_solve_h
+#define tridiagonal_solve_h
+
+#include <cml/et/size_checking.h>
+#include <cml/matrix/matrix_expr.h>
+#include <cml/matvec/matvec_promotions.h>
+#include <cml/banded.h>
+
+namespace cml {
+namespace detail {
+
+/** Read diagonal Offset of a tridiagonal matrix as a vector. */
+template<class MatT, int Offset> struct TridiagonalBand
+{
+    TridiagonalBand(const MatT& T) : m_T(T) {}
+    typename MatT::value_type operator[](size_t i) const {
+        return m_T(i, i + Offset);
+    }
+    const MatT& m_T;
+};
+
+/** Solve the tridiagonal system with subdiagonal a, diagonal b and
+ * superdiagonal c for x, in 2N divisions and 3N multiplications.
+ *
+ * Row i of the system is a[i]*x[i-1] + b[i]*x[i] + c[i]*x[i+1] = d[i];
+ * a[0] and c[N-1] are not read.  x must already have size N, and may be d.
+ */
+template<class SubT, class DiagT, class SuperT, class RhsT, class VecT>
+inline void
+tridiagonal_solve(const SubT& a, const DiagT& b, const SuperT& c,
+        const RhsT& d, VecT& x, size_t N)
+{
+  typedef typename VecT::value_type value_type;
+  if(N == 0) return;
+
+  /* Eliminate the subdiagonal, keeping the modified superdiagonal in cp
+   * and the modified right-hand side in x:
+   */
+  VecT cp; cml::et::detail::ResizeUninitialized(cp,N);
+  value_type m = b[0];
+  cp[0] = (N > 1) ? value_type(c[0]/m) : value_type(0);
+  x[0] = d[0]/m;
+  for(size_t i = 1; i < N; ++i) {
+    m = b[i] - a[i]*cp[i-1];
+    if(i + 1 < N) cp[i] = c[i]/m;
+    x[i] = (d[i] - a[i]*x[i-1])/m;
+  }
+
+  /* Back substitution: */
+  for(size_t i = N-1; i > 0; --i) x[i-1] -= cp[i-1]*x[i];
+}
+
+} // namespace detail
+
+/** Solve Tx = d for x, where T is the tridiagonal matrix with subdiagonal
+ * a, diagonal b and superdiagonal c, by the Thomas algorithm in O(N)
+ * operations.
+ *
+ * All four vectors have size N; row i of the system is a[i]*x[i-1] +
+ * b[i]*x[i] + c[i]*x[i+1] = d[i], and a[0] and c[N-1] are not used.
+ *
+ * @throws std::invalid_argument if the vectors have different sizes.
+ */
+template<class SubT, class DiagT, class SuperT, class RhsT>
+inline typename RhsT::temporary_type
+tridiagonal_solve(const SubT& a, const DiagT& b, const SuperT& c,
+        const RhsT& d)
+{
+  /* Verify that the vectors have the same size: */
+  size_t N = et::CheckedSize(a, d, dynamic_size_tag());
+  et::CheckedSize(b, d, dynamic_size_tag());
+  et::CheckedSize(c, d, dynamic_size_tag());
+
+  typename RhsT::temporary_type x;
+  cml::et::detail::ResizeUninitialized(x,N);
+  detail::tridiagonal_solve(a, b, c, d, x, N);
+  return x;
+}
+
+/** Solve Tx = d for x, where T is a banded<1,1> (tridiagonal) matrix, by
+ * the Thomas algorithm in O(N) operations.
+ *
+ * @sa cml/banded.h
+ */
+template<typename E, class A, typename BO, class L, typename VecT> inline
+typename et::MatVecPromote<matrix<E,banded<1,1,A>,BO,L>,VecT>::temporary_type
+tridiagonal_solve(const matrix<E,banded<1,1,A>,BO,L>& T, const VecT& d)
+{
+  /* Shorthand. */
+  typedef matrix<E,banded<1,1,A>,BO,L> matrix_type;
+  typedef typename et::MatVecPromote<matrix_type,VecT>::temporary_type
+    vector_type;
+
+  /* Verify that the matrix and vector have compatible sizes: */
+  size_t N = T.rows();
+  et::CheckedSize(T, d, dynamic_size_tag());
+
+  vector_type x; cml::et::detail::ResizeUninitialized(x,N);
+  detail::tridiagonal_solve(
+      detail::TridiagonalBand<matrix_type,-1>(T),
+      detail::TridiagonalBand<matrix_type,0>(T),
+      detail::TridiagonalBand<matrix_type,1>(T), d, x, N);
+  return x;
+}
+
+} // namespace cml
+
+#endif
+
+// -------------------------------------------------------------------------
+// vim:ft=cpp
@@ -77,14 +77,17 @@ mul(const LeftT& A, const RightT& x, mul_Ax)
     size_t N = et::CheckedSize(A, x, size_tag());
 
     /* Initialize the new vector: */
-    result_type y; cml::et::detail::Resize(y, N);
+    result_type y; cml::et::detail::ResizeUninitialized(y, N);
 
-    /* Compute y = A*x: */
+    /* Compute y = A*x, skipping the zeros of a triangular A: */
     typedef typename result_type::value_type sum_type;
+    typedef typename et::MatrixStructure<LeftT>::type structure;
     for(size_t i = 0; i < N; ++i) {
         /* XXX This should be unrolled. */
-        sum_type sum(A(i,0)*x[0]);
-        for(size_t k = 1; k < x.size(); ++k) {
+        size_t k0 = 0, k1 = x.size();
+        NonZeroCols(i, k0, k1, structure());
+        sum_type sum(0);
+        for(size_t k = k0; k < k1; ++k) {
             sum += (A(i,k)*x[k]);
         }
         y[i] = sum;
@@ -129,14 +132,17 @@ mul(const LeftT& x, const RightT& A, mul_xA)
     size_t N = et::CheckedSize(x, A, size_tag());
 
     /* Initialize the new vector: */
-    result_type y; cml::et::detail::Resize(y, N);
+    result_type y; cml::et::detail::ResizeUninitialized(y, N);
 
-    /* Compute y = x*A: */
+    /* Compute y = x*A, skipping the zeros of a triangular A: */
     typedef typename result_type::value_type sum_type;
+    typedef typename et::MatrixStructure<RightT>::type structure;
     for(size_t i = 0; i < N; ++i) {
         /* XXX This should be unrolled. */
-        sum_type sum(x[0]*A(0,i));
-        for(size_t k = 1; k < x.size(); ++k) {
+        size_t k0 = 0, k1 = x.size();
+        NonZeroRows(i, k0, k1, structure());
+        sum_type sum(0);
+        for(size_t k = k0; k < k1; ++k) {
             sum += (x[k]*A(k,i));
         }
         y[i] = sum;
@@ -170,7 +176,7 @@ operator*(const matrix<E,AT,BO,L>& left,
 {
     /* Generate a temporary, and compute the right-hand expression: */
     typename et::VectorXpr<XprT>::temporary_type right_tmp;
-    cml::et::detail::Resize(right_tmp,right.size());
+    cml::et::detail::ResizeUninitialized(right_tmp,right.size());
     right_tmp = right;
 
     return detail::mul(left,right_tmp,detail::mul_Ax());
@@ -186,7 +192,7 @@ operator*(const et::MatrixXpr<XprT>& left,
 {
     /* Generate a temporary, and compute the left-hand expression: */
     typename et::MatrixXpr<XprT>::temporary_type left_tmp;
-    cml::et::detail::Resize(left_tmp,left.rows(),left.cols());
+    cml::et::detail::ResizeUninitialized(left_tmp,left.rows(),left.cols());
     left_tmp = left;
 
     return detail::mul(left_tmp,right,detail::mul_Ax());
@@ -202,12 +208,12 @@ operator*(const et::MatrixXpr<XprT1>& left,
 {
     /* Generate a temporary, and compute the left-hand expression: */
     typename et::MatrixXpr<XprT1>::temporary_type left_tmp;
-    cml::et::detail::Resize(left_tmp,left.rows(),left.cols());
+    cml::et::detail::ResizeUninitialized(left_tmp,left.rows(),left.cols());
     left_tmp = left;
 
     /* Generate a temporary, and compute the right-hand expression: */
     typename et::VectorXpr<XprT2>::temporary_type right_tmp;
-    cml::et::detail::Resize(right_tmp,right.size());
+    cml::et::detail::ResizeUninitialized(right_tmp,right.size());
     right_tmp = right;
 
     return detail::mul(left_tmp,right_tmp,detail::mul_Ax());
@@ -234,7 +240,7 @@ operator*(const vector<E,AT>& left,
 {
     /* Generate a temporary, and compute the right-hand expression: */
     typename et::MatrixXpr<XprT>::temporary_type right_tmp;
-    cml::et::detail::Resize(right_tmp,right.rows(),right.cols());
+    cml::et::detail::ResizeUninitialized(right_tmp,right.rows(),right.cols());
     right_tmp = right;
 
     return detail::mul(left,right_tmp,detail::mul_xA());
@@ -250,7 +256,7 @@ operator*(const et::VectorXpr<XprT>& left,
 {
     /* Generate a temporary, and compute the left-hand expression: */
     typename et::VectorXpr<XprT>::temporary_type left_tmp;
-    cml::et::detail::Resize(left_tmp,left.size());
+    cml::et::detail::ResizeUninitialized(left_tmp,left.size());
     left_tmp = left;
 
     return detail::mul(left_tmp,right,detail::mul_xA());
@@ -266,12 +272,12 @@ operator*(const et::VectorXpr<XprT1>& left,
 {
     /* Generate a temporary, and compute the left-hand expression: */
     typename et::VectorXpr<XprT1>::temporary_type left_tmp;
-    cml::et::detail::Resize(left_tmp,left.size());
+    cml::et::detail::ResizeUninitialized(left_tmp,left.size());
     left_tmp = left;
 
     /* Generate a temporary, and compute the right-hand expression: */
     typename et::MatrixXpr<XprT2>::temporary_type right_tmp;
-    cml::et::detail::Resize(right_tmp,right.rows(),right.cols());
+    cml::et::detail::ResizeUninitialized(right_tmp,right.rows(),right.cols());
     right_tmp = right;
 
     return detail::mul(left_tmp,right_tmp,detail::mul_xA());
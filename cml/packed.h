@@ -0,0 +1,164 @@
+/* -*- C++ -*- ------------------------------------------------------------
+ 
+Copyright (c) 2007 Jesse Anders and Demian Nave http://cmldev.net/
+
+The Configurable Math Library (CML) is distributed under the terms of the
+Boost Software License, v1.0 (see cml/LICENSE for details).
+
+ *-----------------------------------------------------------------------*/
+/** @file
+ *  @brief Selectors for packed symmetric and triangular matrices.
+ */
+
+#ifndef packed_h
+#define packed_h
+
+#include <cml/defaults.h>
+#include <cml/core/common.h>
+#include <cml/strided.h>
+
+namespace cml {
+
+/** This is a selector for packed symmetric matrices.
+ *
+ * A symmetric matrix is square, and stores only the n(n+1)/2 elements of
+ * its lower triangle; element (i,j) and element (j,i) are the same element.
+ * Assigning an expression to a symmetric matrix stores the lower triangle
+ * of the expression.  Alloc is rebound to the element type, as for
+ * dynamic<>.
+ *
+ * @sa lower_triangular
+ * @sa upper_triangular
+ */
+template<class Alloc = CML_DEFAULT_ARRAY_ALLOC> struct symmetric {
+    typedef Alloc allocator_type;
+    typedef symmetric_tag structure_tag;
+    typedef symmetric<Alloc> transposed_type;
+};
+
+/** This is a selector for packed lower triangular matrices.
+ *
+ * A lower triangular matrix is square, and stores only the n(n+1)/2
+ * elements on and below its diagonal; the elements above the diagonal are
+ * zero.  Assigning an expression to a lower triangular matrix stores the
+ * lower triangle of the expression.
+ *
+ * @sa symmetric
+ */
+template<class Alloc = CML_DEFAULT_ARRAY_ALLOC> struct lower_triangular;
+
+/** This is a selector for packed upper triangular matrices.
+ *
+ * An upper triangular matrix is square, and stores only the n(n+1)/2
+ * elements on and above its diagonal; the elements below the diagonal are
+ * zero.  Assigning an expression to an upper triangular matrix stores the
+ * upper triangle of the expression.
+ *
+ * @sa symmetric
+ */
+template<class Alloc = CML_DEFAULT_ARRAY_ALLOC> struct upper_triangular;
+
+template<class Alloc> struct lower_triangular {
+    typedef Alloc allocator_type;
+    typedef lower_triangular_tag structure_tag;
+    typedef upper_triangular<Alloc> transposed_type;
+};
+
+template<class Alloc> struct upper_triangular {
+    typedef Alloc allocator_type;
+    typedef upper_triangular_tag structure_tag;
+    typedef lower_triangular<Alloc> transposed_type;
+};
+
+/** The structure of the matrices selected by the generator ArrayType:
+ * general_tag, symmetric_tag, lower_triangular_tag or upper_triangular_tag.
+ */
+template<class ArrayType> struct matrix_structure {
+    typedef general_tag type;
+};
+
+template<class Alloc> struct matrix_structure< symmetric<Alloc> > {
+    typedef symmetric_tag type;
+};
+
+template<class Alloc> struct matrix_structure< lower_triangular<Alloc> > {
+    typedef lower_triangular_tag type;
+};
+
+template<class Alloc> struct matrix_structure< upper_triangular<Alloc> > {
+    typedef upper_triangular_tag type;
+};
+
+/* Packed arrays are not stored in row- or column-major order: */
+template<class Alloc> struct contiguous_storage< symmetric<Alloc> > {
+    enum { is_true = false };
+};
+
+template<class Alloc> struct contiguous_storage< lower_triangular<Alloc> > {
+    enum { is_true = false };
+};
+
+template<class Alloc> struct contiguous_storage< upper_triangular<Alloc> > {
+    enum { is_true = false };
+};
+
+namespace detail {
+
+/** Narrow [k0,k1) to the columns of row i of a matrix with the given
+ * structure that can be non-zero.
+ */
+inline void NonZeroCols(size_t, size_t&, size_t&, general_tag) {}
+inline void NonZeroCols(size_t, size_t&, size_t&, symmetric_tag) {}
+inline void NonZeroCols(size_t i, size_t&, size_t& k1, lower_triangular_tag)
+{
+    if(i + 1 < k1) k1 = i + 1;
+}
+inline void NonZeroCols(size_t i, size_t& k0, size_t&, upper_triangular_tag)
+{
+    if(i > k0) k0 = i;
+}
+
+/** Narrow [k0,k1) to the rows of column j of a matrix with the given
+ * structure that can be non-zero.
+ */
+inline void NonZeroRows(size_t, size_t&, size_t&, general_tag) {}
+inline void NonZeroRows(size_t, size_t&, size_t&, symmetric_tag) {}
+inline void NonZeroRows(size_t j, size_t& k0, size_t&, lower_triangular_tag)
+{
+    if(j > k0) k0 = j;
+}
+inline void NonZeroRows(size_t j, size_t&, size_t& k1, upper_triangular_tag)
+{
+    if(j + 1 < k1) k1 = j + 1;
+}
+
+/** Narrow [k0,k1) to the columns of row i of a matrix with the given
+ * structure that are stored.  Symmetric matrices store their lower
+ * triangle.
+ */
+template<class Structure> inline void
+StoredCols(size_t i, size_t& k0, size_t& k1, Structure) {
+    NonZeroCols(i, k0, k1, Structure());
+}
+inline void StoredCols(size_t i, size_t& k0, size_t& k1, symmetric_tag) {
+    NonZeroCols(i, k0, k1, lower_triangular_tag());
+}
+
+/** Narrow [k0,k1) to the rows of column j of a matrix with the given
+ * structure that are stored.
+ */
+template<class Structure> inline void
+StoredRows(size_t j, size_t& k0, size_t& k1, Structure) {
+    NonZeroRows(j, k0, k1, Structure());
+}
+inline void StoredRows(size_t j, size_t& k0, size_t& k1, symmetric_tag) {
+    NonZeroRows(j, k0, k1, lower_triangular_tag());
+}
+
+} // namespace detail
+} // namespace cml
+
+#endif
+
+// -------------------------------------------------------------------------
+// vim:ft=cpp
@@ -0,0 +1,28 @@
+/* -*- C++ -*- ------------------------------------------------------------
+ 
+Copyright (c) 2007 Jesse Anders and Demian Nave http://cmldev.net/
+
+The Configurable Math Library (CML) is distributed under the terms of the
+Boost Software License, v1.0 (see cml/LICENSE for details).
+
+ *-----------------------------------------------------------------------*/
+/** @file
+ *  @brief
+ *
+ *  Compressed sparse matrices, and their products with dense vectors and
+ *  matrices.
+ */
+
+#ifndef cml_sparse_h
+#define cml_sparse_h
+
+#include <cml/vector.h>
+#include <cml/matrix.h>
+#include <cml/sparse/sparse_builder.h>
+#include <cml/sparse/sparse_matrix.h>
+#include <cml/sparse/sparse_mul.h>
+
+#endif
+
+// -------------------------------------------------------------------------
+// vim:ft=cpp
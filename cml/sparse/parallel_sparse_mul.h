@@ -0,0 +1,119 @@
+/* -*- C++ -*- ------------------------------------------------------------
+ 
+Copyright (c) 2007 Jesse Anders and Demian Nave http://cmldev.net/
+
+The Configurable Math Library (CML) is distributed under the terms of the
+Boost Software License, v1.0 (see cml/LICENSE for details).
+
+ *-----------------------------------------------------------------------*/
+/** @file
+ *  @brief Multithreaded sparse matrix-vector products.
+ *
+ * The outer segments of the sparse matrix are split into ranges holding
+ * about the same number of stored elements, and each range is computed as
+ * a separate task on a cml::thread_pool.
+ *
+ * This header is included automatically when CML_PARALLEL is defined.
+ * Otherwise, it can be included directly to use parallel_mul() with an
+ * explicit pool.
+ *
+ * @note Requires C++11 threads.
+ *
+ * @sa cml/sparse/sparse_mul.h
+ * @sa cml/core/thread_pool.h
+ */
+
+#ifndef parallel_sparse_mul_h
+#define parallel_sparse_mul_h
+
+#include <vector>
+#include <algorithm>
+#include <cml/core/thread_pool.h>
+#include <cml/sparse/sparse_mul.h>
+
+namespace cml {
+namespace detail {
+
+/** Compute one range of outer segments of a parallel product. */
+template<class VecY, class SparseT, class VecX>
+struct SparseGatherTask
+{
+    SparseGatherTask(VecY& y, const SparseT& A, const VecX& x,
+            const std::vector<size_t>& bounds)
+        : m_y(&y), m_A(&A), m_x(&x), m_bounds(&bounds) {}
+
+    void operator()(size_t task) const {
+        SparseGather(*m_y, *m_A, *m_x,
+                (*m_bounds)[task], (*m_bounds)[task+1]);
+    }
+
+    VecY* m_y;
+    const SparseT* m_A;
+    const VecX* m_x;
+    const std::vector<size_t>* m_bounds;
+};
+
+/** Compute the gather form of a sparse product with one task per range of
+ * outer segments.
+ *
+ * The ranges are chosen so that each holds about the same number of stored
+ * elements, with a few ranges per thread so that work-stealing can balance
+ * the load.
+ */
+template<class VecY, class SparseT, class VecX> void
+SparseGatherParallel(VecY& y, const SparseT& A, const VecX& x,
+        thread_pool& pool)
+{
+    const size_t outer = A.outer_size(), nnz = A.nonzeros();
+    const size_t* starts = A.outer_starts();
+    size_t tasks = std::min(4*(pool.size()+1), outer);
+    if(tasks < 2) {
+        SparseGather(y, A, x, 0, outer);
+        return;
+    }
+
+    std::vector<size_t> bounds(tasks+1, outer);
+    bounds[0] = 0;
+    for(size_t t = 1; t < tasks; ++ t) {
+        const size_t* p = std::lower_bound(
+                starts, starts+outer+1, (nnz/tasks)*t + (nnz%tasks)*t/tasks);
+        bounds[t] = std::max(bounds[t-1], size_t(p - starts));
+    }
+
+    pool.parallel_for(tasks,
+            SparseGatherTask<VecY,SparseT,VecX>(y, A, x, bounds));
+}
+
+} // namespace detail
+
+
+/** Multithreaded sparse matrix-vector product, y = A*x.
+ *
+ * Dynamic results are resized if necessary; other results must already
+ * have the right size.  y must not share storage with x.  CSR matrices are
+ * split by rows across the pool; CSC products scatter into y, and are
+ * computed on the calling thread.
+ *
+ * @throws std::invalid_argument if the sizes of A, x, and y do not match.
+ */
+template<typename E1, class L, class Alloc, typename E2, class AT2,
+    typename E3, class AT3> void
+parallel_mul(const sparse_matrix<E1,L,Alloc>& A, const vector<E2,AT2>& x,
+        vector<E3,AT3>& y, thread_pool& pool)
+{
+    detail::SparseCheckedSize(A.cols(), x.size());
+    cml::et::detail::ResizeUninitialized(y, A.rows());
+    detail::SparseCheckedSize(A.rows(), y.size());
+    if(same_type<L,row_major>::is_true) {
+        detail::SparseGatherParallel(y, A, x, pool);
+    } else {
+        detail::SparseScatter(y, A, x);
+    }
+}
+
+} // namespace cml
+
+#endif
+
+// -------------------------------------------------------------------------
+// vim:ft=cpp
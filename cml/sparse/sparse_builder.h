@@ -0,0 +1,124 @@
+/* -*- C++ -*- ------------------------------------------------------------
+ 
+Copyright (c) 2007 Jesse Anders and Demian Nave http://cmldev.net/
+
+The Configurable Math Library (CML) is distributed under the terms of the
+Boost Software License, v1.0 (see cml/LICENSE for details).
+
+ *-----------------------------------------------------------------------*/
+/** @file
+ *  @brief A list of (row, column, value) triplets to build sparse matrices.
+ */
+
+#ifndef sparse_builder_h
+#define sparse_builder_h
+
+#include <vector>
+#include <stdexcept>
+#include <cml/core/common.h>
+
+namespace cml {
+
+/** Collects the elements of a sparse matrix in any order.
+ *
+ * Elements can be added in any order, and elements added more than once
+ * are summed when the matrix is built, as when assembling a stiffness
+ * matrix from element contributions:
+ *
+ *   sparse_builder<double> b(n,n);
+ *   b.reserve(9*elements);
+ *   for(...) b.add(i,j,k);
+ *   sparse_matrix<double> K(b);
+ *
+ * Alloc is rebound to the stored types, as for dynamic<>.
+ *
+ * @sa sparse_matrix
+ */
+template<typename Element, class Alloc = CML_DEFAULT_ARRAY_ALLOC>
+class sparse_builder
+{
+  public:
+
+    /* Standard: */
+    typedef Element value_type;
+
+    /* The arrays holding the triplets: */
+    typedef std::vector<size_t,
+            typename Alloc::template rebind<size_t>::other> index_array;
+    typedef std::vector<Element,
+            typename Alloc::template rebind<Element>::other> value_array;
+
+
+  public:
+
+    /** Start an empty rows x cols matrix. */
+    sparse_builder(size_t rows, size_t cols) : m_rows(rows), m_cols(cols) {}
+
+
+  public:
+
+    /** Return the number of rows of the matrix. */
+    size_t rows() const { return m_rows; }
+
+    /** Return the number of columns of the matrix. */
+    size_t cols() const { return m_cols; }
+
+    /** Return the number of triplets added so far. */
+    size_t size() const { return m_values.size(); }
+
+    /** Return the row of triplet k. */
+    size_t row(size_t k) const { return m_row_indices[k]; }
+
+    /** Return the column of triplet k. */
+    size_t col(size_t k) const { return m_col_indices[k]; }
+
+    /** Return the value of triplet k. */
+    const value_type& value(size_t k) const { return m_values[k]; }
+
+
+  public:
+
+    /** Make room for n triplets without reallocating. */
+    void reserve(size_t n) {
+        m_row_indices.reserve(n);
+        m_col_indices.reserve(n);
+        m_values.reserve(n);
+    }
+
+    /** Add v to element (i,j).
+     *
+     * @throws std::invalid_argument if (i,j) is outside the matrix.
+     */
+    void add(size_t i, size_t j, const value_type& v) {
+        if(i >= m_rows || j >= m_cols)
+            throw std::invalid_argument(
+                    "sparse element exceeds the matrix size.");
+        m_row_indices.push_back(i);
+        m_col_indices.push_back(j);
+        m_values.push_back(v);
+    }
+
+    /** Remove all of the triplets, keeping the matrix size. */
+    void clear() {
+        m_row_indices.clear();
+        m_col_indices.clear();
+        m_values.clear();
+    }
+
+
+  protected:
+
+    /** The matrix size. */
+    size_t			m_rows, m_cols;
+
+    /** The triplets, in the order they were added. */
+    index_array			m_row_indices, m_col_indices;
+    value_array			m_values;
+};
+
+} // namespace cml
+
+#endif
+
+// -------------------------------------------------------------------------
+// vim:ft=cpp
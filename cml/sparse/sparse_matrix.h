@@ -0,0 +1,276 @@
+/* -*- C++ -*- ------------------------------------------------------------
+ 
+Copyright (c) 2007 Jesse Anders and Demian Nave http://cmldev.net/
+
+The Configurable Math Library (CML) is distributed under the terms of the
+Boost Software License, v1.0 (see cml/LICENSE for details).
+
+ *-----------------------------------------------------------------------*/
+/** @file
+ *  @brief Compressed sparse row and column matrices.
+ */
+
+#ifndef sparse_matrix_h
+#define sparse_matrix_h
+
+#include <vector>
+#include <algorithm>
+#include <cml/core/common.h>
+#include <cml/core/cml_meta.h>
+#include <cml/vector.h>
+#include <cml/matrix.h>
+#include <cml/sparse/sparse_builder.h>
+
+namespace cml {
+
+/** A sparse matrix in compressed row (CSR) or compressed column (CSC) form.
+ *
+ * With Layout = row_major the non-zero elements are stored row by row
+ * (CSR), and with col_major column by column (CSC).  Each row (or column)
+ * is an outer segment: outer_starts()[o] is the position of the first
+ * element of segment o in inner_indices() and values(), and
+ * outer_starts()[o+1] is one past its last element.  The elements of each
+ * segment are sorted by inner index (the column for CSR, the row for CSC),
+ * with no duplicates.
+ *
+ * The non-zero pattern is built once, from a sparse_builder<> or a dense
+ * matrix; values() can be changed in place afterwards.  Sparse matrices are
+ * not part of the expression templates, but can be multiplied with dense
+ * vectors and matrices (see cml/sparse/sparse_mul.h).
+ *
+ * Alloc is rebound to the stored types, as for dynamic<>, and is also the
+ * allocator of the dense results of products.
+ */
+template<typename Element, typename Layout = row_major,
+    class Alloc = CML_DEFAULT_ARRAY_ALLOC>
+class sparse_matrix
+{
+  public:
+
+    /* Shorthand for the type of this matrix: */
+    typedef sparse_matrix<Element,Layout,Alloc> matrix_type;
+
+    /* Record the allocator type: */
+    typedef Alloc allocator_type;
+
+    /* Standard: */
+    typedef Element value_type;
+
+    /* For matching by memory layout: */
+    typedef Layout layout;
+
+    /* The arrays holding the matrix: */
+    typedef std::vector<size_t,
+            typename Alloc::template rebind<size_t>::other> index_array;
+    typedef std::vector<Element,
+            typename Alloc::template rebind<Element>::other> value_array;
+
+
+  public:
+
+    /** Construct an empty 0x0 matrix. */
+    sparse_matrix() : m_rows(0), m_cols(0), m_starts(1,0) {}
+
+    /** Construct a rows x cols matrix with no non-zero elements. */
+    sparse_matrix(size_t rows, size_t cols)
+        : m_rows(rows), m_cols(cols),
+        m_starts((same_type<Layout,row_major>::is_true ? rows : cols)+1, 0)
+    {}
+
+    /** Construct a matrix from triplets, summing duplicates. */
+    template<typename E, class A> explicit
+    sparse_matrix(const sparse_builder<E,A>& b) : m_rows(0), m_cols(0) {
+        this->build(b);
+    }
+
+    /** Construct a matrix from the non-zero elements of a dense matrix. */
+    template<typename E, class AT, typename BO, typename L> explicit
+    sparse_matrix(const matrix<E,AT,BO,L>& m) : m_rows(0), m_cols(0) {
+        const bool by_row = same_type<Layout,row_major>::is_true;
+        const size_t outer = by_row ? m.rows() : m.cols();
+        const size_t inner = by_row ? m.cols() : m.rows();
+        m_rows = m.rows();
+        m_cols = m.cols();
+        m_starts.assign(outer+1, 0);
+        for(size_t o = 0; o < outer; ++ o) {
+            for(size_t k = 0; k < inner; ++ k) {
+                value_type v = by_row ? m(o,k) : m(k,o);
+                if(v == value_type(0)) continue;
+                m_indices.push_back(k);
+                m_values.push_back(v);
+            }
+            m_starts[o+1] = m_values.size();
+        }
+    }
+
+    /** Convert a sparse matrix with another layout or element type. */
+    template<typename E, class L, class A> explicit
+    sparse_matrix(const sparse_matrix<E,L,A>& m) : m_rows(0), m_cols(0) {
+        sparse_builder<E,A> b(m.rows(), m.cols());
+        b.reserve(m.nonzeros());
+        const bool by_row = same_type<L,row_major>::is_true;
+        for(size_t o = 0; o < m.outer_size(); ++ o) {
+            for(size_t p = m.outer_starts()[o]; p < m.outer_starts()[o+1]; ++ p)
+            {
+                size_t k = m.inner_indices()[p];
+                if(by_row) b.add(o, k, m.values()[p]);
+                else b.add(k, o, m.values()[p]);
+            }
+        }
+        this->build(b);
+    }
+
+    /** Rebuild the matrix from triplets, summing duplicates. */
+    template<typename E, class A>
+    matrix_type& operator=(const sparse_builder<E,A>& b) {
+        this->build(b);
+        return *this;
+    }
+
+
+  public:
+
+    /** Return the number of rows. */
+    size_t rows() const { return m_rows; }
+
+    /** Return the number of columns. */
+    size_t cols() const { return m_cols; }
+
+    /** Return the matrix size as a pair. */
+    matrix_size size() const { return matrix_size(m_rows,m_cols); }
+
+    /** Return the number of stored elements. */
+    size_t nonzeros() const { return m_values.size(); }
+
+    /** Return the number of outer segments (rows for CSR, columns for
+     * CSC).
+     */
+    size_t outer_size() const { return m_starts.size()-1; }
+
+    /** Return element (i,j), or 0 if it is not stored.
+     *
+     * This takes a binary search in row i (CSR) or column j (CSC).
+     */
+    value_type operator()(size_t i, size_t j) const {
+        const bool by_row = same_type<Layout,row_major>::is_true;
+        const size_t o = by_row ? i : j, k = by_row ? j : i;
+        const size_t* first = this->inner_indices() + m_starts[o];
+        const size_t* last = this->inner_indices() + m_starts[o+1];
+        const size_t* p = std::lower_bound(first, last, k);
+        if(p == last || *p != k) return value_type(0);
+        return m_values[p - this->inner_indices()];
+    }
+
+    /** Return the positions of the outer segments, outer_size()+1 of them. */
+    const size_t* outer_starts() const { return &m_starts[0]; }
+
+    /** Return the inner indices of the stored elements. */
+    const size_t* inner_indices() const {
+        return m_indices.empty() ? 0 : &m_indices[0];
+    }
+
+    /** Return the stored elements. */
+    const value_type* values() const {
+        return m_values.empty() ? 0 : &m_values[0];
+    }
+
+    /** Return the stored elements, to change them in place. */
+    value_type* values() {
+        return m_values.empty() ? 0 : &m_values[0];
+    }
+
+    /** Exchange the arrays of *this and other, without copying. */
+    void swap(matrix_type& other) {
+        std::swap(m_rows, other.m_rows);
+        std::swap(m_cols, other.m_cols);
+        m_starts.swap(other.m_starts);
+        m_indices.swap(other.m_indices);
+        m_values.swap(other.m_values);
+    }
+
+
+  protected:
+
+    /** Build the compressed arrays from triplets in O(n + rows + cols).
+     *
+     * The triplets are bucketed by inner index, then stably by outer index,
+     * so that each segment comes out sorted by inner index, with duplicates
+     * next to each other in the order they were added.  Duplicates are
+     * then summed in place.
+     */
+    template<typename E, class A> void build(const sparse_builder<E,A>& b) {
+        const bool by_row = same_type<Layout,row_major>::is_true;
+        const size_t outer = by_row ? b.rows() : b.cols();
+        const size_t inner = by_row ? b.cols() : b.rows();
+        const size_t n = b.size();
+
+        /* Order the triplets by inner index: */
+        index_array count(inner+1, 0), order(n);
+        for(size_t t = 0; t < n; ++ t)
+            ++ count[(by_row ? b.col(t) : b.row(t))+1];
+        for(size_t k = 0; k < inner; ++ k) count[k+1] += count[k];
+        for(size_t t = 0; t < n; ++ t)
+            order[count[by_row ? b.col(t) : b.row(t)] ++] = t;
+
+        /* Then place them by outer index, keeping that order: */
+        index_array starts(outer+1, 0), next(outer+1, 0);
+        index_array indices(n);
+        value_array values(n);
+        for(size_t t = 0; t < n; ++ t)
+            ++ starts[(by_row ? b.row(t) : b.col(t))+1];
+        for(size_t o = 0; o < outer; ++ o) starts[o+1] += starts[o];
+        std::copy(starts.begin(), starts.end(), next.begin());
+        for(size_t q = 0; q < n; ++ q) {
+            const size_t t = order[q];
+            const size_t p = next[by_row ? b.row(t) : b.col(t)] ++;
+            indices[p] = by_row ? b.col(t) : b.row(t);
+            values[p] = value_type(b.value(t));
+        }
+
+        /* Sum duplicates, compacting the arrays in place: */
+        size_t out = 0;
+        for(size_t o = 0; o < outer; ++ o) {
+            const size_t first = starts[o], last = starts[o+1];
+            starts[o] = out;
+            for(size_t p = first; p < last; ++ p) {
+                if(out > starts[o] && indices[out-1] == indices[p]) {
+                    values[out-1] += values[p];
+                } else {
+                    indices[out] = indices[p];
+                    values[out] = values[p];
+                    ++ out;
+                }
+            }
+        }
+        starts[outer] = out;
+        indices.resize(out);
+        values.resize(out);
+
+        /* Success, so save the new arrays and the size: */
+        m_rows = b.rows();
+        m_cols = b.cols();
+        m_starts.swap(starts);
+        m_indices.swap(indices);
+        m_values.swap(values);
+    }
+
+
+  protected:
+
+    /** The matrix size. */
+    size_t			m_rows, m_cols;
+
+    /** Position of each outer segment in m_indices and m_values. */
+    index_array			m_starts;
+
+    /** Inner index and value of each stored element. */
+    index_array			m_indices;
+    value_array			m_values;
+};
+
+} // namespace cml
+
+#endif
+
+// -------------------------------------------------------------------------
+// vim:ft=cpp
@@ -0,0 +1,260 @@
+/* -*- C++ -*- ------------------------------------------------------------
+ 
+Copyright (c) 2007 Jesse Anders and Demian Nave http://cmldev.net/
+
+The Configurable Math Library (CML) is distributed under the terms of the
+Boost Software License, v1.0 (see cml/LICENSE for details).
+
+ *-----------------------------------------------------------------------*/
+/** @file
+ *  @brief Multiply sparse matrices with dense vectors and matrices.
+ *
+ * A*x, x*A and A*B for a sparse A return dense dynamic temporaries, so
+ * they can be used in vector and matrix expressions like y = A*x + b.
+ * Each product visits only the stored elements of A.
+ *
+ * Products that sum along the outer segments of A (A*x for CSR, x*A for
+ * CSC) compute each element of the result independently.  When
+ * CML_PARALLEL is defined, those with at least CML_PARALLEL_SPMV_THRESHOLD
+ * stored elements are split across the default thread pool.  The other
+ * products scatter each segment into the result, and run on the calling
+ * thread.
+ *
+ * @sa cml/sparse/parallel_sparse_mul.h
+ */
+
+#ifndef sparse_mul_h
+#define sparse_mul_h
+
+#include <stdexcept>
+#include <cml/vector.h>
+#include <cml/matrix.h>
+#include <cml/sparse/sparse_matrix.h>
+
+#if defined(CML_PARALLEL)
+#include <cml/core/thread_pool.h>
+#endif
+
+namespace cml {
+namespace detail {
+
+/** Verify that the inner dimensions of a sparse product agree. */
+inline void SparseCheckedSize(size_t left, size_t right) {
+    if(left != right)
+        throw std::invalid_argument("expressions have incompatible sizes.");
+}
+
+/** Compute y[o] = sum(A(o,k)*x[k]) over the stored elements of each outer
+ * segment o in [o0,o1).
+ */
+template<class VecY, class SparseT, class VecX> inline void
+SparseGather(VecY& y, const SparseT& A, const VecX& x, size_t o0, size_t o1)
+{
+    typedef typename VecY::value_type value_type;
+    const size_t* starts = A.outer_starts();
+    const size_t* indices = A.inner_indices();
+    const typename SparseT::value_type* values = A.values();
+    for(size_t o = o0; o < o1; ++o) {
+        value_type sum(0);
+        for(size_t p = starts[o]; p < starts[o+1]; ++p) {
+            sum += values[p]*x[indices[p]];
+        }
+        y[o] = sum;
+    }
+}
+
+/** Compute y[k] = sum(A(o,k)*x[o]) by adding each outer segment o of A,
+ * scaled by x[o], into y.
+ */
+template<class VecY, class SparseT, class VecX> inline void
+SparseScatter(VecY& y, const SparseT& A, const VecX& x)
+{
+    typedef typename VecY::value_type value_type;
+    const size_t* starts = A.outer_starts();
+    const size_t* indices = A.inner_indices();
+    const typename SparseT::value_type* values = A.values();
+    for(size_t k = 0; k < y.size(); ++k) y[k] = value_type(0);
+    for(size_t o = 0; o < A.outer_size(); ++o) {
+        const value_type xo = x[o];
+        for(size_t p = starts[o]; p < starts[o+1]; ++p) {
+            y[indices[p]] += values[p]*xo;
+        }
+    }
+}
+
+#if defined(CML_PARALLEL)
+/* Defined in cml/sparse/parallel_sparse_mul.h: */
+template<class VecY, class SparseT, class VecX> void
+SparseGatherParallel(VecY& y, const SparseT& A, const VecX& x,
+        thread_pool& pool);
+#endif
+
+/** Compute the gather form of a product, on the default thread pool if it
+ * is large enough and CML_PARALLEL is defined.
+ */
+template<class VecY, class SparseT, class VecX> inline void
+SparseGatherAll(VecY& y, const SparseT& A, const VecX& x)
+{
+#if defined(CML_PARALLEL)
+    if(A.nonzeros() >= size_t(CML_PARALLEL_SPMV_THRESHOLD)) {
+        SparseGatherParallel(y, A, x, default_thread_pool());
+        return;
+    }
+#endif
+    SparseGather(y, A, x, 0, A.outer_size());
+}
+
+/** Compute y = A*x for a CSR matrix. */
+template<class VecY, class SparseT, class VecX> inline void
+SparseMulVec(VecY& y, const SparseT& A, const VecX& x, row_major) {
+    SparseGatherAll(y, A, x);
+}
+
+/** Compute y = A*x for a CSC matrix. */
+template<class VecY, class SparseT, class VecX> inline void
+SparseMulVec(VecY& y, const SparseT& A, const VecX& x, col_major) {
+    SparseScatter(y, A, x);
+}
+
+/** Compute y = x*A for a CSR matrix. */
+template<class VecY, class VecX, class SparseT> inline void
+SparseVecMul(VecY& y, const VecX& x, const SparseT& A, row_major) {
+    SparseScatter(y, A, x);
+}
+
+/** Compute y = x*A for a CSC matrix. */
+template<class VecY, class VecX, class SparseT> inline void
+SparseVecMul(VecY& y, const VecX& x, const SparseT& A, col_major) {
+    SparseGatherAll(y, A, x);
+}
+
+/** Compute C = A*B for a sparse A and a dense B, adding each row of B
+ * scaled by A(i,k) to row i of C for the stored elements of A.
+ */
+template<class MatC, class SparseT, class MatB> inline void
+SparseMulMat(MatC& C, const SparseT& A, const MatB& B)
+{
+    typedef typename MatC::value_type value_type;
+    const bool by_row = same_type<typename SparseT::layout,row_major>::is_true;
+    const size_t* starts = A.outer_starts();
+    const size_t* indices = A.inner_indices();
+    const typename SparseT::value_type* values = A.values();
+    C.zero();
+    for(size_t o = 0; o < A.outer_size(); ++o) {
+        for(size_t p = starts[o]; p < starts[o+1]; ++p) {
+            const size_t i = by_row ? o : indices[p];
+            const size_t k = by_row ? indices[p] : o;
+            const value_type a = values[p];
+            for(size_t j = 0; j < B.cols(); ++j) C(i,j) += a*B(k,j);
+        }
+    }
+}
+
+} // namespace detail
+
+
+/** Compute y = A*x for a sparse A and a dense vector x. */
+template<typename E1, class L, class Alloc, typename E2, class AT>
+inline vector<typename et::ScalarPromote<E1,E2>::type, dynamic<Alloc> >
+operator*(const sparse_matrix<E1,L,Alloc>& left, const vector<E2,AT>& right)
+{
+    typedef vector<
+        typename et::ScalarPromote<E1,E2>::type, dynamic<Alloc> > result_type;
+    detail::SparseCheckedSize(left.cols(), right.size());
+    result_type y; cml::et::detail::ResizeUninitialized(y, left.rows());
+    detail::SparseMulVec(y, left, right, L());
+    return y;
+}
+
+/** Compute y = A*x for a sparse A and a vector expression x. */
+template<typename E, class L, class Alloc, typename XprT>
+inline vector<
+    typename et::ScalarPromote<E,typename XprT::value_type>::type,
+    dynamic<Alloc> >
+operator*(const sparse_matrix<E,L,Alloc>& left,
+        const et::VectorXpr<XprT>& right)
+{
+    /* Generate a temporary, and compute the right-hand expression: */
+    typename et::VectorXpr<XprT>::temporary_type right_tmp;
+    cml::et::detail::ResizeUninitialized(right_tmp,right.size());
+    right_tmp = right;
+
+    return left*right_tmp;
+}
+
+/** Compute y = x*A for a dense vector x and a sparse A. */
+template<typename E1, class AT, typename E2, class L, class Alloc>
+inline vector<typename et::ScalarPromote<E1,E2>::type, dynamic<Alloc> >
+operator*(const vector<E1,AT>& left, const sparse_matrix<E2,L,Alloc>& right)
+{
+    typedef vector<
+        typename et::ScalarPromote<E1,E2>::type, dynamic<Alloc> > result_type;
+    detail::SparseCheckedSize(left.size(), right.rows());
+    result_type y; cml::et::detail::ResizeUninitialized(y, right.cols());
+    detail::SparseVecMul(y, left, right, L());
+    return y;
+}
+
+/** Compute y = x*A for a vector expression x and a sparse A. */
+template<typename XprT, typename E, class L, class Alloc>
+inline vector<
+    typename et::ScalarPromote<typename XprT::value_type,E>::type,
+    dynamic<Alloc> >
+operator*(const et::VectorXpr<XprT>& left,
+        const sparse_matrix<E,L,Alloc>& right)
+{
+    /* Generate a temporary, and compute the left-hand expression: */
+    typename et::VectorXpr<XprT>::temporary_type left_tmp;
+    cml::et::detail::ResizeUninitialized(left_tmp,left.size());
+    left_tmp = left;
+
+    return left_tmp*right;
+}
+
+/** Compute C = A*B for a sparse A and a dense matrix B.
+ *
+ * The result has the basis orientation and layout of B.
+ */
+template<typename E1, class L1, class Alloc,
+    typename E2, class AT, typename BO, typename L2>
+inline matrix<typename et::ScalarPromote<E1,E2>::type, dynamic<Alloc>, BO, L2>
+operator*(const sparse_matrix<E1,L1,Alloc>& left,
+        const matrix<E2,AT,BO,L2>& right)
+{
+    typedef matrix<typename et::ScalarPromote<E1,E2>::type,
+            dynamic<Alloc>, BO, L2> result_type;
+    detail::SparseCheckedSize(left.cols(), right.rows());
+    result_type C(left.rows(), right.cols());
+    detail::SparseMulMat(C, left, right);
+    return C;
+}
+
+/** Compute C = A*B for a sparse A and a matrix expression B. */
+template<typename E, class L, class Alloc, typename XprT>
+inline matrix<
+    typename et::ScalarPromote<E,typename XprT::value_type>::type,
+    dynamic<Alloc>,
+    typename et::MatrixXpr<XprT>::temporary_type::basis_orient,
+    typename et::MatrixXpr<XprT>::temporary_type::layout>
+operator*(const sparse_matrix<E,L,Alloc>& left,
+        const et::MatrixXpr<XprT>& right)
+{
+    /* Generate a temporary, and compute the right-hand expression: */
+    typedef typename et::MatrixXpr<XprT>::temporary_type right_tmp;
+    right_tmp rtmp;
+    cml::et::detail::ResizeUninitialized(rtmp,right.rows(),right.cols());
+    rtmp = right;
+
+    return left*rtmp;
+}
+
+} // namespace cml
+
+#if defined(CML_PARALLEL)
+#include <cml/sparse/parallel_sparse_mul.h>
+#endif
+
+#endif
+
+// -------------------------------------------------------------------------
+// vim:ft=cpp
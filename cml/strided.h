@@ -0,0 +1,59 @@
+/* -*- C++ -*- ------------------------------------------------------------
+ 
+Copyright (c) 2007 Jesse Anders and Demian Nave http://cmldev.net/
+
+The Configurable Math Library (CML) is distributed under the terms of the
+Boost Software License, v1.0 (see cml/LICENSE for details).
+
+ *-----------------------------------------------------------------------*/
+/** @file
+ *  @brief
+ */
+
+#ifndef strided_h
+#define strided_h
+
+namespace cml {
+
+/** This is a selector for strided external arrays.
+ *
+ * Like external<>, a strided array wraps memory owned by the caller, but
+ * consecutive rows (for row-major arrays) or columns (for col-major arrays)
+ * are a run-time leading dimension apart, rather than packed.  This
+ * describes a sub-block of a larger array, or an array with padded rows:
+ *
+ *   double buf[8*16];
+ *   matrix<double, strided<>, col_basis, row_major> A(buf, 8, 12, 16);
+ *
+ * The size can also be fixed at compile time, as for external<>, e.g.
+ * matrix<double, strided<3,3> >(p, 4) for the upper 3x3 block of a 4x4
+ * row-major array.
+ *
+ * @sa external
+ * @sa cml::block
+ */
+template<int Dim1 = -1, int Dim2 = -1> struct strided {
+
+    /** Rebind to a 1D type. */
+    template<int D> struct rebind { typedef strided<D> other; };
+};
+
+/** Whether the arrays selected by the generator ArrayType store their
+ * elements contiguously, so that element k in storage order is at data()+k.
+ *
+ * The SIMD assignment kernels rely on this.
+ */
+template<class ArrayType> struct contiguous_storage {
+    enum { is_true = true };
+};
+
+template<int Dim1, int Dim2> struct contiguous_storage< strided<Dim1,Dim2> > {
+    enum { is_true = false };
+};
+
+} // namespace cml
+
+#endif
+
+// -------------------------------------------------------------------------
+// vim:ft=cpp
@@ -54,7 +54,9 @@ template<typename Element, class ArrayType> class vector;
 
 #include <cml/vector/fixed.h>
 #include <cml/vector/dynamic.h>
+#include <cml/vector/hybrid.h>
 #include <cml/vector/external.h>
+#include <cml/vector/subvector.h>
 
 #endif
 
@@ -150,6 +150,26 @@ class vector< Element, dynamic<Alloc> >
     /** Construct given array size. */
     vector(size_t N) : array_type(N) {}
 
+#if defined(CML_HAS_RVALUE_REFERENCES)
+    /** Move constructor, taking the array of v. */
+    vector(vector_type&& v) : array_type(std::move(v)) {}
+
+    /** Move assignment, taking the array of v if the result would have the
+     * size of v anyway, and v has an equal allocator (e.g. the same
+     * temp_arena).  Otherwise, v is copied as usual.
+     */
+    vector_type& operator=(vector_type&& v) {
+#if defined(CML_AUTOMATIC_VECTOR_RESIZE_ON_ASSIGNMENT)
+        bool take = (this->size() <= v.size());
+#else
+        bool take = (this->size() == v.size());
+#endif
+        take = take && (this->get_allocator() == v.get_allocator());
+        if(take) { this->swap(v); return *this; }
+        return (*this = static_cast<const vector_type&>(v));
+    }
+#endif
+
 
   public:
 
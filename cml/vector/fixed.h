@@ -22,19 +22,21 @@ Boost Software License, v1.0 (see cml/LICENSE for details).
 
 namespace cml {
 
-/** Fixed-size, fixed-memory vector. */
-template<typename Element, int Size>
-class vector< Element, fixed<Size> >
-: public fixed_1D<Element,Size>
+/** Fixed-size, fixed-memory vector, aligned to Align bytes (0 for the
+ * natural alignment of Element).
+ */
+template<typename Element, int Size, int Align>
+class vector< Element, fixed<Size,-1,Align> >
+: public fixed_1D<Element,Size,Align>
 {
   public:
 
     /* Shorthand for the generator: */
     typedef fixed<> storage_type;
-    typedef fixed<Size> generator_type;
+    typedef fixed<Size,-1,Align> generator_type;
 
     /* Shorthand for the array type: */
-    typedef fixed_1D<Element,Size> array_type;
+    typedef fixed_1D<Element,Size,Align> array_type;
 
     /* Shorthand for the type of this vector: */
     typedef vector<Element,generator_type> vector_type;
@@ -49,10 +51,10 @@ class vector< Element, fixed<Size> >
     typedef vector_type temporary_type;
 
     /* The type for a vector in one lower dimension: */
-    typedef vector< Element, fixed<Size-1> > subvector_type;
+    typedef vector< Element, fixed<Size-1,-1,Align> > subvector_type;
 
     /* The type for a vector in one higher dimension: */
-    typedef vector< Element, fixed<Size+1> > supervector_type;
+    typedef vector< Element, fixed<Size+1,-1,Align> > supervector_type;
 
     /* Standard: */
     typedef typename array_type::value_type value_type;
@@ -0,0 +1,93 @@
+/* -*- C++ -*- ------------------------------------------------------------
+ 
+Copyright (c) 2007 Jesse Anders and Demian Nave http://cmldev.net/
+
+The Configurable Math Library (CML) is distributed under the terms of the
+Boost Software License, v1.0 (see cml/LICENSE for details).
+
+ *-----------------------------------------------------------------------*/
+/** @file
+ *  @brief Views of ranges of a vector.
+ *
+ * subvector(v,i,n) returns elements i through i+n-1 of v as an external
+ * vector sharing v's memory, and subvector<N>(v,i) does the same for a
+ * range of N elements known at compile time.  Either can be read, or
+ * assigned to, in place:
+ *
+ *   vector< double, fixed<4> > p;
+ *   subvector<3>(p,0) = cross(a,b);
+ *
+ * The view is only valid while v exists, and keeps its memory.
+ *
+ * @note These are unrelated to vector<>::subvector(i), which returns a
+ * copy of the vector with element i removed.
+ */
+
+#ifndef subvector_h
+#define subvector_h
+
+#include <stdexcept>
+#include <cml/vector/external.h>
+
+namespace cml {
+namespace detail {
+
+/** Return the address of element i of v, after checking that the range
+ * fits in v.
+ */
+template<typename E, class AT> inline E*
+SubvectorOrigin(const vector<E,AT>& v, size_t i, size_t n)
+{
+    if(i + n > v.size())
+        throw std::invalid_argument("subvector exceeds the vector size.");
+    return const_cast<E*>(v.data()) + i;
+}
+
+} // namespace detail
+
+/** Return a view of the n elements of v starting at element i.
+ *
+ * @throws std::invalid_argument if the range does not fit in v.
+ */
+template<typename E, class AT> inline vector< E, external<> >
+subvector(vector<E,AT>& v, size_t i, size_t n)
+{
+    return vector< E, external<> >(detail::SubvectorOrigin(v,i,n), n);
+}
+
+/** Return a read-only view of the n elements of v starting at element i.
+ *
+ * @throws std::invalid_argument if the range does not fit in v.
+ */
+template<typename E, class AT> inline const vector< E, external<> >
+subvector(const vector<E,AT>& v, size_t i, size_t n)
+{
+    return vector< E, external<> >(detail::SubvectorOrigin(v,i,n), n);
+}
+
+/** Return a view of the N elements of v starting at element i.
+ *
+ * @throws std::invalid_argument if the range does not fit in v.
+ */
+template<int N, typename E, class AT> inline vector< E, external<N> >
+subvector(vector<E,AT>& v, size_t i)
+{
+    return vector< E, external<N> >(detail::SubvectorOrigin(v,i,N));
+}
+
+/** Return a read-only view of the N elements of v starting at element i.
+ *
+ * @throws std::invalid_argument if the range does not fit in v.
+ */
+template<int N, typename E, class AT> inline const vector< E, external<N> >
+subvector(const vector<E,AT>& v, size_t i)
+{
+    return vector< E, external<N> >(detail::SubvectorOrigin(v,i,N));
+}
+
+} // namespace cml
+
+#endif
+
+// -------------------------------------------------------------------------
+// vim:ft=cpp
@@ -144,6 +144,17 @@ struct ExprTraits< VectorXpr<ExprT> >
     size_t size(const expr_type& e) const { return e.size(); }
 };
 
+/** Packet access to a VectorXpr<>, if its expression has it. */
+template<class ExprT, class PacketT>
+struct PacketAccess< VectorXpr<ExprT>, PacketT, vector_result_tag >
+{
+    typedef PacketAccess<ExprT,PacketT> expr_access;
+    enum { is_true = expr_access::is_true };
+    static typename PacketT::type load(const VectorXpr<ExprT>& e, size_t i) {
+        return expr_access::load(e.expression(), i);
+    }
+};
+
 
 /** A unary vector expression.
  *
@@ -268,6 +279,23 @@ struct ExprTraits< UnaryVectorOp<ExprT,OpT> >
     size_t size(const expr_type& e) const { return e.size(); }
 };
 
+/** Packet access to a UnaryVectorOp<>, if its subexpression has it and the
+ * operator can be applied to packets.
+ */
+template<class ExprT, class OpT, class PacketT>
+struct PacketAccess< UnaryVectorOp<ExprT,OpT>, PacketT, vector_result_tag >
+{
+    typedef UnaryVectorOp<ExprT,OpT> expr_type;
+    typedef PacketAccess<ExprT,PacketT> expr_access;
+    enum { is_true = expr_access::is_true && PacketOp<OpT,PacketT>::is_true
+        && same_type<typename OpT::value_type,
+                     typename PacketT::value_type>::is_true };
+    static typename PacketT::type load(const expr_type& e, size_t i) {
+        return OpT::template packet_apply<PacketT>(
+                expr_access::load(e.expression(), i));
+    }
+};
+
 
 /** A binary vector expression.
  *
@@ -421,6 +449,27 @@ struct ExprTraits< BinaryVectorOp<LeftT,RightT,OpT> >
     size_t size(const expr_type& e) const { return e.size(); }
 };
 
+/** Packet access to a BinaryVectorOp<>, if both subexpressions have it and
+ * the operator can be applied to packets.
+ */
+template<class LeftT, class RightT, class OpT, class PacketT>
+struct PacketAccess<
+    BinaryVectorOp<LeftT,RightT,OpT>, PacketT, vector_result_tag >
+{
+    typedef BinaryVectorOp<LeftT,RightT,OpT> expr_type;
+    typedef PacketAccess<LeftT,PacketT> left_access;
+    typedef PacketAccess<RightT,PacketT> right_access;
+    enum { is_true = left_access::is_true && right_access::is_true
+        && PacketOp<OpT,PacketT>::is_true
+        && same_type<typename OpT::value_type,
+                     typename PacketT::value_type>::is_true };
+    static typename PacketT::type load(const expr_type& e, size_t i) {
+        return OpT::template packet_apply<PacketT>(
+                left_access::load(e.left_expression(), i),
+                right_access::load(e.right_expression(), i));
+    }
+};
+
 /* Helper struct to verify that both arguments are vector expressions: */
 template<typename LeftTraits, typename RightTraits>
 struct VectorExpressions
@@ -447,6 +496,24 @@ void Resize(VecT& v, size_t S) {
     Resize(v, S, typename VecT::resizing_tag(), typename VecT::memory_tag());
 }
 
+/* Like Resize(), but for temporaries that are overwritten next, so the
+ * elements need not be reset:
+ */
+template<typename VecT, typename RT, typename MT> inline
+void ResizeUninitialized(VecT&,size_t,RT,MT) {}
+
+template<typename VecT> inline
+void ResizeUninitialized(VecT& v, size_t S, resizable_tag, dynamic_memory_tag)
+{
+    v.resize_uninitialized(S);
+}
+
+template<typename VecT> inline
+void ResizeUninitialized(VecT& v, size_t S) {
+    ResizeUninitialized(v, S,
+            typename VecT::resizing_tag(), typename VecT::memory_tag());
+}
+
 } // namespace detail
 
 } // namespace et
@@ -19,6 +19,7 @@ Boost Software License, v1.0 (see cml/LICENSE for details).
 #include <cml/core/cml_assert.h>
 #include <cml/et/scalar_promotions.h>
 #include <cml/et/size_checking.h>
+#include <cml/et/reduce.h>
 #include <cml/vector/vector_unroller.h>
 #include <cml/vector/vector_expr.h>
 #include <cml/matrix/matrix_expr.h>
@@ -94,39 +95,76 @@ struct OuterPromote
         left_type,right_type>::temporary_type promoted_matrix;
 };
 
-/** Construct a dot unroller for fixed-size arrays.
- *
- * @note This should only be called for vectors.
+/** The terms of a dot product, for et::detail::ReduceSum<>.
  *
- * @sa cml::dot
+ * The terms are computed a packet at a time if both arguments and the
+ * product support it.
  */
 template<typename LeftT, typename RightT>
-inline typename DotPromote<LeftT,RightT>::promoted_scalar
-UnrollDot(const LeftT& left, const RightT& right, fixed_size_tag)
+struct DotTerms
 {
     /* Shorthand: */
     typedef DotPromote<LeftT,RightT> dot_helper;
+    typedef et::ExprTraits<RightT> right_traits;
+    typedef typename dot_helper::op_mul op_mul;
+    typedef typename dot_helper::promoted_scalar value_type;
 
-    /* Compile-type vector size check: */
-    typedef typename et::GetCheckedSize<LeftT,RightT,fixed_size_tag>
-        ::check_type check_sizes;
+    /* Packet access to the arguments: */
+    typedef et::Packet<value_type> packet_type;
+    typedef et::PacketAccess<LeftT,packet_type> left_access;
+    typedef et::PacketAccess<RightT,packet_type> right_access;
 
-    /* Get the fixed array size using the helper: */
-    enum { Len = check_sizes::array_size };
+    enum { use_packets = left_access::is_true && right_access::is_true
+        && et::PacketOp<op_mul,packet_type>::is_true
+        && packet_type::has_add };
+
+    DotTerms(const LeftT& left, const RightT& right)
+        : m_left(left), m_right(right) {}
 
+    /** Return left[i]*right[i]. */
+    value_type operator()(size_t i) const {
+        return op_mul().apply(m_left[i], right_traits().get(m_right,i));
+    }
+
+    /** Return a packet of the products starting at i. */
+    typename packet_type::type packet(size_t i) const {
+        return op_mul::template packet_apply<packet_type>(
+                left_access::load(m_left,i), right_access::load(m_right,i));
+    }
+
+    const LeftT& m_left;
+    const RightT& m_right;
+};
+
+/** Sum a short fixed-size dot product with the unroller. */
+template<int Len, typename LeftT, typename RightT>
+inline typename DotPromote<LeftT,RightT>::promoted_scalar
+UnrollDot(const LeftT& left, const RightT& right, true_type)
+{
     /* Record the unroller type: */
+    typedef DotPromote<LeftT,RightT> dot_helper;
     typedef typename dot_helper::op_mul op_mul;
     typedef typename dot_helper::op_add op_add;
     typedef typename et::detail::VectorAccumulateUnroller<
         op_add,op_mul,LeftT,RightT>::template
-        Eval<0, Len-1, (Len <= CML_VECTOR_DOT_UNROLL_LIMIT)> Unroller;
+        Eval<0, Len-1, true> Unroller;
     /* Note: Len is the array size, so Len-1 is the last element. */
 
-    /* Now, call the unroller: */
     return Unroller()(left,right);
 }
 
-/** Use a loop to compute the dot product for dynamic arrays.
+/** Sum a long fixed-size dot product with the reduction engine. */
+template<int Len, typename LeftT, typename RightT>
+inline typename DotPromote<LeftT,RightT>::promoted_scalar
+UnrollDot(const LeftT& left, const RightT& right, false_type)
+{
+    return et::detail::ReduceTerms(DotTerms<LeftT,RightT>(left,right), Len);
+}
+
+/** Construct a dot unroller for fixed-size arrays.
+ *
+ * Vectors longer than CML_VECTOR_DOT_UNROLL_LIMIT are summed with the
+ * reduction engine instead, without instantiating the unroller.
  *
  * @note This should only be called for vectors.
  *
@@ -134,37 +172,38 @@ UnrollDot(const LeftT& left, const RightT& right, fixed_size_tag)
  */
 template<typename LeftT, typename RightT>
 inline typename DotPromote<LeftT,RightT>::promoted_scalar
-UnrollDot(const LeftT& left, const RightT& right, dynamic_size_tag)
+UnrollDot(const LeftT& left, const RightT& right, fixed_size_tag)
 {
-    /* Shorthand: */
-    typedef DotPromote<LeftT,RightT> dot_helper;
-    typedef et::ExprTraits<LeftT> left_traits;
-    typedef et::ExprTraits<RightT> right_traits;
-    typedef typename dot_helper::op_mul op_mul;
-    typedef typename dot_helper::op_add op_add;
+    /* Compile-type vector size check: */
+    typedef typename et::GetCheckedSize<LeftT,RightT,fixed_size_tag>
+        ::check_type check_sizes;
 
-    /* Record the return type: */
-    typedef typename dot_helper::promoted_scalar sum_type;
+    /* Get the fixed array size using the helper: */
+    enum { Len = check_sizes::array_size };
+
+    typedef typename is_true<(Len <= CML_VECTOR_DOT_UNROLL_LIMIT)>::result
+        unroll;
+    return UnrollDot<Len>(left, right, unroll());
+}
 
+/** Compute the dot product for dynamic arrays with the reduction engine.
+ *
+ * @note This should only be called for vectors.
+ *
+ * @sa cml::dot
+ * @sa cml::et::detail::ReduceSum
+ */
+template<typename LeftT, typename RightT>
+inline typename DotPromote<LeftT,RightT>::promoted_scalar
+UnrollDot(const LeftT& left, const RightT& right, dynamic_size_tag)
+{
     /* Verify expression sizes: */
     const size_t N = et::CheckedSize(left,right,dynamic_size_tag());
 
-    /* Initialize the sum. Left and right must be vector expressions, so
-     * it's okay to use array notation here:
+    /* Left and right must be vector expressions, so it's okay to use array
+     * notation in DotTerms:
      */
-    sum_type sum(op_mul().apply(left[0],right[0]));
-    for(size_t i = 1; i < N; ++i) {
-        /* XXX This might not be optimized properly by some compilers.
-         * but to do anything else requires changing the requirements
-         * of a scalar operator, or requires defining a new class of scalar
-         * <op>= operators.
-         */
-        sum = op_add().apply(sum, op_mul().apply(left[i], right[i]));
-        /* Note: we don't need get(), since both arguments are required to
-         * be vector expressions.
-         */
-    }
-    return sum;
+    return et::detail::ReduceTerms(DotTerms<LeftT,RightT>(left,right), N);
 }
 
 /** For cross(): compile-time check for a 3D vector. */
@@ -338,7 +377,7 @@ outer(const LeftT& left, const RightT& right)
      * fixed-size matrices):
      */
     typename detail::OuterPromote<LeftT,RightT>::promoted_matrix C;
-    cml::et::detail::Resize(C, left.size(), right.size());
+    cml::et::detail::ResizeUninitialized(C, left.size(), right.size());
 
     /* Now, compute the outer product: */
     for(size_t i = 0; i < left.size(); ++i) {
@@ -14,6 +14,7 @@ Boost Software License, v1.0 (see cml/LICENSE for details).
 #define vector_traits_h
 
 #include <cml/et/traits.h>
+#include <cml/et/packet.h>
 
 namespace cml {
 namespace et {
@@ -33,10 +34,28 @@ struct ExprTraits< cml::vector<E,AT> >
     typedef expr_type result_type;
     typedef expr_leaf_tag node_tag;
 
+    /* The alignment of the vector's array in bytes: */
+    enum { alignment = expr_type::array_alignment };
+
     value_type get(const expr_type& v, size_t i) const { return v[i]; }
     size_t size(const expr_type& v) const { return v.size(); }
 };
 
+/** Packet access to a vector<> type, which stores its elements
+ * contiguously.  Aligned loads are used if the array is aligned to the
+ * packet size.
+ */
+template<typename E, class AT>
+struct PacketAccess< cml::vector<E,AT>, Packet<E>, vector_result_tag >
+{
+    enum { is_true = (Packet<E>::size > 1) };
+    enum { alignment = ExprTraits< cml::vector<E,AT> >::alignment };
+    static typename Packet<E>::type
+    load(const cml::vector<E,AT>& v, size_t i) {
+        return PacketLoad<Packet<E>,alignment>::load(v.data() + i);
+    }
+};
+
 } // namespace et
 } // namespace cml
 
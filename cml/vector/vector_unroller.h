@@ -11,6 +11,10 @@ Boost Software License, v1.0 (see cml/LICENSE for details).
  *
  * Defines vector unrollers.
  *
+ * Assignments whose source expression supports SIMD packets (see
+ * cml/et/packet.h) are evaluated a packet at a time, with any remaining
+ * elements evaluated one at a time.
+ *
  * @todo Add unrolling for dynamic vectors, and for vectors longer than
  * CML_VECTOR_UNROLL_LIMIT.
  *
@@ -25,6 +29,7 @@ Boost Software License, v1.0 (see cml/LICENSE for details).
 #include <cml/et/traits.h>
 #include <cml/et/size_checking.h>
 #include <cml/et/scalar_ops.h>
+#include <cml/et/packet.h>
 
 #if !defined(CML_VECTOR_UNROLL_LIMIT)
 #error "CML_VECTOR_UNROLL_LIMIT is undefined."
@@ -34,6 +39,74 @@ namespace cml {
 namespace et {
 namespace detail {
 
+/** Apply an assignment operator a packet at a time.
+ *
+ * This is the general case, for element types, operators, or source
+ * expressions that can't be evaluated with SIMD packets.
+ *
+ * @sa cml/et/packet.h
+ */
+template<class OpT, typename E, class AT, class SrcT,
+    bool UsePackets = (Packet<E>::size > 1
+            && PacketOp<OpT, Packet<E> >::is_true
+            && PacketAccess<SrcT, Packet<E> >::is_true)>
+struct VectorPacketAssign
+{
+    enum { is_true = false, size = 1 };
+
+    /** Returns the number of elements assigned, here 0. */
+    size_t operator()(cml::vector<E,AT>&, const SrcT&, size_t) const {
+        return 0;
+    }
+};
+
+/** Apply an assignment operator to as many whole packets as fit in the
+ * first N elements of dest.
+ */
+template<class OpT, typename E, class AT, class SrcT>
+struct VectorPacketAssign<OpT,E,AT,SrcT,true>
+{
+    typedef Packet<E> packet;
+    typedef PacketAccess<SrcT,packet> src_access;
+    typedef PacketLoad<packet,
+            ExprTraits< cml::vector<E,AT> >::alignment> dest_access;
+
+    enum { is_true = true, size = packet::size };
+
+    /** Returns the number of elements assigned.  The rest must be assigned
+     * one at a time by the caller.
+     */
+    size_t operator()(
+            cml::vector<E,AT>& dest, const SrcT& src, size_t N) const
+    {
+        const size_t Last = N - N % size;
+        if(Last == 0) return 0;
+        E* d = dest.data();
+        for(size_t i = 0; i < Last; i += size) {
+            dest_access::store(d + i, OpT::template packet_apply<packet>(
+                        dest_access::load(d + i), src_access::load(src,i)));
+        }
+        return Last;
+    }
+};
+
+/** Resize dest before it is assigned by OpT.
+ *
+ * Plain assignment overwrites every element, so the elements are not reset
+ * first.
+ */
+template<class OpT> struct VectorAssignResize {
+    template<class VecT> static void resize(VecT& dest, size_t N) {
+        Resize(dest,N);
+    }
+};
+
+template<class L, class R> struct VectorAssignResize< OpAssign<L,R> > {
+    template<class VecT> static void resize(VecT& dest, size_t N) {
+        ResizeUninitialized(dest,N);
+    }
+};
+
 /** Unroll a binary assignment operator on a fixed-size vector.
  *
  * This uses forward iteration to make efficient use of the cache.
@@ -121,7 +194,18 @@ class VectorAssignmentUnroller
          * is a dynamic-sized expression, the check will still happen.
          */
 
-        /* Now, call the unroller: */
+        /* Use SIMD packets for vectors at least a packet long, with any
+         * remainder assigned one element at a time:
+         */
+        typedef VectorPacketAssign<OpT,E,AT,SrcT> packets;
+        if(packets::is_true && int(Len) >= int(packets::size)) {
+            for(size_t i = packets()(dest,src,Len); i < Len; ++i) {
+                OpT().apply(dest[i], src_traits().get(src,i));
+            }
+            return;
+        }
+
+        /* Otherwise, call the unroller: */
         Unroller()(dest,src);
     }
 
@@ -136,7 +220,7 @@ class VectorAssignmentUnroller
         size_t N = std::max(dest.size(),src_traits().size(src));
 
         /* Set the destination vector's size: */
-        cml::et::detail::Resize(dest,N);
+        VectorAssignResize<OpT>::resize(dest,N);
 #else
         size_t N = CheckedSize(dest,src,dynamic_size_tag());
 #endif
@@ -153,14 +237,19 @@ class VectorAssignmentUnroller
   public:
     
 
-    /** Just use a loop to assign to a runtime-sized vector. */
+    /** Use a loop to assign to a runtime-sized vector, with SIMD packets
+     * if possible.
+     */
     void operator()(vector_type& dest, const SrcT& src, cml::dynamic_size_tag)
     {
         /* Shorthand: */
         typedef ExprTraits<SrcT> src_traits;
         size_t N = this->CheckOrResize(
                 dest,src,typename vector_type::resizing_tag());
-        for(size_t i = 0; i < N; ++i) {
+
+        /* Assign whole packets, then the remaining elements: */
+        size_t i = VectorPacketAssign<OpT,E,AT,SrcT>()(dest,src,N);
+        for(; i < N; ++i) {
             OpT().apply(dest[i], src_traits().get(src,i));
             /* Note: we don't need get(), since dest is a vector. */
         }
@@ -223,6 +312,7 @@ struct VectorAccumulateUnroller
                             left[i],right_traits().get(right,i)));
                 /* Note: we don't need get(), since dest is a vector. */
             }
+            return accum;
         }
     };
 };
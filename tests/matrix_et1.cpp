@@ -147,6 +147,26 @@ void dynamic_test()
 #undef COPY_CONSTRUCT
 }
 
+void hybrid_test()
+{
+    typedef matrix<double, hybrid<4,4>, col_basis, row_major> matrix_type;
+
+#define CONSTRUCT(_a_) _a_(3,3)
+#if defined(CML_AUTOMATIC_MATRIX_RESIZE_ON_ASSIGNMENT)
+#define COPY_ASSIGN(_a_) _a_
+#define COPY_CONSTRUCT(_a_,_e_) _a_(_e_)
+#else
+#define COPY_ASSIGN(_a_) _a_(3,3); _a_
+#define COPY_CONSTRUCT(_a_,_e_) _a_(3,3); _a_ = (_e_)
+#endif
+
+#include "single_matrix_tests.ixx"
+
+#undef CONSTRUCT
+#undef COPY_ASSIGN
+#undef COPY_CONSTRUCT
+}
+
 /* Note: external matrices cannot be copy-constructed, but they can be
  * assigned.
  */
@@ -270,11 +290,1109 @@ void mixed_dynamic_external_test()
 }
 #endif
 
+/* Fill m with distinct values depending on the element position: */
+template<class MatT> void
+fill(MatT& m, double scale)
+{
+    for(size_t i = 0; i < m.rows(); ++ i)
+        for(size_t j = 0; j < m.cols(); ++ j)
+            m(i,j) = typename MatT::value_type(scale*(3*i + 5*j + 1));
+}
+
+/* Check storage-order, packet and tiled assignment from expressions mixing
+ * layouts, against element-by-element results:
+ */
+template<typename E, class L1, class L2> void
+layout_test(size_t R, size_t C)
+{
+    typedef matrix<E, dynamic<>, col_basis, L1> dest_type;
+    typedef matrix<E, dynamic<>, col_basis, L2> other_type;
+
+    dest_type A(R,C), D(R,C), T(C,R);
+    other_type B(R,C);
+    fill(A, 1.); fill(B, 2.); fill(T, 3.);
+
+    D = A + E(2)*B;
+    for(size_t i = 0; i < R; ++ i)
+        for(size_t j = 0; j < C; ++ j)
+            equal_or_fail(D(i,j), A(i,j) + E(2)*B(i,j),
+                    "mixed layout assignment failed");
+
+    D -= -A*E(3) + A;
+    for(size_t i = 0; i < R; ++ i)
+        for(size_t j = 0; j < C; ++ j)
+            equal_or_fail(D(i,j), A(i,j) + E(2)*B(i,j) + E(2)*A(i,j),
+                    "same layout assignment failed");
+
+    D = transpose(T) - B;
+    for(size_t i = 0; i < R; ++ i)
+        for(size_t j = 0; j < C; ++ j)
+            equal_or_fail(D(i,j), T(j,i) - B(i,j),
+                    "transposed assignment failed");
+}
+
+void layout_tests()
+{
+    size_t sizes[] = { 1, 2, 3, 7, 16, 17, 33 };
+    for(size_t a = 0; a < 7; ++ a) {
+        for(size_t b = 0; b < 7; ++ b) {
+            layout_test<double,row_major,row_major>(sizes[a],sizes[b]);
+            layout_test<double,col_major,row_major>(sizes[a],sizes[b]);
+            layout_test<float,col_major,col_major>(sizes[a],sizes[b]);
+            layout_test<int,row_major,col_major>(sizes[a],sizes[b]);
+        }
+    }
+
+    /* Fixed-size, col-major and aligned: */
+    matrix<float, fixed<5,7,64>, col_basis, col_major> A, D;
+    matrix<float, fixed<5,7>, col_basis, row_major> B;
+    fill(A, 1.); fill(B, 2.);
+    D = A*2.f - B;
+    for(size_t i = 0; i < 5; ++ i)
+        for(size_t j = 0; j < 7; ++ j)
+            equal_or_fail(D(i,j), 2.f*A(i,j) - B(i,j),
+                    "fixed col-major assignment failed");
+    D = A + A;
+    D *= 0.5f;
+    equal_or_fail(D, A, "fixed col-major packet assignment failed");
+}
+
+/* Check buffer reuse and moves for dynamic matrices: */
+void storage_tests()
+{
+    typedef matrix<double, dynamic<>, col_basis, row_major> matrix_type;
+
+    matrix_type A(8,8), B(4,5);
+    fill(A, 1.); fill(B, 2.);
+    const double* p = A.data();
+
+    /* Shrinking and copying into a smaller matrix reuse the array: */
+    A.resize(4,5);
+    if(A.data() != p || A.capacity() != 64 || A(3,4) != 0.)
+        throw std::runtime_error("resize() reallocated");
+    A = B;
+    if(A.data() != p)
+        throw std::runtime_error("assignment reallocated");
+    equal_or_fail(A, B, "assignment failed");
+
+    /* reserve() preserves the elements: */
+    A.reserve(100);
+    if(A.capacity() != 100 || A.data() == p)
+        throw std::runtime_error("reserve() failed");
+    equal_or_fail(A, B, "reserve() failed");
+
+    /* resize_uninitialized() keeps the elements when reusing the array: */
+    matrix_type E(B);
+    p = E.data();
+    E.resize_uninitialized(5,4);
+    if(E.data() != p || E(4,3) != B(3,4))
+        throw std::runtime_error("resize_uninitialized() failed");
+    E.resize_uninitialized(11,11);
+    E = B*transpose(B);
+    equal_or_fail(E, matrix_type(B*transpose(B)), "product failed");
+
+#if defined(CML_HAS_RVALUE_REFERENCES)
+    /* Moves take the array: */
+    p = A.data();
+    matrix_type C(std::move(A));
+    if(C.data() != p || A.capacity() != 0)
+        throw std::runtime_error("move construction copied");
+    matrix_type D(4,5);
+    D = transpose(transpose(C));
+    equal_or_fail(D, B, "move assignment failed");
+    p = C.data();
+    D = std::move(C);
+    if(D.data() != p)
+        throw std::runtime_error("move assignment copied");
+#endif
+}
+
+/* Check that arena matrices and their temporaries use the current arena: */
+void arena_tests()
+{
+    typedef matrix<double, dynamic<>, col_basis, row_major> heap_type;
+    typedef matrix< double, dynamic< arena_allocator<void,32> >,
+            col_basis, row_major> matrix_type;
+
+    heap_type A(6,6), B(6,6);
+    fill(A, 1.); fill(B, -0.5);
+    for(size_t i = 0; i < 6; ++ i) A(i,i) += 50.;
+    heap_type expected = transpose(A*B) + inverse(A);
+
+    size_t used = 0;
+    {
+        temp_arena arena(256);
+        matrix_type C(A), D(B);
+        if(size_t(C.data()) % 32 != 0)
+            throw std::runtime_error("arena matrix is not aligned");
+        matrix_type E = transpose(C*D) + inverse(C);
+        equal_or_fail(E, expected, "arena expression failed");
+        used = arena.used();
+
+        /* Product temporaries are taken from the arena too: */
+        double e00 = (C*D)(0,0);
+        equal_or_fail(e00, (A*B)(0,0), "arena product failed");
+        if(arena.used() < used + 36*sizeof(double))
+            throw std::runtime_error("product temporary was not in the arena");
+        used = arena.used();
+
+        /* Nested arenas take over until they go out of scope: */
+        {
+            temp_arena inner;
+            matrix_type F = C*D;
+            if(arena.used() != used || inner.used() == 0)
+                throw std::runtime_error("inner arena was not used");
+        }
+        matrix_type G(C);
+        if(arena.used() == used)
+            throw std::runtime_error("outer arena was not restored");
+    }
+    if(used < 4*36*sizeof(double) || temp_arena::current() != 0)
+        throw std::runtime_error("arena was not used");
+
+    /* Temporaries moved into a matrix created before the arena are copied,
+     * so the matrix does not keep the arena's memory:
+     */
+    matrix_type R(6,6);
+    R.identity();
+    {
+        temp_arena arena;
+        matrix_type C(A);
+        R = transpose(C);
+        if(R.get_allocator() == C.get_allocator())
+            throw std::runtime_error("arena memory escaped the arena");
+    }
+    {
+        temp_arena other;
+        matrix_type X(6,6);
+        X.zero();
+        equal_or_fail(R, heap_type(transpose(A)), "escaped temporary failed");
+    }
+
+    /* Without an arena, the memory comes from operator new: */
+    matrix_type H(A);
+    H = H*transpose(H);
+    equal_or_fail(H, heap_type(A*transpose(A)), "heap fallback failed");
+}
+
+/* Check hybrid matrices against dynamic ones, mixed with fixed and
+ * dynamic matrices:
+ */
+void hybrid_tests()
+{
+    typedef matrix<double, dynamic<>, col_basis, row_major> dynamic_type;
+    typedef matrix<double, hybrid<4,6>, col_basis, row_major> matrix_type;
+    typedef matrix<double, hybrid<6,4,32>, col_basis, col_major> col_type;
+    typedef matrix<double, fixed<6,4>, col_basis, row_major> fixed_type;
+
+    /* Results stay inline unless a dynamic matrix is involved: */
+    typedef et::MatrixPromote<matrix_type,col_type>::type product_type;
+    typedef et::MatrixPromote<col_type,fixed_type>::type sum_type;
+    typedef et::MatrixPromote<matrix_type,dynamic_type>::type mixed_type;
+    if(!same_type<product_type::generator_type, hybrid<4,4> >::is_true
+            || !same_type<sum_type::generator_type, hybrid<6,4> >::is_true
+            || !same_type<mixed_type::generator_type,
+                dynamic< std::allocator<double> > >::is_true)
+        throw std::runtime_error("wrong hybrid promotion");
+
+    dynamic_type A(3,5), B(5,3);
+    fill(A, 1.); fill(B, 0.25);
+    for(size_t i = 0; i < 3; ++ i) B(i,i) += 10.;
+
+    matrix_type HA(A);
+    col_type HB(B);
+    if(size_t(HB.data()) % 32 != 0)
+        throw std::runtime_error("hybrid matrix is not aligned");
+    equal_or_fail(HA, A, "hybrid copy failed");
+    equal_or_fail(HB, B, "hybrid col-major copy failed");
+
+    product_type P = HA*HB;
+    equal_or_fail(P, dynamic_type(A*B), "hybrid product failed");
+    P = transpose(HB)*transpose(HA) - 2.*P;
+    dynamic_type Q = transpose(A*B) - 2.*(A*B);
+    equal_or_fail(P, Q, "hybrid expression failed");
+
+    fixed_type F;
+    fill(F, 0.5);
+    sum_type S = HB*0.5;
+    S.resize(6,4);
+    S = S + F;
+    equal_or_fail(S, F, "hybrid resize failed");
+
+    dynamic_type D = HA*transpose(A) + inverse(P);
+    equal_or_fail(D, dynamic_type(A*transpose(A) + inverse(Q)),
+            "mixed hybrid expression failed");
+
+    /* The capacity cannot be exceeded: */
+    bool threw = false;
+    try { HA.resize(5,5); } catch(std::invalid_argument&) { threw = true; }
+    if(!threw) throw std::runtime_error("hybrid capacity exceeded");
+}
+
+/* Check strided matrices and block views against packed matrices: */
+void block_tests()
+{
+    typedef matrix<double, dynamic<>, col_basis, row_major> dynamic_type;
+    typedef matrix<double, dynamic<>, col_basis, col_major> col_type;
+    typedef matrix<double, strided<>, col_basis, row_major> strided_type;
+
+    /* A padded buffer; the padding must not be touched: */
+    double buf[5*8];
+    for(size_t k = 0; k < 5*8; ++ k) buf[k] = -1.;
+    strided_type S(buf, 5, 6, 8);
+    dynamic_type A(5,6);
+    fill(A, 1.);
+    S = A + A;
+    for(size_t i = 0; i < 5; ++ i)
+        for(size_t j = 0; j < 8; ++ j)
+            equal_or_fail(buf[i*8+j], (j < 6) ? 2.*A(i,j) : -1.,
+                    "strided assignment failed");
+    S *= 0.5;
+    equal_or_fail(S, A, "strided scaling failed");
+
+    /* Blocks of a col-major matrix: */
+    col_type C(6,7), D(6,7);
+    fill(C, 1.);
+    D = C;
+    dynamic_type B(3,4);
+    fill(B, 0.5);
+    block(C,1,2,3,4) = B;
+    for(size_t i = 0; i < 6; ++ i)
+        for(size_t j = 0; j < 7; ++ j) {
+            const bool in = (i >= 1 && i < 4 && j >= 2 && j < 6);
+            equal_or_fail(C(i,j), in ? B(i-1,j-2) : D(i,j),
+                    "block assignment failed");
+        }
+    equal_or_fail(transpose(block(C,1,2,3,4)), dynamic_type(transpose(B)),
+            "block transpose failed");
+
+    /* Blocks of blocks, and read-only blocks: */
+    const col_type& CC = C;
+    equal_or_fail(block(block(CC,1,2,3,4),1,1,2,2), block(B,1,1,2,2),
+            "nested block failed");
+
+    /* A tiled product computed in place: */
+    dynamic_type L(8,6), R(6,8), P(8,8);
+    fill(L, 0.25); fill(R, -0.5);
+    P.zero();
+    for(size_t i = 0; i < 8; i += 4)
+        for(size_t j = 0; j < 8; j += 4)
+            for(size_t k = 0; k < 6; k += 3)
+                block(P,i,j,4,4) += block(L,i,k,4,3)*block(R,k,j,3,4);
+    equal_or_fail(P, dynamic_type(L*R), "tiled product failed");
+
+    /* Products that overlap the destination use a temporary: */
+    dynamic_type Q = P;
+    block(P,0,0,4,4) = block(P,0,0,4,4)*block(P,0,4,4,4);
+    equal_or_fail(block(P,0,0,4,4),
+            dynamic_type(block(Q,0,0,4,4)*block(Q,0,4,4,4)),
+            "aliased block product failed");
+
+    /* Blocks must fit in the matrix, and strides fit the rows: */
+    bool threw = false;
+    try { block(P,6,0,3,3); } catch(std::invalid_argument&) { threw = true; }
+    if(!threw) throw std::runtime_error("block range was not checked");
+    threw = false;
+    try { strided_type T(buf, 2, 6, 5); }
+    catch(std::invalid_argument&) { threw = true; }
+    if(!threw) throw std::runtime_error("stride was not checked");
+}
+
+/* Check compile-time sized submatrices, and the transforms using them: */
+void submatrix_tests()
+{
+    typedef matrix<double, fixed<4,4>, col_basis, col_major> matrix_type;
+    typedef matrix<double, fixed<3,3>, col_basis, col_major> matrix33_type;
+    typedef vector<double, fixed<3> > vector_type;
+
+    matrix_type M, N;
+    fill(M, 1.);
+    N = M;
+    submatrix<3,3>(M,0,0) *= 2.;
+    for(size_t i = 0; i < 4; ++ i)
+        for(size_t j = 0; j < 4; ++ j)
+            equal_or_fail(M(i,j), (i < 3 && j < 3) ? 2.*N(i,j) : N(i,j),
+                    "fixed submatrix assignment failed");
+
+    /* Fixed-size products of strided operands: */
+    matrix33_type A = submatrix<3,3>(N,0,0), B = submatrix<3,3>(N,1,1);
+    matrix33_type P = submatrix<3,3>(N,0,0)*submatrix<3,3>(N,1,1);
+    equal_or_fail(P, matrix33_type(A*B), "fixed submatrix product failed");
+    submatrix<3,3>(M,1,0) = A*B;
+    equal_or_fail(submatrix<3,3>(M,1,0), P, "fixed block product failed");
+
+    /* The linear part of a transform: */
+    matrix_type T;
+    matrix_linear_transform(T, N);
+    for(size_t i = 0; i < 4; ++ i)
+        for(size_t j = 0; j < 4; ++ j)
+            equal_or_fail(T(i,j), (i < 3 && j < 3) ? N(i,j) : (i == j),
+                    "linear transform failed");
+
+    /* Decomposing scale, rotation and translation: */
+    matrix_type S, R, X;
+    matrix_scale(S, 2., 3., 4.);
+    matrix_rotation_axis_angle(R, normalize(vector_type(1.,2.,3.)), 0.5);
+    matrix_translation(X, 1., 2., 3.);
+    T = X*R*S;
+    double sx, sy, sz;
+    matrix33_type rotation;
+    vector_type translation;
+    matrix_decompose_SRT(T, sx, sy, sz, rotation, translation);
+    equal_or_fail(sx, 2.); equal_or_fail(sy, 3.); equal_or_fail(sz, 4.);
+    equal_or_fail(rotation, submatrix<3,3>(R,0,0), "decomposition failed");
+    equal_or_fail(translation[2], 3., "decomposition failed");
+}
+
+/* Check packed symmetric and triangular matrices against general ones: */
+void packed_tests()
+{
+    typedef matrix<double, dynamic<>, col_basis, row_major> dynamic_type;
+    typedef matrix<double, symmetric<>, col_basis, row_major> symmetric_type;
+    typedef matrix<double, lower_triangular<>, col_basis, col_major>
+        lower_type;
+    typedef matrix<double, upper_triangular<>, col_basis, row_major>
+        upper_type;
+    typedef vector< double, dynamic<> > vector_type;
+
+    /* Packed matrices keep one triangle of what they are assigned: */
+    dynamic_type A(5,5), SA(5,5), LA(5,5), UA(5,5);
+    fill(A, 0.5);
+    for(size_t i = 0; i < 5; ++ i)
+        for(size_t j = 0; j < 5; ++ j) {
+            SA(i,j) = (i >= j) ? A(i,j) : A(j,i);
+            LA(i,j) = (i >= j) ? A(i,j) : 0.;
+            UA(i,j) = (i <= j) ? A(i,j) : 0.;
+        }
+    symmetric_type S = A;
+    lower_type L = A;
+    upper_type U = A;
+    equal_or_fail(S, SA, "symmetric assignment failed");
+    equal_or_fail(L, LA, "lower triangular assignment failed");
+    equal_or_fail(U, UA, "upper triangular assignment failed");
+    if(S.packed_size() != 15) throw std::runtime_error("packed size failed");
+
+    /* Symmetric elements are shared, and zeros can't be written: */
+    symmetric_type S2 = S;
+    S2(1,3) = 7.;
+    equal_or_fail(S2(3,1), 7., "symmetric element failed");
+    L(0,4) = 3.;
+    equal_or_fail(L(0,4), 0., "triangular zero failed");
+
+    /* Products, sums and transposes: */
+    equal_or_fail(dynamic_type(L*U), dynamic_type(LA*UA),
+            "triangular product failed");
+    equal_or_fail(dynamic_type(S*L + U), dynamic_type(SA*LA + UA),
+            "packed sum failed");
+    equal_or_fail(dynamic_type(transpose(L)), dynamic_type(transpose(LA)),
+            "triangular transpose failed");
+    lower_type LL = L*L;
+    equal_or_fail(LL, dynamic_type(LA*LA), "lower product failed");
+    symmetric_type SS(5,5);
+    SS = S*S;
+    SS += S*S;
+    equal_or_fail(SS, dynamic_type(2.*(SA*SA)), "symmetric product failed");
+    S2 = S;
+    S2 += A;
+    equal_or_fail(S2, dynamic_type(2.*SA), "symmetric update failed");
+
+    /* Mat-vec products and triangular solves: */
+    vector_type x(5);
+    for(size_t i = 0; i < 5; ++ i) x[i] = double(i) - 1.5;
+    vector_type bl = L*x, bu = x*U, el = LA*x, eu = x*UA;
+    vector_type xl = triangular_solve(L, bl);
+    vector_type xu = triangular_solve(U, vector_type(UA*x));
+    vector_type xa = triangular_solve(A, bl, lower_triangular_tag());
+    for(size_t i = 0; i < 5; ++ i) {
+        equal_or_fail(bl[i], el[i], "triangular mat-vec product failed");
+        equal_or_fail(bu[i], eu[i], "triangular vec-mat product failed");
+        equal_or_fail(xl[i], x[i], "lower triangular solve failed");
+        equal_or_fail(xu[i], x[i], "upper triangular solve failed");
+        equal_or_fail(xa[i], x[i], "general triangular solve failed");
+    }
+
+    /* Transforms copy packed matrices element by element: */
+    symmetric_type S3 = submatrix(A,0,0,3,3);
+    dynamic_type M(4,4), MA(4,4);
+    MA.identity();
+    for(size_t i = 0; i < 3; ++ i)
+        for(size_t j = 0; j < 3; ++ j) MA(i,j) = SA(i,j);
+    matrix_linear_transform(M, S3);
+    equal_or_fail(M, MA, "packed linear transform failed");
+
+#if defined(CML_HAS_RVALUE_REFERENCES)
+    /* Packed matrices moved out of an arena are copied, so the matrix does
+     * not keep the arena's memory:
+     */
+    typedef matrix< double, symmetric< arena_allocator<void> >,
+            col_basis, row_major> arena_type;
+    dynamic_type I2(4,4);
+    I2.identity();
+    I2 *= 2.;
+    arena_type R(4,4);
+    R.zero();
+    {
+        temp_arena arena;
+        arena_type C(4,4);
+        C.identity();
+        C *= 2.;
+        R = std::move(C);
+        if(R.get_allocator() == C.get_allocator())
+            throw std::runtime_error("packed arena memory escaped the arena");
+    }
+    {
+        temp_arena other;
+        arena_type X(4,4);
+        X.zero();
+        equal_or_fail(dynamic_type(R), I2, "escaped packed matrix failed");
+    }
+#endif
+
+    /* Packed matrices are square: */
+    bool threw = false;
+    try { symmetric_type T(3,4); }
+    catch(std::invalid_argument&) { threw = true; }
+    if(!threw) throw std::runtime_error("packed size was not checked");
+}
+
+/* Check banded matrices and their solvers against general ones: */
+void banded_tests()
+{
+    typedef matrix<double, dynamic<>, col_basis, row_major> dynamic_type;
+    typedef matrix<double, banded<2,1>, col_basis, row_major> banded_type;
+    typedef matrix<double, banded<1,2>, col_basis, col_major> banded_t_type;
+    typedef matrix<double, banded<1,1>, col_basis, col_major> tridiag_type;
+    typedef vector< double, dynamic<> > vector_type;
+
+    /* A diagonally dominant matrix, with its band stored separately: */
+    const size_t N = 7;
+    dynamic_type A(N,N), BA(N,N);
+    fill(A, 0.5);
+    for(size_t i = 0; i < N; ++ i) {
+        A(i,i) += 10.;
+        for(size_t j = 0; j < N; ++ j)
+            BA(i,j) = (j + 2 >= i && i + 1 >= j) ? A(i,j) : 0.;
+    }
+    banded_type B = A;
+    equal_or_fail(B, BA, "banded assignment failed");
+    if(B.band_size() != 4*N) throw std::runtime_error("band size failed");
+    B(0,5) = 3.;
+    equal_or_fail(B(0,5), 0., "banded zero failed");
+
+    /* Products and transposes: */
+    banded_t_type BT = transpose(B);
+    equal_or_fail(BT, dynamic_type(transpose(BA)), "banded transpose failed");
+    equal_or_fail(dynamic_type(B*BT), dynamic_type(BA*transpose(BA)),
+            "banded product failed");
+    vector_type x(N);
+    for(size_t i = 0; i < N; ++ i) x[i] = double(i) - 2.5;
+    vector_type b = B*x, bt = x*B, e = BA*x, et = x*BA;
+    for(size_t i = 0; i < N; ++ i) {
+        equal_or_fail(b[i], e[i], "banded mat-vec product failed");
+        equal_or_fail(bt[i], et[i], "banded vec-mat product failed");
+    }
+
+    /* Band LU keeps the band, and matches the general LU: */
+    banded_type LU = lu(B);
+    equal_or_fail(LU, dynamic_type(lu(BA)), "banded LU failed");
+    vector_type xb = lu_solve(LU, b);
+    for(size_t i = 0; i < N; ++ i)
+        equal_or_fail(xb[i], x[i], "banded LU solve failed");
+
+    /* Tridiagonal systems: */
+    tridiag_type T = A;
+    vector_type lower(N), diag(N), upper(N), d = T*x;
+    for(size_t i = 0; i < N; ++ i) {
+        lower[i] = (i > 0) ? A(i,i-1) : 0.;
+        diag[i] = A(i,i);
+        upper[i] = (i + 1 < N) ? A(i,i+1) : 0.;
+    }
+    vector_type xt = tridiagonal_solve(T, d);
+    vector_type xv = tridiagonal_solve(lower, diag, upper, d);
+    vector_type xl = lu_solve(lu(T), d);
+    for(size_t i = 0; i < N; ++ i) {
+        equal_or_fail(xt[i], x[i], "tridiagonal solve failed");
+        equal_or_fail(xv[i], x[i], "tridiagonal vector solve failed");
+        equal_or_fail(xl[i], x[i], "tridiagonal LU solve failed");
+    }
+
+    /* Transforms copy banded matrices element by element: */
+    tridiag_type T3 = submatrix(A,0,0,3,3);
+    dynamic_type M(4,4), MA(4,4);
+    MA.identity();
+    for(size_t i = 0; i < 3; ++ i)
+        for(size_t j = 0; j < 3; ++ j) MA(i,j) = T3(i,j);
+    matrix_linear_transform(M, T3);
+    equal_or_fail(M, MA, "banded linear transform failed");
+    equal_or_fail(M(0,2), 0., "banded linear transform failed");
+
+#if defined(CML_HAS_RVALUE_REFERENCES)
+    /* Banded matrices moved out of an arena are copied, so the matrix does
+     * not keep the arena's memory:
+     */
+    typedef matrix< double, banded<1,1,arena_allocator<void> >,
+            col_basis, row_major> arena_type;
+    dynamic_type I2(4,4);
+    I2.identity();
+    I2 *= 2.;
+    arena_type R(4,4);
+    R.zero();
+    {
+        temp_arena arena;
+        arena_type C(4,4);
+        C.identity();
+        C *= 2.;
+        R = std::move(C);
+        if(R.get_allocator() == C.get_allocator())
+            throw std::runtime_error("banded arena memory escaped the arena");
+    }
+    {
+        temp_arena other;
+        arena_type X(4,4);
+        X.zero();
+        equal_or_fail(dynamic_type(R), I2, "escaped banded matrix failed");
+    }
+#endif
+
+    /* Banded matrices are square: */
+    bool threw = false;
+    try { banded_type C(3,4); }
+    catch(std::invalid_argument&) { threw = true; }
+    if(!threw) throw std::runtime_error("banded size was not checked");
+}
+
+/* Check pivoted LU on matrices that unpivoted LU can't factor: */
+template<class L> void pivot_tests()
+{
+    typedef matrix<double, dynamic<>, col_basis, L> dynamic_type;
+    typedef vector< double, dynamic<> > vector_type;
+    typedef vector< size_t, dynamic<> > pivot_type;
+
+    /* Large enough for several panels, with zeros on the diagonal: */
+    const size_t N = 2*CML_LU_BLOCK_SIZE + 7;
+    dynamic_type A(N,N), B(N,3);
+    for(size_t i = 0; i < N; ++ i) {
+        for(size_t j = 0; j < N; ++ j)
+            A(i,j) = (i == j) ? 0. : double((i*i*7 + j*13 + i*j*5) % 23) - 11;
+        for(size_t j = 0; j < 3; ++ j) B(i,j) = double(i % 5) + j;
+    }
+    pivot_type piv;
+    dynamic_type LU = A;
+    if(lu_pivot_inplace(LU, piv) == 0)
+        throw std::runtime_error("pivoted LU failed");
+    equal_or_fail(LU, dynamic_type(lu_pivot(A, piv)), "lu_pivot() failed");
+
+    /* One and several right-hand sides: */
+    vector_type b = col(B,0);
+    vector_type x = lu_solve(LU, piv, b), r = A*x;
+    for(size_t i = 0; i < N; ++ i)
+        equal_or_fail(r[i], b[i], "pivoted solve failed", 1e-6);
+    dynamic_type X = lu_solve(LU, piv, B);
+    equal_or_fail(dynamic_type(A*X), B, "pivoted multiple solve failed", 1e-6);
+
+    /* In place on external storage, with a fixed pivot vector: */
+    double data[9] = { 0., 1., 1.,  1., 0., 1.,  1., 1., 0. };
+    matrix<double, external<3,3>, col_basis, L> E(data);
+    matrix<double, fixed<3,3>, col_basis, L> F = E;
+    vector< int, fixed<3> > p3;
+    if(lu_pivot_inplace(E, p3) != -1)
+        throw std::runtime_error("permutation sign failed");
+    vector< double, fixed<3> > e(1., 2., 3.), y = lu_solve(E, p3, e), f = F*y;
+    for(size_t i = 0; i < 3; ++ i)
+        equal_or_fail(f[i], e[i], "external solve failed");
+
+    /* Fixed pivot vectors must hold a pivot for each row: */
+    vector< int, fixed<2> > p2;
+    bool threw = false;
+    try { lu_pivot_inplace(E, p2); }
+    catch(const std::invalid_argument&) { threw = true; }
+    if(!threw) throw std::runtime_error("pivot vector size was not checked");
+
+    /* Singular matrices are reported, given an exactly zero pivot: */
+    dynamic_type S(4,4);
+    fill(S, 1.);
+    for(size_t i = 0; i < 4; ++ i) S(i,1) = 0.;
+    if(lu_pivot_inplace(S, piv) != 0)
+        throw std::runtime_error("singular matrix was not reported");
+
+    /* Several right-hand sides with the unpivoted LU: */
+    dynamic_type D = A;
+    for(size_t i = 0; i < N; ++ i) D(i,i) = 300.;
+    dynamic_type Y = lu_solve(lu(D), B);
+    equal_or_fail(dynamic_type(D*Y), B, "multiple solve failed", 1e-6);
+}
+
+/* Check inverses past 4x4, which need pivoting: */
+template<class L> void inverse_tests()
+{
+    typedef matrix<double, dynamic<>, col_basis, L> dynamic_type;
+
+    /* Large enough for several panels, with zeros on the diagonal: */
+    const size_t N = 2*CML_INVERSE_BLOCK_SIZE + 7;
+    dynamic_type A(N,N);
+    for(size_t i = 0; i < N; ++ i)
+        for(size_t j = 0; j < N; ++ j)
+            A(i,j) = (i == j) ? 0. : double((i*i*7 + j*13 + i*j*5) % 23) - 11;
+
+    /* By panels and in the fixed kernel: */
+    dynamic_type I(N,N);
+    I.identity();
+    equal_or_fail(dynamic_type(A*inverse(A)), I, "inverse failed", 1e-10);
+    matrix<double, fixed<6,6>, col_basis, L> G, H, P;
+    for(size_t i = 0; i < 6; ++ i)
+        for(size_t j = 0; j < 6; ++ j) G(i,j) = A(i,j);
+    H = G;
+    if(!inverse_inplace(H)) throw std::runtime_error("inverse failed");
+    P = H*G;
+    equal_or_fail(P, G.identity(), "fixed inverse failed", 1e-12);
+
+    /* Past 4x4, singular matrices are reported too: */
+    dynamic_type Z(5,5), W;
+    fill(Z, 1.);
+    for(size_t i = 0; i < 5; ++ i) Z(i,2) = 0.;
+    W = Z;
+    if(inverse_inplace(W))
+        throw std::runtime_error("singular matrix was not reported");
+    bool singular = false;
+    try { inverse(Z); } catch(const std::invalid_argument&) { singular = true; }
+    if(!singular) throw std::runtime_error("singular inverse did not throw");
+}
+
+/* Check determinants past 4x4 and their logarithms: */
+template<class L> void log_determinant_tests()
+{
+    typedef matrix<double, dynamic<>, col_basis, L> dynamic_type;
+    typedef vector< size_t, dynamic<> > pivot_type;
+
+    /* Large enough for several panels, with zeros on the diagonal: */
+    const size_t N = 2*CML_LU_BLOCK_SIZE + 7;
+    dynamic_type A(N,N);
+    for(size_t i = 0; i < N; ++ i)
+        for(size_t j = 0; j < N; ++ j)
+            A(i,j) = (i == j) ? 0. : double((i*i*7 + j*13 + i*j*5) % 23) - 11;
+
+    /* Determinants past 4x4 need pivoting, with zeros on the diagonal: */
+    matrix<double, fixed<6,6>, col_basis, L> G;
+    for(size_t i = 0; i < 6; ++ i)
+        for(size_t j = 0; j < 6; ++ j) G(i,j) = A(i,j);
+    int sign, sign2;
+    double logdet = signed_log_determinant(G, sign);
+    equal_or_fail(sign*std::exp(logdet)/determinant(G), 1.,
+            "pivoted determinant failed", 1e-12);
+
+    /* Logarithms of determinants that do not fit in a double, alone and
+     * from an existing factorization:
+     */
+    dynamic_type D = A;
+    for(size_t i = 0; i < N; ++ i) D(i,i) = 300.;
+    const double logdet_D = log_determinant(D);
+    logdet = log_determinant(D*1e-10);
+    equal_or_fail(logdet, logdet_D + N*std::log(1e-10),
+            "log determinant failed", 1e-9);
+    if(determinant(dynamic_type(D*1e-10)) != 0.)
+        throw std::runtime_error("determinant did not underflow");
+    pivot_type piv;
+    dynamic_type LU = A;
+    lu_pivot_inplace(LU, piv);
+    logdet = signed_log_determinant(LU, piv, sign);
+    equal_or_fail(logdet, signed_log_determinant(A, sign2),
+            "factored log determinant failed", 1e-12);
+    if(sign != sign2) throw std::runtime_error("determinant sign failed");
+    LU = D;
+    lu_pivot_inplace(LU, piv);
+    equal_or_fail(log_determinant(LU, piv), logdet_D,
+            "factored log determinant failed", 1e-12);
+
+    /* Singular matrices have no positive determinant: */
+    dynamic_type Z(5,5);
+    fill(Z, 1.);
+    for(size_t i = 0; i < 5; ++ i) Z(i,2) = 0.;
+    logdet = signed_log_determinant(Z, sign);
+    if(sign != 0 || logdet != -std::numeric_limits<double>::infinity())
+        throw std::runtime_error("singular log determinant failed");
+    bool singular = false;
+    try { log_determinant(Z); }
+    catch(const std::invalid_argument&) { singular = true; }
+    if(!singular) throw std::runtime_error("log determinant did not throw");
+}
+
+/* Check the Cholesky and LDLT factorizations by multiplying them out: */
+template<class L> void cholesky_tests()
+{
+    typedef matrix<double, dynamic<>, col_basis, L> dynamic_type;
+    typedef matrix<double, fixed<5,5>, col_basis, L> fixed_type;
+    typedef matrix<double, symmetric<>, col_basis, L> symmetric_type;
+    typedef matrix<double, lower_triangular<>, col_basis, L> lower_type;
+    typedef vector< double, dynamic<> > vector_type;
+
+    /* A symmetric positive definite matrix needing several panels: */
+    const size_t N = 2*CML_CHOLESKY_BLOCK_SIZE + 5;
+    dynamic_type M(N,N), B(N,2);
+    for(size_t i = 0; i < N; ++ i) {
+        for(size_t j = 0; j < N; ++ j)
+            M(i,j) = double((i*i*7 + j*13 + i*j*5) % 23) - 11;
+        B(i,0) = double(i % 7); B(i,1) = 1.;
+    }
+    dynamic_type A = transpose(M)*M;
+    for(size_t i = 0; i < N; ++ i) A(i,i) += 1.;
+
+    dynamic_type C = cholesky(A);
+    equal_or_fail(dynamic_type(C*transpose(C)), A, "cholesky failed", 1e-6);
+    equal_or_fail(C(0,N-1), 0., "cholesky upper triangle failed");
+    vector_type b = col(B,0), x = cholesky_solve(C, b), r = A*x;
+    for(size_t i = 0; i < N; ++ i)
+        equal_or_fail(r[i], b[i], "cholesky solve failed", 1e-6);
+    dynamic_type X = cholesky_solve(C, B);
+    equal_or_fail(dynamic_type(A*X), B, "cholesky multiple solve failed",
+            1e-6);
+
+    /* The fixed-size kernel and packed matrices give the same factor: */
+    fixed_type F, FA;
+    for(size_t i = 0; i < 5; ++ i)
+        for(size_t j = 0; j < 5; ++ j) FA(i,j) = A(i,j);
+    F = FA;
+    if(!cholesky_inplace(F)) throw std::runtime_error("fixed cholesky failed");
+    symmetric_type S = FA;
+    lower_type LS = cholesky(S);
+    equal_or_fail(F, dynamic_type(cholesky(dynamic_type(FA))),
+            "fixed cholesky failed");
+    equal_or_fail(LS, F, "packed cholesky failed");
+
+    /* Packed symmetric matrices are factored into a lower triangle, which
+     * keeps the whole factor:
+     */
+    equal_or_fail(dynamic_type(LS*transpose(LS)), dynamic_type(S),
+            "packed cholesky product failed", 1e-6);
+    lower_type LDS = ldlt(S);
+    dynamic_type LDF = ldlt(dynamic_type(FA));
+    equal_or_fail(LDS, LDF, "packed ldlt failed", 1e-12);
+    if(LDS(3,1) == 0.) throw std::runtime_error("packed ldlt failed");
+
+    /* LDLT handles symmetric indefinite matrices: */
+    dynamic_type D = A;
+    for(size_t i = 0; i < N; ++ i) D(i,i) -= 2000.;
+    dynamic_type LD = ldlt(D), U(N,N), DU(N,N);
+    U.identity(); DU.zero();
+    for(size_t i = 0; i < N; ++ i) {
+        DU(i,i) = LD(i,i);
+        for(size_t j = 0; j < i; ++ j) U(i,j) = LD(i,j);
+    }
+    equal_or_fail(dynamic_type(U*DU*transpose(U)), D, "ldlt failed", 1e-6);
+    X = ldlt_solve(LD, B);
+    equal_or_fail(dynamic_type(D*X), B, "ldlt solve failed", 1e-6);
+    vector_type ones(5);
+    for(size_t i = 0; i < 5; ++ i) ones[i] = 1.;
+    vector_type y = ldlt_solve(ldlt(S), ones), s = S*y;
+    for(size_t i = 0; i < 5; ++ i)
+        equal_or_fail(s[i], 1., "packed ldlt solve failed");
+
+    /* Matrices that are not positive definite are reported: */
+    bool threw = false;
+    try { C = cholesky(D); }
+    catch(std::invalid_argument&) { threw = true; }
+    if(!threw) throw std::runtime_error("indefinite matrix was not reported");
+}
+
+/* Check the QR factorization and the least-squares solvers: */
+template<class L> void qr_tests()
+{
+    typedef matrix<double, dynamic<>, col_basis, L> dynamic_type;
+    typedef matrix<double, fixed<6,3>, col_basis, L> fixed_type;
+    typedef vector< double, dynamic<> > vector_type;
+
+    /* A tall matrix needing several panels: */
+    const size_t M = 200, N = 3*CML_QR_BLOCK_SIZE - 5;
+    dynamic_type A(M,N), B(M,2);
+    vector_type x0(N), b(M);
+    for(size_t i = 0; i < M; ++ i) {
+        for(size_t j = 0; j < N; ++ j)
+            A(i,j) = std::sin(double(i)*(.7*j + 1.) + double(j));
+        B(i,0) = double(i % 7); B(i,1) = 1.;
+    }
+    for(size_t j = 0; j < N; ++ j) x0[j] = double(j % 5) - 2.;
+    b = A*x0;
+
+    vector_type tau;
+    dynamic_type QR = qr(A, tau);
+    dynamic_type Q = qr_q(QR, tau), R = qr_r(A);
+    dynamic_type R1 = block(R, 0, 0, N, N);
+    equal_or_fail(dynamic_type(Q*R1), A, "qr failed", 1e-9);
+    dynamic_type I(N,N); I.identity();
+    equal_or_fail(dynamic_type(transpose(Q)*Q), I, "qr orthogonality failed",
+            1e-9);
+    equal_or_fail(R(N,0) + R(M-1,N-1), 0., "qr_r lower part failed");
+
+    /* Consistent systems are solved exactly: */
+    vector_type x = qr_solve(QR, tau, b);
+    for(size_t j = 0; j < N; ++ j)
+        equal_or_fail(x[j], x0[j], "qr_solve failed", 1e-9);
+
+    /* The residual of a least-squares solution is orthogonal to A: */
+    dynamic_type X = qr_solve(QR, tau, B);
+    dynamic_type AR = transpose(A)*(A*X - B);
+    dynamic_type Z(N,2); Z.zero();
+    equal_or_fail(AR, Z, "qr least squares failed", 1e-7);
+    vector_type b0 = col(B,0), x1 = qr_solve(A, b0);
+    for(size_t j = 0; j < N; ++ j)
+        equal_or_fail(x1[j], X(j,0), "qr_solve(A,b) failed", 1e-9);
+    equal_or_fail(dynamic_type(qr_solve(A, B)), X, "qr_solve(A,B) failed");
+
+    /* Applying Q^T and then Q gives back the original vector: */
+    qr_apply_qt(QR, tau, b0);
+    qr_apply_q(QR, tau, b0);
+    for(size_t i = 0; i < M; ++ i)
+        equal_or_fail(b0[i], B(i,0), "qr_apply_q failed", 1e-9);
+
+    /* Fixed-size matrices give a fixed-size solution: */
+    fixed_type F;
+    vector< double, fixed<6> > fb;
+    for(size_t i = 0; i < 6; ++ i) {
+        for(size_t j = 0; j < 3; ++ j) F(i,j) = A(i,j);
+        fb[i] = B(i,0);
+    }
+    vector< double, fixed<3> > ftau, fx = qr_solve(F, fb);
+    fixed_type FQR = qr(F, ftau);
+    dynamic_type DF = F, DX = qr_solve(DF, dynamic_type(block(B,0,0,6,1)));
+    for(size_t j = 0; j < 3; ++ j)
+        equal_or_fail(fx[j], DX(j,0), "fixed qr_solve failed", 1e-9);
+    fixed_type FR = qr_r(F);
+    matrix<double, fixed<3,3>, col_basis, L> R3;
+    for(size_t i = 0; i < 3; ++ i)
+        for(size_t j = 0; j < 3; ++ j) R3(i,j) = FR(i,j);
+    equal_or_fail(fixed_type(qr_q(FQR, ftau)*R3), F, "fixed qr failed",
+            1e-9);
+
+    /* Rank deficient matrices are reported: */
+    for(size_t i = 0; i < M; ++ i) A(i,3) = 0.;
+    if(qr_inplace(A, tau))
+        throw std::runtime_error("rank deficient qr was not reported");
+}
+
+/* Check eigen_symmetric() by multiplying the decomposition out: */
+template<class L> void eigen_tests()
+{
+    typedef matrix<double, dynamic<>, col_basis, L> dynamic_type;
+    typedef matrix<double, symmetric<>, col_basis, L> symmetric_type;
+    typedef matrix<double, fixed<3,3>, col_basis, L> fixed_type;
+    typedef vector< double, dynamic<> > vector_type;
+
+    const size_t N = 40;
+    dynamic_type A(N,N), V, D(N,N), I(N,N);
+    for(size_t i = 0; i < N; ++ i)
+        for(size_t j = 0; j <= i; ++ j)
+            A(i,j) = A(j,i) = std::sin(double(i)*(.7*j + 1.) + double(j));
+    D.zero(); I.identity();
+
+    vector_type d, d2;
+    if(!eigen_symmetric(A, d, V)) throw std::runtime_error("eigen failed");
+    for(size_t i = 0; i < N; ++ i) {
+        D(i,i) = d[i];
+        if(i > 0 && d[i-1] > d[i])
+            throw std::runtime_error("eigenvalues are not sorted");
+    }
+    equal_or_fail(dynamic_type(V*D*transpose(V)), A, "eigen failed", 1e-12);
+    equal_or_fail(dynamic_type(transpose(V)*V), I, "eigenvectors failed",
+            1e-12);
+
+    /* Packed matrices, and the eigenvalues alone, give the same values: */
+    symmetric_type S = A;
+    eigen_symmetric(S, d2);
+    for(size_t i = 0; i < N; ++ i)
+        equal_or_fail(d2[i], d[i], "eigenvalues failed", 1e-12);
+
+    /* Fixed-size matrices, with the closed form for 3x3 eigenvalues: */
+    fixed_type F(4., 1., 2., 1., 3., 0., 2., 0., 5.), FV, FD;
+    vector< double, fixed<3> > fd, fd2;
+    eigen_symmetric(F, fd, FV);
+    eigen_symmetric(F, fd2);
+    FD.zero();
+    for(size_t i = 0; i < 3; ++ i) {
+        FD(i,i) = fd[i];
+        equal_or_fail(fd2[i], fd[i], "fixed eigenvalues failed", 1e-12);
+    }
+    equal_or_fail(fixed_type(FV*FD*transpose(FV)), F, "fixed eigen failed",
+            1e-12);
+
+    /* Repeated eigenvalues: */
+    F.set(2., 0., 0., 0., 5., 0., 0., 0., 2.);
+    eigen_symmetric(F, fd);
+    equal_or_fail(fd[0], 2., "repeated eigenvalues failed");
+    equal_or_fail(fd[1], 2., "repeated eigenvalues failed");
+    equal_or_fail(fd[2], 5., "repeated eigenvalues failed");
+}
+
+/* Check svd() and polar_decompose() by multiplying them out: */
+template<class L> void svd_tests()
+{
+    typedef matrix<double, dynamic<>, col_basis, L> dynamic_type;
+    typedef matrix<double, fixed<3,3>, col_basis, L> fixed_type;
+    typedef vector< double, dynamic<> > vector_type;
+    typedef vector< double, fixed<3> > vector3_type;
+
+    /* Tall and wide matrices, with the thin factors: */
+    const size_t sizes[2][2] = { { 30, 7 }, { 7, 30 } };
+    for(int k = 0; k < 2; ++ k) {
+        const size_t M = sizes[k][0], N = sizes[k][1], K = 7;
+        dynamic_type A(M,N), U, V, D(K,K), I(K,K);
+        for(size_t i = 0; i < M; ++ i)
+            for(size_t j = 0; j < N; ++ j)
+                A(i,j) = std::sin(double(i)*(.7*j + 1.) + double(j));
+        D.zero(); I.identity();
+
+        vector_type s, s2;
+        if(!svd(A, U, s, V)) throw std::runtime_error("svd failed");
+        for(size_t i = 0; i < K; ++ i) {
+            D(i,i) = s[i];
+            if(i > 0 && s[i-1] < s[i])
+                throw std::runtime_error("singular values are not sorted");
+        }
+        equal_or_fail(dynamic_type(U*D*transpose(V)), A, "svd failed",
+                1e-12);
+        equal_or_fail(dynamic_type(transpose(U)*U), I, "svd U failed",
+                1e-12);
+        equal_or_fail(dynamic_type(transpose(V)*V), I, "svd V failed",
+                1e-12);
+
+        singular_values(A, s2);
+        for(size_t i = 0; i < K; ++ i)
+            equal_or_fail(s2[i], s[i], "singular values failed", 1e-12);
+    }
+
+    /* The 3x3 kernel, with a negative determinant: */
+    fixed_type F(1., 2., 3., 4., 5., 6., 7., 8., 10.), FU, FV, FD, R, S;
+    vector3_type fs;
+    svd(F, FU, fs, FV);
+    FD.zero();
+    for(size_t i = 0; i < 3; ++ i) FD(i,i) = fs[i];
+    equal_or_fail(fixed_type(FU*FD*transpose(FV)), F, "fixed svd failed",
+            1e-12);
+    if(fs[2] < 0.) throw std::runtime_error("fixed svd failed");
+
+    /* Polar decompositions give a rotation whatever the sign of det(F): */
+    for(int k = 0; k < 2; ++ k) {
+        if(k == 1) F.set(2., .3, .1, -.2, 1., .4, .1, 0., 3.);
+        polar_decompose(F, R, S);
+        equal_or_fail(fixed_type(R*S), F, "polar failed", 1e-12);
+        equal_or_fail(S, fixed_type(transpose(S)), "polar S failed", 1e-12);
+        equal_or_fail(fixed_type(transpose(R)*R), fixed_type().identity(),
+                "polar R failed", 1e-12);
+        equal_or_fail(determinant(R), 1., "polar R failed", 1e-12);
+
+        /* The general path agrees with the 3x3 kernel: */
+        dynamic_type DF(F), DR, DS;
+        polar_decompose(DF, DR, DS);
+        equal_or_fail(DR, dynamic_type(R), "dynamic polar failed", 1e-12);
+        equal_or_fail(DS, dynamic_type(S), "dynamic polar failed", 1e-12);
+    }
+
+    /* Singular matrices converge, and still give a rotation: */
+    const double z[9] = { 1., 2., 3.,  2., 4., 6.,  1., 0., 1. };
+    dynamic_type Z(3,3), ZU, ZV, ZR, ZS, I3(3,3);
+    for(size_t i = 0; i < 3; ++ i)
+        for(size_t j = 0; j < 3; ++ j) Z(i,j) = z[3*i+j];
+    I3.identity();
+    vector_type zs;
+    if(!svd(Z, ZU, zs, ZV))
+        throw std::runtime_error("singular svd did not converge");
+    equal_or_fail(zs[2], 0., "singular svd failed", 1e-12);
+    for(int k = 0; k < 2; ++ k) {
+        if(k == 1) Z.zero();
+        if(!polar_decompose(Z, ZR, ZS))
+            throw std::runtime_error("singular polar did not converge");
+        equal_or_fail(dynamic_type(ZR*ZS), Z, "singular polar failed", 1e-12);
+        equal_or_fail(dynamic_type(transpose(ZR)*ZR), I3,
+                "singular polar R failed", 1e-12);
+        equal_or_fail(determinant(ZR), 1., "singular polar R failed", 1e-12);
+    }
+
+    /* Orthogonalizing does not depend on the order of the basis vectors: */
+    fixed_type P(0., 1., 0., 0., 0., 1., 1., 0., 0.), G = F*P;
+    matrix_orthogonalize_3x3_polar(F);
+    matrix_orthogonalize_3x3_polar(G);
+    equal_or_fail(G, fixed_type(F*P), "polar orthogonalize failed", 1e-12);
+}
+
+/* Check the batch functions against inverse() and determinant(): */
+template<class L> void batch_tests()
+{
+    typedef matrix<float, fixed<3,3>, col_basis, L> matrix33_type;
+    typedef matrix<float, fixed<4,4>, col_basis, L> matrix44_type;
+
+    /* The batch results match inverse() and determinant() exactly unless
+     * the compiler may contract multiplies and adds into fused ones:
+     */
+#if defined(__FP_FAST_FMA) || defined(__FP_FAST_FMAF) || defined(__FMA__)
+    const double tol = 1e-4;
+#else
+    const double tol = 0.;
+#endif
+
+    /* Enough matrices for a few packets and a partial one: */
+    const size_t n = 19;
+    matrix33_type A3[n], Z3[n];
+    matrix44_type A4[n], Z4[n];
+    float d3[n], d4[n];
+    for(size_t k = 0; k < n; ++ k) {
+        for(int i = 0; i < 4; ++ i)
+            for(int j = 0; j < 4; ++ j) {
+                const float a = float(std::sin(double(k+i)*(.7*j + 1.)
+                            + double(j)) + (i == j ? 2. : 0.));
+                if(i < 3 && j < 3) A3[k](i,j) = a;
+                A4[k](i,j) = a;
+            }
+    }
+
+    inverse_batch(A3, Z3, n);
+    inverse_batch(A4, Z4, n);
+    determinant_batch(A3, d3, n);
+    determinant_batch(A4, d4, n);
+    for(size_t k = 0; k < n; ++ k) {
+        equal_or_fail(Z3[k], matrix33_type(inverse(A3[k])),
+                "3x3 inverse_batch failed", tol);
+        equal_or_fail(Z4[k], matrix44_type(inverse(A4[k])),
+                "4x4 inverse_batch failed", tol);
+        equal_or_fail(d3[k], determinant(A3[k]),
+                "3x3 determinant_batch failed", tol);
+        equal_or_fail(d4[k], determinant(A4[k]),
+                "4x4 determinant_batch failed", tol);
+    }
+
+    /* In place: */
+    inverse_batch(A4, A4, n);
+    for(size_t k = 0; k < n; ++ k)
+        equal_or_fail(A4[k], Z4[k], "in-place inverse_batch failed", 0.);
+}
+
 int main()
 {
     fixed_test();
     dynamic_test();
+    hybrid_test();
     external_test();
+    layout_tests();
+    storage_tests();
+    arena_tests();
+    hybrid_tests();
+    block_tests();
+    submatrix_tests();
+    packed_tests();
+    banded_tests();
+    pivot_tests<row_major>();
+    pivot_tests<col_major>();
+    inverse_tests<row_major>();
+    inverse_tests<col_major>();
+    log_determinant_tests<row_major>();
+    log_determinant_tests<col_major>();
+    cholesky_tests<row_major>();
+    cholesky_tests<col_major>();
+    qr_tests<row_major>();
+    qr_tests<col_major>();
+    eigen_tests<row_major>();
+    eigen_tests<col_major>();
+    svd_tests<row_major>();
+    svd_tests<col_major>();
+    batch_tests<row_major>();
+    batch_tests<col_major>();
 #if 0
     mixed_fixed_dynamic_test();
     mixed_fixed_external_test();
@@ -0,0 +1,334 @@
+/* -*- C++ -*- ------------------------------------------------------------
+ @@COPYRIGHT@@
+ *-----------------------------------------------------------------------*/
+/** @file
+ *  @brief
+ *
+ * Test matrix multiplication against a reference triple loop.
+ *
+ * Products of run-time sized matrices above CML_BLOCKED_MUL_THRESHOLD go
+ * through the blocked kernel, so the sizes below are chosen to exercise
+ * partial register tiles and partial cache blocks in both layouts.  The
+ * largest products are above CML_PARALLEL_MUL_THRESHOLD, so they are also
+ * computed on the default thread pool.  Assignments like D = A*B + C, which
+ * compute the product directly into D, are checked both with and without D
+ * as one of the operands.  Sparse products are checked against the same
+ * products of a dense copy.
+ *
+ * @sa cml/matrix/matrix_mul.h
+ * @sa cml/matrix/blocked_mul.h
+ * @sa cml/matrix/parallel_mul.h
+ * @sa cml/sparse/sparse_mul.h
+ */
+
+/* Split large products across threads: */
+#define CML_PARALLEL
+#define CML_PARALLEL_SPMV_THRESHOLD 512
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <cmath>
+
+#include <cml/cml.h>
+
+/* Prefix on error messages: */
+#define ERROR_MSG_TAG \
+    std::string(__FUNCTION__) + "@" + TO_STRING(__LINE__) + ": "
+
+using namespace cml;
+
+/* Fill a matrix with small integers, so products are exact: */
+template<typename E, class AT, typename BO, class L> void
+fill(cml::matrix<E,AT,BO,L>& m, int seed)
+{
+    for(size_t i = 0; i < m.rows(); ++ i)
+        for(size_t j = 0; j < m.cols(); ++ j)
+            m(i,j) = E(int((i*7 + j*3 + seed) % 11) - 5);
+}
+
+/* Compare C against the reference product of A and B: */
+template<class MatC, class MatA, class MatB> void
+check_product(const MatC& C, const MatA& A, const MatB& B, std::string msg)
+{
+    if(C.rows() != A.rows() || C.cols() != B.cols())
+        throw std::runtime_error(msg + " (wrong size)");
+    for(size_t i = 0; i < A.rows(); ++ i) {
+        for(size_t j = 0; j < B.cols(); ++ j) {
+            double sum = 0.;
+            for(size_t k = 0; k < A.cols(); ++ k)
+                sum += double(A(i,k))*double(B(k,j));
+            if(std::fabs(sum - double(C(i,j))) > 1e-6)
+                throw std::runtime_error(msg);
+        }
+    }
+}
+
+template<typename E, class L1, class L2> void
+dynamic_test(size_t M, size_t K, size_t N)
+{
+    typedef matrix<E, dynamic<>, col_basis, L1> left_type;
+    typedef matrix<E, dynamic<>, col_basis, L2> right_type;
+
+    left_type A(M,K); fill(A,1);
+    right_type B(K,N); fill(B,2);
+    check_product(A*B, A, B, ERROR_MSG_TAG "A*B");
+    check_product((A+A)*B, A+A, B, ERROR_MSG_TAG "(A+A)*B");
+}
+
+void external_test()
+{
+    typedef matrix<double, external<>, col_basis, row_major> ext_type;
+    typedef matrix<double, dynamic<>, col_basis, col_major> dyn_type;
+
+    std::vector<double> a(70*45), b(45*90);
+    ext_type A(&a[0],70,45); fill(A,3);
+    ext_type B(&b[0],45,90); fill(B,4);
+    dyn_type D(45,90); fill(D,5);
+
+    check_product(A*B, A, B, ERROR_MSG_TAG "external*external");
+    check_product(A*D, A, D, ERROR_MSG_TAG "external*dynamic");
+}
+
+template<typename E, int M, int K, int N, class L1, class L2>
+void fixed_test()
+{
+    typedef matrix<E, fixed<M,K>, col_basis, L1> left_type;
+    typedef matrix<E, fixed<K,N>, col_basis, L2> right_type;
+    typedef matrix<E, fixed<M,N>, col_basis, row_major> row_type;
+    typedef matrix<E, fixed<M,N>, col_basis, col_major> col_type;
+
+    left_type A; fill(A,6);
+    right_type B; fill(B,7);
+    check_product(A*B, A, B, ERROR_MSG_TAG "fixed*fixed");
+
+    /* Results in each layout: */
+    row_type R; detail::MatMulCompute(R, A, B, fixed_size_tag());
+    check_product(R, A, B, ERROR_MSG_TAG "fixed*fixed (row-major)");
+    col_type C; detail::MatMulCompute(C, A, B, fixed_size_tag());
+    check_product(C, A, B, ERROR_MSG_TAG "fixed*fixed (col-major)");
+}
+
+/* Run fixed_test() for all operand layouts: */
+template<typename E, int M, int K, int N> void
+fixed_tests()
+{
+    fixed_test<E,M,K,N,row_major,row_major>();
+    fixed_test<E,M,K,N,row_major,col_major>();
+    fixed_test<E,M,K,N,col_major,row_major>();
+    fixed_test<E,M,K,N,col_major,col_major>();
+}
+
+/* Compare D against alpha A*B + beta C: */
+template<class MatT> void
+check_update(const MatT& D, const MatT& A, const MatT& B, double alpha,
+        const MatT& C, double beta, std::string msg)
+{
+    for(size_t i = 0; i < A.rows(); ++ i) {
+        for(size_t j = 0; j < B.cols(); ++ j) {
+            double sum = 0.;
+            for(size_t k = 0; k < A.cols(); ++ k)
+                sum += double(A(i,k))*double(B(k,j));
+            if(std::fabs(alpha*sum + beta*double(C(i,j)) - double(D(i,j)))
+                    > 1e-6) throw std::runtime_error(msg);
+        }
+    }
+}
+
+/* Assignments that compute the product directly into D, and ones where D
+ * is also an operand.  A, B, C and D must be square, and the same size:
+ */
+template<class MatT> void
+fused_test(MatT& A, MatT& B, MatT& C, MatT& D)
+{
+    fill(A,1); fill(B,2); fill(C,3);
+
+    D = A*B;
+    check_update(D, A, B, 1., C, 0., ERROR_MSG_TAG "D = A*B");
+    D = A*B + C;
+    check_update(D, A, B, 1., C, 1., ERROR_MSG_TAG "D = A*B + C");
+    D = C + A*B;
+    check_update(D, A, B, 1., C, 1., ERROR_MSG_TAG "D = C + A*B");
+    D = A*B - C;
+    check_update(D, A, B, 1., C, -1., ERROR_MSG_TAG "D = A*B - C");
+    D = C - A*B;
+    check_update(D, A, B, -1., C, 1., ERROR_MSG_TAG "D = C - A*B");
+    D = A*B - 2*C;
+    check_update(D, A, B, 1., C, -2., ERROR_MSG_TAG "D = A*B - 2*C");
+    D = C; D += A*B;
+    check_update(D, A, B, 1., C, 1., ERROR_MSG_TAG "D += A*B");
+    D = C; D -= A*B;
+    check_update(D, A, B, -1., C, 1., ERROR_MSG_TAG "D -= A*B");
+
+    /* D is an operand: */
+    D = A; D = D*B;
+    check_update(D, A, B, 1., C, 0., ERROR_MSG_TAG "D = D*B");
+    D = A; D *= B;
+    check_update(D, A, B, 1., C, 0., ERROR_MSG_TAG "D *= B");
+    D = B; D = A*D + C;
+    check_update(D, A, B, 1., C, 1., ERROR_MSG_TAG "D = A*D + C");
+    D = C; D = A*B + D;
+    check_update(D, A, B, 1., C, 1., ERROR_MSG_TAG "D = A*B + D");
+
+    /* Products read elementwise: */
+    D = 2*(A*B);
+    check_update(D, A, B, 2., C, 0., ERROR_MSG_TAG "D = 2*(A*B)");
+    D = transpose(transpose(B)*transpose(A));
+    check_update(D, A, B, 1., C, 0., ERROR_MSG_TAG "D = (B'A')'");
+}
+
+void fused_tests()
+{
+    matrix44f_c A, B, C, D;
+    fused_test(A, B, C, D);
+
+    matrix33d_r A3, B3, C3, D3;
+    fused_test(A3, B3, C3, D3);
+
+    typedef matrix<double, dynamic<>, col_basis, row_major> dyn_type;
+    dyn_type E(5,5), F(5,5), G(5,5), H(5,5);
+    fused_test(E, F, G, H);
+    dyn_type P(90,90), Q(90,90), R(90,90), S(90,90);
+    fused_test(P, Q, R, S);
+}
+
+void parallel_test()
+{
+    typedef matrix<double, dynamic<>, col_basis, row_major> row_type;
+    typedef matrix<double, dynamic<>, col_basis, col_major> col_type;
+    typedef matrix<double, external<>, col_basis, row_major> ext_type;
+
+    thread_pool pool(3);
+
+    row_type A(301,257); fill(A,8);
+    col_type B(257,299); fill(B,9);
+    row_type C;
+    parallel_mul(A, B, C, pool);
+    check_product(C, A, B, ERROR_MSG_TAG "parallel_mul(dynamic)");
+
+    /* External results must already have the right size: */
+    std::vector<double> c(301*299);
+    ext_type E(&c[0],301,299);
+    parallel_mul(A, B, E, pool);
+    check_product(E, A, B, ERROR_MSG_TAG "parallel_mul(external)");
+
+    bool caught = false;
+    try {
+        ext_type F(&c[0],299,301);
+        parallel_mul(A, B, F, pool);
+    } catch(std::invalid_argument&) {
+        caught = true;
+    }
+    if(!caught) throw std::runtime_error(ERROR_MSG_TAG "size mismatch");
+}
+
+/* Check sparse products against the same products of a dense matrix: */
+template<class L1, class L2> void
+sparse_test()
+{
+    typedef matrix<double, dynamic<>, col_basis, row_major> dense_type;
+    typedef vector< double, dynamic<> > vector_type;
+    typedef sparse_matrix<double, L1> sparse_type;
+
+    /* A mostly-empty matrix, added out of order with duplicates: */
+    const size_t M = 300, N = 280;
+    sparse_builder<double> b(M,N);
+    dense_type D(M,N);
+    D.zero();
+    for(size_t t = 0; t < 3*M; ++ t) {
+        const size_t i = (t*37) % M, j = (t*53 + t/M) % N;
+        const double v = double(int(t % 7) - 3);
+        b.add(i,j,v); D(i,j) += v;
+        if(t % 10 == 0) { b.add(i,j,1.); D(i,j) += 1.; }
+    }
+    sparse_type A(b);
+    sparse_matrix<double, L2> T(A);
+    sparse_type S(D);
+    for(size_t i = 0; i < M; ++ i) {
+        for(size_t j = 0; j < N; ++ j) {
+            if(A(i,j) != D(i,j) || T(i,j) != D(i,j) || S(i,j) != D(i,j))
+                throw std::runtime_error(ERROR_MSG_TAG "sparse element");
+        }
+    }
+    if(A.nonzeros() > 3*M)
+        throw std::runtime_error(ERROR_MSG_TAG "sparse duplicates");
+
+    /* Mat-vec products in expressions (exact for small integers): */
+    vector_type x(N), c(M), z(M);
+    for(size_t j = 0; j < N; ++ j) x[j] = double(int(j % 5) - 2);
+    for(size_t i = 0; i < M; ++ i) { c[i] = double(i % 3); z[i] = 1.; }
+    vector_type y = A*x + c, e = D*x + c;
+    vector_type w = (z+z)*A, f = (z+z)*D;
+    vector_type u = A*(x-x);
+    for(size_t i = 0; i < M; ++ i) {
+        if(y[i] != e[i]) throw std::runtime_error(ERROR_MSG_TAG "A*x + c");
+        if(u[i] != 0.) throw std::runtime_error(ERROR_MSG_TAG "A*(x-x)");
+    }
+    for(size_t j = 0; j < N; ++ j) {
+        if(w[j] != f[j]) throw std::runtime_error(ERROR_MSG_TAG "x*A");
+    }
+
+    /* Sparse times dense matrices: */
+    dense_type B(N,17); fill(B,3);
+    check_product(A*B, D, B, ERROR_MSG_TAG "sparse*dense");
+    check_product(A*(B+B), D, B+B, ERROR_MSG_TAG "sparse*(B+B)");
+
+    /* Explicit thread pools: */
+    thread_pool pool(3);
+    vector_type p;
+    parallel_mul(A, x, p, pool);
+    for(size_t i = 0; i < M; ++ i) {
+        if(p[i] != e[i] - c[i])
+            throw std::runtime_error(ERROR_MSG_TAG "parallel_mul(sparse)");
+    }
+
+    bool caught = false;
+    try { vector_type bad = A*c; } catch(std::invalid_argument&) {
+        caught = true;
+    }
+    if(!caught) throw std::runtime_error(ERROR_MSG_TAG "sparse size");
+    caught = false;
+    try { b.add(M,0,1.); } catch(std::invalid_argument&) { caught = true; }
+    if(!caught) throw std::runtime_error(ERROR_MSG_TAG "sparse range");
+}
+
+int main()
+{
+    try {
+        /* Below the threshold: */
+        dynamic_test<double,row_major,row_major>(3,3,3);
+
+        /* Partial register tiles: */
+        dynamic_test<double,row_major,row_major>(37,41,43);
+        dynamic_test<float,row_major,col_major>(37,41,43);
+        dynamic_test<double,col_major,row_major>(37,41,43);
+        dynamic_test<float,col_major,col_major>(37,41,43);
+
+        /* Multiple blocks along each dimension: */
+        dynamic_test<double,row_major,row_major>(211,300,97);
+        dynamic_test<double,col_major,col_major>(130,513,41);
+
+        external_test();
+        fixed_tests<float,2,2,2>();
+        fixed_tests<double,3,3,3>();
+        fixed_tests<float,3,4,4>();
+        fixed_tests<double,3,4,4>();
+        fixed_tests<float,4,3,3>();
+        fixed_tests<double,4,4,3>();
+        fixed_tests<float,4,4,4>();
+        fixed_tests<double,4,4,4>();
+        fixed_tests<double,5,2,6>();
+        fused_tests();
+        parallel_test();
+        sparse_test<row_major,col_major>();
+        sparse_test<col_major,row_major>();
+    } catch(std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// -------------------------------------------------------------------------
+// vim:ft=cpp
@@ -32,6 +32,10 @@
  * Vector dot VecXpr -> Scalar
  * VecXpr dot VecXpr -> Scalar
  *
+ * Assignments evaluated with SIMD packets, for float, double and int.
+ *
+ * Long dot products, summed with multiple (possibly SIMD) accumulators.
+ *
  * @sa cml/vector_ops.h
  * @sa cml/vector_dot.h
  *
@@ -41,6 +45,8 @@
 #include <iostream>
 #include <stdexcept>
 #include <string>
+#include <memory>
+#include <vector>
 #if defined(__ICC) && defined(__linux__) && (__ICC >= 900)
 #include <math.h>
 namespace std {
@@ -133,6 +139,43 @@ void dynamic_test()
 #undef COPY_CONSTRUCT
 }
 
+void hybrid_test()
+{
+    typedef vector< double, hybrid<8> > vector_type;
+
+#define CONSTRUCT(_a_) _a_(4)
+#if defined(CML_AUTOMATIC_VECTOR_RESIZE_ON_ASSIGNMENT)
+#define COPY_ASSIGN(_a_) _a_
+#define COPY_CONSTRUCT(_a_,_e_) _a_(_e_)
+#else
+#define COPY_ASSIGN(_a_) _a_(4); _a_
+#define COPY_CONSTRUCT(_a_,_e_) _a_(4); _a_ = (_e_)
+#endif
+
+#include "single_vector_tests.ixx"
+
+#undef CONSTRUCT
+#undef COPY_ASSIGN
+#undef COPY_CONSTRUCT
+
+    /* Expressions of hybrid and fixed vectors are hybrid vectors: */
+    typedef vector< double, fixed<4> > fixed_type;
+    typedef et::VectorPromote<vector_type,fixed_type>::type promoted_type;
+    if(!same_type<promoted_type::generator_type, hybrid<8> >::is_true)
+        throw std::runtime_error(ERROR_MSG_TAG "wrong hybrid promotion");
+
+    vector_type a(3);
+    a[0] = 1.; a[1] = 2.; a[2] = 3.;
+    vector_type b = 2.*a + a;
+    equal_or_fail(b[2], 9., ERROR_MSG_TAG "hybrid expression");
+
+    /* The capacity cannot be exceeded: */
+    bool threw = false;
+    try { a.resize(9); } catch(std::invalid_argument&) { threw = true; }
+    if(!threw || a.size() != 3)
+        throw std::runtime_error(ERROR_MSG_TAG "hybrid capacity exceeded");
+}
+
 /* Note: external vectors cannot be copy-constructed, but they can be
  * assigned.
  */
@@ -254,10 +297,145 @@ void mixed_dynamic_external_test()
 #undef COPY_CONSTRUCT_2
 }
 
+/* Check expressions evaluated with SIMD packets (cml/et/packet.h) against
+ * the same expressions computed one element at a time, for lengths with
+ * and without a scalar tail:
+ */
+template<typename E, class Alloc> void
+packet_test(size_t N)
+{
+    typedef vector< E, dynamic<Alloc> > vector_type;
+    std::vector<E> _x(N+1);
+    vector< E, external<> > x(&_x[0], N);
+
+    vector_type a(N), b(N), c(N), d(N);
+    for(size_t i = 0; i < N; ++ i) {
+        a[i] = E(int(i%7) - 3); b[i] = E(int(i%5) + 1); c[i] = E(2);
+    }
+
+    c = a + b;
+    c -= -a;
+    c *= E(3);
+    d = E(2)*c - b*E(5);
+    d += a - b;
+    x = d - a;
+    for(size_t i = 0; i < N; ++ i) {
+        E ci = (a[i] + b[i] + a[i])*E(3);
+        E di = E(2)*ci - b[i]*E(5) + (a[i] - b[i]);
+        if(c[i] != ci || d[i] != di || x[i] != di - a[i])
+            throw std::runtime_error(ERROR_MSG_TAG "packet assignment");
+    }
+    if(_x[N] != E(0))
+        throw std::runtime_error(ERROR_MSG_TAG "packet overrun");
+}
+
+void packet_tests()
+{
+    for(size_t N = 1; N <= 37; ++ N) {
+        packet_test< float, std::allocator<void> >(N);
+        packet_test< double, std::allocator<void> >(N);
+        packet_test< int, std::allocator<void> >(N);
+        packet_test< float, aligned_allocator<void,64> >(N);
+        packet_test< double, aligned_allocator<void,32> >(N);
+        packet_test< int, aligned_allocator<void,16> >(N);
+    }
+
+    /* Fixed-size, with a tail: */
+    vector< float, fixed<7> > a, b;
+    for(int i = 0; i < 7; ++ i) { a[i] = float(i); b[i] = float(i*i); }
+    a = b/2.f - a;
+    for(int i = 0; i < 7; ++ i)
+        if(a[i] != float(i*i)/2.f - float(i))
+            throw std::runtime_error(ERROR_MSG_TAG "packet (fixed)");
+
+    /* Aligned storage: */
+    vector< float, fixed<13,-1,32> > c, d;
+    vector< float, dynamic< aligned_allocator<void,64> > > e(13);
+    if(size_t(c.data()) % 32 != 0 || size_t(e.data()) % 64 != 0
+            || et::ExprTraits<vector< float, fixed<13,-1,32> > >::alignment
+            != 32)
+        throw std::runtime_error(ERROR_MSG_TAG "alignment");
+    for(int i = 0; i < 13; ++ i) { c[i] = float(i); e[i] = float(2*i); }
+    d = c + e;
+    e = d*2.f - c;
+    for(int i = 0; i < 13; ++ i)
+        if(d[i] != float(3*i) || e[i] != float(5*i))
+            throw std::runtime_error(ERROR_MSG_TAG "packet (aligned)");
+}
+
+/* Check dot() and length() against a serial sum in double precision: */
+template<typename E> void
+reduction_test(size_t N)
+{
+    vector< E, dynamic<> > a(N), b(N);
+    double ab = 0., aa = 0.;
+    for(size_t i = 0; i < N; ++ i) {
+        a[i] = E(int(i%9) - 4); b[i] = E(int(i%5) + 1);
+        ab += double(a[i])*double(b[i]);
+        aa += double(a[i])*double(a[i]);
+    }
+    equal_or_fail(double(dot(a,b)), ab, ERROR_MSG_TAG "dot()");
+    equal_or_fail(double(dot(a+b,b)), ab + dot(b,b), ERROR_MSG_TAG "dot()");
+    equal_or_fail(double(a.length_squared()), aa, ERROR_MSG_TAG "length^2");
+}
+
+void reduction_tests()
+{
+    for(size_t N = 0; N <= 300; N += (N < 70) ? 1 : 23) {
+        reduction_test<float>(N);
+        reduction_test<double>(N);
+        reduction_test<int>(N);
+    }
+
+    /* Fixed-size, above the unroll limit: */
+    vector< double, fixed<20> > a, b;
+    double ab = 0.;
+    for(int i = 0; i < 20; ++ i) {
+        a[i] = 1./(i+1); b[i] = i; ab += a[i]*b[i];
+    }
+    equal_or_fail(dot(a,b), ab, ERROR_MSG_TAG "dot() (fixed)");
+    equal_or_fail(length(a), std::sqrt(dot(a,a)), ERROR_MSG_TAG "length()");
+
+    /* Far above the limit, without instantiating the unroller: */
+    vector< float, fixed<1200> > c, d;
+    for(int i = 0; i < 1200; ++ i) { c[i] = 1.f; d[i] = 2.f; }
+    equal_or_fail(dot(c,d), 2400.f, ERROR_MSG_TAG "dot() (long fixed)");
+}
+
+/* Check views of vector ranges on both sides of an assignment: */
+void subvector_tests()
+{
+    vector< double, dynamic<> > a(9), b(9);
+    for(int i = 0; i < 9; ++ i) { a[i] = i; b[i] = 10*i; }
+
+    subvector(a,2,5) += subvector(b,0,5)*2.;
+    for(int i = 0; i < 9; ++ i)
+        equal_or_fail(a[i], (i >= 2 && i < 7) ? i + 20*(i-2) : i,
+                ERROR_MSG_TAG "subvector assignment");
+
+    /* Compile-time sized ranges, and read-only views: */
+    vector< double, fixed<4> > p(1., 2., 3., 1.);
+    const vector< double, fixed<4> >& q = p;
+    vector< double, fixed<3> > u(0., 0., 1.);
+    subvector<3>(p,0) = cross(subvector<3>(q,0), u);
+    equal_or_fail(p, vector< double, fixed<4> >(2., -1., 0., 1.),
+            ERROR_MSG_TAG "fixed subvector assignment");
+    equal_or_fail(dot(subvector<2>(q,0), subvector(b,2,2)), 10.,
+            ERROR_MSG_TAG "subvector dot()");
+
+    bool threw = false;
+    try { subvector(a,5,5); } catch(std::invalid_argument&) { threw = true; }
+    if(!threw) throw std::runtime_error(ERROR_MSG_TAG "subvector range");
+}
+
 int main()
 {
     fixed_test();
     dynamic_test();
+    hybrid_test();
+    packet_tests();
+    reduction_tests();
+    subvector_tests();
 #if 0
     external_test();
     mixed_fixed_dynamic_test();